@@ -42,6 +42,11 @@ android {
             cmake {
                 cppFlags("-std=c++17", "-O3", "-fPIC", "-DNDEBUG")
                 arguments("-DANDROID_STL=c++_shared")
+                // Profile recorded by src/main/cpp/host/pgo_profile.sh:
+                // flutter build apk --release -PmicrollmPgoProfile=/abs/path/microllm.profdata
+                (project.findProperty("microllmPgoProfile") as String?)?.let {
+                    arguments("-DMICROLLM_PGO=$it")
+                }
             }
         }
         
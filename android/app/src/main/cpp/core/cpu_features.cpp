@@ -0,0 +1,38 @@
+#include "cpu_features.h"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+namespace microllm {
+
+#if defined(__aarch64__) && defined(__linux__)
+// Values from the arm64 uapi <asm/hwcap.h>; spelled out because older NDK sysroots lack
+// the HWCAP2 ones.
+static constexpr unsigned long HWCAP_SHA2_BIT = 1UL << 6;
+static constexpr unsigned long HWCAP_ASIMDDP_BIT = 1UL << 20;
+static constexpr unsigned long HWCAP_SVE_BIT = 1UL << 22;
+static constexpr unsigned long HWCAP2_I8MM_BIT = 1UL << 13;
+#endif
+
+cpu_features detect_cpu_features() {
+    cpu_features f;
+#if defined(__aarch64__) && defined(__linux__)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    const unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    f.dotprod = (hwcap & HWCAP_ASIMDDP_BIT) != 0;
+    f.sve = (hwcap & HWCAP_SVE_BIT) != 0;
+    f.sha2 = (hwcap & HWCAP_SHA2_BIT) != 0;
+    f.i8mm = (hwcap2 & HWCAP2_I8MM_BIT) != 0;
+#endif
+    return f;
+}
+
+const char * best_ggml_variant(const cpu_features & features) {
+    // The i8mm build also uses dotprod; every ARMv8.6 core has both, but check anyway.
+    if (features.i8mm && features.dotprod) return "ggml_i8mm";
+    if (features.dotprod) return "ggml_dotprod";
+    return "ggml";
+}
+
+} // namespace microllm
@@ -0,0 +1,25 @@
+// Runtime detection of the arm64 extensions ggml's quantized kernels are compiled for.
+//
+// The APK ships libggml.so in several builds (see CPU VARIANTS in CMakeLists.txt); the
+// loader asks best_ggml_variant() which one this CPU can run before any of them is mapped.
+// Deliberately free of ggml/llama dependencies so it can be loaded first.
+
+#pragma once
+
+namespace microllm {
+
+struct cpu_features {
+    bool dotprod = false; // ARMv8.2 SDOT/UDOT (HWCAP_ASIMDDP)
+    bool i8mm = false;    // ARMv8.6 SMMLA/UMMLA (HWCAP2_I8MM)
+    bool sve = false;     // HWCAP_SVE (reported only; no SVE variant is built)
+    bool sha2 = false;    // ARMv8 SHA256H/SHA256SU (HWCAP_SHA2), used by sha256.h
+};
+
+// getauxval(AT_HWCAP/AT_HWCAP2) on arm64 Linux/Android; all false elsewhere.
+cpu_features detect_cpu_features();
+
+// Library name (without "lib" / ".so") of the fastest libggml build the CPU supports:
+// "ggml_i8mm", "ggml_dotprod" or the baseline "ggml".
+const char * best_ggml_variant(const cpu_features & features);
+
+} // namespace microllm
@@ -0,0 +1,100 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sched.h>
+
+namespace microllm {
+
+// Upper bound on cpuN directories probed; sysfs numbering can have holes when cores are
+// hot-unplugged, so probing does not stop at the first missing one.
+static constexpr int32_t MAX_PROBED_CPUS = 64;
+
+static bool read_int64(const std::string & path, int64_t & out) {
+    FILE * f = fopen(path.c_str(), "r");
+    if (f == nullptr) return false;
+    long long v = 0;
+    const bool ok = fscanf(f, "%lld", &v) == 1;
+    fclose(f);
+    if (ok) out = (int64_t) v;
+    return ok;
+}
+
+cpu_topology read_cpu_topology(const std::string & sysfs_cpu_dir) {
+    cpu_topology topo;
+    for (int32_t id = 0; id < MAX_PROBED_CPUS; id++) {
+        const std::string dir = sysfs_cpu_dir + "/cpu" + std::to_string(id);
+
+        // cpu0 usually has no `online` file; a core without one counts as online if its
+        // directory exists at all (probed through cpufreq or topology).
+        int64_t online = 1;
+        const bool has_online = read_int64(dir + "/online", online);
+
+        int64_t max_freq = 0;
+        const bool has_freq = read_int64(dir + "/cpufreq/cpuinfo_max_freq", max_freq);
+
+        int64_t package_id = 0;
+        const bool has_topology = read_int64(dir + "/topology/physical_package_id", package_id);
+
+        if (!has_online && !has_freq && !has_topology) continue;
+        if (online == 0) continue;
+
+        cpu_core core;
+        core.id = id;
+        core.max_freq_khz = has_freq ? max_freq : 0;
+        topo.cores.push_back(core);
+    }
+    return topo;
+}
+
+std::vector<int32_t> cpu_topology::performance_cores() const {
+    std::vector<int32_t> out;
+    if (cores.empty()) return out;
+
+    int64_t min_freq = cores.front().max_freq_khz;
+    int64_t max_freq = cores.front().max_freq_khz;
+    for (const auto & c : cores) {
+        min_freq = std::min(min_freq, c.max_freq_khz);
+        max_freq = std::max(max_freq, c.max_freq_khz);
+    }
+
+    for (const auto & c : cores) {
+        if (min_freq == max_freq || c.max_freq_khz > min_freq) out.push_back(c.id);
+    }
+    return out;
+}
+
+std::vector<int32_t> cpu_topology::fastest_cores() const {
+    std::vector<int32_t> out;
+    int64_t max_freq = 0;
+    for (const auto & c : cores) max_freq = std::max(max_freq, c.max_freq_khz);
+    for (const auto & c : cores) {
+        if (c.max_freq_khz == max_freq) out.push_back(c.id);
+    }
+    return out;
+}
+
+bool pin_current_thread(const std::vector<int32_t> & cores) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int32_t n = 0;
+    for (int32_t id : cores) {
+        if (id < 0 || id >= CPU_SETSIZE) continue;
+        CPU_SET(id, &set);
+        n++;
+    }
+    if (n == 0) return false;
+    // pid 0 = the calling thread (affinity is per thread on Linux).
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+std::string format_core_list(const std::vector<int32_t> & cores) {
+    std::string s;
+    for (size_t i = 0; i < cores.size(); i++) {
+        if (i > 0) s += ',';
+        s += std::to_string(cores[i]);
+    }
+    return s;
+}
+
+} // namespace microllm
@@ -0,0 +1,41 @@
+// CPU core layout read from sysfs, used to keep inference threads off little cores.
+//
+// On big.LITTLE / DynamIQ SoCs the clusters differ in cpuinfo_max_freq, which is the most
+// portable signal Android exposes without root. The same files exist on Linux hosts.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace microllm {
+
+struct cpu_core {
+    int32_t id = 0;
+    int64_t max_freq_khz = 0; // 0 when cpufreq is not exposed
+};
+
+struct cpu_topology {
+    std::vector<cpu_core> cores; // online cores, ascending id
+
+    // Cores above the slowest cluster (big + prime). All cores when the SoC is homogeneous
+    // or frequencies are unknown.
+    std::vector<int32_t> performance_cores() const;
+
+    // Cores of the fastest cluster only (the prime core on 1+3+4 layouts).
+    std::vector<int32_t> fastest_cores() const;
+};
+
+// Reads `<sysfs_cpu_dir>/cpuN/{online,cpufreq/cpuinfo_max_freq}`. `sysfs_cpu_dir` is a
+// parameter so the parser can be pointed at a fixture directory.
+cpu_topology read_cpu_topology(const std::string & sysfs_cpu_dir = "/sys/devices/system/cpu");
+
+// Restricts the calling thread to `cores` (sched_setaffinity). Threads it creates later
+// inherit the mask. Returns false if the mask is empty or the kernel rejects it.
+bool pin_current_thread(const std::vector<int32_t> & cores);
+
+// Comma-separated core ids, e.g. "4,5,6,7", for logs.
+std::string format_core_list(const std::vector<int32_t> & cores);
+
+} // namespace microllm
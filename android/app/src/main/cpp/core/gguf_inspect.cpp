@@ -0,0 +1,116 @@
+#define LOG_TAG "GgufInspect"
+
+#include "gguf_inspect.h"
+
+#include <algorithm>
+
+#include "gguf.h"
+#include "log.h"
+
+namespace microllm {
+
+// Integer value of `key`, whatever width the writer chose; the largest element for
+// per-layer arrays (head_count_kv of OpenELM-style models). `fallback` if absent.
+static int64_t get_int(const gguf_context * gguf, const std::string & key, int64_t fallback) {
+    const int64_t id = gguf_find_key(gguf, key.c_str());
+    if (id < 0) return fallback;
+
+    switch (gguf_get_kv_type(gguf, id)) {
+        case GGUF_TYPE_UINT8:  return gguf_get_val_u8(gguf, id);
+        case GGUF_TYPE_INT8:   return gguf_get_val_i8(gguf, id);
+        case GGUF_TYPE_UINT16: return gguf_get_val_u16(gguf, id);
+        case GGUF_TYPE_INT16:  return gguf_get_val_i16(gguf, id);
+        case GGUF_TYPE_UINT32: return gguf_get_val_u32(gguf, id);
+        case GGUF_TYPE_INT32:  return gguf_get_val_i32(gguf, id);
+        case GGUF_TYPE_UINT64: return (int64_t) gguf_get_val_u64(gguf, id);
+        case GGUF_TYPE_INT64:  return gguf_get_val_i64(gguf, id);
+        case GGUF_TYPE_ARRAY: {
+            const size_t n = gguf_get_arr_n(gguf, id);
+            const gguf_type type = gguf_get_arr_type(gguf, id);
+            if (n == 0 || (type != GGUF_TYPE_INT32 && type != GGUF_TYPE_UINT32)) return fallback;
+            const void * data = gguf_get_arr_data(gguf, id);
+            int64_t max = 0;
+            for (size_t i = 0; i < n; i++) {
+                const int64_t v = type == GGUF_TYPE_INT32 ? ((const int32_t *) data)[i]
+                                                          : ((const uint32_t *) data)[i];
+                max = std::max(max, v);
+            }
+            return max;
+        }
+        default:
+            return fallback;
+    }
+}
+
+static std::string get_str(const gguf_context * gguf, const char * key) {
+    const int64_t id = gguf_find_key(gguf, key);
+    if (id < 0 || gguf_get_kv_type(gguf, id) != GGUF_TYPE_STRING) return "";
+    return gguf_get_val_str(gguf, id);
+}
+
+kv_row_widths kv_widths(int64_t n_embd, int64_t n_head, int64_t n_head_kv,
+                        int64_t key_length, int64_t value_length) {
+    const int64_t head_dim = n_head > 0 ? n_embd / n_head : 0;
+    kv_row_widths kv;
+    kv.k = (key_length > 0 ? key_length : head_dim) * n_head_kv;
+    kv.v = (value_length > 0 ? value_length : head_dim) * n_head_kv;
+    return kv;
+}
+
+bool inspect_gguf(const std::string & path, gguf_model_info & out) {
+    gguf_init_params params = { /*no_alloc =*/ true, /*ctx =*/ nullptr };
+    gguf_context * gguf = gguf_init_from_file(path.c_str(), params);
+    if (gguf == nullptr) {
+        LOGE("Cannot read GGUF header: %s", path.c_str());
+        return false;
+    }
+
+    out = gguf_model_info{};
+    out.architecture = get_str(gguf, "general.architecture");
+    out.name = get_str(gguf, "general.name");
+
+    const int64_t n_tensors = gguf_get_n_tensors(gguf);
+    for (int64_t i = 0; i < n_tensors; i++) {
+        const ggml_type type = gguf_get_tensor_type(gguf, i);
+        const int64_t bytes = (int64_t) gguf_get_tensor_size(gguf, i);
+        out.weights_bytes += bytes;
+        out.n_params += bytes / (int64_t) ggml_type_size(type) * ggml_blck_size(type);
+
+        auto it = std::find_if(out.types.begin(), out.types.end(),
+                               [type](const gguf_type_bytes & t) { return t.type == type; });
+        if (it == out.types.end()) {
+            out.types.push_back({ type, 0, 0 });
+            it = out.types.end() - 1;
+        }
+        it->n_tensors++;
+        it->bytes += bytes;
+    }
+    std::sort(out.types.begin(), out.types.end(),
+              [](const gguf_type_bytes & a, const gguf_type_bytes & b) { return a.bytes > b.bytes; });
+
+    // Hyperparameters live under the architecture's own prefix ("llama.block_count").
+    const std::string arch = out.architecture + ".";
+    out.n_ctx_train = (int32_t) get_int(gguf, arch + "context_length", 0);
+    out.n_layer = (int32_t) get_int(gguf, arch + "block_count", 0);
+    out.n_embd = (int32_t) get_int(gguf, arch + "embedding_length", 0);
+    out.n_head = (int32_t) get_int(gguf, arch + "attention.head_count", 0);
+    out.n_head_kv = (int32_t) get_int(gguf, arch + "attention.head_count_kv", out.n_head);
+
+    const int64_t id_tokens = gguf_find_key(gguf, "tokenizer.ggml.tokens");
+    out.n_vocab = id_tokens >= 0 && gguf_get_kv_type(gguf, id_tokens) == GGUF_TYPE_ARRAY
+                      ? (int32_t) gguf_get_arr_n(gguf, id_tokens)
+                      : (int32_t) get_int(gguf, arch + "vocab_size", 0);
+
+    if (out.n_head > 0) {
+        const kv_row_widths kv = kv_widths(out.n_embd, out.n_head, out.n_head_kv,
+                                           get_int(gguf, arch + "attention.key_length", 0),
+                                           get_int(gguf, arch + "attention.value_length", 0));
+        out.kv_bytes_per_token = (int64_t) out.n_layer * (kv.k + kv.v) *
+                                 (int64_t) ggml_type_size(GGML_TYPE_F16);
+    }
+
+    gguf_free(gguf);
+    return true;
+}
+
+} // namespace microllm
@@ -0,0 +1,58 @@
+// Model facts read from the GGUF header alone.
+//
+// Loading a model to learn its size maps the whole file and builds the tensor graph;
+// inspect_gguf() parses only the metadata and tensor table (gguf_init_from_file with
+// no_alloc), which takes milliseconds. The app uses it to size contexts and judge
+// compatibility from the actual file instead of catalog figures.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ggml.h"
+
+namespace microllm {
+
+// Bytes of the tensors stored in one ggml type (the quantization mix of a file).
+struct gguf_type_bytes {
+    ggml_type type = GGML_TYPE_F32;
+    int32_t n_tensors = 0;
+    int64_t bytes = 0;
+};
+
+struct gguf_model_info {
+    std::string architecture; // general.architecture, e.g. "llama", "qwen2"
+    std::string name;         // general.name; empty if absent
+    int64_t n_params = 0;     // elements over all tensors
+    int64_t weights_bytes = 0;
+    std::vector<gguf_type_bytes> types; // largest share first
+    int32_t n_ctx_train = 0;
+    int32_t n_vocab = 0;
+    int32_t n_layer = 0;
+    int32_t n_embd = 0;
+    int32_t n_head = 0;
+    int32_t n_head_kv = 0;    // largest per-layer value for models that vary it
+    // K plus V cache bytes one token adds at f16, over all layers; scales linearly
+    // with the element size of a quantized cache type. 0 for recurrent models.
+    int64_t kv_bytes_per_token = 0;
+};
+
+// Returns false if the file is not a readable GGUF file.
+bool inspect_gguf(const std::string & path, gguf_model_info & out);
+
+// K and V values one token stores per layer, as llama.cpp's n_embd_k_gqa/n_embd_v_gqa.
+struct kv_row_widths {
+    int64_t k = 0;
+    int64_t v = 0;
+};
+
+// Row widths from the hyperparameters: the explicit head sizes `key_length` and
+// `value_length` (<arch>.attention.key_length/value_length, 0 if absent; Gemma, Qwen3)
+// times n_head_kv, or n_embd / n_head per head otherwise. Shared by inspect_gguf() and
+// llm_engine::estimate_memory() so the two KV figures agree.
+kv_row_widths kv_widths(int64_t n_embd, int64_t n_head, int64_t n_head_kv,
+                        int64_t key_length, int64_t value_length);
+
+} // namespace microllm
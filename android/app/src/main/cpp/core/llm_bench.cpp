@@ -0,0 +1,156 @@
+#define LOG_TAG "LlmBench"
+
+#include "llm_bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "llm_engine.h"
+#include "log.h"
+
+namespace microllm {
+
+static double mean(const std::vector<double> & v) {
+    if (v.empty()) return 0.0;
+    double sum = 0.0;
+    for (double x : v) sum += x;
+    return sum / (double) v.size();
+}
+
+static double stddev(const std::vector<double> & v) {
+    if (v.size() < 2) return 0.0;
+    const double m = mean(v);
+    double sq = 0.0;
+    for (double x : v) sq += (x - m) * (x - m);
+    return std::sqrt(sq / (double) (v.size() - 1));
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// One pp + tg measurement from an empty KV cache.
+static bool run_once(llm_engine & engine, const std::vector<llama_token> & prompt, int32_t n_gen,
+                     double & pp_ms, double & ttft_ms, double & tg_ms) {
+    engine.clear_context();
+
+    const auto t0 = std::chrono::steady_clock::now();
+    if (engine.decode(prompt.data(), (int32_t) prompt.size()) != 0) {
+        return false;
+    }
+    llama_synchronize(engine.context());
+    pp_ms = elapsed_ms(t0);
+
+    llama_token token = engine.sample();
+    ttft_ms = elapsed_ms(t0);
+
+    // Generation is timed on its own so tg tok/s is comparable across prompt sizes.
+    const auto t1 = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < n_gen; i++) {
+        if (engine.decode(&token, 1) != 0) {
+            return false;
+        }
+        token = engine.sample();
+    }
+    llama_synchronize(engine.context());
+    tg_ms = elapsed_ms(t1);
+    return true;
+}
+
+bool run_llm_bench(const llm_bench_params & params, std::vector<llm_bench_result> & out,
+                   const llm_bench_progress & progress) {
+    if (params.n_prompt.empty() || params.n_batch.empty() || params.n_threads.empty()) {
+        LOGE("Benchmark needs at least one prompt size, batch size and thread count");
+        return false;
+    }
+    for (const auto * list : { &params.n_prompt, &params.n_batch, &params.n_threads }) {
+        if (*std::min_element(list->begin(), list->end()) < 1) {
+            LOGE("Benchmark prompt sizes, batch sizes and thread counts must be >= 1");
+            return false;
+        }
+    }
+
+    const int32_t max_prompt = *std::max_element(params.n_prompt.begin(), params.n_prompt.end());
+    const int32_t reps = std::max(1, params.repetitions);
+
+    llm_load_params load;
+    load.model_path = params.model_path;
+    load.n_ctx = max_prompt + params.n_gen + 1;
+    load.n_batch = params.n_batch.front();
+    load.n_ubatch = load.n_batch;
+    load.n_threads = params.n_threads.front();
+    load.warmup = false; // each configuration below is warmed up by reconfigure()
+
+    llm_engine engine;
+    if (!engine.load(load)) {
+        return false;
+    }
+    load.warmup = true;
+
+    const llama_vocab * vocab = llama_model_get_vocab(engine.model());
+    const int32_t n_vocab = llama_vocab_n_tokens(vocab);
+    const llama_token bos = llama_vocab_bos(vocab);
+
+    // Fixed seed: every combination sees the same prompt prefix.
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<llama_token> dist(0, n_vocab - 1);
+    std::vector<llama_token> tokens((size_t) max_prompt);
+    for (llama_token & t : tokens) t = dist(rng);
+    if (bos >= 0 && !tokens.empty()) tokens[0] = bos;
+
+    const int total = (int) (params.n_batch.size() * params.n_threads.size() * params.n_prompt.size());
+    int done = 0;
+
+    for (int32_t n_batch : params.n_batch) {
+        for (int32_t n_threads : params.n_threads) {
+            load.n_batch = n_batch;
+            load.n_ubatch = n_batch;
+            load.n_threads = n_threads;
+            if (!engine.reconfigure(load)) {
+                return false;
+            }
+            // Greedy: sampling cost stays constant and out of the measurement noise.
+            engine.reset_sampler(0.0f, 1.0f, 0);
+
+            for (int32_t n_prompt : params.n_prompt) {
+                const std::vector<llama_token> prompt(tokens.begin(), tokens.begin() + n_prompt);
+                std::vector<double> pp_tps, tg_tps, ttft;
+                for (int32_t r = 0; r < reps; r++) {
+                    double pp_ms = 0.0, ttft_ms = 0.0, tg_ms = 0.0;
+                    if (!run_once(engine, prompt, params.n_gen, pp_ms, ttft_ms, tg_ms)) {
+                        LOGE("Decode failed (pp=%d, batch=%d, threads=%d)", n_prompt, n_batch, n_threads);
+                        return false;
+                    }
+                    pp_tps.push_back(pp_ms > 0.0 ? n_prompt * 1000.0 / pp_ms : 0.0);
+                    tg_tps.push_back(tg_ms > 0.0 ? params.n_gen * 1000.0 / tg_ms : 0.0);
+                    ttft.push_back(ttft_ms);
+                }
+
+                llm_bench_result res;
+                res.n_prompt = n_prompt;
+                res.n_gen = params.n_gen;
+                res.n_batch = n_batch;
+                res.n_threads = n_threads;
+                res.pp_tps = mean(pp_tps);
+                res.pp_tps_stddev = stddev(pp_tps);
+                res.tg_tps = mean(tg_tps);
+                res.tg_tps_stddev = stddev(tg_tps);
+                res.ttft_ms = mean(ttft);
+                out.push_back(res);
+
+                LOGI("pp%d tg%d b%d t%d: pp %.2f tok/s, tg %.2f tok/s, ttft %.1f ms",
+                     n_prompt, params.n_gen, n_batch, n_threads, res.pp_tps, res.tg_tps, res.ttft_ms);
+
+                done++;
+                if (progress && !progress(done, total)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace microllm
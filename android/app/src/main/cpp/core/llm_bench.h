@@ -0,0 +1,45 @@
+// Token-throughput benchmark over llm_engine, in the style of llama-bench.
+//
+// Loads the real GGUF and, for every (n_batch, n_threads, n_prompt) combination,
+// measures prompt processing (pp), token generation (tg) and time to first token.
+// Prompts are random vocab tokens, so results depend only on the model and the device.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace microllm {
+
+struct llm_bench_params {
+    std::string model_path;
+    std::vector<int32_t> n_prompt = { 128, 512 };
+    int32_t n_gen = 32;
+    std::vector<int32_t> n_batch = { 512 };
+    std::vector<int32_t> n_threads = { 4 };
+    int32_t repetitions = 3;
+};
+
+struct llm_bench_result {
+    int32_t n_prompt = 0;
+    int32_t n_gen = 0;
+    int32_t n_batch = 0;
+    int32_t n_threads = 0;
+    double pp_tps = 0.0;        // prompt tokens per second (mean over repetitions)
+    double pp_tps_stddev = 0.0;
+    double tg_tps = 0.0;        // generated tokens per second (mean over repetitions)
+    double tg_tps_stddev = 0.0;
+    double ttft_ms = 0.0;       // prefill + first sample, mean over repetitions
+};
+
+// Called after each finished result with (done, total). Return false to stop early.
+using llm_bench_progress = std::function<bool(int done, int total)>;
+
+// Appends one result per combination to `out`. Returns false if the model cannot be
+// loaded or a decode fails; results gathered before the failure are kept.
+bool run_llm_bench(const llm_bench_params & params, std::vector<llm_bench_result> & out,
+                   const llm_bench_progress & progress = nullptr);
+
+} // namespace microllm
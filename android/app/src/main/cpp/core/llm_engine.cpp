@@ -0,0 +1,779 @@
+#define LOG_TAG "LlmEngine"
+
+#include "llm_engine.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+#include "cpu_topology.h"
+#include "ggml-cpu.h"
+#include "gguf_inspect.h"
+#include "log.h"
+#include "model_prefetch.h"
+#include "proc_stats.h"
+
+namespace microllm {
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Nearest-rank percentile of an ascending-sorted sample.
+static double percentile(const std::vector<double> & sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const size_t rank = (size_t) std::ceil(p * (double) sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// Readahead is I/O bound; more threads only help while flash has queue depth left.
+static constexpr int32_t PREFETCH_THREADS = 4;
+// Share of the load progress bar given to llama.cpp's own loading (with mmap it only
+// maps the file and sets up tensors); the rest tracks the prefetch.
+static constexpr float MODEL_LOAD_SHARE = 0.1f;
+
+namespace {
+
+// Combines llama.cpp's load progress with the prefetch into one monotonic value.
+struct load_progress {
+    const std::function<void(float)> & callback;
+    const model_prefetcher * prefetch;
+    float model = 0.0f;
+    float reported = -1.0f;
+
+    void report() {
+        if (!callback) return;
+        const float fetched = prefetch ? prefetch->progress() : 1.0f;
+        const float p = MODEL_LOAD_SHARE * model + (1.0f - MODEL_LOAD_SHARE) * fetched;
+        if (p > reported) {
+            reported = p;
+            callback(p);
+        }
+    }
+};
+
+} // namespace
+
+ggml_type kv_cache_type_from_name(const std::string & name) {
+    if (name == "f16")  return GGML_TYPE_F16;
+    if (name == "q8_0") return GGML_TYPE_Q8_0;
+    if (name == "q4_0") return GGML_TYPE_Q4_0;
+    return GGML_TYPE_COUNT;
+}
+
+bool is_end_of_generation(const llama_model * model, llama_token token) {
+    // llama.cpp collects the end-of-generation set at load: EOS, EOT and the known
+    // end-of-turn token texts.
+    return llama_vocab_is_eog(llama_model_get_vocab(model), token);
+}
+
+llm_engine::~llm_engine() {
+    unload();
+}
+
+void llm_engine::backend_init() {
+    LOGI("Initializing llama backend");
+    llama_backend_init();
+}
+
+bool llm_engine::load(const llm_load_params & params) {
+    if (model_ != nullptr) {
+        LOGI("Unloading existing model first");
+        unload();
+    }
+
+    LOGI("Loading model from: %s", params.model_path.c_str());
+    LOGI("Context size: %d, batch: %d, ubatch: %d, threads: %d", params.n_ctx, params.n_batch,
+         params.n_ubatch, params.n_threads);
+    LOGI("Flash attention: %s, KV cache: K %s, V %s", params.flash_attn ? "on" : "off",
+         ggml_type_name(params.type_k), ggml_type_name(params.type_v));
+
+    llama_model_params model_params = llama_model_default_params();
+    model_params.n_gpu_layers = 0;  // CPU only for mobile
+    model_params.use_mmap = true;
+    model_params.use_mlock = false; // whole-model mlock; hot tensors are pinned selectively below
+
+    // Started first so the readahead overlaps llama.cpp parsing the file. A quarter of
+    // the free memory is left for the KV cache and compute buffers.
+    std::unique_ptr<model_prefetcher> prefetch;
+    if (params.prefetch) {
+        prefetch = std::make_unique<model_prefetcher>(params.model_path, PREFETCH_THREADS,
+                                                      available_memory_bytes() / 4 * 3);
+    }
+    load_progress progress{ params.on_progress, prefetch.get() };
+    progress.report();
+    model_params.progress_callback = [](float p, void * user_data) {
+        auto * lp = static_cast<load_progress *>(user_data);
+        lp->model = p;
+        lp->report();
+        return true;
+    };
+    model_params.progress_callback_user_data = &progress;
+
+    model_ = llama_model_load_from_file(params.model_path.c_str(), model_params);
+    if (model_ == nullptr) {
+        LOGE("Failed to load model");
+        return false;
+    }
+
+    LOGI("Model loaded, creating context...");
+    if (!init_context(params)) {
+        llama_model_free(model_);
+        model_ = nullptr;
+        return false;
+    }
+    model_path_ = params.model_path;
+
+    if (prefetch) {
+        const auto t0 = std::chrono::steady_clock::now();
+        while (!prefetch->done()) {
+            progress.report();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        LOGI("Waited %.0f ms for prefetch", elapsed_ms(t0));
+    }
+    progress.model = 1.0f;
+    progress.prefetch = nullptr;
+    progress.report();
+
+    {
+        auto residency = std::make_unique<weight_residency>(params.model_path);
+        std::lock_guard<std::mutex> lock(residency_mutex_);
+        residency_ = std::move(residency);
+        lock_hot_weights_ = params.lock_hot_weights;
+    }
+    set_memory_pressure(memory_pressure::none);
+
+    if (params.warmup) {
+        warmup();
+    }
+
+    LOGI("Model loading complete!");
+    return true;
+}
+
+bool llm_engine::reconfigure(const llm_load_params & params) {
+    if (model_ == nullptr) {
+        LOGE("Model not loaded");
+        return false;
+    }
+    free_sampler();
+    if (ctx_) {
+        llama_free(ctx_);
+        ctx_ = nullptr;
+    }
+    free_threadpool();
+    if (!init_context(params)) {
+        return false;
+    }
+    if (params.warmup) {
+        warmup();
+    }
+    return true;
+}
+
+// Decodes `n` copies of `token` at positions pos0.. with logits for the last one only.
+static int decode_filler(llama_context * ctx, llama_token token, int32_t n, llama_pos pos0) {
+    llama_batch batch = llama_batch_init(n, 0, 1);
+    batch.n_tokens = n;
+    for (int32_t i = 0; i < n; i++) {
+        batch.token[i] = token;
+        batch.pos[i] = pos0 + i;
+        batch.n_seq_id[i] = 1;
+        batch.seq_id[i][0] = 0;
+        batch.logits[i] = i == n - 1;
+    }
+    const int res = llama_decode(ctx, batch);
+    llama_batch_free(batch);
+    return res;
+}
+
+llm_warmup_stats llm_engine::warmup() {
+    warmup_ = llm_warmup_stats{};
+    if (ctx_ == nullptr) {
+        LOGE("Context not loaded");
+        return warmup_;
+    }
+
+    const llama_vocab * vocab = llama_model_get_vocab(model_);
+    llama_token token = llama_vocab_bos(vocab);
+    if (token == LLAMA_TOKEN_NULL) token = llama_vocab_eos(vocab);
+    if (token == LLAMA_TOKEN_NULL) token = 0;
+
+    // Bypasses decode() so the tuner, governor and request timings never see it.
+    const int32_t n_prefill = std::max(1, std::min<int32_t>((int32_t) llama_n_ubatch(ctx_),
+                                                            (int32_t) llama_n_ctx(ctx_) - 1));
+    auto t0 = std::chrono::steady_clock::now();
+    if (decode_filler(ctx_, token, n_prefill, 0) != 0) {
+        LOGW("Warm-up prefill failed");
+        clear_context();
+        return warmup_;
+    }
+    warmup_.n_prefill = n_prefill;
+    warmup_.prefill_ms = elapsed_ms(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    if (decode_filler(ctx_, token, 1, n_prefill) != 0) {
+        LOGW("Warm-up decode failed");
+    }
+    warmup_.decode_ms = elapsed_ms(t0);
+
+    clear_context();
+    llama_perf_context_reset(ctx_);
+    LOGI("Warm-up: prefill %d tokens %.0f ms, decode %.0f ms", n_prefill, warmup_.prefill_ms,
+         warmup_.decode_ms);
+    return warmup_;
+}
+
+bool llm_engine::init_context(const llm_load_params & requested) {
+    llm_load_params params = requested;
+    if (params.type_v != GGML_TYPE_F16 && !params.flash_attn) {
+        LOGW("Quantized V cache requires flash attention, enabling it");
+        params.flash_attn = true;
+    }
+    params.n_batch = std::max(params.n_batch, 1);
+
+    // Adaptive: the largest ubatch whose compute buffer fits next to the weights and KV.
+    ubatch_tuner_.reset();
+    if (params.n_ubatch <= 0) {
+        params.n_ubatch = params.n_batch;
+        const llm_memory_estimate at_max = estimate_memory(params);
+        params.n_ubatch = choose_n_ubatch(params.n_batch, at_max.weights_bytes, at_max.kv_bytes,
+                                          at_max.compute_bytes, available_memory_bytes());
+        ubatch_tuner_ = std::make_unique<ubatch_tuner>(params.n_ubatch);
+    }
+    params.n_ubatch = std::min(params.n_ubatch, params.n_batch);
+
+    llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx = params.n_ctx;
+    ctx_params.n_batch = params.n_batch;
+    ctx_params.n_ubatch = params.n_ubatch;
+    ctx_params.n_threads = params.n_threads;
+    ctx_params.n_threads_batch = params.n_threads;
+    ctx_params.flash_attn_type = params.flash_attn ? LLAMA_FLASH_ATTN_TYPE_ENABLED
+                                                   : LLAMA_FLASH_ATTN_TYPE_DISABLED;
+    ctx_params.type_k = params.type_k;
+    ctx_params.type_v = params.type_v;
+
+    ctx_ = llama_init_from_model(model_, ctx_params);
+    if (ctx_ == nullptr) {
+        LOGE("Failed to create context");
+        return false;
+    }
+    params_ = params;
+
+    // A reconfigured context keeps serving with the adapter the previous one had.
+    if (!adapter_path_.empty()) {
+        llama_adapter_lora * adapter = find_adapter(adapter_path_);
+        if (adapter == nullptr || llama_set_adapter_lora(ctx_, adapter, adapter_scale_) != 0) {
+            LOGW("Failed to reapply LoRA adapter %s", adapter_path_.c_str());
+            adapter_path_.clear();
+        }
+    }
+
+    const llm_memory_estimate mem = memory_estimate();
+    LOGI("Memory estimate: weights %lld MB, KV %lld MB, compute %lld MB",
+         (long long) (mem.weights_bytes >> 20), (long long) (mem.kv_bytes >> 20),
+         (long long) (mem.compute_bytes >> 20));
+
+    n_past_ = 0;
+    threads_ = llm_thread_config{};
+    threads_.n_threads = params.n_threads;
+    threads_.n_threads_batch = params.n_threads;
+
+    LOGI("Context created, setting up sampler...");
+    reset_sampler(0.7f, 0.9f, 40);
+    return true;
+}
+
+// Integer metadata value `<arch>.<suffix>` of the loaded model, 0 if absent.
+static int64_t arch_meta_int(const llama_model * model, const char * suffix) {
+    char arch[64];
+    if (llama_model_meta_val_str(model, "general.architecture", arch, sizeof(arch)) < 0) {
+        return 0;
+    }
+    const std::string key = std::string(arch) + "." + suffix;
+    char value[32];
+    if (llama_model_meta_val_str(model, key.c_str(), value, sizeof(value)) < 0) {
+        return 0;
+    }
+    return strtoll(value, nullptr, 10);
+}
+
+llm_memory_estimate llm_engine::estimate_memory(const llm_load_params & params) const {
+    llm_memory_estimate est;
+    if (model_ == nullptr) return est;
+
+    const int64_t n_layer = llama_model_n_layer(model_);
+    const int64_t n_embd = llama_model_n_embd(model_);
+    const int64_t n_head = std::max<int64_t>(llama_model_n_head(model_), 1);
+    const int64_t n_head_kv = llama_model_n_head_kv(model_);
+    const int64_t n_vocab = llama_vocab_n_tokens(llama_model_get_vocab(model_));
+    const kv_row_widths kv = kv_widths(n_embd, n_head, n_head_kv,
+                                       arch_meta_int(model_, "attention.key_length"),
+                                       arch_meta_int(model_, "attention.value_length"));
+    const int64_t n_ctx = params.n_ctx;
+    const int64_t n_ubatch = params.n_ubatch > 0 ? params.n_ubatch : params.n_batch;
+
+    est.weights_bytes = (int64_t) llama_model_size(model_);
+    // K and V hold kv.k and kv.v values per token and layer (ggml_row_size accounts for
+    // the block scales of quantized types).
+    est.kv_bytes = n_layer * n_ctx * (int64_t) (ggml_row_size(params.type_k, kv.k) +
+                                                ggml_row_size(params.type_v, kv.v));
+    // f32 activations of one ubatch: a few n_embd-wide intermediates (FFN included) and,
+    // without flash attention, the per-head attention scores over the whole context.
+    // Logits are only computed for the last token.
+    const int64_t scores = params.flash_attn ? 0 : n_head * n_ctx;
+    est.compute_bytes = 4 * (n_vocab + n_ubatch * (8 * n_embd + scores));
+    return est;
+}
+
+void llm_engine::unload() {
+    free_sampler();
+    if (ctx_) {
+        llama_free(ctx_);
+        ctx_ = nullptr;
+    }
+    free_threadpool();
+    warmup_ = llm_warmup_stats{};
+    governor_.reset();
+    ubatch_tuner_.reset();
+    {
+        std::lock_guard<std::mutex> lock(residency_mutex_);
+        residency_.reset();
+    }
+    if (model_) {
+        llama_model_free(model_);
+        model_ = nullptr;
+    }
+    adapters_.clear();
+    adapter_path_.clear();
+    adapter_scale_ = 0.0f;
+    model_path_.clear();
+    n_past_ = 0;
+}
+
+void llm_engine::set_memory_pressure(memory_pressure pressure) {
+    std::lock_guard<std::mutex> lock(residency_mutex_);
+    if (!residency_) return;
+    residency_->set_pressure(pressure);
+    if (pressure == memory_pressure::none && lock_hot_weights_) {
+        residency_->lock_hot(available_memory_bytes() / 2);
+    }
+}
+
+residency_stats llm_engine::residency() const {
+    std::lock_guard<std::mutex> lock(residency_mutex_);
+    return residency_ ? residency_->stats() : residency_stats{};
+}
+
+bool llm_engine::tokenize(const char * text, size_t len, bool add_bos, std::vector<llama_token> & out) const {
+    if (model_ == nullptr) {
+        LOGE("Model not loaded");
+        return false;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const llama_vocab * vocab = llama_model_get_vocab(model_);
+
+    // Estimate max tokens needed; llama_tokenize reports the exact count as a negative
+    // value when the estimate is too small.
+    std::vector<llama_token> tokens(len + 16);
+    int32_t n = llama_tokenize(vocab, text, (int32_t) len, tokens.data(), (int32_t) tokens.size(), add_bos, true);
+    if (n < 0) {
+        tokens.resize((size_t) -n);
+        n = llama_tokenize(vocab, text, (int32_t) len, tokens.data(), (int32_t) tokens.size(), add_bos, true);
+    }
+    if (n < 0) {
+        LOGE("Tokenization failed");
+        return false;
+    }
+
+    out.insert(out.end(), tokens.begin(), tokens.begin() + n);
+    if (timings_.active) timings_.tokenize_ms += elapsed_ms(t0);
+    return true;
+}
+
+int llm_engine::decode(const llama_token * tokens, int32_t n_tokens) {
+    if (ctx_ == nullptr) {
+        LOGE("Context not loaded");
+        return -1;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const int32_t n_batch = (int32_t) llama_n_batch(ctx_);
+    const int32_t seq_id = 0;
+
+    int32_t offset = 0;
+    while (offset < n_tokens) {
+        const int32_t chunk = ubatch_tuner_ ? ubatch_tuner_->next_chunk() : n_batch;
+        const int32_t n_eval = std::min(chunk, n_tokens - offset);
+        const auto t_chunk = std::chrono::steady_clock::now();
+
+        llama_batch batch = llama_batch_init(n_eval, 0, 1);
+        batch.n_tokens = n_eval;
+
+        for (int32_t i = 0; i < n_eval; i++) {
+            batch.token[i] = tokens[offset + i];
+            batch.pos[i] = (llama_pos) (n_past_ + i);
+            batch.n_seq_id[i] = 1;
+            batch.seq_id[i][0] = seq_id;
+            batch.logits[i] = 0;
+        }
+
+        // Only request logits for the last token of the *final* chunk.
+        if (offset + n_eval == n_tokens) {
+            batch.logits[n_eval - 1] = 1;
+        }
+
+        const int res = llama_decode(ctx_, batch);
+        llama_batch_free(batch);
+
+        if (res != 0) {
+            return res;
+        }
+        if (ubatch_tuner_ && n_eval == chunk) {
+            ubatch_tuner_->record(n_eval, elapsed_ms(t_chunk));
+        }
+
+        n_past_ += n_eval;
+        offset += n_eval;
+    }
+
+    const double ms = elapsed_ms(t0);
+    if (timings_.active) {
+        if (!timings_.prefilled) {
+            timings_.prefilled = true;
+            timings_.n_prompt = n_tokens;
+            timings_.prefill_ms = ms;
+        } else {
+            timings_.decode_ms.push_back(ms);
+        }
+    }
+    if (governor_ && n_tokens == 1) {
+        apply_governor(ms);
+    }
+    return 0;
+}
+
+llama_token llm_engine::sample() {
+    if (ctx_ == nullptr || sampler_ == nullptr) {
+        LOGE("Context or sampler not loaded");
+        return -1;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    llama_token token;
+    if (grammar_ != nullptr) {
+        token = sample_constrained();
+    } else {
+        token = llama_sampler_sample(sampler_, ctx_, -1);
+        llama_sampler_accept(sampler_, token);
+    }
+    if (timings_.active) timings_.sample_ms += elapsed_ms(t0);
+    return token;
+}
+
+// Matching a candidate against the grammar costs far more than the rest of the chain, and
+// doing it for the whole vocabulary (150k tokens for Qwen) on every token would dominate
+// decode time. So the chain picks a token first and only that one is checked; the full
+// vocabulary goes through the grammar only when the pick is rejected, which is rare once
+// the model follows the requested format (the same strategy as llama.cpp's common sampler).
+llama_token llm_engine::sample_constrained() {
+    const float * logits = llama_get_logits_ith(ctx_, -1);
+    const int32_t n_vocab = llama_vocab_n_tokens(llama_model_get_vocab(model_));
+    const auto candidates = [&]() {
+        candidates_.resize(n_vocab);
+        for (llama_token id = 0; id < n_vocab; id++) {
+            candidates_[id] = llama_token_data{ id, logits[id], 0.0f };
+        }
+        return llama_token_data_array{ candidates_.data(), candidates_.size(), -1, false };
+    };
+
+    llama_token_data_array cur = candidates();
+    llama_sampler_apply(sampler_, &cur);
+    llama_token token = cur.data[cur.selected].id;
+
+    llama_token_data single = { token, 1.0f, 0.0f };
+    llama_token_data_array check = { &single, 1, -1, false };
+    llama_sampler_apply(grammar_, &check);
+    if (std::isinf(single.logit)) {
+        cur = candidates();
+        llama_sampler_apply(grammar_, &cur);
+        llama_sampler_apply(sampler_, &cur);
+        token = cur.data[cur.selected].id;
+    }
+
+    llama_sampler_accept(grammar_, token);
+    llama_sampler_accept(sampler_, token);
+    return token;
+}
+
+std::string llm_engine::token_to_piece(llama_token token) const {
+    if (model_ == nullptr) {
+        return {};
+    }
+
+    // Token pieces can be longer than 256 bytes for some vocabularies.
+    // Use a bigger buffer to reduce truncation risk.
+    const auto t0 = std::chrono::steady_clock::now();
+    char buf[4096];
+    const llama_vocab * vocab = llama_model_get_vocab(model_);
+    const int32_t len = llama_token_to_piece(vocab, token, buf, (int32_t) sizeof(buf), 0, true);
+    if (timings_.active) timings_.detokenize_ms += elapsed_ms(t0);
+    if (len < 0) {
+        return {};
+    }
+    return std::string(buf, (size_t) len);
+}
+
+llama_token llm_engine::eos() const {
+    if (model_ == nullptr) {
+        return 2; // Default EOS
+    }
+    return llama_vocab_eos(llama_model_get_vocab(model_));
+}
+
+bool llm_engine::is_eog(llama_token token) const {
+    return model_ != nullptr && is_end_of_generation(model_, token);
+}
+
+int32_t llm_engine::n_ctx() const {
+    return ctx_ != nullptr ? (int32_t) llama_n_ctx(ctx_) : 0;
+}
+
+void llm_engine::free_sampler() {
+    if (sampler_) {
+        llama_sampler_free(sampler_);
+        sampler_ = nullptr;
+    }
+    if (grammar_) {
+        llama_sampler_free(grammar_);
+        grammar_ = nullptr;
+    }
+}
+
+bool llm_engine::reset_sampler(float temperature, float top_p, int32_t top_k, const std::string & grammar) {
+    free_sampler();
+
+    llama_sampler_chain_params chain_params = llama_sampler_chain_default_params();
+    sampler_ = llama_sampler_chain_init(chain_params);
+
+    if (top_k > 0) {
+        llama_sampler_chain_add(sampler_, llama_sampler_init_top_k(top_k));
+    }
+    if (top_p < 1.0f) {
+        llama_sampler_chain_add(sampler_, llama_sampler_init_top_p(top_p, 1));
+    }
+    if (temperature > 0) {
+        llama_sampler_chain_add(sampler_, llama_sampler_init_temp(temperature));
+        llama_sampler_chain_add(sampler_, llama_sampler_init_dist(42));
+    } else {
+        llama_sampler_chain_add(sampler_, llama_sampler_init_greedy());
+    }
+
+    if (grammar.empty() || model_ == nullptr) return true;
+    grammar_ = llama_sampler_init_grammar(llama_model_get_vocab(model_), grammar.c_str(), "root");
+    if (grammar_ == nullptr) {
+        LOGE("Failed to parse sampling grammar");
+        return false;
+    }
+    return true;
+}
+
+void llm_engine::clear_context() {
+    if (ctx_ != nullptr) {
+        llama_memory_t mem = llama_get_memory(ctx_);
+        if (mem != nullptr) {
+            llama_memory_clear(mem, true);
+        }
+    }
+    n_past_ = 0;
+}
+
+llama_adapter_lora * llm_engine::find_adapter(const std::string & path) const {
+    for (const auto & entry : adapters_) {
+        if (entry.first == path) return entry.second;
+    }
+    return nullptr;
+}
+
+bool llm_engine::load_adapter(const std::string & path) {
+    if (model_ == nullptr) {
+        LOGE("Model not loaded");
+        return false;
+    }
+    if (find_adapter(path) != nullptr) return true;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    llama_adapter_lora * adapter = llama_adapter_lora_init(model_, path.c_str());
+    if (adapter == nullptr) {
+        LOGE("Failed to load LoRA adapter %s", path.c_str());
+        return false;
+    }
+    adapters_.emplace_back(path, adapter);
+    LOGI("LoRA adapter %s loaded in %.0f ms (%zu loaded)", path.c_str(),
+         elapsed_ms(t0), adapters_.size());
+    return true;
+}
+
+int llm_engine::set_adapter(const std::string & path, float scale) {
+    if (ctx_ == nullptr) {
+        LOGE("Context not loaded");
+        return -1;
+    }
+    if (path == adapter_path_ && (path.empty() || scale == adapter_scale_)) return 0;
+
+    if (path.empty()) {
+        llama_clear_adapter_lora(ctx_);
+    } else {
+        if (!load_adapter(path)) return -1;
+        // One adapter at a time: drop the previous one from the context first.
+        llama_clear_adapter_lora(ctx_);
+        if (llama_set_adapter_lora(ctx_, find_adapter(path), scale) != 0) {
+            LOGE("Failed to apply LoRA adapter %s", path.c_str());
+            llama_adapter_lora * previous = find_adapter(adapter_path_);
+            if (previous != nullptr) {
+                llama_set_adapter_lora(ctx_, previous, adapter_scale_);
+            }
+            return -1;
+        }
+    }
+    LOGI("LoRA adapter: %s (scale %.2f)", path.empty() ? "none" : path.c_str(), scale);
+    adapter_path_ = path;
+    adapter_scale_ = path.empty() ? 0.0f : scale;
+    clear_context();
+    return 1;
+}
+
+bool llm_engine::set_threads(const llm_thread_config & config) {
+    if (ctx_ == nullptr) {
+        LOGE("Context not loaded");
+        return false;
+    }
+
+    llm_thread_config cfg = config;
+    cfg.n_threads = std::max(1, cfg.n_threads);
+    cfg.n_threads_batch = std::max(1, cfg.n_threads_batch);
+
+    const int32_t n_max = std::max(cfg.n_threads, cfg.n_threads_batch);
+
+    // Lowering counts on the same cores (thermal throttling) keeps the existing workers:
+    // ggml runs each graph with fewer threads of a larger pool.
+    if (threadpool_ != nullptr && cfg.cpus == threads_.cpus && n_max <= threadpool_size_) {
+        llama_set_n_threads(ctx_, cfg.n_threads, cfg.n_threads_batch);
+        threads_ = cfg;
+        LOGI("Threads: decode %d, prefill %d (pool of %d kept)", cfg.n_threads, cfg.n_threads_batch, threadpool_size_);
+        return true;
+    }
+
+    ggml_threadpool * pool = nullptr;
+    if (!cfg.cpus.empty()) {
+        if (!pin_current_thread(cfg.cpus)) {
+            LOGW("Could not pin to cores %s; using unpinned threads", format_core_list(cfg.cpus).c_str());
+            cfg.cpus.clear();
+        } else {
+            // One pool serves both phases: they never overlap, and ggml runs each graph
+            // with the per-phase count from llama_set_n_threads below.
+            ggml_threadpool_params tpp = ggml_threadpool_params_default(n_max);
+            for (int32_t cpu : cfg.cpus) {
+                if (cpu >= 0 && cpu < GGML_MAX_N_THREADS) tpp.cpumask[cpu] = true;
+            }
+            pool = ggml_threadpool_new(&tpp);
+            if (pool == nullptr) {
+                LOGW("ggml_threadpool_new failed; using per-graph threads");
+            }
+        }
+    }
+
+    if (pool != nullptr) {
+        llama_attach_threadpool(ctx_, pool, nullptr);
+    } else {
+        llama_detach_threadpool(ctx_);
+    }
+    if (threadpool_ != nullptr) {
+        ggml_threadpool_free(threadpool_);
+    }
+    threadpool_ = pool;
+    threadpool_size_ = pool != nullptr ? n_max : 0;
+
+    llama_set_n_threads(ctx_, cfg.n_threads, cfg.n_threads_batch);
+    threads_ = cfg;
+
+    LOGI("Threads: decode %d, prefill %d, cores [%s]", cfg.n_threads, cfg.n_threads_batch,
+         cfg.cpus.empty() ? "any" : format_core_list(cfg.cpus).c_str());
+    return true;
+}
+
+void llm_engine::apply_governor(double token_ms) {
+    const throttle_decision d = governor_->on_token(token_ms, threads_.n_threads);
+    if (d.n_threads > 0 && d.n_threads != threads_.n_threads) {
+        llm_thread_config cfg = threads_;
+        cfg.n_threads = d.n_threads;
+        set_threads(cfg);
+    }
+    if (d.pause_ms > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(d.pause_ms));
+    }
+}
+
+void llm_engine::free_threadpool() {
+    // Only called once ctx_ is gone, so nothing is attached to the pool any more.
+    if (threadpool_ != nullptr) {
+        ggml_threadpool_free(threadpool_);
+        threadpool_ = nullptr;
+        threadpool_size_ = 0;
+    }
+}
+
+void llm_engine::begin_request() {
+    std::vector<double> decode_ms = std::move(timings_.decode_ms);
+    decode_ms.clear();
+    timings_ = request_timings{};
+    timings_.decode_ms = std::move(decode_ms); // keep the capacity across requests
+    timings_.active = true;
+    reset_peak_rss();
+}
+
+llm_request_metrics llm_engine::end_request() {
+    llm_request_metrics m;
+    m.tokenize_ms = timings_.tokenize_ms;
+    m.n_prompt = timings_.n_prompt;
+    m.prefill_ms = timings_.prefill_ms;
+    m.n_decode = (int32_t) timings_.decode_ms.size();
+    m.sample_ms = timings_.sample_ms;
+    m.detokenize_ms = timings_.detokenize_ms;
+
+    std::sort(timings_.decode_ms.begin(), timings_.decode_ms.end());
+    m.decode_p50_ms = percentile(timings_.decode_ms, 0.50);
+    m.decode_p95_ms = percentile(timings_.decode_ms, 0.95);
+    m.decode_p99_ms = percentile(timings_.decode_ms, 0.99);
+
+    m.kv_used = n_past_;
+    m.kv_size = n_ctx();
+    m.peak_rss_bytes = peak_rss_bytes();
+
+    timings_.active = false;
+    return m;
+}
+
+llm_preload_budget preload_budget(const llm_engine & current, const std::string & model_path) {
+    llm_preload_budget budget;
+    struct stat st{};
+    if (stat(model_path.c_str(), &st) != 0 || st.st_size <= 0) {
+        LOGE("Cannot stat %s", model_path.c_str());
+        return budget;
+    }
+    budget.needed_bytes = (int64_t) st.st_size / 2 * 3;
+    budget.available_bytes = std::max<int64_t>(
+        available_memory_bytes() - current.residency().resident_bytes, 0);
+    LOGI("Preload budget: need %lld MB, %lld MB available next to the current model",
+         (long long) (budget.needed_bytes >> 20), (long long) (budget.available_bytes >> 20));
+    return budget;
+}
+
+} // namespace microllm
@@ -0,0 +1,287 @@
+// Platform-neutral llama.cpp generation engine.
+//
+// Owns one model, its context and sampler chain, and the KV position decoding continues
+// from. No JNI or Android types appear here: llama_jni.cpp is a thin adapter over this
+// class, and host tools (microllm_cli) drive exactly the same code paths.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llama.h"
+#include "thermal_governor.h"
+#include "ubatch_tuner.h"
+#include "weight_residency.h"
+
+namespace microllm {
+
+struct llm_load_params {
+    std::string model_path;
+    int32_t n_ctx = 2048;
+    // Most tokens per llama_decode() call.
+    int32_t n_batch = 512;
+    // Tokens per compute step (<= n_batch); its compute buffer is reserved at load.
+    // 0 = adaptive: sized from available memory, then the prefill chunk size is tuned
+    // on measured throughput (see ubatch_tuner).
+    int32_t n_ubatch = 512;
+    int32_t n_threads = 4;
+    // Fused attention: the n_ctx x n_ubatch score matrix is never materialized.
+    // Required by a quantized V cache, so load() turns it on in that case.
+    bool flash_attn = false;
+    // KV cache element types (F16, Q8_0 or Q4_0; see kv_cache_type_from_name).
+    ggml_type type_k = GGML_TYPE_F16;
+    ggml_type type_v = GGML_TYPE_F16;
+    // Read the weights into the page cache on background threads, in forward-pass order,
+    // and return from load() once they are resident, so the first prompt does not
+    // page-fault them in (see model_prefetch.h).
+    bool prefetch = true;
+    // Pin the output head, attention and embedding weights with mlock() within half of
+    // the free memory, dropping the locks under memory pressure (see weight_residency.h).
+    bool lock_hot_weights = false;
+    // Run llm_engine::warmup() at the end of load() and reconfigure().
+    bool warmup = true;
+    // Overall load progress, 0..1, called on the thread running load().
+    std::function<void(float)> on_progress;
+};
+
+// Maps "f16", "q8_0" or "q4_0" to its ggml type; GGML_TYPE_COUNT for anything else.
+ggml_type kv_cache_type_from_name(const std::string & name);
+
+// Whether `token` ends generation for `model`: its EOS token, and also the end-of-turn
+// tokens chat templates emit that are not EOS (Llama 3 <|eot_id|>, Gemma <end_of_turn>,
+// Phi-3 <|end|>, Qwen <|im_end|>).
+bool is_end_of_generation(const llama_model * model, llama_token token);
+
+// Memory one loaded model needs on top of the process baseline, from its hyperparameters.
+// The compute figure is an upper bound for a full n_ubatch prefill.
+struct llm_memory_estimate {
+    int64_t weights_bytes = 0;
+    int64_t kv_bytes = 0;
+    int64_t compute_bytes = 0;
+
+    int64_t total_bytes() const { return weights_bytes + kv_bytes + compute_bytes; }
+};
+
+// Cost of the warm-up pass (see llm_engine::warmup).
+struct llm_warmup_stats {
+    int32_t n_prefill = 0; // tokens in the dummy prefill (one full ubatch)
+    double prefill_ms = 0.0;
+    double decode_ms = 0.0;
+
+    double total_ms() const { return prefill_ms + decode_ms; }
+};
+
+// Thread counts for single-token decode and batched prefill, and the cores they may run
+// on. An empty `cpus` leaves placement to the kernel scheduler.
+struct llm_thread_config {
+    int32_t n_threads = 4;
+    int32_t n_threads_batch = 4;
+    std::vector<int32_t> cpus;
+};
+
+// Where the time of one generation request went, collected by the engine between
+// begin_request() and end_request(). Durations are wall-clock milliseconds.
+struct llm_request_metrics {
+    double tokenize_ms = 0.0;
+    int32_t n_prompt = 0;      // tokens in the first decode() of the request
+    double prefill_ms = 0.0;
+    int32_t n_decode = 0;      // decode() calls after the prefill (one per generated token)
+    double decode_p50_ms = 0.0;
+    double decode_p95_ms = 0.0;
+    double decode_p99_ms = 0.0;
+    double sample_ms = 0.0;
+    double detokenize_ms = 0.0;
+    int32_t kv_used = 0;       // KV cells in use at end_request()
+    int32_t kv_size = 0;
+    int64_t peak_rss_bytes = 0; // VmHWM; per request when the kernel allows resetting it
+};
+
+class llm_engine {
+public:
+    llm_engine() = default;
+    ~llm_engine();
+
+    llm_engine(const llm_engine &) = delete;
+    llm_engine & operator=(const llm_engine &) = delete;
+
+    // Process-wide llama.cpp initialization; call once before the first load().
+    static void backend_init();
+
+    // Replaces any loaded model. On failure the engine is left unloaded.
+    bool load(const llm_load_params & params);
+    void unload();
+
+    // Recreates the context and sampler with new n_ctx/n_batch/n_threads while keeping
+    // the loaded weights (`model_path` is ignored). The KV cache starts empty.
+    bool reconfigure(const llm_load_params & params);
+
+    bool is_loaded() const { return model_ != nullptr && ctx_ != nullptr; }
+
+    // File the loaded weights came from; empty if no model is loaded.
+    const std::string & model_path() const { return model_path_; }
+
+    // Decodes one full ubatch of filler tokens and then a single token, and clears the KV
+    // cache again. The first decodes of a context pay for graph building, compute buffer
+    // first touch, weight page faults and thread start-up; afterwards the first real
+    // prompt runs at steady-state speed. Not recorded in request metrics, the ubatch
+    // tuner or the governor.
+    llm_warmup_stats warmup();
+
+    // Cost of the last warm-up of the current context; zero if it had none.
+    const llm_warmup_stats & last_warmup() const { return warmup_; }
+
+    // Weights, KV cache and compute buffer sizes for `params` applied to the loaded model
+    // (`model_path` is ignored). All zero if no model is loaded.
+    llm_memory_estimate estimate_memory(const llm_load_params & params) const;
+
+    // The estimate for the current context.
+    llm_memory_estimate memory_estimate() const { return estimate_memory(params_); }
+
+    // Appends nothing and returns false if no model is loaded or tokenization fails.
+    bool tokenize(const char * text, size_t len, bool add_bos, std::vector<llama_token> & out) const;
+
+    // Decodes `n_tokens` at the current KV position in n_batch-sized chunks (chunks
+    // picked by the ubatch tuner in adaptive mode), requesting logits only for the final
+    // token. Returns 0 on success, -1 if not loaded, otherwise
+    // the llama_decode() error code.
+    int decode(const llama_token * tokens, int32_t n_tokens);
+
+    // Samples from the last logits and accepts the token into the sampler chain.
+    // Returns -1 if not loaded.
+    llama_token sample();
+
+    // Raw bytes of a token piece. Not necessarily valid UTF-8 on its own: multi-byte
+    // characters can be split across consecutive tokens.
+    std::string token_to_piece(llama_token token) const;
+
+    // EOS token of the loaded vocab, or 2 (the common default) if none is loaded.
+    llama_token eos() const;
+    // is_end_of_generation() for the loaded model; generation loops stop on this rather
+    // than on eos(). False if no model is loaded.
+    bool is_eog(llama_token token) const;
+    int32_t n_ctx() const;
+    int32_t n_past() const { return n_past_; }
+
+    // Rebuilds the sampler chain: top-k -> top-p -> temp -> dist, or greedy at temp <= 0.
+    // A non-empty GBNF `grammar` (start rule "root") constrains every sampled token so
+    // the output stays inside it, e.g. a JSON object of a fixed shape. Returns false if
+    // the grammar does not parse; sampling is then unconstrained.
+    bool reset_sampler(float temperature, float top_p, int32_t top_k, const std::string & grammar = {});
+
+    // Clears the KV cache and rewinds the decode position to 0.
+    void clear_context();
+
+    // Loads a LoRA adapter GGUF against the loaded base weights, once per path; later
+    // calls for the same path are free. Adapters live until the model is unloaded, and
+    // several can be loaded side by side. Returns false if the file does not match the
+    // model (architecture or tensor shapes).
+    bool load_adapter(const std::string & path);
+
+    // Makes `path` (loaded on demand) the one active adapter at `scale`, or runs the base
+    // model alone for an empty path. Only the context's adapter list changes, so
+    // switching between requests costs no weight I/O. The KV cache was computed under
+    // the previous adapter, so a switch clears it; returns 1 when that happened, 0 when
+    // the adapter and scale were already active, -1 on failure (previous one kept).
+    int set_adapter(const std::string & path, float scale);
+
+    // Path of the active adapter; empty for the base model.
+    const std::string & active_adapter() const { return adapter_path_; }
+    float active_adapter_scale() const { return adapter_scale_; }
+
+    // Applies new thread counts without reloading. With `cpus` set, the calling thread is
+    // pinned to them and a persistent ggml threadpool is created from it, so every worker
+    // inherits the mask (ggml's own cpumask handling is a no-op on Android). Decodes must
+    // keep running on the calling thread for the pinning to hold. Reducing the counts on
+    // the same cores is cheap and safe between decodes: the pool is kept.
+    bool set_threads(const llm_thread_config & config);
+    const llm_thread_config & thread_config() const { return threads_; }
+
+    // Paces single-token decodes: after each one the governor may lower the decode thread
+    // count (pool kept, see set_threads) or sleep to hold a sustainable rate. Prefill is
+    // not paced. Pass nullptr to disable. Dropped on unload().
+    void set_governor(std::unique_ptr<thermal_governor> governor) { governor_ = std::move(governor); }
+    const thermal_governor * governor() const { return governor_.get(); }
+
+    // Memory pressure from the OS. Raising it drops weight locks immediately; returning
+    // to none relocks hot weights if load() was asked to. Safe to call from any thread,
+    // including while another one decodes.
+    void set_memory_pressure(memory_pressure pressure);
+
+    // Mapped, resident and locked bytes of the loaded weights; all zero if none are
+    // loaded. Safe to call from any thread.
+    residency_stats residency() const;
+
+    // Starts collecting llm_request_metrics for the calls that follow. The first decode()
+    // after this counts as prefill, every later one as a per-token decode. Outside a
+    // request nothing is recorded.
+    void begin_request();
+    llm_request_metrics end_request();
+
+    llama_model * model() const { return model_; }
+    llama_context * context() const { return ctx_; }
+
+private:
+    bool init_context(const llm_load_params & params);
+    llama_adapter_lora * find_adapter(const std::string & path) const;
+    void free_threadpool();
+    void free_sampler();
+    llama_token sample_constrained();
+    void apply_governor(double token_ms);
+
+    struct request_timings {
+        bool active = false;
+        bool prefilled = false;
+        double tokenize_ms = 0.0;
+        double prefill_ms = 0.0;
+        double sample_ms = 0.0;
+        double detokenize_ms = 0.0;
+        int32_t n_prompt = 0;
+        std::vector<double> decode_ms;
+    };
+
+    llama_model * model_ = nullptr;
+    llama_context * ctx_ = nullptr;
+    llama_sampler * sampler_ = nullptr;
+    llama_sampler * grammar_ = nullptr; // kept out of sampler_, see sample_constrained()
+    std::vector<llama_token_data> candidates_;
+    ggml_threadpool * threadpool_ = nullptr; // attached to ctx_ while set
+    int32_t threadpool_size_ = 0;
+    llm_thread_config threads_;
+    llm_load_params params_; // what the current context was created with
+    std::string model_path_; // set by load(); reconfigure() keeps it
+    llm_warmup_stats warmup_;
+    std::unique_ptr<thermal_governor> governor_;
+    std::unique_ptr<ubatch_tuner> ubatch_tuner_; // set in adaptive ubatch mode
+    mutable std::mutex residency_mutex_; // guards residency_ itself, not its state
+    std::unique_ptr<weight_residency> residency_;
+    bool lock_hot_weights_ = false;
+    int32_t n_past_ = 0; // current position in KV cache (token index)
+    // Adapters loaded for model_, owned (and freed) by it.
+    std::vector<std::pair<std::string, llama_adapter_lora *>> adapters_;
+    std::string adapter_path_;  // active on ctx_; empty = base model
+    float adapter_scale_ = 0.0f;
+    mutable request_timings timings_; // written by the const tokenize/token_to_piece too
+};
+
+// Memory check for loading a second model while `current` keeps serving (hot swap).
+// The incoming model needs 1.5x its file size (weights plus KV cache and compute buffers
+// at typical settings, the same rule the app uses before a cold load). MemAvailable
+// counts the serving model's page cache as reclaimable, but evicting it would make that
+// model page-fault on every token, so its resident weights are not counted as free.
+struct llm_preload_budget {
+    int64_t needed_bytes = 0;
+    int64_t available_bytes = 0;
+
+    bool fits() const { return needed_bytes > 0 && needed_bytes <= available_bytes; }
+};
+
+llm_preload_budget preload_budget(const llm_engine & current, const std::string & model_path);
+
+} // namespace microllm
@@ -0,0 +1,25 @@
+// Logging for the platform-neutral inference core.
+//
+// Each translation unit defines LOG_TAG before including this header. On Android the
+// macros go to logcat; on the host build they go to stderr so the same code can run
+// under perf, sanitizers and CI without a device.
+
+#pragma once
+
+#ifndef LOG_TAG
+#define LOG_TAG "MicroLLM"
+#endif
+
+#if defined(__ANDROID__)
+  #include <android/log.h>
+  #define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, __VA_ARGS__)
+  #define LOGW(...) __android_log_print(ANDROID_LOG_WARN,  LOG_TAG, __VA_ARGS__)
+  #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#else
+  #include <cstdio>
+  #define MICROLLM_LOG(level, ...) \
+      do { fprintf(stderr, "%s/" LOG_TAG ": ", level); fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); } while (0)
+  #define LOGI(...) MICROLLM_LOG("I", __VA_ARGS__)
+  #define LOGW(...) MICROLLM_LOG("W", __VA_ARGS__)
+  #define LOGE(...) MICROLLM_LOG("E", __VA_ARGS__)
+#endif
@@ -0,0 +1,122 @@
+#define LOG_TAG "ModelConvert"
+
+#include "model_convert.h"
+
+#include <chrono>
+#include <cstdio>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+#include "gguf_inspect.h"
+#include "llama.h"
+#include "log.h"
+
+namespace microllm {
+
+static constexpr const char * CONVERTED_SUFFIX = ".repack.gguf";
+
+// Types the CPU backend repacks at load on arm64 with dotprod/i8mm.
+static bool is_repack_type(ggml_type type) {
+    return type == GGML_TYPE_Q4_0 || type == GGML_TYPE_IQ4_NL;
+}
+
+std::string converted_model_path(const std::string & model_path) {
+    std::string stem = model_path;
+    const std::string ext = ".gguf";
+    if (stem.size() > ext.size() && stem.compare(stem.size() - ext.size(), ext.size(), ext) == 0) {
+        stem.resize(stem.size() - ext.size());
+    }
+    return stem + CONVERTED_SUFFIX;
+}
+
+std::string resolve_converted_model(const std::string & model_path) {
+    const std::string converted = converted_model_path(model_path);
+    struct stat src{};
+    struct stat dst{};
+    if (stat(model_path.c_str(), &src) != 0 || stat(converted.c_str(), &dst) != 0) {
+        return model_path;
+    }
+    // A model re-downloaded after its conversion invalidates it.
+    if (dst.st_mtime < src.st_mtime || dst.st_size <= 0) return model_path;
+    return converted;
+}
+
+convert_status convert_model_for_cpu(const std::string & model_path, const cpu_features & features,
+                                     int n_threads, std::string & out_path) {
+    out_path = model_path;
+
+    if (!features.dotprod) {
+        LOGI("No dotprod: no repacked kernels to convert for");
+        return convert_status::not_needed;
+    }
+
+    const std::string converted = resolve_converted_model(model_path);
+    if (converted != model_path) {
+        out_path = converted;
+        return convert_status::cached;
+    }
+
+    gguf_model_info info;
+    if (!inspect_gguf(model_path, info)) return convert_status::failed;
+    if (info.types.empty() || is_repack_type(info.types[0].type)) {
+        return convert_status::not_needed;
+    }
+    // Requantizing from 5+ bits or from float would cost more quality than Q4_K -> Q4_0.
+    if (info.types[0].type != GGML_TYPE_Q4_K) {
+        LOGI("Dominant type %s is not Q4_K; keeping the model as is",
+             ggml_type_name(info.types[0].type));
+        return convert_status::not_needed;
+    }
+
+    const std::string target = converted_model_path(model_path);
+    const std::string tmp = target + ".tmp";
+
+    struct statvfs fs{};
+    if (statvfs(model_path.c_str(), &fs) == 0) {
+        const int64_t free_bytes = (int64_t) fs.f_bavail * (int64_t) fs.f_frsize;
+        // Q4_0 is slightly smaller than Q4_K_M; the margin covers the Q6_K output head.
+        if (free_bytes < info.weights_bytes + info.weights_bytes / 10) {
+            LOGW("Not enough storage to convert: %lld MB free, ~%lld MB needed",
+                 (long long) (free_bytes >> 20), (long long) (info.weights_bytes >> 20));
+            return convert_status::failed;
+        }
+    }
+
+    llama_model_quantize_params params = llama_model_quantize_default_params();
+    params.nthread = n_threads;
+    params.ftype = LLAMA_FTYPE_MOSTLY_Q4_0;
+    params.allow_requantize = true;
+
+    LOGI("Converting %s (%s) to Q4_0 for the %s kernels", model_path.c_str(),
+         ggml_type_name(info.types[0].type), features.i8mm ? "i8mm" : "dotprod");
+    const auto start = std::chrono::steady_clock::now();
+    if (llama_model_quantize(model_path.c_str(), tmp.c_str(), &params) != 0) {
+        LOGE("Conversion failed: %s", model_path.c_str());
+        std::remove(tmp.c_str());
+        return convert_status::failed;
+    }
+    // Rename last, so an interrupted conversion never leaves a truncated cache behind.
+    if (std::rename(tmp.c_str(), target.c_str()) != 0) {
+        LOGE("Cannot move conversion into place: %s", target.c_str());
+        std::remove(tmp.c_str());
+        return convert_status::failed;
+    }
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOGI("Converted in %lld ms: %s", (long long) ms, target.c_str());
+
+    out_path = target;
+    return convert_status::converted;
+}
+
+const char * convert_status_name(convert_status status) {
+    switch (status) {
+        case convert_status::converted:  return "converted";
+        case convert_status::cached:     return "cached";
+        case convert_status::not_needed: return "notNeeded";
+        case convert_status::failed:     return "failed";
+    }
+    return "failed";
+}
+
+} // namespace microllm
@@ -0,0 +1,43 @@
+// One-time conversion of a downloaded model into the weight type ggml's CPU backend
+// runs fastest on this CPU.
+//
+// ggml's arm64 kernels for the interleaved layouts (q4_0_4x4 with dotprod, q4_0_4x8
+// with i8mm) only exist for Q4_0 and IQ4_NL: the CPU backend repacks those tensors into
+// the interleaved layout as it loads them, while Q4_K (the usual Q4_K_M download) takes
+// the generic vec_dot path. GGUF cannot store the interleaved layout itself, so the
+// conversion rewrites a Q4_K model as Q4_0 next to the original (llama_model_quantize);
+// loads that opt in (resolve_converted_model) then go through the repacked kernels.
+// Quantization error rises slightly (Q4_0 has no per-block minimum), which is why both
+// the conversion and loading the copy are explicit choices rather than part of loading.
+
+#pragma once
+
+#include <string>
+
+#include "cpu_features.h"
+
+namespace microllm {
+
+enum class convert_status {
+    converted,  // written to the cache path by this call
+    cached,     // an up-to-date conversion already existed
+    not_needed, // the CPU has no repacked kernels, or the model already uses their type
+    failed,
+};
+
+// Where the conversion of `model_path` is cached: "<stem>.repack.gguf" beside it.
+std::string converted_model_path(const std::string & model_path);
+
+// `model_path`'s conversion if one exists and is newer than the model, else `model_path`.
+std::string resolve_converted_model(const std::string & model_path);
+
+// Converts `model_path` for `features` with `n_threads` (0: all cores) and stores the
+// result at converted_model_path(). Takes minutes for billion-parameter models and needs
+// free storage for the converted copy; call it off the inference thread. `out_path`
+// receives the path to load (the conversion, or the original when not_needed/failed).
+convert_status convert_model_for_cpu(const std::string & model_path, const cpu_features & features,
+                                     int n_threads, std::string & out_path);
+
+const char * convert_status_name(convert_status status);
+
+} // namespace microllm
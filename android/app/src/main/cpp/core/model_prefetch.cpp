@@ -0,0 +1,186 @@
+#define LOG_TAG "ModelPrefetch"
+
+#include "model_prefetch.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include "gguf.h"
+#include "log.h"
+
+namespace microllm {
+
+// Work granularity: small enough to spread a layer over the workers and to report
+// progress smoothly, large enough for the block layer to merge the requests.
+static constexpr uint64_t PIECE_BYTES = 4ull << 20;
+// Tensors closer than this are read as one range.
+static constexpr uint64_t MERGE_GAP_BYTES = 64ull << 10;
+static constexpr size_t FALLBACK_BUF_BYTES = 1u << 20;
+
+// Forward-pass rank of a tensor: inputs first, then blocks by index, then the head.
+static int tensor_rank(const char * name) {
+    if (strncmp(name, "blk.", 4) == 0) {
+        return atoi(name + 4);
+    }
+    if (strncmp(name, "output", 6) == 0) {
+        return INT_MAX;
+    }
+    return -1;
+}
+
+bool gguf_tensors(const std::string & path, std::vector<gguf_tensor_range> & out) {
+    gguf_init_params params = { /*no_alloc =*/ true, /*ctx =*/ nullptr };
+    gguf_context * gguf = gguf_init_from_file(path.c_str(), params);
+    if (gguf == nullptr) {
+        LOGE("Cannot read GGUF header: %s", path.c_str());
+        return false;
+    }
+
+    const uint64_t data_offset = gguf_get_data_offset(gguf);
+    const int64_t n_tensors = gguf_get_n_tensors(gguf);
+    out.clear();
+    out.reserve((size_t) n_tensors);
+    for (int64_t i = 0; i < n_tensors; i++) {
+        out.push_back({ gguf_get_tensor_name(gguf, i),
+                        { data_offset + gguf_get_tensor_offset(gguf, i),
+                          gguf_get_tensor_size(gguf, i) } });
+    }
+    gguf_free(gguf);
+    return true;
+}
+
+bool gguf_tensor_ranges(const std::string & path, std::vector<file_range> & out) {
+    std::vector<gguf_tensor_range> all;
+    if (!gguf_tensors(path, all)) {
+        return false;
+    }
+
+    struct ranked {
+        int rank;
+        file_range range;
+    };
+    std::vector<ranked> tensors;
+    tensors.reserve(all.size());
+    for (const gguf_tensor_range & t : all) {
+        tensors.push_back({ tensor_rank(t.name.c_str()), t.range });
+    }
+
+    std::stable_sort(tensors.begin(), tensors.end(), [](const ranked & a, const ranked & b) {
+        return a.rank != b.rank ? a.rank < b.rank : a.range.offset < b.range.offset;
+    });
+
+    out.clear();
+    for (const ranked & t : tensors) {
+        if (t.range.size == 0) continue;
+        if (!out.empty()) {
+            file_range & last = out.back();
+            const uint64_t end = last.offset + last.size;
+            if (t.range.offset >= end && t.range.offset - end <= MERGE_GAP_BYTES) {
+                last.size = t.range.offset + t.range.size - last.offset;
+                continue;
+            }
+        }
+        out.push_back(t.range);
+    }
+    return true;
+}
+
+model_prefetcher::model_prefetcher(const std::string & path, int32_t n_threads, int64_t max_bytes) {
+    std::vector<file_range> ranges;
+    if (!gguf_tensor_ranges(path, ranges)) {
+        return;
+    }
+
+    uint64_t budget = max_bytes > 0 ? (uint64_t) max_bytes : UINT64_MAX;
+    for (const file_range & r : ranges) {
+        for (uint64_t off = 0; off < r.size && budget > 0; off += PIECE_BYTES) {
+            const uint64_t size = std::min({ PIECE_BYTES, r.size - off, budget });
+            pieces_.push_back({ r.offset + off, size });
+            total_bytes_ += size;
+            budget -= size;
+        }
+    }
+    if (pieces_.empty()) {
+        return;
+    }
+
+    fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        LOGE("Cannot open %s for prefetch: %s", path.c_str(), strerror(errno));
+        pieces_.clear();
+        total_bytes_ = 0;
+        return;
+    }
+
+    n_threads = std::max(1, std::min<int32_t>(n_threads, (int32_t) pieces_.size()));
+    LOGI("Prefetching %llu MB in %zu pieces on %d threads%s",
+         (unsigned long long) (total_bytes_ >> 20), pieces_.size(), n_threads,
+         max_bytes > 0 && (uint64_t) max_bytes <= total_bytes_ ? " (capped by free memory)" : "");
+    running_ = n_threads;
+    for (int32_t i = 0; i < n_threads; i++) {
+        threads_.emplace_back(&model_prefetcher::worker, this);
+    }
+}
+
+model_prefetcher::~model_prefetcher() {
+    cancel();
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+float model_prefetcher::progress() const {
+    if (total_bytes_ == 0) return 1.0f;
+    return (float) ((double) done_bytes_.load() / (double) total_bytes_);
+}
+
+bool model_prefetcher::done() const {
+    return running_.load() == 0;
+}
+
+void model_prefetcher::cancel() {
+    cancelled_ = true;
+    for (std::thread & t : threads_) {
+        if (t.joinable()) t.join();
+    }
+    threads_.clear();
+}
+
+void model_prefetcher::worker() {
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<char> buf; // only for filesystems without readahead()
+
+    for (size_t i = next_++; i < pieces_.size() && !cancelled_; i = next_++) {
+        const file_range & p = pieces_[i];
+        if (buf.empty() && readahead(fd_, (off64_t) p.offset, (size_t) p.size) != 0) {
+            // FUSE and some emulated storage reject readahead(); reading through a
+            // buffer populates the page cache just the same.
+            LOGW("readahead failed (%s), falling back to read()", strerror(errno));
+            buf.resize(FALLBACK_BUF_BYTES);
+        }
+        if (!buf.empty()) {
+            for (uint64_t off = 0; off < p.size && !cancelled_;) {
+                const size_t n = (size_t) std::min<uint64_t>(buf.size(), p.size - off);
+                const ssize_t r = pread(fd_, buf.data(), n, (off_t) (p.offset + off));
+                if (r <= 0) break;
+                off += (uint64_t) r;
+            }
+        }
+        done_bytes_ += p.size;
+    }
+
+    if (--running_ == 0 && !cancelled_) {
+        const double ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - t0).count();
+        LOGI("Prefetch complete: %llu MB in %.0f ms", (unsigned long long) (total_bytes_ >> 20), ms);
+    }
+}
+
+} // namespace microllm
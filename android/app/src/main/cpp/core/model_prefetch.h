@@ -0,0 +1,69 @@
+// Background page-cache prefetch of GGUF weights.
+//
+// With use_mmap the model "loads" in milliseconds and the first prompt then page-faults
+// every weight in from flash, one 4 KB fault at a time on the decoding thread. The
+// prefetcher reads the tensor ranges from the GGUF header and has a few worker threads
+// issue readahead() over them in the order a forward pass touches them (embeddings,
+// blk.0 ... blk.N, output), so the mapping only takes minor faults afterwards.
+// llama.cpp's own MADV_WILLNEED covers the whole file in file order on one thread and
+// gives no progress; this one is parallel, use-ordered and observable.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace microllm {
+
+// Byte range of tensor data within the model file.
+struct file_range {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+struct gguf_tensor_range {
+    std::string name;
+    file_range range; // absolute offset within the file
+};
+
+// Every tensor of a GGUF file, in header order. Returns false if the header cannot be read.
+bool gguf_tensors(const std::string & path, std::vector<gguf_tensor_range> & out);
+
+// Tensor data ranges of a GGUF file in forward-pass order, adjacent ranges merged.
+// Returns false if the header cannot be read.
+bool gguf_tensor_ranges(const std::string & path, std::vector<file_range> & out);
+
+class model_prefetcher {
+public:
+    // Prefetches at most `max_bytes` (<= 0: everything) so a model larger than the free
+    // page cache does not evict its own first layers.
+    model_prefetcher(const std::string & path, int32_t n_threads, int64_t max_bytes);
+    ~model_prefetcher(); // cancels and joins
+
+    model_prefetcher(const model_prefetcher &) = delete;
+    model_prefetcher & operator=(const model_prefetcher &) = delete;
+
+    // Fraction of the planned bytes read ahead so far, 0..1. 1 when there is nothing to do.
+    float progress() const;
+    bool done() const;
+
+    // Stops the workers after their current piece and joins them.
+    void cancel();
+
+private:
+    void worker();
+
+    int fd_ = -1;
+    std::vector<file_range> pieces_; // planned work, in use order
+    uint64_t total_bytes_ = 0;
+    std::atomic<size_t> next_{0};
+    std::atomic<uint64_t> done_bytes_{0};
+    std::atomic<int32_t> running_{0};
+    std::atomic<bool> cancelled_{false};
+    std::vector<std::thread> threads_;
+};
+
+} // namespace microllm
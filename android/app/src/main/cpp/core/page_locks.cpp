@@ -0,0 +1,59 @@
+#include "page_locks.h"
+
+#include <algorithm>
+
+namespace microllm {
+
+page_run page_locks::span(const file_range & range) const {
+    page_run run;
+    run.first = (size_t) range.offset / page_;
+    run.end = ((size_t) (range.offset + range.size) + page_ - 1) / page_;
+    return run;
+}
+
+bool page_locks::page_held(size_t page, const file_range & except) const {
+    for (const file_range & r : locked_) {
+        if (r.offset == except.offset) continue;
+        const page_run run = span(r);
+        if (page >= run.first && page < run.end) return true;
+    }
+    return false;
+}
+
+// Ranges do not overlap: only the first and last page can be shared with a neighbour.
+page_run page_locks::own(const file_range & range) const {
+    page_run run = span(range);
+    if (run.first < run.end && page_held(run.first, range)) run.first++;
+    if (run.first < run.end && page_held(run.end - 1, range)) run.end--;
+    return run;
+}
+
+int64_t page_locks::added_bytes(const file_range & range) const {
+    if (locked(range)) return 0;
+    return (int64_t) (own(range).count() * page_);
+}
+
+page_run page_locks::lock(const file_range & range) {
+    if (!locked(range)) {
+        locked_bytes_ += added_bytes(range);
+        locked_.push_back(range);
+    }
+    return span(range);
+}
+
+page_run page_locks::unlock(const file_range & range) {
+    auto it = std::find_if(locked_.begin(), locked_.end(),
+                           [&](const file_range & r) { return r.offset == range.offset; });
+    if (it == locked_.end()) return {};
+    const page_run run = own(range);
+    locked_.erase(it);
+    locked_bytes_ -= (int64_t) (run.count() * page_);
+    return run;
+}
+
+bool page_locks::locked(const file_range & range) const {
+    return std::any_of(locked_.begin(), locked_.end(),
+                       [&](const file_range & r) { return r.offset == range.offset; });
+}
+
+} // namespace microllm
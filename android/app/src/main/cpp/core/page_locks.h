@@ -0,0 +1,59 @@
+// Page accounting for mlock()ed byte ranges.
+//
+// mlock() works on whole pages and locks do not nest: one munlock() releases a page no
+// matter how many ranges locked it. Neighbouring tensors share their boundary pages, so
+// weight_residency tracks which ranges hold which pages here and only unlocks the pages
+// no other locked range still touches. No syscalls, so the accounting runs on a host.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "model_prefetch.h"
+
+namespace microllm {
+
+// Pages [first, end).
+struct page_run {
+    size_t first = 0;
+    size_t end = 0;
+
+    size_t count() const { return end - first; }
+};
+
+class page_locks {
+public:
+    explicit page_locks(size_t page_size) : page_(page_size) {}
+
+    size_t page_size() const { return page_; }
+
+    // Pages the range touches: what mlock() has to cover to pin it.
+    page_run span(const file_range & range) const;
+
+    // Bytes locking `range` would add to locked_bytes(): its pages no locked range holds.
+    int64_t added_bytes(const file_range & range) const;
+
+    // Records `range` as locked and returns the pages to mlock().
+    page_run lock(const file_range & range);
+
+    // Forgets `range` and returns the pages only it held, the ones that may be
+    // munlock()ed. Ranges are identified by offset; they must not overlap.
+    page_run unlock(const file_range & range);
+
+    bool locked(const file_range & range) const;
+
+    // Locked pages in bytes, each page counted once.
+    int64_t locked_bytes() const { return locked_bytes_; }
+
+private:
+    bool page_held(size_t page, const file_range & except) const;
+    page_run own(const file_range & range) const;
+
+    size_t page_;
+    std::vector<file_range> locked_;
+    int64_t locked_bytes_ = 0;
+};
+
+} // namespace microllm
@@ -0,0 +1,56 @@
+#include "proc_stats.h"
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace microllm {
+
+int64_t current_rss_bytes() {
+    FILE * f = fopen("/proc/self/statm", "r");
+    if (f == nullptr) return 0;
+    long pages_total = 0, pages_resident = 0;
+    const int n = fscanf(f, "%ld %ld", &pages_total, &pages_resident);
+    fclose(f);
+    if (n != 2) return 0;
+    return (int64_t) pages_resident * (int64_t) sysconf(_SC_PAGESIZE);
+}
+
+int64_t peak_rss_bytes() {
+    FILE * f = fopen("/proc/self/status", "r");
+    if (f == nullptr) return 0;
+    char line[256];
+    long kb = 0;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            sscanf(line + 6, "%ld", &kb);
+            break;
+        }
+    }
+    fclose(f);
+    return (int64_t) kb * 1024;
+}
+
+int64_t available_memory_bytes() {
+    FILE * f = fopen("/proc/meminfo", "r");
+    if (f == nullptr) return 0;
+    char line[256];
+    long kb = 0;
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (strncmp(line, "MemAvailable:", 13) == 0) {
+            sscanf(line + 13, "%ld", &kb);
+            break;
+        }
+    }
+    fclose(f);
+    return (int64_t) kb * 1024;
+}
+
+bool reset_peak_rss() {
+    FILE * f = fopen("/proc/self/clear_refs", "w");
+    if (f == nullptr) return false;
+    const bool ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+} // namespace microllm
@@ -0,0 +1,27 @@
+// Process memory statistics read from procfs.
+//
+// Linux and Android expose the same /proc files, so these work unchanged on the host
+// build. All functions return 0 when the value is unavailable.
+
+#pragma once
+
+#include <cstdint>
+
+namespace microllm {
+
+// Resident set size of this process right now.
+int64_t current_rss_bytes();
+
+// High-water mark of the resident set size (VmHWM) since process start, or since the
+// last successful reset_peak_rss().
+int64_t peak_rss_bytes();
+
+// MemAvailable from /proc/meminfo: memory the kernel can hand out without swapping,
+// page cache included.
+int64_t available_memory_bytes();
+
+// Resets VmHWM to the current RSS (writes "5" to /proc/self/clear_refs, Linux 4.0+).
+// Returns false when the kernel or sandbox does not allow it.
+bool reset_peak_rss();
+
+} // namespace microllm
@@ -0,0 +1,137 @@
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "cpu_features.h"
+
+namespace microllm {
+
+static constexpr uint32_t INITIAL_STATE[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+static inline uint32_t load_be32(const uint8_t * p) {
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+// FIPS 180-4 reference rounds; the fallback for x86 hosts and arm64 cores without SHA2.
+static void compress_portable(uint32_t state[8], const uint8_t * blocks, size_t n_blocks) {
+    for (size_t b = 0; b < n_blocks; b++, blocks += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) w[i] = load_be32(blocks + 4 * i);
+        for (int i = 16; i < 64; i++) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], bb = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            const uint32_t ch = (e & f) ^ (~e & g);
+            const uint32_t t1 = h + s1 + ch + SHA256_K[i] + w[i];
+            const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            const uint32_t maj = (a & bb) ^ (a & c) ^ (bb & c);
+            const uint32_t t2 = s0 + maj;
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = bb; bb = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += bb; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+sha256_compress_fn sha256_portable_kernel() {
+    return compress_portable;
+}
+
+static sha256_compress_fn select_kernel() {
+    const sha256_compress_fn arm = sha256_arm_kernel();
+    if (arm != nullptr && detect_cpu_features().sha2) return arm;
+    return compress_portable;
+}
+
+sha256::sha256() : compress_(select_kernel()) {
+    reset();
+}
+
+void sha256::reset() {
+    std::memcpy(state_, INITIAL_STATE, sizeof(state_));
+    total_bytes_ = 0;
+    buffer_len_ = 0;
+}
+
+void sha256::update(const void * data, size_t len) {
+    const uint8_t * p = (const uint8_t *) data;
+    total_bytes_ += len;
+
+    if (buffer_len_ > 0) {
+        const size_t take = std::min(len, sizeof(buffer_) - buffer_len_);
+        std::memcpy(buffer_ + buffer_len_, p, take);
+        buffer_len_ += take;
+        p += take;
+        len -= take;
+        if (buffer_len_ < sizeof(buffer_)) return;
+        compress_(state_, buffer_, 1);
+        buffer_len_ = 0;
+    }
+
+    // Whole blocks straight from the caller's chunk, without copying.
+    const size_t n_blocks = len / 64;
+    if (n_blocks > 0) {
+        compress_(state_, p, n_blocks);
+        p += n_blocks * 64;
+        len -= n_blocks * 64;
+    }
+
+    std::memcpy(buffer_, p, len);
+    buffer_len_ = len;
+}
+
+void sha256::finish(uint8_t out[DIGEST_SIZE]) {
+    const uint64_t bit_len = total_bytes_ * 8;
+
+    // 0x80, zeros up to 56 mod 64, then the message length in bits, big-endian.
+    uint8_t pad[72] = { 0x80 };
+    const size_t pad_len = (buffer_len_ < 56 ? 56 : 120) - buffer_len_;
+    for (int i = 0; i < 8; i++) pad[pad_len + i] = (uint8_t) (bit_len >> (56 - 8 * i));
+    update(pad, pad_len + 8);
+
+    for (int i = 0; i < 8; i++) {
+        out[4 * i + 0] = (uint8_t) (state_[i] >> 24);
+        out[4 * i + 1] = (uint8_t) (state_[i] >> 16);
+        out[4 * i + 2] = (uint8_t) (state_[i] >> 8);
+        out[4 * i + 3] = (uint8_t) state_[i];
+    }
+}
+
+bool sha256::accelerated() const {
+    return compress_ != compress_portable;
+}
+
+std::string to_hex(const uint8_t * bytes, size_t len) {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string out(len * 2, '0');
+    for (size_t i = 0; i < len; i++) {
+        out[2 * i] = DIGITS[bytes[i] >> 4];
+        out[2 * i + 1] = DIGITS[bytes[i] & 0xf];
+    }
+    return out;
+}
+
+} // namespace microllm
@@ -0,0 +1,54 @@
+// Incremental SHA-256 for verifying model downloads as they stream to disk.
+//
+// Multi-GB GGUF files are hashed chunk by chunk while being written, so verification
+// costs no second read of the file. On arm64 CPUs with the SHA2 extension (almost every
+// Android device) blocks go through the SHA256H/SHA256SU instructions, several times
+// faster than the portable code used elsewhere (x86 hosts, old cores).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace microllm {
+
+// Compresses `n_blocks` consecutive 64-byte blocks into `state`.
+using sha256_compress_fn = void (*)(uint32_t state[8], const uint8_t * blocks, size_t n_blocks);
+
+class sha256 {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+
+    sha256();
+
+    void reset();
+    void update(const void * data, size_t len);
+    // Writes the digest; the object must be reset() before further use.
+    void finish(uint8_t out[DIGEST_SIZE]);
+
+    // True when the ARMv8 SHA2 instructions are in use.
+    bool accelerated() const;
+
+private:
+    uint32_t state_[8];
+    uint64_t total_bytes_ = 0;
+    uint8_t buffer_[64];
+    size_t buffer_len_ = 0;
+    sha256_compress_fn compress_;
+};
+
+// Lowercase hex of `len` bytes.
+std::string to_hex(const uint8_t * bytes, size_t len);
+
+// Round constants, shared with the ARMv8 kernel.
+extern const uint32_t SHA256_K[64];
+
+// ARMv8 kernel (sha256_arm.cpp), or nullptr when not compiled for arm64 with crypto.
+sha256_compress_fn sha256_arm_kernel();
+
+// FIPS 180-4 reference kernel; the fallback, and the reference the ARM kernel is tested
+// against.
+sha256_compress_fn sha256_portable_kernel();
+
+} // namespace microllm
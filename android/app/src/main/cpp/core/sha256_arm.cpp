@@ -0,0 +1,59 @@
+// ARMv8 Cryptographic Extension kernel for sha256.h. Built with +crypto on arm64 and
+// only selected when the CPU reports HWCAP_SHA2.
+
+#include "sha256.h"
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SHA2)
+#include <arm_neon.h>
+#endif
+
+namespace microllm {
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SHA2)
+
+static void compress_arm(uint32_t state[8], const uint8_t * blocks, size_t n_blocks) {
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32x4_t efgh = vld1q_u32(state + 4);
+
+    for (size_t b = 0; b < n_blocks; b++, blocks += 64) {
+        const uint32x4_t abcd_in = abcd;
+        const uint32x4_t efgh_in = efgh;
+
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; i++) {
+            msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 16 * i)));
+        }
+
+        // Four rounds per step; the schedule for step i + 4 is derived from steps i..i+3.
+        for (int i = 0; i < 16; i++) {
+            const uint32x4_t wk = vaddq_u32(msg[i & 3], vld1q_u32(SHA256_K + 4 * i));
+            const uint32x4_t abcd_prev = abcd;
+            abcd = vsha256hq_u32(abcd, efgh, wk);
+            efgh = vsha256h2q_u32(efgh, abcd_prev, wk);
+            if (i < 12) {
+                msg[i & 3] = vsha256su1q_u32(vsha256su0q_u32(msg[i & 3], msg[(i + 1) & 3]),
+                                             msg[(i + 2) & 3], msg[(i + 3) & 3]);
+            }
+        }
+
+        abcd = vaddq_u32(abcd, abcd_in);
+        efgh = vaddq_u32(efgh, efgh_in);
+    }
+
+    vst1q_u32(state, abcd);
+    vst1q_u32(state + 4, efgh);
+}
+
+sha256_compress_fn sha256_arm_kernel() {
+    return compress_arm;
+}
+
+#else
+
+sha256_compress_fn sha256_arm_kernel() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace microllm
@@ -0,0 +1,286 @@
+#define LOG_TAG "SttEngine"
+
+#include "stt_engine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "proc_stats.h"
+
+namespace microllm {
+
+// whisper_model_loader backed by a read-only mapping of the model file.
+//
+// whisper.cpp copies every tensor into its own backend buffer, so weights cannot stay
+// file-backed the way llama.cpp's use_mmap does. Reading through a sequential mapping
+// still avoids stdio's extra buffer copy, and unmapping on close drops the file pages
+// from our RSS as soon as loading completes.
+struct mmap_loader_ctx {
+    const uint8_t * base = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+};
+
+static size_t mmap_loader_read(void * ctx, void * output, size_t read_size) {
+    auto * m = (mmap_loader_ctx *) ctx;
+    const size_t n = std::min(read_size, m->size - m->pos);
+    memcpy(output, m->base + m->pos, n);
+    m->pos += n;
+    return n;
+}
+
+static bool mmap_loader_eof(void * ctx) {
+    auto * m = (mmap_loader_ctx *) ctx;
+    return m->pos >= m->size;
+}
+
+static void mmap_loader_close(void * ctx) {
+    auto * m = (mmap_loader_ctx *) ctx;
+    if (m->base != nullptr) {
+        munmap((void *) m->base, m->size);
+        m->base = nullptr;
+    }
+}
+
+static whisper_context * init_from_mmap(const char * path, whisper_context_params cparams, int64_t & file_bytes) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+    file_bytes = (int64_t) st.st_size;
+
+    void * addr = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    madvise(addr, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+    mmap_loader_ctx m;
+    m.base = (const uint8_t *) addr;
+    m.size = (size_t) st.st_size;
+
+    whisper_model_loader loader{};
+    loader.context = &m;
+    loader.read = mmap_loader_read;
+    loader.eof = mmap_loader_eof;
+    loader.close = mmap_loader_close;
+
+    whisper_context * ctx = whisper_init_with_params(&loader, cparams);
+    // whisper_init_with_params closes the loader on every path, but be defensive.
+    mmap_loader_close(&m);
+    return ctx;
+}
+
+// Mean token probability of a segment, ignoring special/timestamp tokens.
+// Returns 0 when the segment carries no text tokens.
+static float segment_confidence(whisper_context * ctx, int i_segment) {
+    const whisper_token eot = whisper_token_eot(ctx);
+    const int n_tokens = whisper_full_n_tokens(ctx, i_segment);
+    float sum = 0.0f;
+    int n = 0;
+    for (int j = 0; j < n_tokens; j++) {
+        if (whisper_full_get_token_id(ctx, i_segment, j) >= eot) continue;
+        sum += whisper_full_get_token_p(ctx, i_segment, j);
+        n++;
+    }
+    return n > 0 ? sum / (float) n : 0.0f;
+}
+
+// Deliver only the newly decoded segments.
+//
+// Re-sending the accumulated transcript on every segment is O(n^2) over a long
+// recording; the caller owns concatenation.
+static void on_new_segment_cb(whisper_context * ctx, whisper_state * /*state*/, int n_new, void * user_data) {
+    const auto * cb = (const stt_segment_callback *) user_data;
+    if (cb == nullptr || !*cb) {
+        return;
+    }
+
+    const int n_segments = whisper_full_n_segments(ctx);
+    const int start = std::max(0, n_segments - n_new);
+    for (int i = start; i < n_segments; i++) {
+        // Whisper timestamps are in 10 ms units.
+        const int64_t t0_ms = whisper_full_get_segment_t0(ctx, i) * 10;
+        const int64_t t1_ms = whisper_full_get_segment_t1(ctx, i) * 10;
+        (*cb)(whisper_full_get_segment_text(ctx, i), t0_ms, t1_ms, segment_confidence(ctx, i));
+    }
+}
+
+stt_engine::~stt_engine() {
+    unload();
+}
+
+bool stt_engine::load(const char * path, int n_threads) {
+    unload();
+
+    LOGI("Loading whisper model from: %s", path);
+    n_threads_ = n_threads;
+
+    whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;      // CPU only for mobile
+    cparams.flash_attn = false;
+
+    stt_load_report report;
+    report.rss_before = current_rss_bytes();
+
+    ctx_ = init_from_mmap(path, cparams, report.file_bytes);
+    report.mmap_loader = ctx_ != nullptr;
+    if (ctx_ == nullptr) {
+        LOGI("mmap loader unavailable, falling back to buffered file loader");
+        ctx_ = whisper_init_from_file_with_params(path, cparams);
+    }
+
+    if (ctx_ == nullptr) {
+        LOGE("Failed to init whisper context");
+        report_ = stt_load_report{};
+        return false;
+    }
+
+    report.rss_after = current_rss_bytes();
+    report_ = report;
+    LOGI("Whisper model loaded (%s, ftype=%d): file=%lld MB, rss +%lld MB",
+         whisper_model_type_readable(ctx_), whisper_model_ftype(ctx_),
+         (long long) (report.file_bytes >> 20),
+         (long long) ((report.rss_after - report.rss_before) >> 20));
+    return true;
+}
+
+void stt_engine::unload() {
+    if (ctx_) {
+        whisper_free(ctx_);
+        ctx_ = nullptr;
+    }
+}
+
+bool stt_engine::transcribe(const float * audio, size_t n_samples, const stt_request & request) {
+    if (ctx_ == nullptr) {
+        LOGE("transcribe called but model not loaded");
+        return false;
+    }
+
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = n_threads_;
+    params.translate = request.translate;
+    params.language = request.language.c_str();
+    params.print_progress = false;
+    params.print_realtime = false;
+    params.print_timestamps = false;
+    if (request.on_segment) {
+        params.new_segment_callback = on_new_segment_cb;
+        params.new_segment_callback_user_data = (void *) &request.on_segment;
+    }
+
+    const int res = whisper_full(ctx_, params, audio, (int) n_samples);
+    if (res != 0) {
+        LOGE("whisper_full failed: %d", res);
+        return false;
+    }
+    return true;
+}
+
+std::string stt_engine::text() const {
+    std::string out;
+    if (ctx_ == nullptr) return out;
+    const int n_segments = whisper_full_n_segments(ctx_);
+    out.reserve(256);
+    for (int i = 0; i < n_segments; i++) {
+        const char * text = whisper_full_get_segment_text(ctx_, i);
+        if (text) out.append(text);
+    }
+    return out;
+}
+
+stt_transcript stt_engine::transcript() const {
+    stt_transcript out;
+    if (ctx_ == nullptr) return out;
+
+    const whisper_token eot = whisper_token_eot(ctx_);
+    const int n_segments = whisper_full_n_segments(ctx_);
+    out.segments.resize((size_t) n_segments);
+    out.text.reserve(256);
+    out.lang_id = whisper_full_lang_id(ctx_);
+
+    for (int i = 0; i < n_segments; i++) {
+        stt_segment & seg = out.segments[(size_t) i];
+        seg.t0_ms = whisper_full_get_segment_t0(ctx_, i) * 10;
+        seg.t1_ms = whisper_full_get_segment_t1(ctx_, i) * 10;
+        seg.no_speech_prob = whisper_full_get_segment_no_speech_prob(ctx_, i);
+
+        const char * seg_text = whisper_full_get_segment_text(ctx_, i);
+        seg.text_offset = (int32_t) out.text.size();
+        if (seg_text) out.text.append(seg_text);
+        seg.text_len = (int32_t) out.text.size() - seg.text_offset;
+
+        seg.token_offset = (int32_t) out.tokens.size();
+        float p_sum = 0.0f;
+        const int n_tokens = whisper_full_n_tokens(ctx_, i);
+        for (int j = 0; j < n_tokens; j++) {
+            const whisper_token id = whisper_full_get_token_id(ctx_, i, j);
+            if (id >= eot) continue;
+            const float p = whisper_full_get_token_p(ctx_, i, j);
+            out.tokens.push_back({ id, p });
+            p_sum += p;
+        }
+        seg.token_count = (int32_t) out.tokens.size() - seg.token_offset;
+        seg.confidence = seg.token_count > 0 ? p_sum / (float) seg.token_count : 0.0f;
+    }
+    return out;
+}
+
+std::string stt_engine::detect_language(const float * audio, size_t n_samples, int max_ms, float * out_prob) {
+    if (ctx_ == nullptr) {
+        LOGE("detectLanguage called but model not loaded");
+        return {};
+    }
+
+    const size_t max_samples = (size_t) std::max(1000, max_ms) * (SAMPLE_RATE / 1000);
+    n_samples = std::min(n_samples, max_samples);
+
+    if (whisper_pcm_to_mel(ctx_, audio, (int) n_samples, n_threads_) != 0) {
+        LOGE("whisper_pcm_to_mel failed");
+        return {};
+    }
+
+    std::vector<float> probs((size_t) whisper_lang_max_id() + 1, 0.0f);
+    const int lang_id = whisper_lang_auto_detect(ctx_, 0, n_threads_, probs.data());
+    if (lang_id < 0) {
+        LOGE("whisper_lang_auto_detect failed: %d", lang_id);
+        return {};
+    }
+
+    const char * code = whisper_lang_str(lang_id);
+    LOGI("Detected language %s (p=%.2f) from %zu ms", code ? code : "?", probs[(size_t) lang_id],
+         n_samples / (SAMPLE_RATE / 1000));
+
+    if (out_prob != nullptr) {
+        *out_prob = probs[(size_t) lang_id];
+    }
+    return code ? std::string(code) : std::string();
+}
+
+int stt_engine::ftype() const {
+    return ctx_ != nullptr ? whisper_model_ftype(ctx_) : -1;
+}
+
+std::vector<float> stt_engine::pcm16_to_f32(const int16_t * pcm, size_t n) {
+    std::vector<float> out(n);
+    constexpr float k = 1.0f / 32768.0f;
+    for (size_t i = 0; i < n; i++) out[i] = (float) pcm[i] * k;
+    return out;
+}
+
+std::string stt_engine::base_language(const std::string & tag) {
+    if (tag.empty()) return "en";
+    const auto dash = tag.find('-');
+    return dash != std::string::npos ? tag.substr(0, dash) : tag;
+}
+
+} // namespace microllm
@@ -0,0 +1,112 @@
+// Platform-neutral whisper.cpp transcription engine.
+//
+// Owns one whisper context plus the memory accounting captured when it was loaded.
+// whisper_jni.cpp adapts this to JNI (and packs results into a ByteBuffer); host tools
+// call it directly with float PCM.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "whisper.h"
+
+namespace microllm {
+
+// Packed so the JNI layer can copy arrays of these straight into the buffer described
+// in WhisperTranscript.kt.
+#pragma pack(push, 1)
+struct stt_segment {
+    int64_t t0_ms;
+    int64_t t1_ms;
+    int32_t token_offset;
+    int32_t token_count;
+    int32_t text_offset;
+    int32_t text_len;
+    float confidence;
+    float no_speech_prob;
+};
+
+struct stt_token {
+    int32_t id;
+    float p;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(stt_segment) == 40, "stt_segment layout changed");
+static_assert(sizeof(stt_token) == 8, "stt_token layout changed");
+
+// Result of the last transcribe(): text tokens only (special and timestamp tokens carry
+// no transcript content); segments reference `text` by byte offset/length.
+struct stt_transcript {
+    std::vector<stt_segment> segments;
+    std::vector<stt_token> tokens;
+    std::string text;
+    int32_t lang_id = -1;
+};
+
+// Memory accounting captured around the last successful load().
+struct stt_load_report {
+    int64_t file_bytes = 0;
+    int64_t rss_before = 0;
+    int64_t rss_after = 0;
+    bool mmap_loader = false;
+};
+
+// Called once per newly decoded segment: text (raw UTF-8), start/end in ms, and mean
+// token probability.
+using stt_segment_callback = std::function<void(const char * text, int64_t t0_ms, int64_t t1_ms, float confidence)>;
+
+struct stt_request {
+    std::string language = "en"; // ISO-639-1, or "auto"
+    bool translate = false;
+    stt_segment_callback on_segment;
+};
+
+class stt_engine {
+public:
+    static constexpr int SAMPLE_RATE = 16000;
+
+    stt_engine() = default;
+    ~stt_engine();
+
+    stt_engine(const stt_engine &) = delete;
+    stt_engine & operator=(const stt_engine &) = delete;
+
+    // Replaces any loaded model. On failure the engine is left unloaded.
+    bool load(const char * path, int n_threads);
+    void unload();
+    bool is_loaded() const { return ctx_ != nullptr; }
+
+    // Runs whisper_full over 16 kHz mono float PCM. Returns false on failure.
+    bool transcribe(const float * audio, size_t n_samples, const stt_request & request);
+
+    // Concatenated text of the last transcribe().
+    std::string text() const;
+
+    // Segments, tokens and probabilities of the last transcribe().
+    stt_transcript transcript() const;
+
+    // Identifies the spoken language from the first `max_ms` (at least 1000) of audio.
+    // Returns the ISO-639-1 code, or an empty string on failure.
+    std::string detect_language(const float * audio, size_t n_samples, int max_ms, float * out_prob);
+
+    const stt_load_report & load_report() const { return report_; }
+    int ftype() const;
+    whisper_context * context() const { return ctx_; }
+
+    static std::vector<float> pcm16_to_f32(const int16_t * pcm, size_t n);
+
+    // BCP-47 tag (e.g. "es-ES") to the base language whisper.cpp expects ("es").
+    static std::string base_language(const std::string & tag);
+
+private:
+    whisper_context * ctx_ = nullptr;
+    int n_threads_ = 4;
+    stt_load_report report_;
+};
+
+} // namespace microllm
@@ -0,0 +1,145 @@
+#define LOG_TAG "ThermalGovernor"
+
+#include "thermal_governor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "log.h"
+
+namespace microllm {
+
+// Upper bound on thermal_zoneN directories probed.
+static constexpr int32_t MAX_THERMAL_ZONES = 128;
+
+// Smoothing for per-token latency and the cool-state rate.
+static constexpr double EMA_ALPHA = 0.2;
+
+static bool read_line(const std::string & path, char * buf, size_t size) {
+    FILE * f = fopen(path.c_str(), "r");
+    if (f == nullptr) return false;
+    const bool ok = fgets(buf, (int) size, f) != nullptr;
+    fclose(f);
+    if (ok) buf[strcspn(buf, "\n")] = '\0';
+    return ok;
+}
+
+// Zone types vary by vendor: "cpu-1-0-usr", "cpuss-0", "soc_thermal", "mtktscpu",
+// "tsens_tz_sensor1", "x86_pkg_temp", ...
+static bool is_cpu_zone(const char * type) {
+    std::string t(type);
+    std::transform(t.begin(), t.end(), t.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+    for (const char * key : { "cpu", "soc", "tsens", "x86_pkg" }) {
+        if (t.find(key) != std::string::npos) return true;
+    }
+    return false;
+}
+
+double read_cpu_temp_c(const std::string & sysfs_root) {
+    double hottest_cpu = -1.0;
+    double hottest_any = -1.0;
+    char buf[128];
+    for (int32_t i = 0; i < MAX_THERMAL_ZONES; i++) {
+        const std::string dir = sysfs_root + "/class/thermal/thermal_zone" + std::to_string(i);
+        if (!read_line(dir + "/temp", buf, sizeof(buf))) continue;
+
+        // Usually millidegrees; a few drivers report whole degrees.
+        double t = atof(buf);
+        if (t > 1000.0) t /= 1000.0;
+        if (t <= 0.0 || t > 200.0) continue; // disabled or bogus sensor
+
+        hottest_any = std::max(hottest_any, t);
+        if (read_line(dir + "/type", buf, sizeof(buf)) && is_cpu_zone(buf)) {
+            hottest_cpu = std::max(hottest_cpu, t);
+        }
+    }
+    return hottest_cpu >= 0.0 ? hottest_cpu : hottest_any;
+}
+
+void read_battery(const std::string & sysfs_root, int32_t & pct, bool & charging) {
+    const std::string dir = sysfs_root + "/class/power_supply/battery";
+    char buf[64];
+    pct = read_line(dir + "/capacity", buf, sizeof(buf)) ? atoi(buf) : -1;
+    charging = read_line(dir + "/status", buf, sizeof(buf)) &&
+               (strcmp(buf, "Charging") == 0 || strcmp(buf, "Full") == 0);
+}
+
+static double pace_ms(double target_tps, double token_ms) {
+    if (target_tps <= 0.0) return 0.0;
+    return std::max(0.0, 1000.0 / target_tps - token_ms);
+}
+
+throttle_decision default_throttle_policy::decide(const throttle_input & in) {
+    const bool low_battery = in.battery_pct >= 0 && in.battery_pct < params_.low_battery_pct && !in.charging;
+
+    if (in.temp_c >= params_.hard_temp_c) {
+        level_ = 2;
+    } else if (in.temp_c >= params_.soft_temp_c) {
+        level_ = std::max(level_, 1);
+    } else if (in.temp_c < params_.soft_temp_c - params_.hysteresis_c) {
+        level_ = 0;
+    } else if (level_ == 2) {
+        level_ = 1; // below hard but not yet cooled off
+    }
+    const int level = low_battery ? std::max(level_, 1) : level_;
+
+    throttle_decision d;
+    if (level == 0) {
+        if (in.n_threads >= params_.max_threads && in.token_ms > 0.0) {
+            const double tps = 1000.0 / in.token_ms;
+            cool_tps_ = cool_tps_ > 0.0 ? cool_tps_ + EMA_ALPHA * (tps - cool_tps_) : tps;
+        }
+        d.n_threads = params_.max_threads;
+        d.pause_ms = 0.0;
+        return d;
+    }
+
+    const double target = params_.target_tps > 0.0 ? params_.target_tps : 0.75 * cool_tps_;
+    if (level == 1) {
+        const int32_t floor = std::max(params_.min_threads, (params_.max_threads + 1) / 2);
+        d.n_threads = std::max(floor, std::min(in.n_threads, params_.max_threads) - 1);
+        d.pause_ms = pace_ms(target, in.token_ms);
+    } else {
+        d.n_threads = params_.min_threads;
+        d.pause_ms = pace_ms(0.5 * target, in.token_ms);
+    }
+    return d;
+}
+
+thermal_governor::thermal_governor(std::string sysfs_root, std::unique_ptr<throttle_policy> policy,
+                                   double sample_interval_ms)
+    : root_(std::move(sysfs_root)),
+      policy_(std::move(policy)),
+      interval_ms_(sample_interval_ms),
+      since_sample_ms_(sample_interval_ms) {}
+
+throttle_decision thermal_governor::on_token(double token_ms, int32_t n_threads) {
+    input_.token_ms = input_.token_ms > 0.0 ? input_.token_ms + EMA_ALPHA * (token_ms - input_.token_ms) : token_ms;
+    input_.n_threads = n_threads;
+
+    since_sample_ms_ += token_ms + (has_decision_ ? decision_.pause_ms : 0.0);
+    if (has_decision_ && since_sample_ms_ < interval_ms_) {
+        return decision_;
+    }
+    since_sample_ms_ = 0.0;
+
+    input_.temp_c = read_cpu_temp_c(root_);
+    read_battery(root_, input_.battery_pct, input_.charging);
+
+    const throttle_decision next = policy_->decide(input_);
+    if (!has_decision_ || next.n_threads != decision_.n_threads ||
+        (next.pause_ms > 0.0) != (decision_.pause_ms > 0.0)) {
+        LOGI("%.1f C, battery %d%%%s, %.1f ms/token -> %d threads, pause %.1f ms",
+             input_.temp_c, input_.battery_pct, input_.charging ? " (charging)" : "",
+             input_.token_ms, next.n_threads, next.pause_ms);
+    }
+    decision_ = next;
+    has_decision_ = true;
+    return decision_;
+}
+
+} // namespace microllm
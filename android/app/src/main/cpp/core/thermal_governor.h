@@ -0,0 +1,95 @@
+// Thermal- and battery-aware pacing for token generation.
+//
+// Sustained decoding heats the SoC until the kernel throttles it hard and tokens/s
+// collapses. The governor samples thermal zones and battery state from sysfs plus the
+// measured per-token latency, and asks a throttle_policy for a thread count and a
+// duty-cycle pause per token that hold a rate the device can sustain.
+//
+// All sysfs paths hang off a configurable root, so policies can be exercised on a Linux
+// host against a fake tree (microllm_cli --sysfs-root).
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace microllm {
+
+struct throttle_input {
+    double temp_c = -1.0;         // hottest CPU/SoC zone; < 0 when unreadable
+    int32_t battery_pct = -1;     // < 0 when unreadable
+    bool charging = false;
+    double token_ms = 0.0;        // smoothed single-token decode latency
+    int32_t n_threads = 1;        // decode threads in use
+};
+
+struct throttle_decision {
+    int32_t n_threads = 1;
+    double pause_ms = 0.0;        // sleep after every token (duty cycling)
+};
+
+// Pluggable policy. decide() is called once per sampling interval, not per token.
+class throttle_policy {
+public:
+    virtual ~throttle_policy() = default;
+    virtual throttle_decision decide(const throttle_input & in) = 0;
+};
+
+struct throttle_params {
+    double target_tps = 0.0;      // 0 = 75% of the rate measured while cool
+    double soft_temp_c = 60.0;    // start shedding threads and pacing
+    double hard_temp_c = 75.0;    // minimum threads, half the target rate
+    double hysteresis_c = 5.0;    // cool down this far below soft before recovering
+    int32_t min_threads = 1;
+    int32_t max_threads = 4;
+    int32_t low_battery_pct = 15; // treated as warm while discharging below this
+};
+
+// Three levels: cool (all threads, no pauses), warm (shed one thread per interval down
+// to half, pace to the target), hot (minimum threads, pace to half the target).
+class default_throttle_policy : public throttle_policy {
+public:
+    explicit default_throttle_policy(const throttle_params & params) : params_(params) {}
+
+    throttle_decision decide(const throttle_input & in) override;
+
+    int level() const { return level_; }
+
+private:
+    throttle_params params_;
+    int level_ = 0;
+    double cool_tps_ = 0.0;  // EMA of tokens/s observed at level 0 with max threads
+};
+
+// Reads `<root>/class/thermal/thermal_zone*/{type,temp}` and returns the hottest zone
+// whose type names a CPU/SoC sensor (all zones if none do), in degrees Celsius.
+// Returns < 0 if nothing is readable.
+double read_cpu_temp_c(const std::string & sysfs_root);
+
+// Reads `<root>/class/power_supply/battery/{capacity,status}`. Leaves `pct` at -1 when
+// unreadable.
+void read_battery(const std::string & sysfs_root, int32_t & pct, bool & charging);
+
+class thermal_governor {
+public:
+    thermal_governor(std::string sysfs_root, std::unique_ptr<throttle_policy> policy,
+                     double sample_interval_ms = 1000.0);
+
+    // Feed the latency of one single-token decode. Sensors are sampled and the policy
+    // consulted at most once per interval; in between the last decision is returned.
+    throttle_decision on_token(double token_ms, int32_t n_threads);
+
+    double last_temp_c() const { return input_.temp_c; }
+
+private:
+    std::string root_;
+    std::unique_ptr<throttle_policy> policy_;
+    double interval_ms_;
+    double since_sample_ms_;
+    throttle_input input_;
+    throttle_decision decision_;
+    bool has_decision_ = false;
+};
+
+} // namespace microllm
@@ -0,0 +1,115 @@
+#define LOG_TAG "ThreadTuner"
+
+#include "thread_tuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include "cpu_topology.h"
+#include "log.h"
+
+namespace microllm {
+
+static constexpr int32_t CALIBRATION_PROMPT = 64;
+static constexpr int32_t CALIBRATION_DECODE = 16;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Thread counts worth trying on `n_cores` performance cores: all of them, one fewer (leaves
+// room for the UI thread), and half.
+static std::vector<int32_t> candidate_counts(int32_t n_cores) {
+    std::vector<int32_t> out = { n_cores, n_cores - 1, n_cores / 2 };
+    out.erase(std::remove_if(out.begin(), out.end(), [](int32_t n) { return n < 1; }), out.end());
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+// Times one prefill and a run of single-token decodes from an empty KV cache.
+static bool measure(llm_engine & engine, const std::vector<llama_token> & prompt,
+                    double & prefill_tps, double & decode_tps) {
+    engine.clear_context();
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (engine.decode(prompt.data(), (int32_t) prompt.size()) != 0) return false;
+    llama_synchronize(engine.context());
+    const double prefill_ms = elapsed_ms(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < CALIBRATION_DECODE; i++) {
+        llama_token token = prompt[(size_t) i % prompt.size()];
+        if (engine.decode(&token, 1) != 0) return false;
+    }
+    llama_synchronize(engine.context());
+    const double decode_ms = elapsed_ms(t0);
+
+    prefill_tps = prefill_ms > 0 ? prompt.size() * 1000.0 / prefill_ms : 0.0;
+    decode_tps = decode_ms > 0 ? CALIBRATION_DECODE * 1000.0 / decode_ms : 0.0;
+    return true;
+}
+
+bool tune_llm_threads(llm_engine & engine, const std::vector<int32_t> & cpus, llm_thread_tuning & out) {
+    if (!engine.is_loaded()) {
+        LOGE("Model not loaded");
+        return false;
+    }
+    if (engine.n_ctx() < CALIBRATION_PROMPT + CALIBRATION_DECODE) {
+        LOGW("Context too small to calibrate threads");
+        return false;
+    }
+
+    // Without a readable topology, fall back to unpinned threads over every core.
+    const int32_t n_cores = std::max<int32_t>(1, cpus.empty()
+        ? (int32_t) std::thread::hardware_concurrency() : (int32_t) cpus.size());
+    const std::vector<int32_t> candidates = candidate_counts(n_cores);
+
+    // Random vocab tokens: timing depends only on the model and the device.
+    const int32_t n_vocab = llama_vocab_n_tokens(llama_model_get_vocab(engine.model()));
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int32_t> dist(0, n_vocab - 1);
+    std::vector<llama_token> prompt((size_t) CALIBRATION_PROMPT);
+    for (auto & t : prompt) t = dist(rng);
+
+    llm_thread_config cfg;
+    cfg.cpus = cpus;
+
+    // Warm-up so the first candidate does not pay for page faults on the mmap'd weights.
+    cfg.n_threads = cfg.n_threads_batch = candidates.back();
+    double prefill_tps = 0.0, decode_tps = 0.0;
+    if (!engine.set_threads(cfg) || !measure(engine, prompt, prefill_tps, decode_tps)) {
+        engine.clear_context();
+        return false;
+    }
+
+    out = llm_thread_tuning{};
+    out.config.cpus = cpus;
+    for (int32_t n : candidates) {
+        cfg.n_threads = cfg.n_threads_batch = n;
+        if (!engine.set_threads(cfg) || !measure(engine, prompt, prefill_tps, decode_tps)) {
+            engine.clear_context();
+            return false;
+        }
+        LOGI("  %d threads: prefill %.1f tok/s, decode %.1f tok/s", n, prefill_tps, decode_tps);
+        if (prefill_tps > out.prefill_tps) {
+            out.prefill_tps = prefill_tps;
+            out.config.n_threads_batch = n;
+        }
+        if (decode_tps > out.decode_tps) {
+            out.decode_tps = decode_tps;
+            out.config.n_threads = n;
+        }
+    }
+
+    engine.clear_context();
+    if (!engine.set_threads(out.config)) return false;
+    LOGI("Tuned threads on cores [%s]: decode %d (%.1f tok/s), prefill %d (%.1f tok/s)",
+         format_core_list(cpus).c_str(), out.config.n_threads, out.decode_tps,
+         out.config.n_threads_batch, out.prefill_tps);
+    return true;
+}
+
+} // namespace microllm
@@ -0,0 +1,29 @@
+// Picks prefill and decode thread counts for the loaded model with a short calibration.
+//
+// Prefill is compute-bound and usually scales with every fast core; single-token decode
+// is memory-bound and often peaks with fewer threads, so the two are tuned separately.
+// Candidates only ever use the performance cores from cpu_topology.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "llm_engine.h"
+
+namespace microllm {
+
+struct llm_thread_tuning {
+    llm_thread_config config;   // best counts, pinned to the performance cores
+    double prefill_tps = 0.0;   // measured with config.n_threads_batch
+    double decode_tps = 0.0;    // measured with config.n_threads
+};
+
+// Runs a 64-token prefill and 16 single-token decodes per candidate thread count on
+// `engine` (unpinned over all cores when `cpus` is empty), applies the winner with
+// set_threads() and clears the KV cache. Takes one to a few seconds for a 1B model;
+// callers should cache the result per device.
+// Returns false if the engine is not loaded or a decode fails.
+bool tune_llm_threads(llm_engine & engine, const std::vector<int32_t> & cpus, llm_thread_tuning & out);
+
+} // namespace microllm
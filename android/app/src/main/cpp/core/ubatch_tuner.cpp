@@ -0,0 +1,91 @@
+#define LOG_TAG "UbatchTuner"
+
+#include "ubatch_tuner.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+namespace microllm {
+
+static constexpr int32_t MIN_UBATCH = 32;
+static constexpr int32_t MIN_CANDIDATE = 64;
+static constexpr int32_t SAMPLES_PER_CANDIDATE = 2;
+
+int32_t choose_n_ubatch(int32_t n_max, int64_t weights_bytes, int64_t kv_bytes,
+                        int64_t compute_bytes_at_max, int64_t available_bytes) {
+    if (n_max <= MIN_UBATCH || available_bytes <= 0 || compute_bytes_at_max <= 0) {
+        return n_max;
+    }
+
+    const int64_t allowance = (available_bytes - weights_bytes - kv_bytes) / 4;
+    const double bytes_per_token = (double) compute_bytes_at_max / (double) n_max;
+
+    int32_t n = n_max;
+    while (n > MIN_UBATCH && (double) n * bytes_per_token > (double) allowance) {
+        // Next power of two below n.
+        int32_t p = MIN_UBATCH;
+        while (p * 2 < n) p *= 2;
+        n = p;
+    }
+    if (n < n_max) {
+        LOGI("ubatch %d -> %d: %lld MB available, compute %lld MB at %d",
+             n_max, n, (long long) (available_bytes >> 20),
+             (long long) (compute_bytes_at_max >> 20), n_max);
+    }
+    return n;
+}
+
+ubatch_tuner::ubatch_tuner(int32_t max_ubatch) {
+    candidates_.push_back({ max_ubatch });
+    for (int32_t s = MIN_CANDIDATE; s < max_ubatch; s *= 2) {
+        candidates_.push_back({ s });
+    }
+    std::sort(candidates_.begin() + 1, candidates_.end(),
+              [](const candidate & a, const candidate & b) { return a.size > b.size; });
+}
+
+int32_t ubatch_tuner::next_chunk() const {
+    for (const candidate & c : candidates_) {
+        if (c.samples < SAMPLES_PER_CANDIDATE) return c.size;
+    }
+    return best();
+}
+
+void ubatch_tuner::record(int32_t n_tokens, double ms) {
+    if (ms <= 0.0) return;
+    if (!warmed_up_) {
+        warmed_up_ = true;
+        return;
+    }
+
+    for (candidate & c : candidates_) {
+        if (c.size != n_tokens) continue;
+        const bool was_exploring = exploring();
+        const double tps = n_tokens * 1000.0 / ms;
+        c.tps = c.samples == 0 ? tps : 0.7 * c.tps + 0.3 * tps;
+        c.samples++;
+        if (was_exploring && !exploring()) {
+            LOGI("Prefill chunk: %d tokens", best());
+        }
+        return;
+    }
+}
+
+int32_t ubatch_tuner::best() const {
+    if (exploring()) return candidates_.front().size;
+    const candidate * best = &candidates_.front();
+    for (const candidate & c : candidates_) {
+        if (c.tps > best->tps) best = &c;
+    }
+    return best->size;
+}
+
+bool ubatch_tuner::exploring() const {
+    for (const candidate & c : candidates_) {
+        if (c.samples < SAMPLES_PER_CANDIDATE) return true;
+    }
+    return false;
+}
+
+} // namespace microllm
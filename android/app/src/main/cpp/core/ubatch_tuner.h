@@ -0,0 +1,52 @@
+// Adaptive prompt-processing (ubatch) sizing.
+//
+// llama.cpp reserves its compute buffer for n_ubatch tokens when the context is created,
+// so the ubatch ceiling is a memory decision made at load time (choose_n_ubatch). Below
+// that ceiling any chunk size can be submitted per llama_decode(), and the fastest one
+// depends on the SoC: larger chunks amortize weight reads, smaller ones stay in cache.
+// ubatch_tuner measures prefill throughput per chunk size on real prompts and settles on
+// the best one.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace microllm {
+
+// Largest ubatch (a power of two >= 32, or `n_max` itself) whose compute buffer fits in a
+// quarter of the memory left after weights and KV cache. `compute_bytes_at_max` is the
+// compute estimate for `n_max`. `available_bytes` <= 0 (unknown) returns `n_max`.
+int32_t choose_n_ubatch(int32_t n_max, int64_t weights_bytes, int64_t kv_bytes,
+                        int64_t compute_bytes_at_max, int64_t available_bytes);
+
+class ubatch_tuner {
+public:
+    // Candidates are the powers of two from 64 up to `max_ubatch`, plus `max_ubatch`.
+    explicit ubatch_tuner(int32_t max_ubatch);
+
+    // Chunk size for the next prefill chunk: each candidate is measured a few times,
+    // largest first, then the fastest is used.
+    int32_t next_chunk() const;
+
+    // Records one decoded chunk. Only full chunks of a candidate size count; the very
+    // first one is dropped because it pays for faulting the weights in.
+    void record(int32_t n_tokens, double ms);
+
+    // Fastest candidate so far (the largest until every candidate was measured).
+    int32_t best() const;
+
+private:
+    bool exploring() const;
+
+    struct candidate {
+        int32_t size = 0;
+        double tps = 0.0;  // moving average of tokens/s
+        int32_t samples = 0;
+    };
+
+    std::vector<candidate> candidates_; // descending size
+    bool warmed_up_ = false;
+};
+
+} // namespace microllm
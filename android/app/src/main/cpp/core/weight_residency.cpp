@@ -0,0 +1,166 @@
+#define LOG_TAG "WeightResidency"
+
+#include "weight_residency.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "log.h"
+
+namespace microllm {
+
+// Lock priority of a tensor, or -1 if it is not worth pinning. The output head is read
+// in full for every generated token; attention weights for every token of every layer;
+// the embedding table only row by row, but in full when it doubles as the output head.
+static int hot_priority(const std::string & name) {
+    if (name.compare(0, 6, "output") == 0) return 0;
+    if (name.compare(0, 4, "blk.") == 0 && name.find(".attn_") != std::string::npos) return 1;
+    if (name.compare(0, 10, "token_embd") == 0) return 2;
+    return -1;
+}
+
+static size_t page_size() {
+    static const size_t size = (size_t) sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+// Raises the soft RLIMIT_MEMLOCK to the hard one and returns it (INT64_MAX if unlimited).
+static int64_t memlock_limit() {
+    rlimit lim{};
+    if (getrlimit(RLIMIT_MEMLOCK, &lim) != 0) return 0;
+    if (lim.rlim_cur < lim.rlim_max) {
+        rlimit raised = lim;
+        raised.rlim_cur = lim.rlim_max;
+        if (setrlimit(RLIMIT_MEMLOCK, &raised) == 0) lim = raised;
+    }
+    return lim.rlim_cur == RLIM_INFINITY ? INT64_MAX : (int64_t) lim.rlim_cur;
+}
+
+weight_residency::weight_residency(const std::string & path) : locks_(page_size()) {
+    std::vector<gguf_tensor_range> tensors;
+    if (!gguf_tensors(path, tensors)) {
+        return;
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Cannot open %s: %s", path.c_str(), strerror(errno));
+        return;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void * addr = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            base_ = addr;
+            size_ = (size_t) st.st_size;
+        } else {
+            LOGE("mmap failed: %s", strerror(errno));
+        }
+    }
+    close(fd); // the mapping keeps the file referenced
+    if (base_ == nullptr) {
+        return;
+    }
+
+    for (const gguf_tensor_range & t : tensors) {
+        const int priority = hot_priority(t.name);
+        if (priority >= 0 && t.range.size > 0 && t.range.offset + t.range.size <= size_) {
+            hot_.push_back({ t.range, priority });
+        }
+    }
+    std::stable_sort(hot_.begin(), hot_.end(), [](const hot_tensor & a, const hot_tensor & b) {
+        return a.priority < b.priority;
+    });
+}
+
+weight_residency::~weight_residency() {
+    if (base_ != nullptr) {
+        munmap(base_, size_); // drops the locks too
+    }
+}
+
+bool weight_residency::allowed(const hot_tensor & t) const {
+    switch (pressure_) {
+        case memory_pressure::none:     return true;
+        case memory_pressure::moderate: return t.priority == 0;
+        case memory_pressure::critical: return false;
+    }
+    return false;
+}
+
+// Only the pages no other locked tensor touches are unlocked with `t`.
+void weight_residency::unlock(const hot_tensor & t) {
+    const page_run own = locks_.unlock(t.range);
+    if (own.count() > 0) {
+        munlock((char *) base_ + own.first * page_size(), own.count() * page_size());
+    }
+}
+
+int64_t weight_residency::lock_hot(int64_t budget_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_ == nullptr) return 0;
+
+    const int64_t budget = std::min(budget_bytes, memlock_limit());
+    const int64_t before = locks_.locked_bytes();
+    const size_t page = page_size();
+    for (const hot_tensor & t : hot_) {
+        if (locks_.locked(t.range) || !allowed(t)) continue;
+        if (locks_.locked_bytes() + locks_.added_bytes(t.range) > budget) break;
+
+        // Faults the range in if the prefetch has not already. Relocking pages shared
+        // with a locked neighbour is a no-op.
+        const page_run span = locks_.span(t.range);
+        if (mlock((char *) base_ + span.first * page, span.count() * page) != 0) {
+            LOGW("mlock failed after %lld MB: %s", (long long) (locks_.locked_bytes() >> 20),
+                 strerror(errno));
+            break;
+        }
+        locks_.lock(t.range);
+    }
+    const int64_t locked = locks_.locked_bytes();
+    if (locked != before) {
+        LOGI("Locked %lld MB of hot weights (budget %lld MB)", (long long) (locked >> 20),
+             (long long) (budget >> 20));
+    }
+    return locked;
+}
+
+void weight_residency::set_pressure(memory_pressure pressure) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pressure_ = pressure;
+    const int64_t before = locks_.locked_bytes();
+    for (const hot_tensor & t : hot_) {
+        if (locks_.locked(t.range) && !allowed(t)) unlock(t);
+    }
+    const int64_t locked = locks_.locked_bytes();
+    if (locked != before) {
+        LOGI("Memory pressure %d: unlocked %lld MB, %lld MB still locked", (int) pressure,
+             (long long) ((before - locked) >> 20), (long long) (locked >> 20));
+    }
+}
+
+residency_stats weight_residency::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    residency_stats s;
+    if (base_ == nullptr) return s;
+
+    s.mapped_bytes = (int64_t) size_;
+    s.locked_bytes = locks_.locked_bytes();
+    const size_t page = page_size();
+    std::vector<unsigned char> vec((size_ + page - 1) / page);
+    if (mincore(base_, size_, vec.data()) == 0) {
+        int64_t pages = 0;
+        for (unsigned char v : vec) pages += v & 1;
+        s.resident_bytes = std::min<int64_t>(pages * (int64_t) page, s.mapped_bytes);
+    }
+    return s;
+}
+
+} // namespace microllm
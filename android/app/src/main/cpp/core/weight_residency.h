@@ -0,0 +1,76 @@
+// Memory-pressure-aware residency of mmap'ed model weights.
+//
+// llama.cpp's use_mlock pins the whole model, which exceeds RLIMIT_MEMLOCK on most
+// Android devices and is the wrong trade on a phone anyway. weight_residency maps the
+// model file a second time (address space only) and mlock()s just the tensors every
+// token reads — output head, attention, embeddings — within a byte budget. Both
+// mappings share the page cache, so pages locked here never fault for llama.cpp either.
+// Under memory pressure the locks are dropped, lowest priority first, so the kernel can
+// reclaim weights instead of killing the process.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "model_prefetch.h"
+#include "page_locks.h"
+
+namespace microllm {
+
+enum class memory_pressure {
+    none,     // lock hot tensors within the budget
+    moderate, // keep only the output head locked
+    critical, // nothing locked
+};
+
+struct residency_stats {
+    int64_t mapped_bytes = 0;   // model file size
+    int64_t resident_bytes = 0; // model pages currently in RAM (page cache)
+    int64_t locked_bytes = 0;   // pinned by this manager
+};
+
+// All methods are thread-safe: pressure callbacks arrive while a decode is running.
+class weight_residency {
+public:
+    explicit weight_residency(const std::string & path);
+    ~weight_residency();
+
+    weight_residency(const weight_residency &) = delete;
+    weight_residency & operator=(const weight_residency &) = delete;
+
+    bool ok() const { return base_ != nullptr; }
+
+    // Locks hot tensors, highest priority first, until `budget_bytes` are locked in total
+    // (further capped by RLIMIT_MEMLOCK). Tensors the current pressure level excludes
+    // stay unlocked. Returns the bytes locked afterwards.
+    int64_t lock_hot(int64_t budget_bytes);
+
+    // Drops the locks the new level does not allow. Lowering the level does not relock by
+    // itself; call lock_hot() once memory is available again.
+    void set_pressure(memory_pressure pressure);
+
+    // Resident bytes come from mincore(), which reports page-cache residency for files
+    // the app owns (the downloaded model) and only this mapping's pages otherwise.
+    residency_stats stats() const;
+
+private:
+    struct hot_tensor {
+        file_range range;
+        int priority = 0; // 0 = locked longest
+    };
+
+    bool allowed(const hot_tensor & t) const;
+    void unlock(const hot_tensor & t);
+
+    mutable std::mutex mutex_;
+    void * base_ = nullptr;
+    size_t size_ = 0;
+    std::vector<hot_tensor> hot_; // ascending priority
+    page_locks locks_;
+    memory_pressure pressure_ = memory_pressure::none;
+};
+
+} // namespace microllm
@@ -0,0 +1,29 @@
+// JNI entry point for picking the libggml build before it is loaded.
+// Built into libmicrollm_cpu.so, which links nothing from ggml or llama.cpp.
+
+#include <jni.h>
+#include "core/cpu_features.h"
+
+extern "C" {
+
+JNIEXPORT jstring JNICALL
+Java_com_microllm_app_GgmlLoader_bestVariant(JNIEnv* env, jclass clazz) {
+    return env->NewStringUTF(microllm::best_ggml_variant(microllm::detect_cpu_features()));
+}
+
+// [dotprod, i8mm, sve]
+JNIEXPORT jbooleanArray JNICALL
+Java_com_microllm_app_GgmlLoader_cpuFeatures(JNIEnv* env, jclass clazz) {
+    const microllm::cpu_features f = microllm::detect_cpu_features();
+    const jboolean values[3] = {
+        (jboolean) (f.dotprod ? JNI_TRUE : JNI_FALSE),
+        (jboolean) (f.i8mm ? JNI_TRUE : JNI_FALSE),
+        (jboolean) (f.sve ? JNI_TRUE : JNI_FALSE),
+    };
+    jbooleanArray out = env->NewBooleanArray(3);
+    if (out == nullptr) return nullptr;
+    env->SetBooleanArrayRegion(out, 0, 3, values);
+    return out;
+}
+
+} // extern "C"
@@ -0,0 +1,63 @@
+// C entry points for the Dart FFI downloader: the download verifier
+// (lib/native/sha256_bindings.dart) and storage helpers (lib/native/storage_bindings.dart).
+// Built into libmicrollm_hash.so, which links nothing from ggml or llama.cpp, so the
+// downloader can load it without pulling in the inference runtime.
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#include "core/sha256.h"
+
+#define MICROLLM_FFI extern "C" __attribute__((visibility("default")))
+
+MICROLLM_FFI void * microllm_sha256_new() {
+    return new microllm::sha256();
+}
+
+MICROLLM_FFI void microllm_sha256_update(void * hasher, const uint8_t * data, size_t len) {
+    static_cast<microllm::sha256 *>(hasher)->update(data, len);
+}
+
+// Writes the 32-byte digest and resets the hasher.
+MICROLLM_FFI void microllm_sha256_finish(void * hasher, uint8_t * out) {
+    auto * h = static_cast<microllm::sha256 *>(hasher);
+    h->finish(out);
+    h->reset();
+}
+
+MICROLLM_FFI int32_t microllm_sha256_accelerated(void * hasher) {
+    return static_cast<microllm::sha256 *>(hasher)->accelerated() ? 1 : 0;
+}
+
+MICROLLM_FFI void microllm_sha256_free(void * hasher) {
+    delete static_cast<microllm::sha256 *>(hasher);
+}
+
+// Creates or truncates `path` and reserves `size` bytes of storage for it, so a long
+// download fails up front instead of with ENOSPC halfway through. Returns 0 or the errno
+// (EOPNOTSUPP/EINVAL on filesystems without fallocate, ENOSPC when it does not fit).
+MICROLLM_FFI int32_t microllm_fallocate(const char * path, int64_t size) {
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return errno;
+    }
+    const int err = posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (err != 0) {
+        // Drop whatever was reserved before the failure.
+        (void) ftruncate(fd, 0);
+    }
+    close(fd);
+    return err;
+}
+
+// Bytes an unprivileged app can still write on the filesystem holding `path`, or -1.
+MICROLLM_FFI int64_t microllm_free_bytes(const char * path) {
+    struct statvfs st;
+    if (statvfs(path, &st) != 0) {
+        return -1;
+    }
+    return static_cast<int64_t>(st.f_bavail) * static_cast<int64_t>(st.f_frsize);
+}
@@ -0,0 +1,71 @@
+// Host (Linux) throughput benchmark, llama-bench style, over core/llm_bench.
+//
+//   microllm_bench -m model.gguf [-p 128,512] [-n 32] [-b 512] [-t 4,8] [-r 3]
+//
+// Prints one markdown table row per (batch, threads, prompt) combination, matching the
+// rows LlamaNative.runBenchmark() returns on device.
+
+#define LOG_TAG "MicroLLMBench"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/llm_bench.h"
+#include "core/llm_engine.h"
+#include "core/log.h"
+
+namespace {
+
+std::vector<int32_t> parse_list(const char * s) {
+    std::vector<int32_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back((int32_t) atoi(item.c_str()));
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+    microllm::llm_bench_params params;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string a = argv[i];
+        const char * v = argv[i + 1];
+        if      (a == "-m") params.model_path = v;
+        else if (a == "-p") params.n_prompt = parse_list(v);
+        else if (a == "-n") params.n_gen = atoi(v);
+        else if (a == "-b") params.n_batch = parse_list(v);
+        else if (a == "-t") params.n_threads = parse_list(v);
+        else if (a == "-r") params.repetitions = atoi(v);
+        else {
+            params.model_path.clear();
+            break;
+        }
+    }
+    if (params.model_path.empty() || argc % 2 == 0) {
+        fprintf(stderr, "usage: %s -m model.gguf [-p 128,512] [-n 32] [-b 512] [-t 4,8] [-r 3]\n", argv[0]);
+        return 2;
+    }
+
+    microllm::llm_engine::backend_init();
+
+    printf("| n_prompt | n_gen | n_batch | threads |        pp t/s |        tg t/s | ttft ms |\n");
+    printf("| -------: | ----: | ------: | ------: | ------------: | ------------: | ------: |\n");
+    fflush(stdout);
+
+    std::vector<microllm::llm_bench_result> results;
+    const bool ok = microllm::run_llm_bench(params, results, [&results](int, int) {
+        const auto & r = results.back();
+        printf("| %8d | %5d | %7d | %7d | %7.2f ± %4.2f | %7.2f ± %4.2f | %7.1f |\n",
+               r.n_prompt, r.n_gen, r.n_batch, r.n_threads,
+               r.pp_tps, r.pp_tps_stddev, r.tg_tps, r.tg_tps_stddev, r.ttft_ms);
+        fflush(stdout);
+        return true;
+    });
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,448 @@
+// Host (Linux) driver for the inference core.
+//
+// Runs the same llm_engine / stt_engine code the app uses through JNI, so generation,
+// KV handling and transcription can be exercised under perf, sanitizers and CI without
+// a device.
+//
+//   microllm_cli -m model.gguf [-p prompt] [-n n_predict] [-c n_ctx] [-t threads]
+//                [-b n_batch] [-ub n_ubatch|0] [-fa on|off] [-ctk type] [-ctv type] [--prefetch on|off]
+//                [--lock-hot on|off] [--warmup on|off] [--sysfs-root dir] [--target-tps n]
+//                [--lora adapter.gguf] [--lora-scale s] [--grammar-file rules.gbnf]
+//                [--use-converted on|off]
+//   microllm_cli -m model.gguf --inspect
+//   microllm_cli -m model.gguf --convert [-t threads]
+//   microllm_cli -m model.gguf --sha256
+//   microllm_cli -w ggml-base.bin -a audio.wav [-l lang] [-t threads]
+
+#define LOG_TAG "MicroLLMCli"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/cpu_features.h"
+#include "core/gguf_inspect.h"
+#include "core/llm_engine.h"
+#include "core/log.h"
+#include "core/model_convert.h"
+#include "core/sha256.h"
+#include "core/proc_stats.h"
+
+#if MICROLLM_HAS_WHISPER
+#include "core/stt_engine.h"
+#endif
+
+namespace {
+
+struct cli_args {
+    std::string model;
+    std::string prompt = "Hello, my name is";
+    int n_predict = 64;
+    int n_ctx = 2048;
+    int n_threads = 4;
+    int n_batch = 512;
+    int n_ubatch = 512; // 0 = adaptive
+    bool flash_attn = false;
+    std::string cache_type_k = "f16";
+    std::string cache_type_v = "f16";
+    bool prefetch = true;
+    bool lock_hot = false;
+    bool warmup = true;
+    bool use_converted = false; // load the --convert result next to the model, if any
+    std::string lora; // LoRA adapter applied on top of the model
+    float lora_scale = 1.0f;
+    std::string grammar_file; // GBNF the output is constrained to
+    bool inspect = false; // print the GGUF header summary instead of generating
+    bool convert = false; // write the CPU-optimized copy instead of generating
+    bool hash = false;    // print the file's SHA-256 (download verifier) instead of generating
+    std::string whisper_model;
+    std::string audio;
+    std::string language = "en";
+    // Thermal governor; enabled when either is set. A fake sysfs root lets throttle
+    // policies be exercised on a desktop by editing thermal_zone*/temp during a run.
+    std::string sysfs_root;
+    double target_tps = 0.0;
+};
+
+void print_usage(const char * argv0) {
+    fprintf(stderr,
+            "usage: %s -m model.gguf [-p prompt] [-n n_predict] [-c n_ctx] [-t threads]\n"
+            "          [-b n_batch] [-ub n_ubatch|0 (adaptive)] [-fa on|off]\n"
+            "          [-ctk f16|q8_0|q4_0] [-ctv f16|q8_0|q4_0] [--prefetch on|off]\n"
+            "          [--lock-hot on|off] [--warmup on|off] [--sysfs-root dir] [--target-tps n]\n"
+            "          [--lora adapter.gguf] [--lora-scale s] [--grammar-file rules.gbnf]\n"
+            "          [--use-converted on|off]\n"
+            "       %s -m model.gguf --inspect\n"
+            "       %s -m model.gguf --convert [-t threads]\n"
+            "       %s -m model.gguf --sha256\n"
+            "       %s -w whisper.bin -a audio.wav [-l lang] [-t threads]\n",
+            argv0, argv0, argv0, argv0, argv0);
+}
+
+bool parse_args(int argc, char ** argv, cli_args & args) {
+    for (int i = 1; i < argc; i++) {
+        const std::string a = argv[i];
+        if (a == "--inspect") {
+            args.inspect = true;
+            continue;
+        }
+        if (a == "--convert") {
+            args.convert = true;
+            continue;
+        }
+        if (a == "--sha256") {
+            args.hash = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char * v = argv[++i];
+        if      (a == "-m") args.model = v;
+        else if (a == "-p") args.prompt = v;
+        else if (a == "-n") args.n_predict = atoi(v);
+        else if (a == "-c") args.n_ctx = atoi(v);
+        else if (a == "-t") args.n_threads = atoi(v);
+        else if (a == "-b") args.n_batch = atoi(v);
+        else if (a == "-ub") args.n_ubatch = atoi(v);
+        else if (a == "-fa") args.flash_attn = strcmp(v, "on") == 0;
+        else if (a == "-ctk") args.cache_type_k = v;
+        else if (a == "-ctv") args.cache_type_v = v;
+        else if (a == "--prefetch") args.prefetch = strcmp(v, "on") == 0;
+        else if (a == "--lock-hot") args.lock_hot = strcmp(v, "on") == 0;
+        else if (a == "--warmup") args.warmup = strcmp(v, "on") == 0;
+        else if (a == "--use-converted") args.use_converted = strcmp(v, "on") == 0;
+        else if (a == "--lora") args.lora = v;
+        else if (a == "--lora-scale") args.lora_scale = (float) atof(v);
+        else if (a == "--grammar-file") args.grammar_file = v;
+        else if (a == "-w") args.whisper_model = v;
+        else if (a == "-a") args.audio = v;
+        else if (a == "-l") args.language = v;
+        else if (a == "--sysfs-root") args.sysfs_root = v;
+        else if (a == "--target-tps") args.target_tps = atof(v);
+        else return false;
+    }
+    return !args.model.empty() || (!args.whisper_model.empty() && !args.audio.empty());
+}
+
+double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int run_inspect(const cli_args & args) {
+    const auto t0 = std::chrono::steady_clock::now();
+    microllm::gguf_model_info info;
+    if (!microllm::inspect_gguf(args.model, info)) {
+        return 1;
+    }
+    const double ms = ms_since(t0);
+
+    printf("architecture: %s%s%s\n", info.architecture.c_str(), info.name.empty() ? "" : ", ",
+           info.name.c_str());
+    printf("params: %.2f B, weights %lld MB\n", (double) info.n_params / 1e9,
+           (long long) (info.weights_bytes >> 20));
+    printf("context: %d trained, vocab %d\n", info.n_ctx_train, info.n_vocab);
+    printf("layers: %d, embd %d, heads %d (kv %d)\n", info.n_layer, info.n_embd, info.n_head,
+           info.n_head_kv);
+    printf("kv cache: %lld bytes/token at f16 (%lld MB for %d tokens)\n",
+           (long long) info.kv_bytes_per_token,
+           (long long) ((info.kv_bytes_per_token * args.n_ctx) >> 20), args.n_ctx);
+    for (const microllm::gguf_type_bytes & t : info.types) {
+        printf("  %-6s %4d tensors %8lld MB (%.1f%%)\n", ggml_type_name(t.type), t.n_tensors,
+               (long long) (t.bytes >> 20), 100.0 * (double) t.bytes / (double) info.weights_bytes);
+    }
+    fprintf(stderr, "read header in %.1f ms\n", ms);
+    return 0;
+}
+
+int run_convert(const cli_args & args) {
+    microllm::llm_engine::backend_init();
+    const microllm::cpu_features features = microllm::detect_cpu_features();
+    const auto t0 = std::chrono::steady_clock::now();
+    std::string out_path;
+    const microllm::convert_status status =
+        microllm::convert_model_for_cpu(args.model, features, args.n_threads, out_path);
+    printf("%s: %s\n", microllm::convert_status_name(status), out_path.c_str());
+    fprintf(stderr, "took %.0f ms\n", ms_since(t0));
+    return status == microllm::convert_status::failed ? 1 : 0;
+}
+
+// Same chunked update the app does while a download streams in.
+int run_hash(const cli_args & args) {
+    FILE * f = fopen(args.model.c_str(), "rb");
+    if (f == nullptr) {
+        LOGE("Cannot open %s", args.model.c_str());
+        return 1;
+    }
+    microllm::sha256 hasher;
+    std::vector<uint8_t> chunk(1 << 20);
+    int64_t total = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    size_t n;
+    while ((n = fread(chunk.data(), 1, chunk.size(), f)) > 0) {
+        hasher.update(chunk.data(), n);
+        total += (int64_t) n;
+    }
+    fclose(f);
+    uint8_t digest[microllm::sha256::DIGEST_SIZE];
+    hasher.finish(digest);
+    const double ms = ms_since(t0);
+
+    printf("%s  %s\n", microllm::to_hex(digest, sizeof(digest)).c_str(), args.model.c_str());
+    fprintf(stderr, "%lld MB in %.0f ms (%.0f MB/s, %s)\n", (long long) (total >> 20), ms,
+            (double) (total >> 20) / (ms / 1000.0), hasher.accelerated() ? "sha2" : "portable");
+    return 0;
+}
+
+bool read_text_file(const std::string & path, std::string & out) {
+    FILE * f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        LOGE("Cannot open %s", path.c_str());
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.append(buf, n);
+    }
+    fclose(f);
+    return true;
+}
+
+int run_generation(const cli_args & args) {
+    microllm::llm_engine::backend_init();
+    microllm::llm_engine engine;
+
+    microllm::llm_load_params params;
+    // Same as the app's opt-in: the --convert result next to the model replaces it.
+    params.model_path = args.use_converted ? microllm::resolve_converted_model(args.model) : args.model;
+    if (params.model_path != args.model) {
+        LOGI("Using converted model %s", params.model_path.c_str());
+    }
+    params.n_ctx = args.n_ctx;
+    params.n_threads = args.n_threads;
+    params.n_batch = args.n_batch;
+    params.n_ubatch = args.n_ubatch;
+    params.flash_attn = args.flash_attn;
+    params.type_k = microllm::kv_cache_type_from_name(args.cache_type_k);
+    params.type_v = microllm::kv_cache_type_from_name(args.cache_type_v);
+    if (params.type_k == GGML_TYPE_COUNT || params.type_v == GGML_TYPE_COUNT) {
+        LOGE("Unsupported KV cache type (use f16, q8_0 or q4_0)");
+        return 1;
+    }
+    params.prefetch = args.prefetch;
+    params.lock_hot_weights = args.lock_hot;
+    params.warmup = args.warmup;
+    params.on_progress = [](float p) { fprintf(stderr, "\rloading %3d%%", (int) (p * 100.0f)); };
+    const auto t_load = std::chrono::steady_clock::now();
+    if (!engine.load(params)) {
+        fprintf(stderr, "\n");
+        return 1;
+    }
+    const microllm::llm_warmup_stats & warm = engine.last_warmup();
+    fprintf(stderr, "\rloaded in %.0f ms (warm-up %.0f ms: %d-token prefill %.0f ms, decode %.0f ms)\n",
+            ms_since(t_load), warm.total_ms(), warm.n_prefill, warm.prefill_ms, warm.decode_ms);
+    const microllm::residency_stats res = engine.residency();
+    fprintf(stderr, "weights: %lld MB mapped, %lld MB resident, %lld MB locked\n",
+            (long long) (res.mapped_bytes >> 20), (long long) (res.resident_bytes >> 20),
+            (long long) (res.locked_bytes >> 20));
+
+    if (!args.lora.empty()) {
+        const auto t_lora = std::chrono::steady_clock::now();
+        if (engine.set_adapter(args.lora, args.lora_scale) < 0) {
+            return 1;
+        }
+        fprintf(stderr, "LoRA adapter applied in %.0f ms (scale %.2f)\n", ms_since(t_lora),
+                args.lora_scale);
+    }
+
+    if (!args.sysfs_root.empty() || args.target_tps > 0.0) {
+        microllm::throttle_params tp;
+        tp.target_tps = args.target_tps;
+        tp.max_threads = args.n_threads;
+        tp.min_threads = std::min(2, args.n_threads);
+        engine.set_governor(std::make_unique<microllm::thermal_governor>(
+            args.sysfs_root.empty() ? "/sys" : args.sysfs_root,
+            std::make_unique<microllm::default_throttle_policy>(tp)));
+    }
+
+    if (!args.grammar_file.empty()) {
+        std::string grammar;
+        if (!read_text_file(args.grammar_file, grammar) ||
+            !engine.reset_sampler(0.7f, 0.9f, 40, grammar)) {
+            return 1;
+        }
+    }
+
+    engine.begin_request();
+    std::vector<llama_token> tokens;
+    if (!engine.tokenize(args.prompt.data(), args.prompt.size(), true, tokens)) {
+        return 1;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (engine.decode(tokens.data(), (int32_t) tokens.size()) != 0) {
+        LOGE("Prompt decode failed");
+        return 1;
+    }
+    const double prefill_ms = ms_since(t0);
+
+    printf("%s", args.prompt.c_str());
+    fflush(stdout);
+
+    t0 = std::chrono::steady_clock::now();
+    int n_generated = 0;
+    while (n_generated < args.n_predict && engine.n_past() < engine.n_ctx()) {
+        llama_token token = engine.sample();
+        if (token < 0 || engine.is_eog(token)) {
+            break;
+        }
+        const std::string piece = engine.token_to_piece(token);
+        fwrite(piece.data(), 1, piece.size(), stdout);
+        fflush(stdout);
+        n_generated++;
+        if (engine.decode(&token, 1) != 0) {
+            LOGE("Decode failed");
+            break;
+        }
+    }
+    const double decode_ms = ms_since(t0);
+    const microllm::llm_request_metrics m = engine.end_request();
+    printf("\n");
+
+    fprintf(stderr, "\nprefill: %zu tokens in %.1f ms (%.2f tok/s)\n", tokens.size(), prefill_ms,
+            prefill_ms > 0 ? tokens.size() * 1000.0 / prefill_ms : 0.0);
+    fprintf(stderr, "decode:  %d tokens in %.1f ms (%.2f tok/s)\n", n_generated, decode_ms,
+            decode_ms > 0 ? n_generated * 1000.0 / decode_ms : 0.0);
+    fprintf(stderr, "per-token decode: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms\n",
+            m.decode_p50_ms, m.decode_p95_ms, m.decode_p99_ms);
+    fprintf(stderr, "tokenize %.2f ms, sample %.2f ms, detokenize %.2f ms\n",
+            m.tokenize_ms, m.sample_ms, m.detokenize_ms);
+    fprintf(stderr, "kv: %d / %d cells\n", m.kv_used, m.kv_size);
+    fprintf(stderr, "peak rss: %lld MB\n", (long long) (m.peak_rss_bytes >> 20));
+    const microllm::llm_memory_estimate mem = engine.memory_estimate();
+    fprintf(stderr, "estimate: weights %lld MB, kv %lld MB, compute %lld MB\n",
+            (long long) (mem.weights_bytes >> 20), (long long) (mem.kv_bytes >> 20),
+            (long long) (mem.compute_bytes >> 20));
+    return 0;
+}
+
+#if MICROLLM_HAS_WHISPER
+// Minimal RIFF/WAVE reader: 16-bit PCM, mono, 16 kHz only (the format the app records).
+bool read_wav_pcm16(const std::string & path, std::vector<int16_t> & out) {
+    FILE * f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        LOGE("Cannot open %s", path.c_str());
+        return false;
+    }
+
+    char riff[12];
+    bool ok = fread(riff, 1, sizeof(riff), f) == sizeof(riff)
+           && memcmp(riff, "RIFF", 4) == 0 && memcmp(riff + 8, "WAVE", 4) == 0;
+    bool fmt_ok = false;
+    while (ok) {
+        char id[4];
+        uint32_t size = 0;
+        if (fread(id, 1, 4, f) != 4 || fread(&size, 4, 1, f) != 1) {
+            ok = false;
+            break;
+        }
+        if (memcmp(id, "fmt ", 4) == 0) {
+            uint8_t fmt[16] = {};
+            if (size < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), f) != sizeof(fmt)) {
+                ok = false;
+                break;
+            }
+            uint16_t format, channels, bits;
+            uint32_t rate;
+            memcpy(&format, fmt, 2);
+            memcpy(&channels, fmt + 2, 2);
+            memcpy(&rate, fmt + 4, 4);
+            memcpy(&bits, fmt + 14, 2);
+            fmt_ok = format == 1 && channels == 1 && bits == 16
+                  && rate == (uint32_t) microllm::stt_engine::SAMPLE_RATE;
+            fseek(f, (long) (size - sizeof(fmt) + (size & 1)), SEEK_CUR);
+        } else if (memcmp(id, "data", 4) == 0) {
+            out.resize(size / 2);
+            ok = fmt_ok && fread(out.data(), 2, out.size(), f) == out.size();
+            break;
+        } else {
+            fseek(f, (long) (size + (size & 1)), SEEK_CUR);
+        }
+    }
+    fclose(f);
+
+    if (!ok) {
+        LOGE("%s: expected a 16 kHz mono 16-bit PCM WAV file", path.c_str());
+    }
+    return ok;
+}
+
+int run_transcription(const cli_args & args) {
+    std::vector<int16_t> pcm;
+    if (!read_wav_pcm16(args.audio, pcm)) {
+        return 1;
+    }
+
+    microllm::stt_engine engine;
+    if (!engine.load(args.whisper_model.c_str(), args.n_threads)) {
+        return 1;
+    }
+
+    const std::vector<float> audio = microllm::stt_engine::pcm16_to_f32(pcm.data(), pcm.size());
+
+    microllm::stt_request request;
+    request.language = microllm::stt_engine::base_language(args.language);
+    request.on_segment = [](const char * text, int64_t t0_ms, int64_t t1_ms, float confidence) {
+        printf("[%7.2f -> %7.2f] (p=%.2f) %s\n", t0_ms / 1000.0, t1_ms / 1000.0, confidence, text ? text : "");
+        fflush(stdout);
+    };
+
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!engine.transcribe(audio.data(), audio.size(), request)) {
+        return 1;
+    }
+    const double ms = ms_since(t0);
+
+    const double audio_ms = audio.size() * 1000.0 / microllm::stt_engine::SAMPLE_RATE;
+    fprintf(stderr, "\ntranscribed %.1f s of audio in %.1f ms (RTF %.3f)\n", audio_ms / 1000.0, ms,
+            audio_ms > 0 ? ms / audio_ms : 0.0);
+    fprintf(stderr, "peak rss: %lld MB\n", (long long) (microllm::peak_rss_bytes() >> 20));
+    return 0;
+}
+#endif
+
+} // namespace
+
+int main(int argc, char ** argv) {
+    cli_args args;
+    if (!parse_args(argc, argv, args)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    if (!args.whisper_model.empty()) {
+#if MICROLLM_HAS_WHISPER
+        return run_transcription(args);
+#else
+        LOGE("Built without whisper.cpp; -w/-a are unavailable");
+        return 2;
+#endif
+    }
+    if (args.inspect) {
+        return run_inspect(args);
+    }
+    if (args.convert) {
+        return run_convert(args);
+    }
+    if (args.hash) {
+        return run_hash(args);
+    }
+    return run_generation(args);
+}
@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# Records a PGO profile for libggml/libllama with the benchmark harness on a device.
+#
+# Builds microllm_bench and microllm_cli for arm64 with -DMICROLLM_PGO=generate, runs a
+# prompt-processing + generation workload over adb and merges the raw profiles:
+#
+#   ANDROID_NDK=~/Android/Sdk/ndk/<version> \
+#       android/app/src/main/cpp/host/pgo_profile.sh model.gguf [out.profdata]
+#
+# Then build the app with the profile:
+#
+#   flutter build apk --release -PmicrollmPgoProfile=$PWD/microllm.profdata
+#
+# Record on a device with the same CPU generation as the release target; the profile is
+# only as representative as the workload (the prompt sizes and thread counts below).
+
+set -e
+
+MODEL="$1"
+OUT="${2:-microllm.profdata}"
+THREADS="${THREADS:-4}"
+
+if [ -z "$MODEL" ] || [ ! -f "$MODEL" ]; then
+    echo "usage: $0 model.gguf [out.profdata]"
+    exit 1
+fi
+if [ -z "$ANDROID_NDK" ]; then
+    echo "ANDROID_NDK is not set"
+    exit 1
+fi
+
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="${BUILD_DIR:-build-pgo}"
+DEVICE_DIR=/data/local/tmp/microllm-pgo
+LLVM_BIN=$(echo "$ANDROID_NDK"/toolchains/llvm/prebuilt/*/bin)
+
+# Only the baseline libggml is instrumented: the variants share its source, and
+# functions whose compiled form differs simply fall back to static heuristics.
+cmake -S "$SRC_DIR" -B "$BUILD_DIR" \
+    -DCMAKE_TOOLCHAIN_FILE="$ANDROID_NDK/build/cmake/android.toolchain.cmake" \
+    -DANDROID_ABI=arm64-v8a \
+    -DANDROID_PLATFORM=android-29 \
+    -DANDROID_STL=c++_shared \
+    -DCMAKE_BUILD_TYPE=Release \
+    -DMICROLLM_BUILD_TOOLS=ON \
+    -DMICROLLM_CPU_VARIANTS=OFF \
+    -DMICROLLM_PGO=generate
+cmake --build "$BUILD_DIR" -j --target microllm_bench microllm_cli
+
+adb shell "rm -rf $DEVICE_DIR && mkdir -p $DEVICE_DIR"
+adb push "$BUILD_DIR/microllm_bench" "$BUILD_DIR/microllm_cli" "$BUILD_DIR/libggml.so" \
+    "$LLVM_BIN/../sysroot/usr/lib/aarch64-linux-android/libc++_shared.so" "$DEVICE_DIR/"
+adb push "$MODEL" "$DEVICE_DIR/model.gguf"
+
+# Prefill at the batch sizes the app uses, then chat-style generation.
+adb shell "cd $DEVICE_DIR && export LD_LIBRARY_PATH=. LLVM_PROFILE_FILE=./microllm-%p.profraw && \
+    ./microllm_bench -m model.gguf -p 128,512 -n 64 -b 512 -t $THREADS -r 2 && \
+    ./microllm_cli -m model.gguf -t $THREADS -n 256 -p 'Explain how a transformer generates text.'"
+
+PROFRAW_DIR=$(mktemp -d)
+for f in $(adb shell "ls $DEVICE_DIR/*.profraw" | tr -d '\r'); do
+    adb pull "$f" "$PROFRAW_DIR/"
+done
+"$LLVM_BIN/llvm-profdata" merge -o "$OUT" "$PROFRAW_DIR"/*.profraw
+rm -rf "$PROFRAW_DIR"
+
+echo "PGO profile written to $OUT"
@@ -0,0 +1,77 @@
+// Shared JNI string helpers for the llama and whisper bridges.
+
+#pragma once
+
+#include <jni.h>
+
+// Convert raw bytes into a Java String safely.
+//
+// Why:
+// - llama_token_to_piece may return byte sequences that are not valid "Modified UTF-8".
+// - JNI NewStringUTF() requires Modified UTF-8 and will hard-abort the process if invalid.
+// - Constructing String(byte[], UTF_8) tolerates invalid sequences and replaces them (U+FFFD),
+//   preventing fatal JNI aborts on multilingual output.
+static inline jstring new_string_from_utf8_bytes(JNIEnv* env, const char* bytes, int len) {
+    if (bytes == nullptr || len <= 0) {
+        return env->NewStringUTF("");
+    }
+
+    jbyteArray arr = env->NewByteArray(len);
+    if (arr == nullptr) {
+        // OOM: best-effort fallback
+        return env->NewStringUTF("");
+    }
+    env->SetByteArrayRegion(arr, 0, len, reinterpret_cast<const jbyte*>(bytes));
+
+    // Get StandardCharsets.UTF_8
+    jclass scClass = env->FindClass("java/nio/charset/StandardCharsets");
+    if (scClass == nullptr) {
+        env->DeleteLocalRef(arr);
+        return env->NewStringUTF("");
+    }
+    jfieldID utf8Field = env->GetStaticFieldID(scClass, "UTF_8", "Ljava/nio/charset/Charset;");
+    if (utf8Field == nullptr) {
+        env->DeleteLocalRef(scClass);
+        env->DeleteLocalRef(arr);
+        return env->NewStringUTF("");
+    }
+    jobject utf8Charset = env->GetStaticObjectField(scClass, utf8Field);
+    if (utf8Charset == nullptr) {
+        env->DeleteLocalRef(scClass);
+        env->DeleteLocalRef(arr);
+        return env->NewStringUTF("");
+    }
+
+    // new String(byte[], Charset)
+    jclass strClass = env->FindClass("java/lang/String");
+    if (strClass == nullptr) {
+        env->DeleteLocalRef(utf8Charset);
+        env->DeleteLocalRef(scClass);
+        env->DeleteLocalRef(arr);
+        return env->NewStringUTF("");
+    }
+    jmethodID ctor = env->GetMethodID(strClass, "<init>", "([BLjava/nio/charset/Charset;)V");
+    if (ctor == nullptr) {
+        env->DeleteLocalRef(strClass);
+        env->DeleteLocalRef(utf8Charset);
+        env->DeleteLocalRef(scClass);
+        env->DeleteLocalRef(arr);
+        return env->NewStringUTF("");
+    }
+
+    jobject strObj = env->NewObject(strClass, ctor, arr, utf8Charset);
+    jstring out = (jstring) strObj;
+
+    // Clean up locals (String object returned remains valid as `out`)
+    env->DeleteLocalRef(strClass);
+    env->DeleteLocalRef(utf8Charset);
+    env->DeleteLocalRef(scClass);
+    env->DeleteLocalRef(arr);
+
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+        return env->NewStringUTF("");
+    }
+
+    return out != nullptr ? out : env->NewStringUTF("");
+}
@@ -1,251 +1,438 @@
 // JNI wrapper for llama.cpp
-// This handles all struct construction natively to avoid FFI alignment issues
+// This handles all struct construction natively to avoid FFI alignment issues.
+// Inference logic lives in core/llm_engine.cpp; this file only converts JNI types.
 
 #include <jni.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
-#include <cstring>
-#include <android/log.h>
-#include "llama.h"
+#include "core/cpu_features.h"
+#include "core/cpu_topology.h"
+#include "core/gguf_inspect.h"
+#include "core/llm_bench.h"
+#include "core/llm_engine.h"
+#include "core/model_convert.h"
+#include "core/thread_tuner.h"
+#include "jni_utf8.h"
 
 #define LOG_TAG "LlamaJNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-
-// Convert raw bytes into a Java String safely.
-//
-// Why:
-// - llama_token_to_piece may return byte sequences that are not valid "Modified UTF-8".
-// - JNI NewStringUTF() requires Modified UTF-8 and will hard-abort the process if invalid.
-// - Constructing String(byte[], UTF_8) tolerates invalid sequences and replaces them (U+FFFD),
-//   preventing fatal JNI aborts on multilingual output.
-static jstring new_string_from_utf8_bytes(JNIEnv* env, const char* bytes, int len) {
-    if (bytes == nullptr || len <= 0) {
-        return env->NewStringUTF("");
-    }
-
-    jbyteArray arr = env->NewByteArray(len);
-    if (arr == nullptr) {
-        // OOM: best-effort fallback
-        return env->NewStringUTF("");
-    }
-    env->SetByteArrayRegion(arr, 0, len, reinterpret_cast<const jbyte*>(bytes));
-
-    // Get StandardCharsets.UTF_8
-    jclass scClass = env->FindClass("java/nio/charset/StandardCharsets");
-    if (scClass == nullptr) {
-        env->DeleteLocalRef(arr);
-        return env->NewStringUTF("");
-    }
-    jfieldID utf8Field = env->GetStaticFieldID(scClass, "UTF_8", "Ljava/nio/charset/Charset;");
-    if (utf8Field == nullptr) {
-        env->DeleteLocalRef(scClass);
-        env->DeleteLocalRef(arr);
-        return env->NewStringUTF("");
-    }
-    jobject utf8Charset = env->GetStaticObjectField(scClass, utf8Field);
-    if (utf8Charset == nullptr) {
-        env->DeleteLocalRef(scClass);
-        env->DeleteLocalRef(arr);
-        return env->NewStringUTF("");
-    }
+#include "core/log.h"
+
+// Global state: the model serving requests, used from LlamaHandler's executor thread.
+static std::unique_ptr<microllm::llm_engine> g_engine = std::make_unique<microllm::llm_engine>();
+// Guards the g_engine pointer for the calls made from other threads (memory pressure,
+// residency, preload budget) against swapPreloadedModel(); the executor does not need it.
+static std::mutex g_engine_mutex;
+// The next model, loaded on a background thread by preloadModel() while g_engine serves.
+// g_staged_mutex is held only to install, take or drop it, never across a load. Every
+// preloadModel() and discard bumps g_staged_generation, so a load that finishes after a
+// discard (or a newer preload) sees the bump and frees its result instead.
+static std::unique_ptr<microllm::llm_engine> g_staged;
+static uint64_t g_staged_generation = 0;
+static std::mutex g_staged_mutex;
+
+static std::vector<int32_t> int_array_to_vector(JNIEnv* env, jintArray arr) {
+    std::vector<int32_t> out;
+    if (arr == nullptr) return out;
+    const jsize n = env->GetArrayLength(arr);
+    out.resize((size_t) n);
+    env->GetIntArrayRegion(arr, 0, n, reinterpret_cast<jint *>(out.data()));
+    return out;
+}
 
-    // new String(byte[], Charset)
-    jclass strClass = env->FindClass("java/lang/String");
-    if (strClass == nullptr) {
-        env->DeleteLocalRef(utf8Charset);
-        env->DeleteLocalRef(scClass);
-        env->DeleteLocalRef(arr);
-        return env->NewStringUTF("");
-    }
-    jmethodID ctor = env->GetMethodID(strClass, "<init>", "([BLjava/nio/charset/Charset;)V");
-    if (ctor == nullptr) {
-        env->DeleteLocalRef(strClass);
-        env->DeleteLocalRef(utf8Charset);
-        env->DeleteLocalRef(scClass);
-        env->DeleteLocalRef(arr);
-        return env->NewStringUTF("");
-    }
+// Values per row returned by runBenchmark(); keep in sync with LlamaNative.kt.
+static constexpr int BENCH_ROW_STRIDE = 9;
 
-    jobject strObj = env->NewObject(strClass, ctor, arr, utf8Charset);
-    jstring out = (jstring) strObj;
+// Values returned by endRequestMetrics(); keep in sync with LlamaNative.kt.
+static constexpr int REQUEST_METRICS_SIZE = 12;
 
-    // Clean up locals (String object returned remains valid as `out`)
-    env->DeleteLocalRef(strClass);
-    env->DeleteLocalRef(utf8Charset);
-    env->DeleteLocalRef(scClass);
-    env->DeleteLocalRef(arr);
+// Forwards load progress to `callbackObj.onProgress(float)` (no-op if null).
+static std::function<void(float)> make_progress_callback(JNIEnv* env, jobject callbackObj) {
+    if (callbackObj == nullptr) return nullptr;
 
-    if (env->ExceptionCheck()) {
+    jclass cbCls = env->GetObjectClass(callbackObj);
+    jmethodID mid = env->GetMethodID(cbCls, "onProgress", "(F)V");
+    env->DeleteLocalRef(cbCls);
+    if (mid == nullptr) {
         env->ExceptionClear();
-        return env->NewStringUTF("");
-    }
-
-    return out != nullptr ? out : env->NewStringUTF("");
-}
-
-// Global state (single model instance)
-static llama_model* g_model = nullptr;
-static llama_context* g_ctx = nullptr;
-static llama_sampler* g_sampler = nullptr;
-static int32_t g_n_past = 0; // current position in KV cache (token index)
-
-static int decode_tokens_internal(const llama_token * tokens, int32_t n_tokens) {
-    if (g_ctx == nullptr) {
-        return -1;
+        LOGE("Callback object has no onProgress(float) method");
+        return nullptr;
     }
 
-    const int32_t n_batch = (int32_t) llama_n_batch(g_ctx);
-    const int32_t seq_id = 0;
-
-    int32_t offset = 0;
-    while (offset < n_tokens) {
-        const int32_t n_eval = std::min(n_batch, n_tokens - offset);
-
-        llama_batch batch = llama_batch_init(n_eval, 0, 1);
-        batch.n_tokens = n_eval;
-
-        for (int32_t i = 0; i < n_eval; i++) {
-            batch.token[i] = tokens[offset + i];
-            batch.pos[i] = (llama_pos) (g_n_past + i);
-            batch.n_seq_id[i] = 1;
-            batch.seq_id[i][0] = seq_id;
-            batch.logits[i] = 0;
-        }
-
-        // Only request logits for the last token of the *final* chunk.
-        if (offset + n_eval == n_tokens) {
-            batch.logits[n_eval - 1] = 1;
+    return [env, callbackObj, mid](float progress) {
+        if (env->ExceptionCheck()) return;
+        env->CallVoidMethod(callbackObj, mid, (jfloat) progress);
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
         }
-
-        const int res = llama_decode(g_ctx, batch);
-        llama_batch_free(batch);
-
-        if (res != 0) {
-            return res;
-        }
-
-        g_n_past += n_eval;
-        offset += n_eval;
-    }
-
-    return 0;
+    };
 }
 
 extern "C" {
 
 JNIEXPORT void JNICALL
 Java_com_microllm_app_LlamaNative_init(JNIEnv* env, jclass clazz) {
-    LOGI("Initializing llama backend");
-    llama_backend_init();
+    microllm::llm_engine::backend_init();
+}
+
+// Shared by loadModel() and preloadModel(). Returns false for an unsupported KV cache type.
+// With `useConverted`, the CPU-optimized copy written by convertModel() is loaded instead
+// of `modelPath` when there is an up-to-date one.
+static bool read_load_params(
+    JNIEnv* env,
+    jstring modelPath,
+    jint contextSize,
+    jint threads,
+    jint batchSize,
+    jint ubatchSize,
+    jboolean flashAttn,
+    jstring cacheTypeK,
+    jstring cacheTypeV,
+    jboolean prefetch,
+    jboolean lockHotWeights,
+    jboolean useConverted,
+    microllm::llm_load_params & params
+) {
+    const char* path = env->GetStringUTFChars(modelPath, nullptr);
+    params.model_path = useConverted == JNI_TRUE ? microllm::resolve_converted_model(path) : path;
+    if (params.model_path != path) {
+        LOGI("Using converted model %s", params.model_path.c_str());
+    }
+    params.n_ctx = contextSize;
+    params.n_threads = threads;
+    params.n_batch = batchSize;
+    params.n_ubatch = ubatchSize;
+    params.flash_attn = flashAttn == JNI_TRUE;
+    params.prefetch = prefetch == JNI_TRUE;
+    params.lock_hot_weights = lockHotWeights == JNI_TRUE;
+    env->ReleaseStringUTFChars(modelPath, path);
+
+    const char* type_k = env->GetStringUTFChars(cacheTypeK, nullptr);
+    const char* type_v = env->GetStringUTFChars(cacheTypeV, nullptr);
+    params.type_k = microllm::kv_cache_type_from_name(type_k);
+    params.type_v = microllm::kv_cache_type_from_name(type_v);
+    if (params.type_k == GGML_TYPE_COUNT || params.type_v == GGML_TYPE_COUNT) {
+        LOGE("Unsupported KV cache type: K %s, V %s", type_k, type_v);
+    }
+    env->ReleaseStringUTFChars(cacheTypeK, type_k);
+    env->ReleaseStringUTFChars(cacheTypeV, type_v);
+    return params.type_k != GGML_TYPE_COUNT && params.type_v != GGML_TYPE_COUNT;
 }
 
+// preloadModel() results; keep in sync with LlamaNative.kt.
+static constexpr jint PRELOAD_OK = 0;
+static constexpr jint PRELOAD_NO_MEMORY = 1;
+static constexpr jint PRELOAD_FAILED = 2;
+static constexpr jint PRELOAD_DISCARDED = 3;
+
 JNIEXPORT jboolean JNICALL
 Java_com_microllm_app_LlamaNative_loadModel(
     JNIEnv* env, 
     jclass clazz,
     jstring modelPath,
     jint contextSize,
-    jint threads
+    jint threads,
+    jint batchSize,
+    jint ubatchSize,
+    jboolean flashAttn,
+    jstring cacheTypeK,
+    jstring cacheTypeV,
+    jboolean prefetch,
+    jboolean lockHotWeights,
+    jboolean useConverted,
+    jobject progressCallback
 ) {
-    if (g_model != nullptr) {
-        LOGI("Unloading existing model first");
-        if (g_sampler) {
-            llama_sampler_free(g_sampler);
-            g_sampler = nullptr;
-        }
-        if (g_ctx) {
-            llama_free(g_ctx);
-            g_ctx = nullptr;
-        }
-        llama_model_free(g_model);
-        g_model = nullptr;
-        g_n_past = 0;
+    microllm::llm_load_params params;
+    if (!read_load_params(env, modelPath, contextSize, threads, batchSize, ubatchSize, flashAttn,
+                          cacheTypeK, cacheTypeV, prefetch, lockHotWeights, useConverted, params)) {
+        return JNI_FALSE;
     }
+    // LlamaHandler calls warmup() once the decode threads are pinned, so the warm-up also
+    // starts the threadpool the first prompt will use.
+    params.warmup = false;
+    // Runs on this (the loading) thread, so `env` stays valid.
+    params.on_progress = make_progress_callback(env, progressCallback);
 
-    const char* path = env->GetStringUTFChars(modelPath, nullptr);
-    LOGI("Loading model from: %s", path);
-    LOGI("Context size: %d, threads: %d", contextSize, threads);
+    return g_engine->load(params) ? JNI_TRUE : JNI_FALSE;
+}
 
-    // Get default model params and customize
-    llama_model_params model_params = llama_model_default_params();
-    model_params.n_gpu_layers = 0;  // CPU only for mobile
-    model_params.use_mmap = true;
-    model_params.use_mlock = false;
+// Loads the next model into a staging engine while the current one keeps serving on the
+// executor; blocks the calling (background) thread. Replaces an earlier staged model.
+// Returns PRELOAD_NO_MEMORY without loading if both models would not fit
+// (microllm::preload_budget), PRELOAD_FAILED if the load itself fails, and
+// PRELOAD_DISCARDED if discardPreloadedModel() or another preload came in meanwhile.
+JNIEXPORT jint JNICALL
+Java_com_microllm_app_LlamaNative_preloadModel(
+    JNIEnv* env,
+    jclass clazz,
+    jstring modelPath,
+    jint contextSize,
+    jint threads,
+    jint batchSize,
+    jint ubatchSize,
+    jboolean flashAttn,
+    jstring cacheTypeK,
+    jstring cacheTypeV,
+    jboolean prefetch,
+    jboolean lockHotWeights,
+    jboolean useConverted,
+    jobject progressCallback
+) {
+    microllm::llm_load_params params;
+    if (!read_load_params(env, modelPath, contextSize, threads, batchSize, ubatchSize, flashAttn,
+                          cacheTypeK, cacheTypeV, prefetch, lockHotWeights, useConverted, params)) {
+        return PRELOAD_FAILED;
+    }
+    // Nothing waits on this thread, so the warm-up is paid here rather than after the swap.
+    params.warmup = true;
+    params.on_progress = make_progress_callback(env, progressCallback);
+
+    // Free the model this one replaces before budgeting for the new one.
+    std::unique_ptr<microllm::llm_engine> previous;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> staged_lock(g_staged_mutex);
+        generation = ++g_staged_generation;
+        previous = std::move(g_staged);
+    }
+    previous.reset();
+    {
+        std::lock_guard<std::mutex> lock(g_engine_mutex);
+        if (!microllm::preload_budget(*g_engine, params.model_path).fits()) {
+            return PRELOAD_NO_MEMORY;
+        }
+    }
 
-    // Load model
-    g_model = llama_model_load_from_file(path, model_params);
-    env->ReleaseStringUTFChars(modelPath, path);
+    // Load, prefetch and warm-up run without the lock so a discard or swap never waits.
+    auto staged = std::make_unique<microllm::llm_engine>();
+    if (!staged->load(params)) {
+        return PRELOAD_FAILED;
+    }
+    {
+        std::lock_guard<std::mutex> staged_lock(g_staged_mutex);
+        if (generation == g_staged_generation) {
+            g_staged = std::move(staged);
+            return PRELOAD_OK;
+        }
+    }
+    LOGI("Preloaded model discarded while loading");
+    return PRELOAD_DISCARDED; // `staged` is freed outside the lock
+}
 
-    if (g_model == nullptr) {
-        LOGE("Failed to load model");
-        return JNI_FALSE;
+// Makes the preloaded model the serving one and frees the previous model. Call on the
+// executor between requests. Returns false if nothing is staged.
+JNIEXPORT jboolean JNICALL
+Java_com_microllm_app_LlamaNative_swapPreloadedModel(JNIEnv* env, jclass clazz) {
+    std::unique_ptr<microllm::llm_engine> previous;
+    {
+        std::lock_guard<std::mutex> staged_lock(g_staged_mutex);
+        if (!g_staged) return JNI_FALSE;
+        std::lock_guard<std::mutex> lock(g_engine_mutex);
+        previous = std::move(g_engine);
+        g_engine = std::move(g_staged);
     }
+    LOGI("Swapped in preloaded model");
+    previous.reset(); // outside the locks: unmapping a large model takes a while
+    return JNI_TRUE;
+}
 
-    LOGI("Model loaded, creating context...");
+// Frees a preloaded model that will not be swapped in. Does not wait for a preload in
+// progress: that load drops its result when it finishes.
+JNIEXPORT void JNICALL
+Java_com_microllm_app_LlamaNative_discardPreloadedModel(JNIEnv* env, jclass clazz) {
+    std::unique_ptr<microllm::llm_engine> staged;
+    {
+        std::lock_guard<std::mutex> staged_lock(g_staged_mutex);
+        ++g_staged_generation;
+        staged = std::move(g_staged);
+    } // freed here, outside the lock
+}
 
-    // Get default context params and customize
-    llama_context_params ctx_params = llama_context_default_params();
-    ctx_params.n_ctx = contextSize;
-    ctx_params.n_batch = 512;
-    ctx_params.n_ubatch = 512;
-    ctx_params.n_threads = threads;
-    ctx_params.n_threads_batch = threads;
-    ctx_params.flash_attn_type = LLAMA_FLASH_ATTN_TYPE_DISABLED;
+// Memory estimate for the loaded model and context, or null if none is loaded:
+//   [0] weights bytes
+//   [1] KV cache bytes (n_ctx cells at the configured K/V types)
+//   [2] compute buffer bytes (upper bound for a full prefill batch)
+JNIEXPORT jlongArray JNICALL
+Java_com_microllm_app_LlamaNative_getMemoryEstimate(JNIEnv* env, jclass clazz) {
+    if (!g_engine->is_loaded()) return nullptr;
+
+    const microllm::llm_memory_estimate est = g_engine->memory_estimate();
+    const jlong values[3] = {
+        (jlong) est.weights_bytes,
+        (jlong) est.kv_bytes,
+        (jlong) est.compute_bytes,
+    };
+
+    jlongArray out = env->NewLongArray(3);
+    if (out == nullptr) return nullptr;
+    env->SetLongArrayRegion(out, 0, 3, values);
+    return out;
+}
 
-    // Create context
-    g_ctx = llama_init_from_model(g_model, ctx_params);
+// Warm-up pass over the loaded context, or null if none is loaded:
+//   [0] prefill tokens
+//   [1] prefill ms
+//   [2] decode ms
+JNIEXPORT jdoubleArray JNICALL
+Java_com_microllm_app_LlamaNative_warmup(JNIEnv* env, jclass clazz) {
+    if (!g_engine->is_loaded()) return nullptr;
+
+    const microllm::llm_warmup_stats stats = g_engine->warmup();
+    const jdouble values[3] = {
+        (jdouble) stats.n_prefill,
+        stats.prefill_ms,
+        stats.decode_ms,
+    };
+
+    jdoubleArray out = env->NewDoubleArray(3);
+    if (out == nullptr) return nullptr;
+    env->SetDoubleArrayRegion(out, 0, 3, values);
+    return out;
+}
 
-    if (g_ctx == nullptr) {
-        LOGE("Failed to create context");
-        llama_model_free(g_model);
-        g_model = nullptr;
-        return JNI_FALSE;
-    }
+// 0 = none, 1 = moderate, 2 = critical (see LlamaNative.kt). Callable from any thread.
+JNIEXPORT void JNICALL
+Java_com_microllm_app_LlamaNative_setMemoryPressure(JNIEnv* env, jclass clazz, jint level) {
+    const microllm::memory_pressure pressure =
+        level >= 2 ? microllm::memory_pressure::critical
+        : level == 1 ? microllm::memory_pressure::moderate
+                     : microllm::memory_pressure::none;
+    std::lock_guard<std::mutex> lock(g_engine_mutex);
+    g_engine->set_memory_pressure(pressure);
+}
 
-    // Reset KV position for new model
-    g_n_past = 0;
+// Residency of the loaded weights, or null if none are loaded:
+//   [0] mapped bytes (model file)
+//   [1] resident bytes (in RAM now)
+//   [2] locked bytes
+JNIEXPORT jlongArray JNICALL
+Java_com_microllm_app_LlamaNative_getWeightResidency(JNIEnv* env, jclass clazz) {
+    microllm::residency_stats stats;
+    {
+        std::lock_guard<std::mutex> lock(g_engine_mutex);
+        stats = g_engine->residency();
+    }
+    if (stats.mapped_bytes == 0) return nullptr;
+
+    const jlong values[3] = {
+        (jlong) stats.mapped_bytes,
+        (jlong) stats.resident_bytes,
+        (jlong) stats.locked_bytes,
+    };
+
+    jlongArray out = env->NewLongArray(3);
+    if (out == nullptr) return nullptr;
+    env->SetLongArrayRegion(out, 0, 3, values);
+    return out;
+}
 
-    LOGI("Context created, setting up sampler...");
+// Values in inspectModel()'s number array; keep in sync with LlamaNative.kt.
+static constexpr int INSPECT_NUMBERS_SIZE = 9;
+
+// GGUF header facts without loading the model (see core/gguf_inspect.h), or null if the
+// file cannot be read. Callable from any thread.
+//   [0] String architecture
+//   [1] String model name ("" if absent)
+//   [2] long[]: params, weights bytes, trained context, vocab, layers, embedding length,
+//       heads, KV heads, f16 KV bytes per token
+//   [3] String[] ggml type names, largest share first
+//   [4] long[] bytes stored in each of those types
+JNIEXPORT jobjectArray JNICALL
+Java_com_microllm_app_LlamaNative_inspectModel(JNIEnv* env, jclass clazz, jstring modelPath) {
+    const char* path = env->GetStringUTFChars(modelPath, nullptr);
+    microllm::gguf_model_info info;
+    const bool ok = microllm::inspect_gguf(path, info);
+    env->ReleaseStringUTFChars(modelPath, path);
+    if (!ok) return nullptr;
+
+    const jlong numbers[INSPECT_NUMBERS_SIZE] = {
+        (jlong) info.n_params,
+        (jlong) info.weights_bytes,
+        (jlong) info.n_ctx_train,
+        (jlong) info.n_vocab,
+        (jlong) info.n_layer,
+        (jlong) info.n_embd,
+        (jlong) info.n_head,
+        (jlong) info.n_head_kv,
+        (jlong) info.kv_bytes_per_token,
+    };
+    jlongArray numberArray = env->NewLongArray(INSPECT_NUMBERS_SIZE);
+    if (numberArray == nullptr) return nullptr;
+    env->SetLongArrayRegion(numberArray, 0, INSPECT_NUMBERS_SIZE, numbers);
+
+    const jsize n_types = (jsize) info.types.size();
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray typeNames = env->NewObjectArray(n_types, stringClass, nullptr);
+    jlongArray typeBytes = env->NewLongArray(n_types);
+    if (typeNames == nullptr || typeBytes == nullptr) return nullptr;
+    for (jsize i = 0; i < n_types; i++) {
+        jstring name = env->NewStringUTF(ggml_type_name(info.types[i].type));
+        env->SetObjectArrayElement(typeNames, i, name);
+        env->DeleteLocalRef(name);
+        const jlong bytes = (jlong) info.types[i].bytes;
+        env->SetLongArrayRegion(typeBytes, i, 1, &bytes);
+    }
 
-    // Create sampler chain
-    llama_sampler_chain_params chain_params = llama_sampler_chain_default_params();
-    g_sampler = llama_sampler_chain_init(chain_params);
+    jclass objectClass = env->FindClass("java/lang/Object");
+    jobjectArray out = env->NewObjectArray(5, objectClass, nullptr);
+    if (out == nullptr) return nullptr;
+    env->SetObjectArrayElement(out, 0, new_string_from_utf8_bytes(
+        env, info.architecture.data(), (int) info.architecture.size()));
+    env->SetObjectArrayElement(out, 1, new_string_from_utf8_bytes(
+        env, info.name.data(), (int) info.name.size()));
+    env->SetObjectArrayElement(out, 2, numberArray);
+    env->SetObjectArrayElement(out, 3, typeNames);
+    env->SetObjectArrayElement(out, 4, typeBytes);
+    return out;
+}
 
-    // Add samplers: top-k -> top-p -> temp -> dist
-    llama_sampler_chain_add(g_sampler, llama_sampler_init_top_k(40));
-    llama_sampler_chain_add(g_sampler, llama_sampler_init_top_p(0.9f, 1));
-    llama_sampler_chain_add(g_sampler, llama_sampler_init_temp(0.7f));
-    llama_sampler_chain_add(g_sampler, llama_sampler_init_dist(42));
+// Rewrites the model into the weight type this CPU's repacked kernels use and caches it
+// beside the original (core/model_convert.h); later loads of `modelPath` pick it up.
+// Blocks for minutes on large models; call from a background thread.
+//   [0] String status: "converted", "cached", "notNeeded" or "failed"
+//   [1] String path that loads of modelPath will use
+JNIEXPORT jobjectArray JNICALL
+Java_com_microllm_app_LlamaNative_convertModel(JNIEnv* env, jclass clazz, jstring modelPath, jint threads) {
+    const char* path = env->GetStringUTFChars(modelPath, nullptr);
+    const std::string model_path = path;
+    env->ReleaseStringUTFChars(modelPath, path);
 
-    LOGI("Model loading complete!");
-    return JNI_TRUE;
+    std::string out_path;
+    const microllm::convert_status status = microllm::convert_model_for_cpu(
+        model_path, microllm::detect_cpu_features(), threads, out_path);
+
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray out = env->NewObjectArray(2, stringClass, nullptr);
+    if (out == nullptr) return nullptr;
+    env->SetObjectArrayElement(out, 0, env->NewStringUTF(microllm::convert_status_name(status)));
+    env->SetObjectArrayElement(out, 1, new_string_from_utf8_bytes(
+        env, out_path.data(), (int) out_path.size()));
+    return out;
 }
 
 JNIEXPORT void JNICALL
 Java_com_microllm_app_LlamaNative_unloadModel(JNIEnv* env, jclass clazz) {
     LOGI("Unloading model");
-    
-    if (g_sampler) {
-        llama_sampler_free(g_sampler);
-        g_sampler = nullptr;
-    }
-    if (g_ctx) {
-        llama_free(g_ctx);
-        g_ctx = nullptr;
-    }
-    if (g_model) {
-        llama_model_free(g_model);
-        g_model = nullptr;
-    }
-    g_n_past = 0;
-    
+    g_engine->unload();
     LOGI("Model unloaded");
 }
 
 JNIEXPORT jboolean JNICALL
 Java_com_microllm_app_LlamaNative_isLoaded(JNIEnv* env, jclass clazz) {
-    return (g_model != nullptr && g_ctx != nullptr) ? JNI_TRUE : JNI_FALSE;
+    return g_engine->is_loaded() ? JNI_TRUE : JNI_FALSE;
+}
+
+// The file the serving model was loaded from (a converted copy when useConverted picked
+// one), or null if no model is loaded.
+JNIEXPORT jstring JNICALL
+Java_com_microllm_app_LlamaNative_getModelPath(JNIEnv* env, jclass clazz) {
+    const std::string & path = g_engine->model_path();
+    if (path.empty()) return nullptr;
+    return new_string_from_utf8_bytes(env, path.data(), (int) path.size());
 }
 
 JNIEXPORT jintArray JNICALL
@@ -255,31 +442,20 @@ Java_com_microllm_app_LlamaNative_tokenize(
     jstring text,
     jboolean addBos
 ) {
-    if (g_model == nullptr) {
-        LOGE("Model not loaded");
-        return nullptr;
-    }
-
     const char* textChars = env->GetStringUTFChars(text, nullptr);
-    const llama_vocab* vocab = llama_model_get_vocab(g_model);
-    
-    // Estimate max tokens needed
-    int maxTokens = strlen(textChars) + 16;
-    std::vector<llama_token> tokens(maxTokens);
 
-    int nTokens = llama_tokenize(vocab, textChars, strlen(textChars), 
-                                  tokens.data(), maxTokens, addBos, true);
-    
+    std::vector<llama_token> tokens;
+    const bool ok = g_engine->tokenize(textChars, strlen(textChars), addBos == JNI_TRUE, tokens);
+
     env->ReleaseStringUTFChars(text, textChars);
 
-    if (nTokens < 0) {
-        LOGE("Tokenization failed");
+    if (!ok) {
         return nullptr;
     }
 
     // Create Java array
-    jintArray result = env->NewIntArray(nTokens);
-    env->SetIntArrayRegion(result, 0, nTokens, tokens.data());
+    jintArray result = env->NewIntArray((jsize) tokens.size());
+    env->SetIntArrayRegion(result, 0, (jsize) tokens.size(), tokens.data());
     
     return result;
 }
@@ -290,7 +466,7 @@ Java_com_microllm_app_LlamaNative_decode(
     jclass clazz,
     jintArray tokens
 ) {
-    if (g_ctx == nullptr) {
+    if (!g_engine->is_loaded()) {
         LOGE("Context not loaded");
         return -1;
     }
@@ -298,26 +474,18 @@ Java_com_microllm_app_LlamaNative_decode(
     jsize nTokens = env->GetArrayLength(tokens);
     jint* tokenData = env->GetIntArrayElements(tokens, nullptr);
 
-    // Decode with proper batch fields so logits are produced.
     // NOTE: llama_token is int32_t, jint is int32_t on Android.
-    const int result = decode_tokens_internal(reinterpret_cast<llama_token *>(tokenData), (int32_t) nTokens);
+    const int result = g_engine->decode(reinterpret_cast<llama_token *>(tokenData), (int32_t) nTokens);
 
-    env->ReleaseIntArrayElements(tokens, tokenData, 0);
+    // Tokens are read-only here; skip the copy-back.
+    env->ReleaseIntArrayElements(tokens, tokenData, JNI_ABORT);
     
     return result;
 }
 
 JNIEXPORT jint JNICALL
 Java_com_microllm_app_LlamaNative_sample(JNIEnv* env, jclass clazz) {
-    if (g_ctx == nullptr || g_sampler == nullptr) {
-        LOGE("Context or sampler not loaded");
-        return -1;
-    }
-
-    llama_token token = llama_sampler_sample(g_sampler, g_ctx, -1);
-    llama_sampler_accept(g_sampler, token);
-
-    return token;
+    return g_engine->sample();
 }
 
 JNIEXPORT jstring JNICALL
@@ -326,80 +494,246 @@ Java_com_microllm_app_LlamaNative_tokenToString(
     jclass clazz,
     jint token
 ) {
-    if (g_model == nullptr) {
-        return env->NewStringUTF("");
-    }
+    const std::string piece = g_engine->token_to_piece(token);
 
-    // Token pieces can be longer than 256 bytes for some vocabularies.
-    // Use a bigger buffer to reduce truncation risk.
-    std::vector<char> buf(4096);
-    const llama_vocab* vocab = llama_model_get_vocab(g_model);
-    int len = llama_token_to_piece(vocab, token, buf.data(), (int)buf.size(), 0, true);
-    
-    if (len < 0) {
-        return env->NewStringUTF("");
-    }
-
-    // `len` is the number of bytes written (may include non-UTF8 bytes).
+    // The piece may contain non-UTF8 bytes (split multi-byte characters).
     // Do NOT use NewStringUTF here (it requires Modified UTF-8).
-    return new_string_from_utf8_bytes(env, buf.data(), len);
+    return new_string_from_utf8_bytes(env, piece.data(), (int) piece.size());
 }
 
 JNIEXPORT jint JNICALL
 Java_com_microllm_app_LlamaNative_getEosToken(JNIEnv* env, jclass clazz) {
-    if (g_model == nullptr) {
-        return 2; // Default EOS
-    }
-    const llama_vocab* vocab = llama_model_get_vocab(g_model);
-    return llama_vocab_eos(vocab);
+    return g_engine->eos();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_microllm_app_LlamaNative_isEog(JNIEnv* env, jclass clazz, jint token) {
+    return g_engine->is_eog(token) ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT jint JNICALL
 Java_com_microllm_app_LlamaNative_getContextSize(JNIEnv* env, jclass clazz) {
-    if (g_ctx == nullptr) {
-        return 0;
-    }
-    return llama_n_ctx(g_ctx);
+    return g_engine->n_ctx();
 }
 
-JNIEXPORT void JNICALL
+// `grammar` is GBNF text with a "root" rule, or null for unconstrained sampling.
+// Returns false if the grammar does not parse (the sampler is then unconstrained).
+JNIEXPORT jboolean JNICALL
 Java_com_microllm_app_LlamaNative_resetSampler(
     JNIEnv* env,
     jclass clazz,
     jfloat temperature,
     jfloat topP,
-    jint topK
+    jint topK,
+    jstring grammar
 ) {
-    if (g_sampler) {
-        llama_sampler_free(g_sampler);
+    std::string gbnf;
+    if (grammar != nullptr) {
+        const char* chars = env->GetStringUTFChars(grammar, nullptr);
+        gbnf = chars;
+        env->ReleaseStringUTFChars(grammar, chars);
     }
+    return g_engine->reset_sampler(temperature, topP, topK, gbnf) ? JNI_TRUE : JNI_FALSE;
+}
 
-    llama_sampler_chain_params chain_params = llama_sampler_chain_default_params();
-    g_sampler = llama_sampler_chain_init(chain_params);
+JNIEXPORT void JNICALL
+Java_com_microllm_app_LlamaNative_clearContext(JNIEnv* env, jclass clazz) {
+    g_engine->clear_context();
+}
 
-    if (topK > 0) {
-        llama_sampler_chain_add(g_sampler, llama_sampler_init_top_k(topK));
+// Loads a LoRA adapter against the loaded model ahead of its first request; a no-op if
+// it is already loaded. Adapters stay until the model is unloaded or swapped out.
+JNIEXPORT jboolean JNICALL
+Java_com_microllm_app_LlamaNative_loadAdapter(JNIEnv* env, jclass clazz, jstring adapterPath) {
+    const char* path = env->GetStringUTFChars(adapterPath, nullptr);
+    const bool ok = g_engine->load_adapter(path);
+    env->ReleaseStringUTFChars(adapterPath, path);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+// Selects the adapter for the next request (null or empty = base model), loading it on
+// first use. Returns 0 if it was already active, 1 if it was switched (KV cache cleared),
+// 2 on failure.
+JNIEXPORT jint JNICALL
+Java_com_microllm_app_LlamaNative_setAdapter(
+    JNIEnv* env,
+    jclass clazz,
+    jstring adapterPath,
+    jfloat scale
+) {
+    std::string path;
+    if (adapterPath != nullptr) {
+        const char* chars = env->GetStringUTFChars(adapterPath, nullptr);
+        path = chars;
+        env->ReleaseStringUTFChars(adapterPath, chars);
     }
-    if (topP < 1.0f) {
-        llama_sampler_chain_add(g_sampler, llama_sampler_init_top_p(topP, 1));
+    const int status = g_engine->set_adapter(path, scale);
+    return status < 0 ? 2 : status;
+}
+
+JNIEXPORT jintArray JNICALL
+Java_com_microllm_app_LlamaNative_getPerformanceCores(JNIEnv* env, jclass clazz) {
+    const std::vector<int32_t> cores = microllm::read_cpu_topology().performance_cores();
+    jintArray out = env->NewIntArray((jsize) cores.size());
+    if (out == nullptr) return nullptr;
+    env->SetIntArrayRegion(out, 0, (jsize) cores.size(), reinterpret_cast<const jint *>(cores.data()));
+    return out;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_microllm_app_LlamaNative_applyThreadConfig(
+    JNIEnv* env,
+    jclass clazz,
+    jint nThreads,
+    jint nThreadsBatch,
+    jboolean pinToPerformanceCores
+) {
+    microllm::llm_thread_config config;
+    config.n_threads = nThreads;
+    config.n_threads_batch = nThreadsBatch;
+    if (pinToPerformanceCores == JNI_TRUE) {
+        config.cpus = microllm::read_cpu_topology().performance_cores();
     }
-    if (temperature > 0) {
-        llama_sampler_chain_add(g_sampler, llama_sampler_init_temp(temperature));
-        llama_sampler_chain_add(g_sampler, llama_sampler_init_dist(42));
-    } else {
-        llama_sampler_chain_add(g_sampler, llama_sampler_init_greedy());
+    return g_engine->set_threads(config) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Changes thread counts between decodes without reloading the model, keeping the current
+// core pinning (e.g. fewer threads under thermal pressure).
+JNIEXPORT jboolean JNICALL
+Java_com_microllm_app_LlamaNative_setThreads(
+    JNIEnv* env,
+    jclass clazz,
+    jint prefillThreads,
+    jint decodeThreads
+) {
+    microllm::llm_thread_config config = g_engine->thread_config();
+    config.n_threads = decodeThreads;
+    config.n_threads_batch = prefillThreads;
+    return g_engine->set_threads(config) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Enables thermal/battery pacing of single-token decodes with the default policy, capped
+// at the current decode thread count. targetTokensPerSecond <= 0 derives the target from
+// the rate measured while the device is cool.
+JNIEXPORT jboolean JNICALL
+Java_com_microllm_app_LlamaNative_setThermalGovernor(
+    JNIEnv* env,
+    jclass clazz,
+    jboolean enabled,
+    jdouble targetTokensPerSecond
+) {
+    if (enabled != JNI_TRUE) {
+        g_engine->set_governor(nullptr);
+        return JNI_TRUE;
+    }
+    if (!g_engine->is_loaded()) return JNI_FALSE;
+
+    microllm::throttle_params params;
+    params.target_tps = targetTokensPerSecond;
+    params.max_threads = g_engine->thread_config().n_threads;
+    params.min_threads = std::min(2, params.max_threads);
+    g_engine->set_governor(std::make_unique<microllm::thermal_governor>(
+        "/sys", std::make_unique<microllm::default_throttle_policy>(params)));
+    return JNI_TRUE;
+}
+
+// Calibrates decode/prefill thread counts on the performance cores and applies them.
+// Returns [nThreads, nThreadsBatch] or null on failure (previous settings are kept).
+JNIEXPORT jintArray JNICALL
+Java_com_microllm_app_LlamaNative_autoTuneThreads(JNIEnv* env, jclass clazz) {
+    const microllm::llm_thread_config previous = g_engine->thread_config();
+    microllm::llm_thread_tuning tuning;
+    if (!microllm::tune_llm_threads(*g_engine, microllm::read_cpu_topology().performance_cores(), tuning)) {
+        g_engine->set_threads(previous);
+        return nullptr;
     }
+
+    const jint values[2] = { tuning.config.n_threads, tuning.config.n_threads_batch };
+    jintArray out = env->NewIntArray(2);
+    if (out == nullptr) return nullptr;
+    env->SetIntArrayRegion(out, 0, 2, values);
+    return out;
 }
 
 JNIEXPORT void JNICALL
-Java_com_microllm_app_LlamaNative_clearContext(JNIEnv* env, jclass clazz) {
-    if (g_ctx != nullptr) {
-        llama_memory_t mem = llama_get_memory(g_ctx);
-        if (mem != nullptr) {
-            llama_memory_clear(mem, true);
-        }
+Java_com_microllm_app_LlamaNative_beginRequestMetrics(JNIEnv* env, jclass clazz) {
+    g_engine->begin_request();
+}
+
+// Returns REQUEST_METRICS_SIZE doubles:
+//   [tokenizeMs, promptTokens, prefillMs, decodeTokens, decodeP50Ms, decodeP95Ms,
+//    decodeP99Ms, sampleMs, detokenizeMs, kvUsed, kvSize, peakRssBytes]
+JNIEXPORT jdoubleArray JNICALL
+Java_com_microllm_app_LlamaNative_endRequestMetrics(JNIEnv* env, jclass clazz) {
+    const microllm::llm_request_metrics m = g_engine->end_request();
+    const jdouble values[REQUEST_METRICS_SIZE] = {
+        m.tokenize_ms, (jdouble) m.n_prompt, m.prefill_ms, (jdouble) m.n_decode,
+        m.decode_p50_ms, m.decode_p95_ms, m.decode_p99_ms, m.sample_ms, m.detokenize_ms,
+        (jdouble) m.kv_used, (jdouble) m.kv_size, (jdouble) m.peak_rss_bytes,
+    };
+
+    jdoubleArray out = env->NewDoubleArray(REQUEST_METRICS_SIZE);
+    if (out == nullptr) return nullptr;
+    env->SetDoubleArrayRegion(out, 0, REQUEST_METRICS_SIZE, values);
+    return out;
+}
+
+// Throughput benchmark on a separately loaded copy of `modelPath`; the chat model and
+// its KV cache are left untouched. Weights are mmap'd, so when the same file is already
+// loaded the pages are shared and only the benchmark context costs extra memory.
+//
+// Returns one row of BENCH_ROW_STRIDE doubles per (batch, threads, prompt) combination:
+//   [nPrompt, nGen, nBatch, nThreads, ppTps, ppTpsStddev, tgTps, tgTpsStddev, ttftMs]
+// or null if the model cannot be loaded or decoding fails.
+JNIEXPORT jdoubleArray JNICALL
+Java_com_microllm_app_LlamaNative_runBenchmark(
+    JNIEnv* env,
+    jclass clazz,
+    jstring modelPath,
+    jintArray promptSizes,
+    jint genTokens,
+    jintArray batchSizes,
+    jintArray threadCounts,
+    jint repetitions
+) {
+    const char* path = env->GetStringUTFChars(modelPath, nullptr);
+    microllm::llm_bench_params params;
+    params.model_path = path;
+    env->ReleaseStringUTFChars(modelPath, path);
+
+    params.n_prompt = int_array_to_vector(env, promptSizes);
+    params.n_gen = genTokens;
+    params.n_batch = int_array_to_vector(env, batchSizes);
+    params.n_threads = int_array_to_vector(env, threadCounts);
+    params.repetitions = repetitions;
+
+    // The benchmark sweeps its own thread counts: lift the chat engine's core pinning from
+    // this thread for the run so larger counts are not squeezed onto the big cores.
+    std::vector<int32_t> all_cores;
+    for (const auto & core : microllm::read_cpu_topology().cores) all_cores.push_back(core.id);
+    const std::vector<int32_t> pinned = g_engine->thread_config().cpus;
+    if (!pinned.empty()) microllm::pin_current_thread(all_cores);
+
+    std::vector<microllm::llm_bench_result> results;
+    const bool ok = microllm::run_llm_bench(params, results);
+    if (!pinned.empty()) microllm::pin_current_thread(pinned);
+    if (!ok) {
+        return nullptr;
     }
-    g_n_past = 0;
+
+    std::vector<jdouble> flat;
+    flat.reserve(results.size() * BENCH_ROW_STRIDE);
+    for (const auto & r : results) {
+        flat.insert(flat.end(), {
+            (jdouble) r.n_prompt, (jdouble) r.n_gen, (jdouble) r.n_batch, (jdouble) r.n_threads,
+            r.pp_tps, r.pp_tps_stddev, r.tg_tps, r.tg_tps_stddev, r.ttft_ms,
+        });
+    }
+
+    jdoubleArray out = env->NewDoubleArray((jsize) flat.size());
+    if (out == nullptr) return nullptr;
+    env->SetDoubleArrayRegion(out, 0, (jsize) flat.size(), flat.data());
+    return out;
 }
 
 } // extern "C"
@@ -0,0 +1,120 @@
+// Host test for end-of-generation detection: loads the vocab-only GGUFs llama.cpp ships in
+// its models/ directory and checks that the end-of-turn tokens chat templates emit stop
+// generation (is_end_of_generation), not only the vocab's EOS token. Exits 77 (skipped)
+// when the vocab files are not available.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "llama.h"
+#include "core/llm_engine.h"
+
+#ifndef MICROLLM_LLAMA_VOCAB_DIR
+#define MICROLLM_LLAMA_VOCAB_DIR "models"
+#endif
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                        \
+        }                                                                        \
+    } while (0)
+
+namespace {
+
+constexpr int SKIPPED = 77;
+
+struct vocab_model {
+    llama_model * model = nullptr;
+
+    explicit vocab_model(const std::string & name) {
+        const std::string path = std::string(MICROLLM_LLAMA_VOCAB_DIR) + "/" + name;
+        if (FILE * f = fopen(path.c_str(), "rb")) {
+            fclose(f);
+            llama_model_params params = llama_model_default_params();
+            params.vocab_only = true;
+            model = llama_model_load_from_file(path.c_str(), params);
+        }
+    }
+
+    ~vocab_model() {
+        if (model != nullptr) {
+            llama_model_free(model);
+        }
+    }
+
+    vocab_model(const vocab_model &) = delete;
+    vocab_model & operator=(const vocab_model &) = delete;
+
+    // The single token `text` tokenizes to with special tokens parsed, or -1.
+    llama_token token(const std::string & text) const {
+        std::vector<llama_token> tokens(8);
+        const int32_t n = llama_tokenize(llama_model_get_vocab(model), text.c_str(),
+                                         (int32_t) text.size(), tokens.data(),
+                                         (int32_t) tokens.size(), false, true);
+        return n == 1 ? tokens[0] : -1;
+    }
+};
+
+// Llama 3 instruct models end their turns with <|eot_id|> (128009); the Qwen ids the
+// generation loops used to compare against (151643, 151645) are not even in this vocab.
+bool test_llama3() {
+    vocab_model v("ggml-vocab-llama-bpe.gguf");
+    if (v.model == nullptr) return false;
+
+    const llama_token eot = v.token("<|eot_id|>");
+    CHECK(eot == 128009);
+    CHECK(microllm::is_end_of_generation(v.model, eot));
+    CHECK(microllm::is_end_of_generation(v.model, v.token("<|end_of_text|>")));
+    CHECK(!microllm::is_end_of_generation(v.model, v.token("<|start_header_id|>")));
+    CHECK(!microllm::is_end_of_generation(v.model, v.token("Hello")));
+    return true;
+}
+
+// Phi-3 ends turns with <|end|>.
+bool test_phi3() {
+    vocab_model v("ggml-vocab-phi-3.gguf");
+    if (v.model == nullptr) return false;
+
+    const llama_token end = v.token("<|end|>");
+    CHECK(end >= 0);
+    CHECK(microllm::is_end_of_generation(v.model, end));
+    CHECK(!microllm::is_end_of_generation(v.model, v.token("<|user|>")));
+    return true;
+}
+
+// Qwen2: both ids the loops hard-coded before stay covered.
+bool test_qwen2() {
+    vocab_model v("ggml-vocab-qwen2.gguf");
+    if (v.model == nullptr) return false;
+
+    CHECK(microllm::is_end_of_generation(v.model, 151643)); // <|endoftext|>
+    CHECK(microllm::is_end_of_generation(v.model, 151645)); // <|im_end|>
+    CHECK(!microllm::is_end_of_generation(v.model, v.token("<|im_start|>")));
+    return true;
+}
+
+} // namespace
+
+int main() {
+    llama_backend_init();
+    bool ran = test_llama3();
+    ran = test_phi3() || ran;
+    ran = test_qwen2() || ran;
+    llama_backend_free();
+
+    if (!ran) {
+        printf("eog_test: no vocab files in %s, skipped\n", MICROLLM_LLAMA_VOCAB_DIR);
+        return SKIPPED;
+    }
+    if (g_failures > 0) {
+        fprintf(stderr, "eog_test: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("eog_test: all checks passed\n");
+    return 0;
+}
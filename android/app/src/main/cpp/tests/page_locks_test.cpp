@@ -0,0 +1,165 @@
+// Host test for weight_residency's page accounting: tensors that share a boundary page,
+// unlocking in the order set_pressure() drops priorities, and the locked byte count
+// returning to zero once every range is released.
+
+#include <cstdio>
+
+#include "core/page_locks.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                        \
+        }                                                                        \
+    } while (0)
+
+namespace {
+
+constexpr size_t PAGE = 4096;
+
+microllm::file_range range(uint64_t offset, uint64_t size) {
+    microllm::file_range r;
+    r.offset = offset;
+    r.size = size;
+    return r;
+}
+
+void test_span() {
+    microllm::page_locks locks(PAGE);
+    const microllm::page_run aligned = locks.span(range(PAGE, 2 * PAGE));
+    CHECK(aligned.first == 1 && aligned.end == 3);
+    const microllm::page_run unaligned = locks.span(range(PAGE - 1, 2));
+    CHECK(unaligned.first == 0 && unaligned.end == 2);
+    const microllm::page_run inside = locks.span(range(10, 100));
+    CHECK(inside.first == 0 && inside.end == 1);
+}
+
+// Two tensors meeting inside page 2: the shared page is counted once and stays locked
+// until both are released, whichever goes first.
+void test_shared_boundary_page() {
+    const microllm::file_range a = range(0, 2 * PAGE + 100);         // pages 0-2
+    const microllm::file_range b = range(2 * PAGE + 100, 2 * PAGE);  // pages 2-4
+
+    for (bool a_first : { true, false }) {
+        microllm::page_locks locks(PAGE);
+        locks.lock(a);
+        CHECK(locks.locked_bytes() == 3 * (int64_t) PAGE);
+        CHECK(locks.added_bytes(b) == 2 * (int64_t) PAGE);
+        const microllm::page_run b_span = locks.lock(b);
+        CHECK(b_span.first == 2 && b_span.end == 5); // mlock covers the whole range
+        CHECK(locks.locked_bytes() == 5 * (int64_t) PAGE);
+
+        const microllm::file_range & first = a_first ? a : b;
+        const microllm::file_range & second = a_first ? b : a;
+        const microllm::page_run released = locks.unlock(first);
+        CHECK(released.count() == 2);
+        CHECK(released.first != 2 && released.end - 1 != 2); // page 2 is still held
+        CHECK(locks.locked_bytes() == 3 * (int64_t) PAGE);
+
+        const microllm::page_run rest = locks.unlock(second);
+        CHECK(rest.count() == 3);
+        CHECK(rest.first <= 2 && rest.end > 2); // last holder releases the shared page
+        CHECK(locks.locked_bytes() == 0);
+    }
+}
+
+// Several small tensors inside one page: nothing is unlocked until the last one goes.
+void test_single_shared_page() {
+    microllm::page_locks locks(PAGE);
+    const microllm::file_range parts[] = { range(0, 1000), range(1000, 1000), range(2000, 1000) };
+    for (const microllm::file_range & r : parts) locks.lock(r);
+    CHECK(locks.locked_bytes() == (int64_t) PAGE);
+
+    CHECK(locks.unlock(parts[1]).count() == 0);
+    CHECK(locks.unlock(parts[0]).count() == 0);
+    CHECK(locks.locked_bytes() == (int64_t) PAGE);
+    const microllm::page_run last = locks.unlock(parts[2]);
+    CHECK(last.first == 0 && last.end == 1);
+    CHECK(locks.locked_bytes() == 0);
+}
+
+// The set_pressure() sequence on a layout like a real model: token_embd, attention of two
+// blocks and the output head back to back with unaligned boundaries. Moderate pressure
+// drops embeddings and attention (priorities 2 and 1) in priority order; critical drops
+// the output head. Every page must be released exactly once.
+void test_pressure_order() {
+    struct tensor {
+        microllm::file_range range;
+        int priority;
+    };
+    const tensor tensors[] = {
+        { range(0, 10 * PAGE + 512), 2 },                   // token_embd
+        { range(10 * PAGE + 512, 3 * PAGE), 1 },            // blk.0.attn_qkv
+        { range(13 * PAGE + 512, 3 * PAGE + 100), 1 },      // blk.1.attn_qkv
+        { range(16 * PAGE + 612, 8 * PAGE), 0 },            // output
+    };
+
+    microllm::page_locks locks(PAGE);
+    // lock_hot(): highest priority first.
+    for (int priority = 0; priority <= 2; priority++) {
+        for (const tensor & t : tensors) {
+            if (t.priority == priority) locks.lock(t.range);
+        }
+    }
+    const int64_t all_pages = 25; // pages 0-24
+    CHECK(locks.locked_bytes() == all_pages * (int64_t) PAGE);
+
+    bool unlocked[all_pages] = {};
+    int64_t released = 0;
+    auto release = [&](const microllm::file_range & r) {
+        const microllm::page_run run = locks.unlock(r);
+        for (size_t p = run.first; p < run.end; p++) {
+            CHECK(!unlocked[p]);
+            unlocked[p] = true;
+        }
+        released += (int64_t) run.count();
+        CHECK(locks.locked_bytes() == (all_pages - released) * (int64_t) PAGE);
+    };
+
+    // set_pressure(moderate): walks hot tensors in ascending priority, keeps priority 0.
+    for (int priority = 1; priority <= 2; priority++) {
+        for (const tensor & t : tensors) {
+            if (t.priority == priority) release(t.range);
+        }
+    }
+    CHECK(!unlocked[16]); // shared between blk.1 attention and the output head
+    CHECK(locks.locked(tensors[3].range));
+    CHECK(locks.locked_bytes() == 9 * (int64_t) PAGE); // pages 16-24
+
+    // set_pressure(critical).
+    release(tensors[3].range);
+    CHECK(locks.locked_bytes() == 0);
+    for (bool u : unlocked) CHECK(u);
+}
+
+void test_repeated_calls() {
+    microllm::page_locks locks(PAGE);
+    const microllm::file_range r = range(100, PAGE);
+    locks.lock(r);
+    locks.lock(r);
+    CHECK(locks.locked_bytes() == 2 * (int64_t) PAGE);
+    CHECK(locks.added_bytes(r) == 0);
+    CHECK(locks.unlock(r).count() == 2);
+    CHECK(locks.unlock(r).count() == 0);
+    CHECK(locks.locked_bytes() == 0);
+}
+
+} // namespace
+
+int main() {
+    test_span();
+    test_shared_boundary_page();
+    test_single_shared_page();
+    test_pressure_order();
+    test_repeated_calls();
+
+    if (g_failures > 0) {
+        fprintf(stderr, "page_locks_test: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("page_locks_test: all checks passed\n");
+    return 0;
+}
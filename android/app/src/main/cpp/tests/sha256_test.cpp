@@ -0,0 +1,135 @@
+// Host test for the download verifier's SHA-256: the FIPS 180-4 vectors, messages around
+// the 56-byte padding boundary fed in split chunks, and, where the ARMv8 kernel is built
+// and the CPU has SHA2, that kernel against the portable one.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/cpu_features.h"
+#include "core/sha256.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                        \
+        }                                                                        \
+    } while (0)
+
+namespace {
+
+// Hex digest of `message`, fed to update() in pieces of `chunk` bytes (0: all at once).
+std::string digest(const std::string & message, size_t chunk = 0) {
+    microllm::sha256 h;
+    if (chunk == 0) {
+        h.update(message.data(), message.size());
+    } else {
+        for (size_t i = 0; i < message.size(); i += chunk) {
+            h.update(message.data() + i, std::min(chunk, message.size() - i));
+        }
+    }
+    uint8_t out[microllm::sha256::DIGEST_SIZE];
+    h.finish(out);
+    return microllm::to_hex(out, sizeof(out));
+}
+
+void test_fips_vectors() {
+    CHECK(digest("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK(digest("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(digest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    CHECK(digest(std::string(1000000, 'a'), 4096) ==
+          "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+// finish() pads within the last block below 56 buffered bytes and spills into a second
+// block from 56 on; both sides of that boundary, whole and in odd-sized chunks.
+void test_padding_boundary() {
+    struct vector {
+        size_t len;
+        const char * hex;
+    };
+    const vector vectors[] = {
+        { 55, "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318" },
+        { 56, "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a" },
+        { 63, "7d3e74a05d7db15bce4ad9ec0658ea98e3f06eeecf16b4c6fff2da457ddc2f34" },
+        { 64, "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb" },
+    };
+    for (const vector & v : vectors) {
+        const std::string message(v.len, 'a');
+        for (size_t chunk : { (size_t) 0, (size_t) 1, (size_t) 7, (size_t) 55 }) {
+            if (digest(message, chunk) != v.hex) {
+                fprintf(stderr, "%zu bytes in %zu-byte chunks\n", v.len, chunk);
+                CHECK(digest(message, chunk) == v.hex);
+            }
+        }
+    }
+}
+
+// Chunks straddling block boundaries (buffered tail plus whole blocks from the caller).
+void test_chunked_blocks() {
+    std::string message(1000, '\0');
+    for (size_t i = 0; i < message.size(); i++) message[i] = (char) (i % 251);
+    const char * expected = "4e4c294b331f7a2099a379bec34b9f9fc03dc46ab465d998f4d683da53487e6d";
+    CHECK(digest(message) == expected);
+    CHECK(digest(message, 65) == expected);
+    CHECK(digest(message, 200) == expected);
+}
+
+void test_reset_reuses() {
+    microllm::sha256 h;
+    h.update("junk", 4);
+    uint8_t out[microllm::sha256::DIGEST_SIZE];
+    h.finish(out);
+    h.reset();
+    h.update("abc", 3);
+    h.finish(out);
+    CHECK(microllm::to_hex(out, sizeof(out)) ==
+          "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+void test_arm_kernel() {
+    const microllm::sha256_compress_fn arm = microllm::sha256_arm_kernel();
+    if (arm == nullptr || !microllm::detect_cpu_features().sha2) {
+        printf("sha256_test: ARMv8 kernel not available here, comparison skipped\n");
+        return;
+    }
+    std::vector<uint8_t> blocks(64 * 37);
+    uint32_t x = 0x12345678;
+    for (uint8_t & b : blocks) {
+        x = x * 1664525u + 1013904223u;
+        b = (uint8_t) (x >> 24);
+    }
+    for (size_t n_blocks : { (size_t) 1, (size_t) 2, (size_t) 37 }) {
+        uint32_t ref[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        uint32_t got[8];
+        std::memcpy(got, ref, sizeof(got));
+        microllm::sha256_portable_kernel()(ref, blocks.data(), n_blocks);
+        arm(got, blocks.data(), n_blocks);
+        CHECK(std::memcmp(ref, got, sizeof(ref)) == 0);
+    }
+    microllm::sha256 h;
+    CHECK(h.accelerated());
+}
+
+} // namespace
+
+int main() {
+    test_fips_vectors();
+    test_padding_boundary();
+    test_chunked_blocks();
+    test_reset_reuses();
+    test_arm_kernel();
+
+    if (g_failures > 0) {
+        fprintf(stderr, "sha256_test: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("sha256_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,208 @@
+// Host test for the thermal governor: writes thermal zones and battery state into a fake
+// sysfs tree under a temp dir and checks the default_throttle_policy decisions at each
+// level as the readings change.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "core/thermal_governor.h"
+
+namespace fs = std::filesystem;
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                        \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_NEAR(a, b) CHECK(std::fabs((a) - (b)) < 1e-6)
+
+namespace {
+
+// A sysfs root with writable thermal zones and battery files, removed on destruction.
+class fake_sysfs {
+public:
+    fake_sysfs() {
+        std::string tmpl = (fs::temp_directory_path() / "microllm_thermal_XXXXXX").string();
+        if (mkdtemp(tmpl.data()) == nullptr) {
+            perror("mkdtemp");
+            exit(1);
+        }
+        root_ = tmpl;
+    }
+
+    ~fake_sysfs() {
+        std::error_code ec;
+        fs::remove_all(root_, ec);
+    }
+
+    const std::string & root() const { return root_; }
+
+    void zone(int index, const std::string & type, const std::string & temp) const {
+        const fs::path dir = fs::path(root_) / "class/thermal" / ("thermal_zone" + std::to_string(index));
+        write(dir / "type", type);
+        write(dir / "temp", temp);
+    }
+
+    void battery(int pct, const std::string & status) const {
+        const fs::path dir = fs::path(root_) / "class/power_supply/battery";
+        write(dir / "capacity", std::to_string(pct));
+        write(dir / "status", status);
+    }
+
+private:
+    static void write(const fs::path & path, const std::string & value) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path) << value << "\n";
+    }
+
+    std::string root_;
+};
+
+struct governed {
+    microllm::default_throttle_policy * policy;
+    std::unique_ptr<microllm::thermal_governor> governor;
+};
+
+// Interval 0: every token re-reads the sensors and consults the policy.
+governed make_governor(const fake_sysfs & sysfs, const microllm::throttle_params & params) {
+    auto policy = std::make_unique<microllm::default_throttle_policy>(params);
+    governed g{ policy.get(), nullptr };
+    g.governor = std::make_unique<microllm::thermal_governor>(sysfs.root(), std::move(policy), 0.0);
+    return g;
+}
+
+microllm::throttle_params test_params(double target_tps) {
+    microllm::throttle_params p;
+    p.target_tps = target_tps;
+    p.max_threads = 4;
+    p.min_threads = 1;
+    return p;
+}
+
+void test_sensor_reads() {
+    fake_sysfs sysfs;
+    CHECK(microllm::read_cpu_temp_c(sysfs.root()) < 0.0);
+
+    // Non-CPU zones count only when no CPU zone is readable.
+    sysfs.zone(0, "battery", "80000");
+    CHECK_NEAR(microllm::read_cpu_temp_c(sysfs.root()), 80.0);
+    sysfs.zone(3, "cpu-1-0-usr", "45500");
+    sysfs.zone(5, "soc_thermal", "52");  // whole degrees
+    CHECK_NEAR(microllm::read_cpu_temp_c(sysfs.root()), 52.0);
+    sysfs.zone(6, "cpuss-0", "0");       // disabled sensor
+    CHECK_NEAR(microllm::read_cpu_temp_c(sysfs.root()), 52.0);
+
+    int32_t pct = 0;
+    bool charging = true;
+    microllm::read_battery(sysfs.root(), pct, charging);
+    CHECK(pct == -1);
+    CHECK(!charging);
+    sysfs.battery(42, "Charging");
+    microllm::read_battery(sysfs.root(), pct, charging);
+    CHECK(pct == 42);
+    CHECK(charging);
+}
+
+void test_levels() {
+    fake_sysfs sysfs;
+    sysfs.battery(80, "Discharging");
+    governed g = make_governor(sysfs, test_params(10.0));
+
+    // Cool: all threads, no pacing.
+    sysfs.zone(0, "cpu-0-0", "45000");
+    microllm::throttle_decision d = g.governor->on_token(50.0, 4);
+    CHECK(g.policy->level() == 0);
+    CHECK(d.n_threads == 4);
+    CHECK_NEAR(d.pause_ms, 0.0);
+
+    // Warm: shed one thread per interval down to half, pace 50 ms tokens to 10 tok/s.
+    sysfs.zone(0, "cpu-0-0", "62000");
+    d = g.governor->on_token(50.0, 4);
+    CHECK(g.policy->level() == 1);
+    CHECK(d.n_threads == 3);
+    CHECK_NEAR(d.pause_ms, 50.0);
+    d = g.governor->on_token(50.0, d.n_threads);
+    CHECK(d.n_threads == 2);
+    d = g.governor->on_token(50.0, d.n_threads);
+    CHECK(d.n_threads == 2);
+
+    // Hot: minimum threads, paced to half the target.
+    sysfs.zone(0, "cpu-0-0", "80000");
+    d = g.governor->on_token(50.0, d.n_threads);
+    CHECK(g.policy->level() == 2);
+    CHECK(d.n_threads == 1);
+    CHECK_NEAR(d.pause_ms, 150.0);
+
+    // Still above soft: stays hot. Inside the hysteresis band it steps back to warm.
+    sysfs.zone(0, "cpu-0-0", "72000");
+    d = g.governor->on_token(50.0, d.n_threads);
+    CHECK(g.policy->level() == 2);
+    CHECK(d.n_threads == 1);
+    sysfs.zone(0, "cpu-0-0", "57000");
+    d = g.governor->on_token(50.0, d.n_threads);
+    CHECK(g.policy->level() == 1);
+    CHECK(d.n_threads == 2);
+    CHECK_NEAR(d.pause_ms, 50.0);
+
+    // Cooled below soft - hysteresis: back to cool.
+    sysfs.zone(0, "cpu-0-0", "54000");
+    d = g.governor->on_token(50.0, d.n_threads);
+    CHECK(g.policy->level() == 0);
+    CHECK(d.n_threads == 4);
+    CHECK_NEAR(d.pause_ms, 0.0);
+}
+
+void test_low_battery() {
+    fake_sysfs sysfs;
+    sysfs.zone(0, "cpu-0-0", "40000");
+    sysfs.battery(10, "Discharging");
+    governed g = make_governor(sysfs, test_params(10.0));
+
+    // Treated as warm while discharging below low_battery_pct.
+    microllm::throttle_decision d = g.governor->on_token(50.0, 4);
+    CHECK(d.n_threads == 3);
+    CHECK_NEAR(d.pause_ms, 50.0);
+
+    sysfs.battery(10, "Charging");
+    d = g.governor->on_token(50.0, d.n_threads);
+    CHECK(d.n_threads == 4);
+    CHECK_NEAR(d.pause_ms, 0.0);
+}
+
+void test_derived_target() {
+    fake_sysfs sysfs;
+    sysfs.zone(0, "cpu-0-0", "45000");
+    governed g = make_governor(sysfs, test_params(0.0));
+
+    // 50 ms tokens while cool at max threads: 20 tok/s, so the warm target is 15 tok/s.
+    g.governor->on_token(50.0, 4);
+    sysfs.zone(0, "cpu-0-0", "65000");
+    const microllm::throttle_decision d = g.governor->on_token(50.0, 4);
+    CHECK_NEAR(d.pause_ms, 1000.0 / 15.0 - 50.0);
+}
+
+} // namespace
+
+int main() {
+    test_sensor_reads();
+    test_levels();
+    test_low_battery();
+    test_derived_target();
+
+    if (g_failures > 0) {
+        fprintf(stderr, "thermal_governor_test: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("thermal_governor_test: all checks passed\n");
+    return 0;
+}
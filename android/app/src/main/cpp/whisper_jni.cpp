@@ -4,63 +4,173 @@
 // - If external/whisper.cpp is present, we compile against whisper.cpp and provide real STT.
 // - If not present, we still build a stub libwhisper.so so the app compiles,
 //   and `isAvailable()` returns false with clear error messages.
+//
+// Inference logic lives in core/stt_engine.cpp; this file converts JNI types and packs
+// results for Kotlin.
 
 #include <jni.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <vector>
-#include <android/log.h>
+#include "jni_utf8.h"
 
 #define LOG_TAG "WhisperJNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include "core/log.h"
 
 #if __has_include("whisper.h")
-  #include "whisper.h"
+  #include "core/proc_stats.h"
+  #include "core/stt_engine.h"
   #define HAS_WHISPER 1
 #else
   #define HAS_WHISPER 0
 #endif
 
 #if HAS_WHISPER
-static whisper_context * g_wctx = nullptr;
-#else
-static void * g_wctx = nullptr;
-#endif
+static microllm::stt_engine g_engine;
 
-static int g_threads = 4;
+// Copy PCM16 samples out of the Java array and convert to float.
+static std::vector<float> read_pcm16(JNIEnv * env, jshortArray pcm16) {
+    const jsize n = env->GetArrayLength(pcm16);
+    if (n <= 0) return {};
 
-static std::vector<float> pcm16_to_f32(const int16_t * pcm, int n) {
-    std::vector<float> out;
-    out.resize(n);
-    constexpr float k = 1.0f / 32768.0f;
-    for (int i = 0; i < n; i++) out[i] = (float) pcm[i] * k;
-    return out;
+    jboolean isCopy = JNI_FALSE;
+    auto * pcm_ptr = (int16_t *) env->GetShortArrayElements(pcm16, &isCopy);
+    std::vector<float> audio = microllm::stt_engine::pcm16_to_f32(pcm_ptr, (size_t) n);
+    env->ReleaseShortArrayElements(pcm16, (jshort *) pcm_ptr, JNI_ABORT);
+    return audio;
 }
 
-#if HAS_WHISPER
-struct stream_callback_ctx {
-    JNIEnv * env;
-    jobject callback_obj;
-    jmethodID mid_onPartial;
-    std::string accumulated;
-};
+// languageTag is BCP-47 (e.g., "es-ES"). whisper.cpp expects ISO-639-1 like "es".
+// We pass just the base language part.
+static std::string base_language(JNIEnv * env, jstring languageTag) {
+    const char * lang = languageTag ? env->GetStringUTFChars(languageTag, nullptr) : nullptr;
+    std::string langStr = lang ? std::string(lang) : std::string();
+    if (lang) env->ReleaseStringUTFChars(languageTag, lang);
+    return microllm::stt_engine::base_language(langStr);
+}
 
-static void on_new_segment_cb(whisper_context * ctx, whisper_state * /*state*/, int n_new, void * user_data) {
-    auto * cb = (stream_callback_ctx *) user_data;
-    if (cb == nullptr || cb->env == nullptr || cb->callback_obj == nullptr || cb->mid_onPartial == nullptr) {
-        return;
+// Forward each new segment to `callbackObj.onSegment(...)` (no-op if null).
+//
+// Segment text is raw UTF-8 from the tokenizer; NewStringUTF() aborts on invalid
+// Modified UTF-8, so it goes through the byte[] path.
+static microllm::stt_segment_callback make_segment_callback(JNIEnv * env, jobject callbackObj) {
+    if (callbackObj == nullptr) return nullptr;
+
+    jclass cbCls = env->GetObjectClass(callbackObj);
+    // Kotlin object is expected to have:
+    //   fun onSegment(text: String, t0Ms: Long, t1Ms: Long, confidence: Float)
+    jmethodID mid = env->GetMethodID(cbCls, "onSegment", "(Ljava/lang/String;JJF)V");
+    env->DeleteLocalRef(cbCls);
+    if (mid == nullptr) {
+        env->ExceptionClear();
+        LOGE("Callback object has no onSegment(String, long, long, float) method");
+        return nullptr;
     }
 
-    const int n_segments = whisper_full_n_segments(ctx);
-    const int start = std::max(0, n_segments - n_new);
-    for (int i = start; i < n_segments; i++) {
-        const char * text = whisper_full_get_segment_text(ctx, i);
-        if (text) cb->accumulated.append(text);
+    return [env, callbackObj, mid](const char * text, int64_t t0_ms, int64_t t1_ms, float confidence) {
+        if (env->ExceptionCheck()) return;
+        jstring jtxt = new_string_from_utf8_bytes(env, text, text ? (int) strlen(text) : 0);
+        env->CallVoidMethod(callbackObj, mid, jtxt, (jlong) t0_ms, (jlong) t1_ms, (jfloat) confidence);
+        env->DeleteLocalRef(jtxt);
+        if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
+    };
+}
+
+// Shared body of the transcribe* entry points: reads and validates audio, then runs
+// the engine. Returns false (and logs) on any failure; `empty` is set for empty input.
+static bool run_transcription(JNIEnv * env, jshortArray pcm16, jint sampleRate, jstring languageTag,
+                              jboolean translateToEnglish, jobject callbackObj, bool & empty) {
+    empty = false;
+    if (!g_engine.is_loaded()) {
+        LOGE("transcribe called but model not loaded");
+        return false;
+    }
+
+    std::vector<float> audio = read_pcm16(env, pcm16);
+    if (audio.empty()) {
+        empty = true;
+        return false;
+    }
+
+    // Whisper expects 16 kHz audio. If sampleRate differs, we currently reject.
+    // (We downsample in Kotlin before calling into native.)
+    if ((int) sampleRate != microllm::stt_engine::SAMPLE_RATE) {
+        LOGE("Expected 16000 Hz audio, got %d", (int) sampleRate);
+        return false;
+    }
+
+    microllm::stt_request request;
+    request.language = base_language(env, languageTag);
+    request.translate = translateToEnglish == JNI_TRUE;
+    request.on_segment = make_segment_callback(env, callbackObj);
+
+    return g_engine.transcribe(audio.data(), audio.size(), request);
+}
+
+// Structured transcription result handed to Kotlin as a direct ByteBuffer.
+//
+// Layout (native byte order, little-endian on all supported ABIs):
+//   transcript_header
+//   stt_segment[n_segments]
+//   stt_token[n_tokens]
+//   UTF-8 text blob (text_bytes), segments reference it by byte offset/length
+//
+// The buffer is malloc'd here and must be released with WhisperNative.freeResult().
+// Keep in sync with WhisperTranscript.kt.
+static constexpr uint32_t TRANSCRIPT_MAGIC = 0x52505357; // "WSPR"
+static constexpr uint32_t TRANSCRIPT_VERSION = 1;
+
+#pragma pack(push, 1)
+struct transcript_header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t n_segments;
+    int32_t n_tokens;
+    int32_t text_bytes;
+    int32_t lang_id;
+    int32_t reserved[2];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(transcript_header) == 32, "transcript_header layout changed");
+
+static jobject pack_transcript(JNIEnv * env, const microllm::stt_transcript & t) {
+    const size_t size = sizeof(transcript_header)
+                      + t.segments.size() * sizeof(microllm::stt_segment)
+                      + t.tokens.size() * sizeof(microllm::stt_token)
+                      + t.text.size();
+    auto * buf = (uint8_t *) malloc(size);
+    if (buf == nullptr) {
+        LOGE("Failed to allocate %zu bytes for transcript", size);
+        return nullptr;
     }
 
-    jstring jtxt = cb->env->NewStringUTF(cb->accumulated.c_str());
-    cb->env->CallVoidMethod(cb->callback_obj, cb->mid_onPartial, jtxt);
-    cb->env->DeleteLocalRef(jtxt);
+    transcript_header header{};
+    header.magic = TRANSCRIPT_MAGIC;
+    header.version = TRANSCRIPT_VERSION;
+    header.n_segments = (int32_t) t.segments.size();
+    header.n_tokens = (int32_t) t.tokens.size();
+    header.text_bytes = (int32_t) t.text.size();
+    header.lang_id = t.lang_id;
+
+    uint8_t * p = buf;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, t.segments.data(), t.segments.size() * sizeof(microllm::stt_segment));
+    p += t.segments.size() * sizeof(microllm::stt_segment);
+    memcpy(p, t.tokens.data(), t.tokens.size() * sizeof(microllm::stt_token));
+    p += t.tokens.size() * sizeof(microllm::stt_token);
+    memcpy(p, t.text.data(), t.text.size());
+
+    jobject out = env->NewDirectByteBuffer(buf, (jlong) size);
+    if (out == nullptr) {
+        free(buf);
+    }
+    return out;
 }
 #endif
 
@@ -86,42 +196,62 @@ Java_com_microllm_app_WhisperNative_loadModel(
     LOGE("whisper.cpp not compiled in (missing whisper.h)");
     return JNI_FALSE;
 #else
-    if (g_wctx != nullptr) {
-        whisper_free(g_wctx);
-        g_wctx = nullptr;
-    }
-
     const char * path = env->GetStringUTFChars(modelPath, nullptr);
-    LOGI("Loading whisper model from: %s", path);
-    g_threads = (int) threads;
-
-    g_wctx = whisper_init_from_file(path);
+    const bool ok = g_engine.load(path, (int) threads);
     env->ReleaseStringUTFChars(modelPath, path);
-
-    if (g_wctx == nullptr) {
-        LOGE("Failed to init whisper context");
-        return JNI_FALSE;
-    }
-
-    return JNI_TRUE;
+    return ok ? JNI_TRUE : JNI_FALSE;
 #endif
 }
 
 JNIEXPORT void JNICALL
 Java_com_microllm_app_WhisperNative_unloadModel(JNIEnv *, jclass) {
 #if HAS_WHISPER
-    if (g_wctx) {
-        whisper_free(g_wctx);
-        g_wctx = nullptr;
-    }
-#else
-    g_wctx = nullptr;
+    g_engine.unload();
 #endif
 }
 
 JNIEXPORT jboolean JNICALL
 Java_com_microllm_app_WhisperNative_isLoaded(JNIEnv *, jclass) {
-    return g_wctx != nullptr ? JNI_TRUE : JNI_FALSE;
+#if HAS_WHISPER
+    return g_engine.is_loaded() ? JNI_TRUE : JNI_FALSE;
+#else
+    return JNI_FALSE;
+#endif
+}
+
+// Memory report for the loaded model, or null if none is loaded:
+//   [0] model file bytes (weights as stored; whisper copies them into its own buffers)
+//   [1] RSS growth across load (weights + KV + compute buffers)
+//   [2] estimate of the KV/compute bytes: RSS growth minus the file size, clamped at
+//       0. whisper.cpp does not expose its state buffer sizes, and the RSS delta also
+//       counts allocator and page-cache noise, so this is not an exact figure.
+//   [3] current process RSS
+//   [4] model ftype (whisper_model_ftype: 0=f32, 1=f16, 8=q5_0, 9=q5_1, 7=q8_0, ...)
+//   [5] 1 if the mmap loader was used, else 0
+JNIEXPORT jlongArray JNICALL
+Java_com_microllm_app_WhisperNative_getMemoryReport(JNIEnv * env, jclass) {
+#if !HAS_WHISPER
+    (void) env;
+    return nullptr;
+#else
+    if (!g_engine.is_loaded()) return nullptr;
+
+    const microllm::stt_load_report & r = g_engine.load_report();
+    const int64_t load_delta = std::max<int64_t>(0, r.rss_after - r.rss_before);
+    const jlong values[6] = {
+        (jlong) r.file_bytes,
+        (jlong) load_delta,
+        (jlong) std::max<int64_t>(0, load_delta - r.file_bytes),
+        (jlong) microllm::current_rss_bytes(),
+        (jlong) g_engine.ftype(),
+        (jlong) (r.mmap_loader ? 1 : 0),
+    };
+
+    jlongArray out = env->NewLongArray(6);
+    if (out == nullptr) return nullptr;
+    env->SetLongArrayRegion(out, 0, 6, values);
+    return out;
+#endif
 }
 
 JNIEXPORT jstring JNICALL
@@ -136,59 +266,13 @@ Java_com_microllm_app_WhisperNative_transcribePcm16(
     (void) env; (void) pcm16; (void) sampleRate; (void) languageTag; (void) translateToEnglish;
     return nullptr;
 #else
-    if (g_wctx == nullptr) {
-        LOGE("transcribe called but model not loaded");
-        return nullptr;
-    }
-
-    const jsize n = env->GetArrayLength(pcm16);
-    if (n <= 0) {
-        return env->NewStringUTF("");
+    bool empty = false;
+    if (!run_transcription(env, pcm16, sampleRate, languageTag, translateToEnglish, nullptr, empty)) {
+        return empty ? env->NewStringUTF("") : nullptr;
     }
 
-    jboolean isCopy = JNI_FALSE;
-    auto * pcm_ptr = (int16_t *) env->GetShortArrayElements(pcm16, &isCopy);
-    std::vector<float> audio = pcm16_to_f32(pcm_ptr, (int) n);
-    env->ReleaseShortArrayElements(pcm16, (jshort *) pcm_ptr, JNI_ABORT);
-
-    // Whisper expects 16 kHz audio. If sampleRate differs, we currently reject.
-    // (We downsample in Kotlin before calling into native.)
-    if ((int) sampleRate != 16000) {
-        LOGE("Expected 16000 Hz audio, got %d", (int) sampleRate);
-        return nullptr;
-    }
-
-    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-    params.n_threads = g_threads;
-    params.translate = translateToEnglish == JNI_TRUE;
-    params.print_progress = false;
-    params.print_realtime = false;
-    params.print_timestamps = false;
-
-    const char * lang = env->GetStringUTFChars(languageTag, nullptr);
-    // languageTag is BCP-47 (e.g., "es-ES"). whisper.cpp expects ISO-639-1 like "es".
-    // We pass just the base language part.
-    std::string langStr = lang ? std::string(lang) : std::string("en");
-    env->ReleaseStringUTFChars(languageTag, lang);
-    const auto dash = langStr.find('-');
-    if (dash != std::string::npos) langStr = langStr.substr(0, dash);
-    params.language = langStr.c_str();
-
-    const int res = whisper_full(g_wctx, params, audio.data(), (int) audio.size());
-    if (res != 0) {
-        LOGE("whisper_full failed: %d", res);
-        return nullptr;
-    }
-
-    const int n_segments = whisper_full_n_segments(g_wctx);
-    std::string out;
-    out.reserve(256);
-    for (int i = 0; i < n_segments; i++) {
-        const char * text = whisper_full_get_segment_text(g_wctx, i);
-        if (text) out.append(text);
-    }
-
-    return env->NewStringUTF(out.c_str());
+    const std::string out = g_engine.text();
+    return new_string_from_utf8_bytes(env, out.data(), (int) out.size());
 #endif
 }
 
@@ -205,71 +289,94 @@ Java_com_microllm_app_WhisperNative_transcribePcm16Streaming(
     (void) env; (void) pcm16; (void) sampleRate; (void) languageTag; (void) translateToEnglish; (void) callbackObj;
     return nullptr;
 #else
-    if (g_wctx == nullptr) {
-        LOGE("transcribeStreaming called but model not loaded");
-        return nullptr;
+    bool empty = false;
+    if (!run_transcription(env, pcm16, sampleRate, languageTag, translateToEnglish, callbackObj, empty)) {
+        return empty ? env->NewStringUTF("") : nullptr;
     }
 
-    const jsize n = env->GetArrayLength(pcm16);
-    if (n <= 0) {
-        return env->NewStringUTF("");
+    // Final aggregated text
+    const std::string out = g_engine.text();
+    return new_string_from_utf8_bytes(env, out.data(), (int) out.size());
+#endif
+}
+
+// Same as transcribePcm16Streaming, but returns the packed segment/token result
+// (see transcript_header) instead of a flat string. Returns null on failure.
+JNIEXPORT jobject JNICALL
+Java_com_microllm_app_WhisperNative_transcribePcm16Detailed(
+        JNIEnv * env,
+        jclass,
+        jshortArray pcm16,
+        jint sampleRate,
+        jstring languageTag,
+        jboolean translateToEnglish,
+        jobject callbackObj) {
+#if !HAS_WHISPER
+    (void) env; (void) pcm16; (void) sampleRate; (void) languageTag; (void) translateToEnglish; (void) callbackObj;
+    return nullptr;
+#else
+    bool empty = false;
+    if (!run_transcription(env, pcm16, sampleRate, languageTag, translateToEnglish, callbackObj, empty)) {
+        return nullptr;
     }
 
-    jboolean isCopy = JNI_FALSE;
-    auto * pcm_ptr = (int16_t *) env->GetShortArrayElements(pcm16, &isCopy);
-    std::vector<float> audio = pcm16_to_f32(pcm_ptr, (int) n);
-    env->ReleaseShortArrayElements(pcm16, (jshort *) pcm_ptr, JNI_ABORT);
+    return pack_transcript(env, g_engine.transcript());
+#endif
+}
 
-    if ((int) sampleRate != 16000) {
+// Fast language identification on the first `maxMs` of audio only.
+//
+// Why:
+// - A wrong BCP-47 tag wastes the whole transcription.
+// - whisper_full(language="auto") re-detects on every call; callers cache our answer
+//   per streaming session instead.
+//
+// Returns the ISO-639-1 code (e.g. "es"), or null on failure. If `outProb` is non-null
+// and has at least one element, element 0 receives the detection probability.
+JNIEXPORT jstring JNICALL
+Java_com_microllm_app_WhisperNative_detectLanguage(
+        JNIEnv * env,
+        jclass,
+        jshortArray pcm16,
+        jint sampleRate,
+        jint maxMs,
+        jfloatArray outProb) {
+#if !HAS_WHISPER
+    (void) env; (void) pcm16; (void) sampleRate; (void) maxMs; (void) outProb;
+    return nullptr;
+#else
+    if (!g_engine.is_loaded()) {
+        LOGE("detectLanguage called but model not loaded");
+        return nullptr;
+    }
+    if ((int) sampleRate != microllm::stt_engine::SAMPLE_RATE) {
         LOGE("Expected 16000 Hz audio, got %d", (int) sampleRate);
         return nullptr;
     }
 
-    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-    params.n_threads = g_threads;
-    params.translate = translateToEnglish == JNI_TRUE;
-    params.print_progress = false;
-    params.print_realtime = false;
-    params.print_timestamps = false;
-
-    const char * lang = env->GetStringUTFChars(languageTag, nullptr);
-    std::string langStr = lang ? std::string(lang) : std::string("en");
-    env->ReleaseStringUTFChars(languageTag, lang);
-    const auto dash = langStr.find('-');
-    if (dash != std::string::npos) langStr = langStr.substr(0, dash);
-    params.language = langStr.c_str();
-
-    stream_callback_ctx cb{};
-    if (callbackObj != nullptr) {
-        jclass cbCls = env->GetObjectClass(callbackObj);
-        // Kotlin object is expected to have: fun onPartial(text: String)
-        jmethodID mid = env->GetMethodID(cbCls, "onPartial", "(Ljava/lang/String;)V");
-        cb.env = env;
-        cb.callback_obj = callbackObj;
-        cb.mid_onPartial = mid;
-        cb.accumulated.reserve(256);
-        params.new_segment_callback = on_new_segment_cb;
-        params.new_segment_callback_user_data = &cb;
+    std::vector<float> audio = read_pcm16(env, pcm16);
+    if (audio.empty()) {
+        return nullptr;
     }
 
-    const int res = whisper_full(g_wctx, params, audio.data(), (int) audio.size());
-    if (res != 0) {
-        LOGE("whisper_full failed: %d", res);
+    float p = 0.0f;
+    const std::string code = g_engine.detect_language(audio.data(), audio.size(), (int) maxMs, &p);
+    if (code.empty()) {
         return nullptr;
     }
 
-    // Final aggregated text
-    const int n_segments = whisper_full_n_segments(g_wctx);
-    std::string out;
-    out.reserve(256);
-    for (int i = 0; i < n_segments; i++) {
-        const char * text = whisper_full_get_segment_text(g_wctx, i);
-        if (text) out.append(text);
+    if (outProb != nullptr && env->GetArrayLength(outProb) > 0) {
+        const jfloat jp = p;
+        env->SetFloatArrayRegion(outProb, 0, 1, &jp);
     }
-
-    return env->NewStringUTF(out.c_str());
+    return env->NewStringUTF(code.c_str());
 #endif
 }
 
-} // extern "C"
+JNIEXPORT void JNICALL
+Java_com_microllm_app_WhisperNative_freeResult(JNIEnv * env, jclass, jobject buffer) {
+    if (buffer == nullptr) return;
+    free(env->GetDirectBufferAddress(buffer));
+}
 
+} // extern "C"
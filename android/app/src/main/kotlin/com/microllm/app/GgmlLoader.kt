@@ -0,0 +1,53 @@
+package com.microllm.app
+
+/**
+ * Loads the libggml build that best matches this CPU, once per process.
+ *
+ * The APK ships libggml.so (ARMv8.0 baseline) plus libggml_dotprod.so (ARMv8.2) and
+ * libggml_i8mm.so (ARMv8.6), all with the SONAME libggml.so. Loading a variant before
+ * libllama/libwhisper makes the dynamic linker satisfy their libggml.so dependency with
+ * it. libmicrollm_cpu.so only reads the hwcaps and links nothing from ggml.
+ */
+object GgmlLoader {
+
+    /** Library name of the loaded build ("ggml", "ggml_dotprod", "ggml_i8mm"), or null. */
+    @Volatile
+    var loadedVariant: String? = null
+        private set
+
+    @Synchronized
+    fun load() {
+        if (loadedVariant != null) return
+
+        val variant = try {
+            System.loadLibrary("microllm_cpu")
+            bestVariant()
+        } catch (e: UnsatisfiedLinkError) {
+            android.util.Log.w("GgmlLoader", "CPU feature probe unavailable: ${e.message}")
+            "ggml"
+        }
+
+        if (variant != "ggml") {
+            try {
+                System.loadLibrary(variant)
+                loadedVariant = variant
+                android.util.Log.i("GgmlLoader", "Loaded lib$variant.so")
+                return
+            } catch (e: UnsatisfiedLinkError) {
+                android.util.Log.w("GgmlLoader", "Failed to load lib$variant.so, using baseline: ${e.message}")
+            }
+        }
+
+        System.loadLibrary("ggml")
+        loadedVariant = "ggml"
+        android.util.Log.i("GgmlLoader", "Loaded libggml.so (baseline)")
+    }
+
+    /** Best libggml build for this CPU, from getauxval(AT_HWCAP/AT_HWCAP2). */
+    @JvmStatic
+    private external fun bestVariant(): String
+
+    /** [dotprod, i8mm, sve] as reported by the kernel. */
+    @JvmStatic
+    external fun cpuFeatures(): BooleanArray?
+}
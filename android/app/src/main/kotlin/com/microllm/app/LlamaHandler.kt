@@ -1,8 +1,12 @@
 package com.microllm.app
 
+import android.content.ComponentCallbacks2
 import android.content.Context
+import android.os.Build
 import android.os.Handler
 import android.os.Looper
+import androidx.annotation.Keep
+import io.flutter.plugin.common.EventChannel
 import io.flutter.plugin.common.MethodCall
 import io.flutter.plugin.common.MethodChannel
 import java.io.File
@@ -13,11 +17,17 @@ import java.util.concurrent.Executors
  * 
  * This uses the LlamaNative JNI bindings to call llama.cpp directly,
  * bypassing Dart FFI and its struct alignment issues.
+ *
+ * Events on `com.microllm.app/llama_events`:
+ * - {type:"loadProgress", progress: <double 0..1>}
  */
-class LlamaHandler(private val context: Context) {
+class LlamaHandler(private val context: Context) : EventChannel.StreamHandler {
     
     companion object {
         private var initialized = false
+
+        // Thread calibration results, keyed by build fingerprint so an OS update re-tunes.
+        private const val THREAD_PREFS = "llama_thread_tuning"
         
         init {
             try {
@@ -32,7 +42,23 @@ class LlamaHandler(private val context: Context) {
     }
     
     private val executor = Executors.newSingleThreadExecutor()
+    // Loads the next model for a hot swap while [executor] keeps serving the current one.
+    private val preloadExecutor = Executors.newSingleThreadExecutor()
+    // Header reads; never queued behind a generation or a preload.
+    private val inspectExecutor = Executors.newSingleThreadExecutor()
+    // Model conversions; take minutes, so they get their own thread.
+    private val convertExecutor = Executors.newSingleThreadExecutor()
     private val mainHandler = Handler(Looper.getMainLooper())
+    private var eventSink: EventChannel.EventSink? = null
+
+    // Last level passed to LlamaNative.setMemoryPressure.
+    @Volatile
+    private var memoryPressure = LlamaNative.PRESSURE_NONE
+
+    // Thermal governor as last set from Dart (off until enabled); re-applied after every
+    // load. Touched only on the inference executor.
+    private var thermalGovernorEnabled = false
+    private var thermalGovernorTarget = 0.0
 
     // Incremental conversation buffer to avoid re-decoding the whole chat each turn.
     // This makes responses much faster and improves "memory retention" across turns.
@@ -40,6 +66,12 @@ class LlamaHandler(private val context: Context) {
     private var conversationInitialized = false
     private var conversationLanguage = "English"
 
+    // LoRA adapter the conversation's KV cache was computed with (null = base model).
+    // Stateless requests may run under another adapter; they switch back to this one
+    // before restoring the chat.
+    private var chatAdapter: String? = null
+    private var chatAdapterScale = 1.0f
+
     // Pending conversation state captured before the model is loaded.
     //
     // Why:
@@ -74,14 +106,31 @@ class LlamaHandler(private val context: Context) {
             "loadModel" -> {
                 val modelPath = call.argument<String>("modelPath")
                 val contextSize = call.argument<Int>("contextSize") ?: 2048
-                val threads = call.argument<Int>("threads") ?: 4
+                // 0 (or absent) = pick automatically, see configureThreads()
+                val threads = call.argument<Int>("threads") ?: 0
+                val batchSize = call.argument<Int>("batchSize") ?: 512
+                // 0 = adaptive (sized from free memory, tuned on prefill speed)
+                val ubatchSize = call.argument<Int>("ubatchSize") ?: 512
+                val flashAttn = call.argument<Boolean>("flashAttention") ?: false
+                val cacheTypeK = call.argument<String>("cacheTypeK") ?: "f16"
+                val cacheTypeV = call.argument<String>("cacheTypeV") ?: "f16"
+                val prefetch = call.argument<Boolean>("prefetch") ?: true
+                val lockHotWeights = call.argument<Boolean>("lockHotWeights") ?: false
+                // Opt-in: load the convertModel() copy of modelPath when there is one.
+                val useConverted = call.argument<Boolean>("useOptimizedModel") ?: false
+                val warmup = call.argument<Boolean>("warmup") ?: true
+                val hotSwap = call.argument<Boolean>("hotSwap") ?: false
                 
                 if (modelPath == null) {
                     result.error("INVALID_ARGS", "Model path is required", null)
                     return
                 }
                 
-                loadModelAsync(modelPath, contextSize, threads, result)
+                loadModelAsync(
+                    modelPath, contextSize, threads, batchSize, ubatchSize,
+                    flashAttn, cacheTypeK, cacheTypeV, prefetch, lockHotWeights, useConverted,
+                    warmup, hotSwap, result
+                )
             }
             "unloadModel" -> {
                 unloadModelAsync(result)
@@ -126,8 +175,20 @@ class LlamaHandler(private val context: Context) {
                 val temperature = (call.argument<Double>("temperature") ?: 0.7).toFloat()
                 val topP = (call.argument<Double>("topP") ?: 0.9).toFloat()
                 val topK = call.argument<Int>("topK") ?: 40
-                LlamaNative.resetSampler(temperature, topP, topK)
-                result.success(true)
+                val grammar = call.argument<String>("grammar")
+                // Replaces the sampler the executor's sample() calls use; grammar parsing
+                // can also take a while, so both stay off the platform thread.
+                executor.execute {
+                    try {
+                        val ok = LlamaNative.resetSampler(temperature, topP, topK, grammar)
+                        mainHandler.post {
+                            if (ok) result.success(true)
+                            else result.error("GRAMMAR_INVALID", "Sampling grammar does not parse", null)
+                        }
+                    } catch (e: Exception) {
+                        mainHandler.post { result.error("RESET_SAMPLER_FAILED", e.message, null) }
+                    }
+                }
             }
             "clearContext" -> {
                 LlamaNative.clearContext()
@@ -157,7 +218,10 @@ class LlamaHandler(private val context: Context) {
                 val temperature = (call.argument<Double>("temperature") ?: 0.7).toFloat()
                 val topP = (call.argument<Double>("topP") ?: 0.9).toFloat()
                 val topK = call.argument<Int>("topK") ?: 40
-                generateAsync(prompt, maxTokens, temperature, topP, topK, result)
+                val loraAdapter = call.argument<String>("loraAdapter")
+                val loraScale = (call.argument<Double>("loraScale") ?: 1.0).toFloat()
+                val grammar = call.argument<String>("grammar")
+                generateAsync(prompt, maxTokens, temperature, topP, topK, grammar, loraAdapter, loraScale, result)
             }
             "generateStateless" -> {
                 val prompt = call.argument<String>("prompt") ?: ""
@@ -175,14 +239,158 @@ class LlamaHandler(private val context: Context) {
                     temperature = temperature,
                     topP = topP,
                     topK = topK,
+                    grammar = call.argument<String>("grammar"),
+                    loraAdapter = call.argument<String>("loraAdapter"),
+                    loraScale = (call.argument<Double>("loraScale") ?: 1.0).toFloat(),
+                    result = result
+                )
+            }
+            "runBenchmark" -> {
+                val modelPath = call.argument<String>("modelPath")
+                if (modelPath == null) {
+                    result.error("INVALID_ARGS", "Model path is required", null)
+                    return
+                }
+                runBenchmarkAsync(
+                    modelPath = modelPath,
+                    promptSizes = (call.argument<List<Int>>("promptSizes") ?: listOf(128, 512)).toIntArray(),
+                    genTokens = call.argument<Int>("genTokens") ?: 32,
+                    batchSizes = (call.argument<List<Int>>("batchSizes") ?: listOf(512)).toIntArray(),
+                    threadCounts = (call.argument<List<Int>>("threadCounts") ?: listOf(4)).toIntArray(),
+                    repetitions = call.argument<Int>("repetitions") ?: 3,
                     result = result
                 )
             }
+            "setThreads" -> {
+                val prefill = call.argument<Int>("prefill")
+                val decode = call.argument<Int>("decode")
+                if (prefill == null || decode == null || prefill < 1 || decode < 1) {
+                    result.error("INVALID_ARGS", "prefill and decode thread counts (>= 1) are required", null)
+                    return
+                }
+                // On the inference executor: it is the pinned thread and never mid-decode here.
+                executor.execute {
+                    val ok = LlamaNative.isLoaded() && LlamaNative.setThreads(prefill, decode)
+                    mainHandler.post {
+                        if (ok) result.success(true)
+                        else result.error("SET_THREADS_FAILED", "No model loaded", null)
+                    }
+                }
+            }
+            "loadAdapter" -> {
+                val adapterPath = call.argument<String>("adapterPath")
+                if (adapterPath == null) {
+                    result.error("INVALID_ARGS", "Adapter path is required", null)
+                    return
+                }
+                // Between requests on the inference executor: it mutates the engine.
+                executor.execute {
+                    val ok = LlamaNative.isLoaded() && LlamaNative.loadAdapter(adapterPath)
+                    mainHandler.post {
+                        if (ok) result.success(true)
+                        else result.error("ADAPTER_FAILED", "Failed to load LoRA adapter $adapterPath", null)
+                    }
+                }
+            }
+            "inspectModel" -> {
+                val modelPath = call.argument<String>("modelPath")
+                if (modelPath == null) {
+                    result.error("INVALID_ARGS", "Model path is required", null)
+                    return
+                }
+                inspectModelAsync(modelPath, result)
+            }
+            "convertModel" -> {
+                val modelPath = call.argument<String>("modelPath")
+                if (modelPath == null) {
+                    result.error("INVALID_ARGS", "Model path is required", null)
+                    return
+                }
+                convertModelAsync(modelPath, result)
+            }
+            "getWeightResidency" -> {
+                val residency = LlamaNative.getWeightResidency()
+                if (residency == null) {
+                    result.error("NOT_LOADED", "No model loaded", null)
+                } else {
+                    result.success(mapOf(
+                        "mappedBytes" to residency[0],
+                        "residentBytes" to residency[1],
+                        "lockedBytes" to residency[2]
+                    ))
+                }
+            }
+            "setThermalGovernor" -> {
+                val enabled = call.argument<Boolean>("enabled") ?: true
+                val target = call.argument<Double>("targetTokensPerSecond") ?: 0.0
+                executor.execute {
+                    thermalGovernorEnabled = enabled
+                    thermalGovernorTarget = target
+                    val ok = LlamaNative.setThermalGovernor(enabled, target)
+                    mainHandler.post {
+                        if (ok) result.success(true)
+                        else result.error("NOT_LOADED", "No model loaded", null)
+                    }
+                }
+            }
             else -> {
                 result.notImplemented()
             }
         }
     }
+
+    /**
+     * Native throughput benchmark (prompt processing, generation, time to first token).
+     *
+     * Runs on the inference executor so it never overlaps a generation; the native side
+     * loads its own context, leaving the chat KV cache intact.
+     */
+    private fun runBenchmarkAsync(
+        modelPath: String,
+        promptSizes: IntArray,
+        genTokens: Int,
+        batchSizes: IntArray,
+        threadCounts: IntArray,
+        repetitions: Int,
+        result: MethodChannel.Result
+    ) {
+        if (!File(modelPath).exists()) {
+            result.error("FILE_NOT_FOUND", "Model file not found: $modelPath", null)
+            return
+        }
+
+        executor.execute {
+            try {
+                val flat = LlamaNative.runBenchmark(
+                    modelPath, promptSizes, genTokens, batchSizes, threadCounts, repetitions
+                )
+                if (flat == null) {
+                    mainHandler.post { result.error("BENCHMARK_FAILED", "Native benchmark failed", null) }
+                    return@execute
+                }
+
+                val stride = LlamaNative.BENCH_ROW_STRIDE
+                val rows = (0 until flat.size / stride).map { i ->
+                    val o = i * stride
+                    mapOf(
+                        "nPrompt" to flat[o].toInt(),
+                        "nGen" to flat[o + 1].toInt(),
+                        "nBatch" to flat[o + 2].toInt(),
+                        "nThreads" to flat[o + 3].toInt(),
+                        "ppTokensPerSecond" to flat[o + 4],
+                        "ppStdDev" to flat[o + 5],
+                        "tgTokensPerSecond" to flat[o + 6],
+                        "tgStdDev" to flat[o + 7],
+                        "ttftMs" to flat[o + 8]
+                    )
+                }
+                mainHandler.post { result.success(rows) }
+            } catch (e: Exception) {
+                android.util.Log.e("LlamaHandler", "Benchmark failed", e)
+                mainHandler.post { result.error("BENCHMARK_EXCEPTION", e.message, e.stackTraceToString()) }
+            }
+        }
+    }
     
     /**
      * Stateless generation that does NOT pollute the chat KV cache.
@@ -200,6 +408,9 @@ class LlamaHandler(private val context: Context) {
         temperature: Float,
         topP: Float,
         topK: Int,
+        grammar: String?,
+        loraAdapter: String?,
+        loraScale: Float,
         result: MethodChannel.Result
     ) {
         executor.execute {
@@ -214,12 +425,24 @@ class LlamaHandler(private val context: Context) {
             val snapshotLanguage = conversationLanguage
             val snapshotPendingLang = pendingAssistantLanguage
             val snapshotPendingMsgs = pendingMessages
+            // Set as the chat's KV cache is cleared; requests rejected before that leave
+            // nothing to restore.
+            var contextCleared = false
 
             try {
                 // Reset sampler with request params
-                LlamaNative.resetSampler(temperature, topP, topK)
+                if (!LlamaNative.resetSampler(temperature, topP, topK, grammar)) {
+                    mainHandler.post { result.error("GRAMMAR_INVALID", "Sampling grammar does not parse", null) }
+                    return@execute
+                }
+                if (!selectAdapter(loraAdapter, loraScale, refillConversation = false)) {
+                    mainHandler.post { result.error("ADAPTER_FAILED", "Failed to apply LoRA adapter $loraAdapter", null) }
+                    return@execute
+                }
+                LlamaNative.beginRequestMetrics()
 
                 // Isolated prompt buffer (ChatML)
+                contextCleared = true
                 LlamaNative.clearContext()
                 val iso = StringBuilder()
                 iso.append("<|im_start|>system\n")
@@ -241,7 +464,6 @@ class LlamaHandler(private val context: Context) {
                     return@execute
                 }
 
-                val eosToken = LlamaNative.getEosToken()
                 val generated = StringBuilder()
                 var count = 0
 
@@ -249,8 +471,7 @@ class LlamaHandler(private val context: Context) {
                     val token = LlamaNative.sample()
                     if (token < 0) break
 
-                    val isEos = token == eosToken || token == 151643 || token == 151645
-                    if (isEos) break
+                    if (LlamaNative.isEog(token)) break
 
                     val tokenStr = LlamaNative.tokenToString(token)
                     generated.append(tokenStr)
@@ -271,12 +492,15 @@ class LlamaHandler(private val context: Context) {
                     count++
                 }
 
+                // Collect before the finally block re-decodes the chat snapshot.
+                val metrics = collectRequestMetrics()
                 mainHandler.post {
                     result.success(
                         mapOf(
                             "text" to generated.toString(),
                             "tokenCount" to count,
-                            "promptTokens" to tokens.size
+                            "promptTokens" to tokens.size,
+                            "metrics" to metrics
                         )
                     )
                 }
@@ -285,37 +509,104 @@ class LlamaHandler(private val context: Context) {
                 mainHandler.post { result.error("GENERATE_STATELESS_FAILED", e.message, e.stackTraceToString()) }
             } finally {
                 // Restore chat state (buffer + KV cache) so translation never affects conversation memory.
-                try {
-                    conversationBuffer.clear()
-                    conversationBuffer.append(snapshotBuffer)
-                    conversationInitialized = snapshotInitialized
-                    conversationLanguage = snapshotLanguage
-                    pendingAssistantLanguage = snapshotPendingLang
-                    pendingMessages = snapshotPendingMsgs
+                if (contextCleared) {
+                    try {
+                        conversationBuffer.clear()
+                        conversationBuffer.append(snapshotBuffer)
+                        conversationInitialized = snapshotInitialized
+                        conversationLanguage = snapshotLanguage
+                        pendingAssistantLanguage = snapshotPendingLang
+                        pendingMessages = snapshotPendingMsgs
 
-                    LlamaNative.clearContext()
-                    if (snapshotInitialized && snapshotBuffer.isNotBlank()) {
-                        val restoreTokens = LlamaNative.tokenize(snapshotBuffer, true)
-                        if (restoreTokens != null) {
-                            val restoreRes = LlamaNative.decode(restoreTokens)
-                            if (restoreRes != 0) {
-                                android.util.Log.w("LlamaHandler", "Restore decode failed: $restoreRes")
+                        // The chat's KV cache is rebuilt under the chat's own adapter.
+                        LlamaNative.setAdapter(chatAdapter, chatAdapterScale)
+                        LlamaNative.clearContext()
+                        if (snapshotInitialized && snapshotBuffer.isNotBlank()) {
+                            val restoreTokens = LlamaNative.tokenize(snapshotBuffer, true)
+                            if (restoreTokens != null) {
+                                val restoreRes = LlamaNative.decode(restoreTokens)
+                                if (restoreRes != 0) {
+                                    android.util.Log.w("LlamaHandler", "Restore decode failed: $restoreRes")
+                                }
+                            } else {
+                                android.util.Log.w("LlamaHandler", "Restore tokenize failed")
                             }
-                        } else {
-                            android.util.Log.w("LlamaHandler", "Restore tokenize failed")
                         }
+                    } catch (e: Exception) {
+                        android.util.Log.w("LlamaHandler", "Failed to restore chat state after stateless generation: ${e.message}")
                     }
-                } catch (e: Exception) {
-                    android.util.Log.w("LlamaHandler", "Failed to restore chat state after stateless generation: ${e.message}")
                 }
             }
         }
     }
 
+    /**
+     * Applies a request's LoRA adapter (null = base model). Adapters are loaded against
+     * the shared base weights once and then only switched, but a switch clears the KV
+     * cache; with [refillConversation] the running chat is prefilled again under the new
+     * adapter so it keeps its memory.
+     * @return false if the adapter could not be loaded or applied
+     */
+    private fun selectAdapter(adapterPath: String?, scale: Float, refillConversation: Boolean): Boolean {
+        val status = LlamaNative.setAdapter(adapterPath, scale)
+        if (status == LlamaNative.ADAPTER_FAILED) return false
+        if (status == LlamaNative.ADAPTER_SWITCHED && refillConversation &&
+            conversationInitialized && conversationBuffer.isNotBlank()
+        ) {
+            val tokens = LlamaNative.tokenize(conversationBuffer.toString(), true)
+            if (tokens == null || LlamaNative.decode(tokens) != 0) {
+                android.util.Log.w("LlamaHandler", "Conversation refill after adapter switch failed; starting over")
+                LlamaNative.clearContext()
+                conversationBuffer.clear()
+                conversationInitialized = false
+            }
+        }
+        return true
+    }
+
+    /**
+     * Ends the current request's native timing and converts it for the platform channel.
+     * Returns an empty map if the native call fails.
+     */
+    private fun collectRequestMetrics(): Map<String, Any> {
+        val m = LlamaNative.endRequestMetrics()
+        if (m == null || m.size < LlamaNative.REQUEST_METRICS_SIZE) return emptyMap()
+        android.util.Log.i(
+            "LlamaHandler",
+            "Request metrics: prefill ${m[1].toInt()} tok ${"%.1f".format(m[2])}ms, " +
+                "decode ${m[3].toInt()} tok p50 ${"%.1f".format(m[4])}ms p99 ${"%.1f".format(m[6])}ms, " +
+                "kv ${m[9].toInt()}/${m[10].toInt()}"
+        )
+        return mapOf(
+            "tokenizeMs" to m[0],
+            "promptTokens" to m[1].toInt(),
+            "prefillMs" to m[2],
+            "decodeTokens" to m[3].toInt(),
+            "decodeP50Ms" to m[4],
+            "decodeP95Ms" to m[5],
+            "decodeP99Ms" to m[6],
+            "sampleMs" to m[7],
+            "detokenizeMs" to m[8],
+            "kvUsed" to m[9].toInt(),
+            "kvSize" to m[10].toInt(),
+            "peakRssBytes" to m[11].toLong()
+        )
+    }
+
     private fun loadModelAsync(
         modelPath: String,
         contextSize: Int,
         threads: Int,
+        batchSize: Int,
+        ubatchSize: Int,
+        flashAttn: Boolean,
+        cacheTypeK: String,
+        cacheTypeV: String,
+        prefetch: Boolean,
+        lockHotWeights: Boolean,
+        useConverted: Boolean,
+        warmup: Boolean,
+        hotSwap: Boolean,
         result: MethodChannel.Result
     ) {
         val file = File(modelPath)
@@ -326,56 +617,272 @@ class LlamaHandler(private val context: Context) {
         
         val fileSize = file.length()
         android.util.Log.i("LlamaHandler", "Loading model: $modelPath (${fileSize / 1024 / 1024}MB)")
-        
-        executor.execute {
+
+        // Whole percents only: the native side reports per tensor and per
+        // prefetched piece, far more often than the UI can show.
+        var lastPercent = -1
+        val progress = LoadProgressCallback { p ->
+            val percent = (p * 100).toInt()
+            if (percent != lastPercent) {
+                lastPercent = percent
+                emit(mapOf("type" to "loadProgress", "progress" to p.toDouble()))
+            }
+        }
+
+        val coldLoad = Runnable {
             try {
                 val startTime = System.currentTimeMillis()
-                
-                val success = LlamaNative.loadModel(modelPath, contextSize, threads)
-                
-                val elapsed = System.currentTimeMillis() - startTime
-                android.util.Log.i("LlamaHandler", "Model loading completed in ${elapsed}ms, success=$success")
-                
+                val success = LlamaNative.loadModel(
+                    modelPath, contextSize, if (threads > 0) threads else 4,
+                    batchSize, ubatchSize, flashAttn, cacheTypeK, cacheTypeV,
+                    prefetch, lockHotWeights, useConverted, progress
+                )
+                finishLoad(success, startTime, fileSize, threads, warmup, result)
+            } catch (e: Exception) {
+                android.util.Log.e("LlamaHandler", "Model loading failed", e)
                 mainHandler.post {
-                    if (success) {
-                        // Reset conversation state when model changes
-                        conversationBuffer.clear()
-                        conversationInitialized = false
+                    result.error("LOAD_EXCEPTION", e.message, e.stackTraceToString())
+                }
+            }
+        }
+
+        if (!hotSwap || !LlamaNative.isLoaded()) {
+            executor.execute(coldLoad)
+            return
+        }
 
-                        // Apply any pending conversation (language + messages) captured before load.
-                        // This ensures the system prompt uses the correct target language even if
-                        // the user changed it on the loading screen.
+        // Hot swap: the current model keeps serving on [executor] while the next one loads
+        // and warms up on [preloadExecutor]; the swap itself queues behind any running request.
+        preloadExecutor.execute {
+            try {
+                val startTime = System.currentTimeMillis()
+                val status = LlamaNative.preloadModel(
+                    modelPath, contextSize, if (threads > 0) threads else 4,
+                    batchSize, ubatchSize, flashAttn, cacheTypeK, cacheTypeV,
+                    prefetch, lockHotWeights, useConverted, progress
+                )
+                when (status) {
+                    LlamaNative.PRELOAD_OK -> executor.execute {
                         try {
-                            applyPendingConversationIfAny()
+                            val success = LlamaNative.swapPreloadedModel()
+                            // Warmed up during the preload; no second pass on the executor.
+                            finishLoad(success, startTime, fileSize, threads, false, result)
                         } catch (e: Exception) {
-                            android.util.Log.w("LlamaHandler", "Failed to apply pending conversation: ${e.message}")
+                            android.util.Log.e("LlamaHandler", "Model swap failed", e)
+                            mainHandler.post {
+                                result.error("LOAD_EXCEPTION", e.message, e.stackTraceToString())
+                            }
                         }
-
-                        result.success(mapOf(
-                            "success" to true,
-                            "contextSize" to LlamaNative.getContextSize(),
-                            "loadTimeMs" to elapsed,
-                            "fileSizeBytes" to fileSize
-                        ))
-                    } else {
+                    }
+                    LlamaNative.PRELOAD_NO_MEMORY -> {
+                        android.util.Log.i("LlamaHandler", "Both models do not fit in memory, unloading first")
+                        executor.execute(coldLoad)
+                    }
+                    LlamaNative.PRELOAD_DISCARDED -> mainHandler.post {
+                        // Superseded by a newer load or the handler is shutting down.
+                        result.error("LOAD_DISCARDED", "Model load was superseded", null)
+                    }
+                    else -> mainHandler.post {
+                        // The previous model is still loaded and serving.
                         result.error("LOAD_FAILED", "Failed to load model", null)
                     }
                 }
             } catch (e: Exception) {
-                android.util.Log.e("LlamaHandler", "Model loading failed", e)
+                android.util.Log.e("LlamaHandler", "Model preload failed", e)
+                LlamaNative.discardPreloadedModel()
                 mainHandler.post {
                     result.error("LOAD_EXCEPTION", e.message, e.stackTraceToString())
                 }
             }
         }
     }
+
+    /**
+     * Post-load setup on [executor] once [success]ful: thread pinning, governor, warm-up;
+     * then reports the result. Shared by the cold load and the hot swap.
+     */
+    private fun finishLoad(
+        success: Boolean,
+        startTime: Long,
+        fileSize: Long,
+        threads: Int,
+        warmup: Boolean,
+        result: MethodChannel.Result
+    ) {
+        // The native load starts unpressured; re-apply what the OS last reported.
+        if (success && memoryPressure != LlamaNative.PRESSURE_NONE) {
+            LlamaNative.setMemoryPressure(memoryPressure)
+        }
+        
+        val elapsed = System.currentTimeMillis() - startTime
+        android.util.Log.i("LlamaHandler", "Model loading completed in ${elapsed}ms, success=$success")
+
+        val threadConfig = if (success) configureThreads(threads) else intArrayOf(0, 0)
+        // Off unless Dart enabled it via setThermalGovernor.
+        if (success && thermalGovernorEnabled) {
+            LlamaNative.setThermalGovernor(true, thermalGovernorTarget)
+        }
+        // After configureThreads: the warm-up also starts the pinned threadpool.
+        val warmupStats = if (success && warmup) LlamaNative.warmup() else null
+        warmupStats?.let {
+            android.util.Log.i(
+                "LlamaHandler",
+                "Warm-up: ${it[0].toInt()} tokens in ${it[1].toLong()}ms, decode ${it[2].toLong()}ms"
+            )
+        }
+        val memory = if (success) LlamaNative.getMemoryEstimate() else null
+
+        // Still on the executor: the conversation state belongs to it, and applying the
+        // pending conversation clears the KV cache and decodes the prompt.
+        if (success) {
+            // Reset conversation state when model changes
+            conversationBuffer.clear()
+            conversationInitialized = false
+            // Adapters belong to the previous model.
+            chatAdapter = null
+
+            // Apply any pending conversation (language + messages) captured before load.
+            // This ensures the system prompt uses the correct target language even if
+            // the user changed it on the loading screen.
+            try {
+                applyPendingConversationIfAny()
+            } catch (e: Exception) {
+                android.util.Log.w("LlamaHandler", "Failed to apply pending conversation: ${e.message}")
+            }
+        }
+        val contextSize = if (success) LlamaNative.getContextSize() else 0
+        // A converted copy may have replaced the requested file; report the one serving.
+        val loadedPath = if (success) LlamaNative.getModelPath() else null
+        val loadedSize = loadedPath?.let { File(it).length() } ?: fileSize
+
+        mainHandler.post {
+            if (success) {
+                result.success(mapOf(
+                    "success" to true,
+                    "contextSize" to contextSize,
+                    "loadTimeMs" to elapsed,
+                    "modelPath" to loadedPath,
+                    "fileSizeBytes" to loadedSize,
+                    "threads" to threadConfig[0],
+                    "threadsBatch" to threadConfig[1],
+                    "cpuVariant" to (GgmlLoader.loadedVariant ?: "unknown"),
+                    "warmupMs" to warmupStats?.let { (it[1] + it[2]).toLong() },
+                    "memory" to memory?.let {
+                        mapOf(
+                            "weightsBytes" to it[0],
+                            "kvCacheBytes" to it[1],
+                            "computeBytes" to it[2]
+                        )
+                    }
+                ))
+            } else {
+                result.error("LOAD_FAILED", "Failed to load model", null)
+            }
+        }
+    }
     
+    /**
+     * Choose decode/prefill thread counts for the model just loaded and pin them to the
+     * performance cores. Runs on [executor], which every later inference call shares.
+     *
+     * - [requested] > 0: explicit user setting, used for both phases.
+     * - otherwise: the calibration cached for this device, or a fresh one (1-3 s, once).
+     *
+     * @return [decode threads, prefill threads]
+     */
+    private fun configureThreads(requested: Int): IntArray {
+        if (requested > 0) {
+            LlamaNative.applyThreadConfig(requested, requested, true)
+            return intArrayOf(requested, requested)
+        }
+
+        val prefs = context.getSharedPreferences(THREAD_PREFS, Context.MODE_PRIVATE)
+        val key = "tuning:${Build.FINGERPRINT}"
+        val cached = prefs.getString(key, null)
+            ?.split(",")
+            ?.mapNotNull { it.toIntOrNull() }
+            ?.takeIf { it.size == 2 }
+        if (cached != null && LlamaNative.applyThreadConfig(cached[0], cached[1], true)) {
+            android.util.Log.i("LlamaHandler", "Using cached thread tuning: decode=${cached[0]}, prefill=${cached[1]}")
+            return cached.toIntArray()
+        }
+
+        val tuned = LlamaNative.autoTuneThreads()
+        if (tuned != null && tuned.size == 2) {
+            prefs.edit().putString(key, "${tuned[0]},${tuned[1]}").apply()
+            android.util.Log.i("LlamaHandler", "Thread tuning: decode=${tuned[0]}, prefill=${tuned[1]}")
+            return tuned
+        }
+
+        val fallback = LlamaNative.getPerformanceCores()?.size?.takeIf { it > 0 } ?: 4
+        android.util.Log.w("LlamaHandler", "Thread tuning failed, using $fallback threads")
+        LlamaNative.applyThreadConfig(fallback, fallback, true)
+        return intArrayOf(fallback, fallback)
+    }
+
+    private fun inspectModelAsync(modelPath: String, result: MethodChannel.Result) {
+        inspectExecutor.execute {
+            val info = try {
+                LlamaNative.inspectModel(modelPath)
+            } catch (e: Exception) {
+                android.util.Log.e("LlamaHandler", "Model inspection failed", e)
+                null
+            }
+            val numbers = info?.get(2) as? LongArray
+            mainHandler.post {
+                if (info == null || numbers == null || numbers.size < LlamaNative.INSPECT_NUMBERS_SIZE) {
+                    result.error("INVALID_MODEL", "Cannot read GGUF header: $modelPath", null)
+                    return@post
+                }
+                @Suppress("UNCHECKED_CAST")
+                val typeNames = info[3] as Array<String>
+                val typeBytes = info[4] as LongArray
+                result.success(mapOf(
+                    "architecture" to info[0] as String,
+                    "name" to info[1] as String,
+                    "parameterCount" to numbers[0],
+                    "weightsBytes" to numbers[1],
+                    "contextLength" to numbers[2].toInt(),
+                    "vocabSize" to numbers[3].toInt(),
+                    "layerCount" to numbers[4].toInt(),
+                    "embeddingLength" to numbers[5].toInt(),
+                    "headCount" to numbers[6].toInt(),
+                    "headCountKv" to numbers[7].toInt(),
+                    "kvBytesPerToken" to numbers[8],
+                    "tensorTypeBytes" to typeNames.indices.associate { typeNames[it] to typeBytes[it] }
+                ))
+            }
+        }
+    }
+
+    private fun convertModelAsync(modelPath: String, result: MethodChannel.Result) {
+        convertExecutor.execute {
+            // Leave most cores to generation when a model is serving meanwhile.
+            val cores = LlamaNative.getPerformanceCores()?.size?.takeIf { it > 0 } ?: 4
+            val threads = if (LlamaNative.isLoaded()) minOf(2, cores) else cores
+            val out = try {
+                LlamaNative.convertModel(modelPath, threads)
+            } catch (e: Exception) {
+                android.util.Log.e("LlamaHandler", "Model conversion failed", e)
+                null
+            }
+            mainHandler.post {
+                if (out == null || out.size < 2 || out[0] == "failed") {
+                    result.error("CONVERT_FAILED", "Cannot convert model: $modelPath", null)
+                    return@post
+                }
+                result.success(mapOf("status" to out[0], "path" to out[1]))
+            }
+        }
+    }
+
     private fun unloadModelAsync(result: MethodChannel.Result) {
         executor.execute {
             try {
                 LlamaNative.unloadModel()
                 conversationBuffer.clear()
                 conversationInitialized = false
+                chatAdapter = null
                 // Keep pending state cleared when explicitly unloading a model.
                 pendingAssistantLanguage = null
                 pendingMessages = emptyList()
@@ -445,12 +952,29 @@ class LlamaHandler(private val context: Context) {
         temperature: Float,
         topP: Float,
         topK: Int,
+        grammar: String?,
+        loraAdapter: String?,
+        loraScale: Float,
         result: MethodChannel.Result
     ) {
         executor.execute {
             try {
                 // Reset sampler with generation params
-                LlamaNative.resetSampler(temperature, topP, topK)
+                if (!LlamaNative.resetSampler(temperature, topP, topK, grammar)) {
+                    mainHandler.post {
+                        result.error("GRAMMAR_INVALID", "Sampling grammar does not parse", null)
+                    }
+                    return@execute
+                }
+                if (!selectAdapter(loraAdapter, loraScale, refillConversation = true)) {
+                    mainHandler.post {
+                        result.error("ADAPTER_FAILED", "Failed to apply LoRA adapter $loraAdapter", null)
+                    }
+                    return@execute
+                }
+                chatAdapter = loraAdapter
+                chatAdapterScale = loraScale
+                LlamaNative.beginRequestMetrics()
 
                 android.util.Log.i(
                     "LlamaHandler",
@@ -516,12 +1040,9 @@ class LlamaHandler(private val context: Context) {
                         break
                     }
                     
-                    // Check for various EOS tokens
-                    // Qwen2.5: 151643 (<|endoftext|>), 151645 (<|im_end|>)
-                    val isEos = token == eosToken || token == 151643 || token == 151645
-                    
-                    if (isEos) {
-                        android.util.Log.i("LlamaHandler", "Hit EOS token $token at $count")
+                    // EOS or an end-of-turn token of the model's vocab
+                    if (LlamaNative.isEog(token)) {
+                        android.util.Log.i("LlamaHandler", "Hit end-of-generation token $token at $count")
                         break
                     }
                     
@@ -543,12 +1064,14 @@ class LlamaHandler(private val context: Context) {
 
                 // Persist assistant output into the running conversation buffer
                 conversationBuffer.append(generated.toString()).append("\\n<|im_end|>\\n")
+                val metrics = collectRequestMetrics()
                 
                 mainHandler.post {
                     result.success(mapOf(
                         "text" to generated.toString(),
                         "tokenCount" to count,
-                        "promptTokens" to tokens.size
+                        "promptTokens" to tokens.size,
+                        "metrics" to metrics
                     ))
                 }
             } catch (e: Exception) {
@@ -561,12 +1084,75 @@ class LlamaHandler(private val context: Context) {
     }
     
     fun destroy() {
+        inspectExecutor.shutdownNow()
+        convertExecutor.shutdownNow()
+        preloadExecutor.shutdownNow()
         executor.execute {
+            LlamaNative.discardPreloadedModel()
             LlamaNative.unloadModel()
         }
         executor.shutdown()
     }
 
+    /**
+     * Forwarded from the activity's onTrimMemory. Weight locks are dropped right away on
+     * the calling thread (munlock is cheap and the native side is thread-safe), so a
+     * running generation does not hold pinned memory while the system reclaims.
+     */
+    fun onTrimMemory(level: Int) {
+        val pressure = when {
+            level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL ||
+                level >= ComponentCallbacks2.TRIM_MEMORY_MODERATE -> LlamaNative.PRESSURE_CRITICAL
+            level == ComponentCallbacks2.TRIM_MEMORY_UI_HIDDEN -> return
+            else -> LlamaNative.PRESSURE_MODERATE
+        }
+        if (pressure > memoryPressure) {
+            android.util.Log.i("LlamaHandler", "onTrimMemory($level): memory pressure $pressure")
+            memoryPressure = pressure
+            LlamaNative.setMemoryPressure(pressure)
+        }
+    }
+
+    /**
+     * Low-memory state observed by MemoryHandler. Entering it counts as moderate pressure;
+     * leaving it relocks hot weights, on the executor since mlock may fault them in.
+     */
+    fun onLowMemoryState(lowMemory: Boolean) {
+        if (lowMemory) {
+            if (memoryPressure < LlamaNative.PRESSURE_MODERATE) {
+                memoryPressure = LlamaNative.PRESSURE_MODERATE
+                LlamaNative.setMemoryPressure(LlamaNative.PRESSURE_MODERATE)
+            }
+        } else if (memoryPressure != LlamaNative.PRESSURE_NONE) {
+            memoryPressure = LlamaNative.PRESSURE_NONE
+            executor.execute { LlamaNative.setMemoryPressure(LlamaNative.PRESSURE_NONE) }
+        }
+    }
+
+    override fun onListen(arguments: Any?, events: EventChannel.EventSink?) {
+        eventSink = events
+    }
+
+    override fun onCancel(arguments: Any?) {
+        eventSink = null
+    }
+
+    /** EventChannel emissions must happen on the main thread. */
+    private fun emit(event: Map<String, Any>) {
+        mainHandler.post {
+            eventSink?.success(event)
+        }
+    }
+
+    @Keep
+    private class LoadProgressCallback(private val onProgressCb: (Float) -> Unit) {
+        /** Called from native on the loading thread. */
+        @Suppress("unused")
+        fun onProgress(progress: Float) {
+            onProgressCb(progress)
+        }
+    }
+
     private fun setConversationAsync(
         assistantLanguage: String,
         messages: List<Map<String, Any?>>,
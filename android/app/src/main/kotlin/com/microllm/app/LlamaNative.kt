@@ -10,6 +10,9 @@ object LlamaNative {
     
     init {
         try {
+            // libggml.so is the ggml runtime shared by libllama and libwhisper; the
+            // loader picks the dotprod/i8mm build when the CPU supports it.
+            GgmlLoader.load()
             System.loadLibrary("llama")
             android.util.Log.i("LlamaNative", "Loaded libllama.so")
         } catch (e: UnsatisfiedLinkError) {
@@ -25,10 +28,148 @@ object LlamaNative {
 
     /**
      * Load a model from the given path.
+     * @param batchSize most tokens per decode call (n_batch)
+     * @param ubatchSize tokens per compute step (n_ubatch, <= [batchSize]); 0 sizes it from
+     *   available memory and tunes the prefill chunk size on measured throughput
+     * @param flashAttn fused attention kernel; forced on when [cacheTypeV] is quantized
+     * @param cacheTypeK KV cache key type: "f16", "q8_0" or "q4_0"
+     * @param cacheTypeV KV cache value type: "f16", "q8_0" or "q4_0"
+     * @param prefetch read the weights into the page cache in forward-pass order before
+     *   returning, so the first prompt does not page-fault them in from flash
+     * @param lockHotWeights mlock the output head, attention and embedding weights within
+     *   half of the free memory; released again under [setMemoryPressure]
+     * @param useConverted load the [convertModel] copy of [modelPath] instead when an
+     *   up-to-date one exists; [getModelPath] reports which file was loaded
+     * @param progressCallback object with `fun onProgress(progress: Float)`, called on the
+     *   loading thread with the overall progress 0..1; may be null
      * @return true on success, false on failure
      */
     @JvmStatic
-    external fun loadModel(modelPath: String, contextSize: Int, threads: Int): Boolean
+    external fun loadModel(
+        modelPath: String,
+        contextSize: Int,
+        threads: Int,
+        batchSize: Int,
+        ubatchSize: Int,
+        flashAttn: Boolean,
+        cacheTypeK: String,
+        cacheTypeV: String,
+        prefetch: Boolean,
+        lockHotWeights: Boolean,
+        useConverted: Boolean,
+        progressCallback: Any?
+    ): Boolean
+
+    /**
+     * Load the next model (same parameters as [loadModel]) into a staging slot while the
+     * current one keeps serving, including the warm-up. Blocks; call it off the inference
+     * executor. Replaces a model staged earlier.
+     * @return [PRELOAD_OK]; [PRELOAD_NO_MEMORY] without loading if the two models would
+     *   not fit in memory together; [PRELOAD_FAILED] if the load fails;
+     *   [PRELOAD_DISCARDED] if [discardPreloadedModel] or another preload ran meanwhile,
+     *   in which case the loaded model has already been freed
+     */
+    @JvmStatic
+    external fun preloadModel(
+        modelPath: String,
+        contextSize: Int,
+        threads: Int,
+        batchSize: Int,
+        ubatchSize: Int,
+        flashAttn: Boolean,
+        cacheTypeK: String,
+        cacheTypeV: String,
+        prefetch: Boolean,
+        lockHotWeights: Boolean,
+        useConverted: Boolean,
+        progressCallback: Any?
+    ): Int
+
+    const val PRELOAD_OK = 0
+    const val PRELOAD_NO_MEMORY = 1
+    const val PRELOAD_FAILED = 2
+    const val PRELOAD_DISCARDED = 3
+
+    /**
+     * Make the preloaded model the serving one and free the previous model. Call on the
+     * inference executor between requests.
+     * @return false if nothing was preloaded
+     */
+    @JvmStatic
+    external fun swapPreloadedModel(): Boolean
+
+    /**
+     * Free a preloaded model that will not be swapped in. Returns at once even while
+     * [preloadModel] is loading; that load then frees its model instead of staging it.
+     */
+    @JvmStatic
+    external fun discardPreloadedModel()
+
+    /**
+     * Runs one full-ubatch dummy prefill and one decode step, then clears the KV cache,
+     * so the first real prompt does not pay for graph setup, buffer first-touch and
+     * thread start-up. Call after the thread configuration is final.
+     *
+     * Layout: [prefillTokens, prefillMs, decodeMs], or null if no model is loaded.
+     */
+    @JvmStatic
+    external fun warmup(): DoubleArray?
+
+    /**
+     * Memory pressure from the OS: [PRESSURE_NONE], [PRESSURE_MODERATE] (keep only the
+     * output head locked) or [PRESSURE_CRITICAL] (no locks). Returning to none relocks
+     * hot weights if the model was loaded with lockHotWeights. Safe from any thread;
+     * dropping locks is cheap, relocking may fault weights in.
+     */
+    @JvmStatic
+    external fun setMemoryPressure(level: Int)
+
+    /**
+     * Residency of the loaded weights, or null if none are loaded.
+     *
+     * Layout: [mappedBytes, residentBytes, lockedBytes].
+     */
+    @JvmStatic
+    external fun getWeightResidency(): LongArray?
+
+    const val PRESSURE_NONE = 0
+    const val PRESSURE_MODERATE = 1
+    const val PRESSURE_CRITICAL = 2
+
+    /**
+     * Memory estimate for the loaded model and context, or null if none is loaded.
+     *
+     * Layout: [weightsBytes, kvCacheBytes, computeBytes].
+     */
+    @JvmStatic
+    external fun getMemoryEstimate(): LongArray?
+
+    /**
+     * Read a model's GGUF header without loading it (milliseconds). Safe from any
+     * thread. Null if the file is not readable GGUF.
+     *
+     * Layout: [architecture: String, name: String, numbers: LongArray,
+     * typeNames: Array<String>, typeBytes: LongArray]. numbers is
+     * [params, weightsBytes, contextLength, vocabSize, layers, embeddingLength,
+     * heads, kvHeads, kvBytesPerToken (f16)]; the type arrays give the bytes stored
+     * per ggml type, largest first.
+     */
+    @JvmStatic
+    external fun inspectModel(modelPath: String): Array<Any>?
+
+    const val INSPECT_NUMBERS_SIZE = 9
+
+    /**
+     * Rewrite a Q4_K model as Q4_0, the type this CPU's interleaved dotprod/i8mm kernels
+     * repack at load, and cache it beside the original ("<name>.repack.gguf"). Later
+     * [loadModel]/[preloadModel] calls with [modelPath] and useConverted load the cached
+     * copy. Takes minutes for large models; call off the inference executor.
+     *
+     * Layout: [status, path] where status is "converted", "cached", "notNeeded" (no
+     * dotprod, or the model is not Q4_K) or "failed", and path is the file loads will use.
+     */
+    @JvmStatic
+    external fun convertModel(modelPath: String, threads: Int): Array<String>?
 
     /**
      * Unload the current model and free all resources.
@@ -42,6 +183,13 @@ object LlamaNative {
     @JvmStatic
     external fun isLoaded(): Boolean
 
+    /**
+     * The file the loaded model came from (the converted copy if useConverted picked one),
+     * or null if no model is loaded.
+     */
+    @JvmStatic
+    external fun getModelPath(): String?
+
     /**
      * Tokenize text into token IDs.
      * @return array of token IDs, or null on failure
@@ -75,6 +223,14 @@ object LlamaNative {
     @JvmStatic
     external fun getEosToken(): Int
 
+    /**
+     * Whether [token] ends generation: the EOS token or any end-of-turn token of the
+     * loaded vocab (e.g. Llama 3's <|eot_id|>, Gemma's <end_of_turn>), which chat models
+     * emit instead of EOS. Generation loops stop on this.
+     */
+    @JvmStatic
+    external fun isEog(token: Int): Boolean
+
     /**
      * Get the context size of the loaded model.
      */
@@ -82,14 +238,120 @@ object LlamaNative {
     external fun getContextSize(): Int
 
     /**
-     * Reset the sampler with new parameters.
+     * Reset the sampler with new parameters. A GBNF [grammar] (start rule "root")
+     * constrains generation to it, e.g. to one JSON object; null samples freely. Call on
+     * the inference executor: the sampler is shared with [sample].
+     * @return false if the grammar does not parse (sampling is then unconstrained)
      */
     @JvmStatic
-    external fun resetSampler(temperature: Float, topP: Float, topK: Int)
+    external fun resetSampler(temperature: Float, topP: Float, topK: Int, grammar: String?): Boolean
 
     /**
      * Clear the KV cache for a new conversation.
      */
     @JvmStatic
     external fun clearContext()
+
+    /**
+     * Load a LoRA adapter against the loaded model without activating it; adapters stay
+     * loaded (base weights shared) until the model is unloaded or swapped.
+     * @return false if the adapter does not match the model
+     */
+    @JvmStatic
+    external fun loadAdapter(adapterPath: String): Boolean
+
+    /**
+     * Select the LoRA adapter for the next request, or the base model for null. Loads it
+     * on first use; switching clears the KV cache.
+     * @return one of the ADAPTER_* constants
+     */
+    @JvmStatic
+    external fun setAdapter(adapterPath: String?, scale: Float): Int
+
+    const val ADAPTER_UNCHANGED = 0
+    const val ADAPTER_SWITCHED = 1
+    const val ADAPTER_FAILED = 2
+
+    /**
+     * Ids of the cores above the slowest cluster (all cores on homogeneous SoCs),
+     * from cpufreq in sysfs.
+     */
+    @JvmStatic
+    external fun getPerformanceCores(): IntArray?
+
+    /**
+     * Set decode ([nThreads]) and prefill ([nThreadsBatch]) thread counts without reloading.
+     * With [pinToPerformanceCores] the calling thread and the inference workers are
+     * restricted to [getPerformanceCores]; later calls must come from the same thread.
+     */
+    @JvmStatic
+    external fun applyThreadConfig(nThreads: Int, nThreadsBatch: Int, pinToPerformanceCores: Boolean): Boolean
+
+    /**
+     * Change prefill and decode thread counts between decodes, keeping the model, the KV
+     * cache and the current core pinning. Call from the inference thread.
+     */
+    @JvmStatic
+    external fun setThreads(prefillThreads: Int, decodeThreads: Int): Boolean
+
+    /**
+     * Enable or disable thermal/battery pacing of token generation. While enabled, each
+     * generated token may lower the decode thread count or add a short pause to hold a
+     * sustainable rate. [targetTokensPerSecond] <= 0 derives the target from the rate
+     * measured while the device is cool. Uses the current decode thread count as the cap.
+     */
+    @JvmStatic
+    external fun setThermalGovernor(enabled: Boolean, targetTokensPerSecond: Double): Boolean
+
+    /**
+     * Calibrate decode and prefill thread counts on the performance cores with a short
+     * run on the loaded model (clears the KV cache) and apply the fastest.
+     * @return [nThreads, nThreadsBatch], or null on failure
+     */
+    @JvmStatic
+    external fun autoTuneThreads(): IntArray?
+
+    /**
+     * Start timing the tokenize/decode/sample/detokenize calls of one generation request.
+     * The first [decode] that follows counts as prefill.
+     */
+    @JvmStatic
+    external fun beginRequestMetrics()
+
+    /**
+     * Number of values returned by [endRequestMetrics]:
+     * tokenizeMs, promptTokens, prefillMs, decodeTokens, decodeP50Ms, decodeP95Ms,
+     * decodeP99Ms, sampleMs, detokenizeMs, kvUsed, kvSize, peakRssBytes.
+     */
+    const val REQUEST_METRICS_SIZE = 12
+
+    /**
+     * Stop timing and return the metrics collected since [beginRequestMetrics].
+     * @return [REQUEST_METRICS_SIZE] values, or null if the array cannot be allocated
+     */
+    @JvmStatic
+    external fun endRequestMetrics(): DoubleArray?
+
+    /**
+     * Values per row in the [runBenchmark] result:
+     * nPrompt, nGen, nBatch, nThreads, ppTps, ppTpsStddev, tgTps, tgTpsStddev, ttftMs.
+     */
+    const val BENCH_ROW_STRIDE = 9
+
+    /**
+     * Run a llama-bench style throughput benchmark on a separately loaded copy of
+     * [modelPath], once per (batch size, thread count, prompt size) combination.
+     * The loaded chat model and its KV cache are not touched.
+     *
+     * @return [BENCH_ROW_STRIDE] values per combination, or null on failure
+     */
+    @JvmStatic
+    external fun runBenchmark(
+        modelPath: String,
+        promptSizes: IntArray,
+        genTokens: Int,
+        batchSizes: IntArray,
+        threadCounts: IntArray,
+        repetitions: Int
+    ): DoubleArray?
 }
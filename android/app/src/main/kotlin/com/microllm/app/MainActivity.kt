@@ -44,7 +44,9 @@ class MainActivity : FlutterActivity() {
         // Whisper needs a Context for permission checks and main-thread marshaling.
         whisperHandler = WhisperHandler(this)
         ttsHandler = TextToSpeechHandler(this)
-        memoryHandler = MemoryHandler(this)
+        memoryHandler = MemoryHandler(this) { lowMemory ->
+            llamaHandler.onLowMemoryState(lowMemory)
+        }
         deviceScannerHandler = DeviceScannerHandler(this)
 
         // Set up LLM method channel (via JNI, bypasses FFI struct issues)
@@ -55,6 +57,12 @@ class MainActivity : FlutterActivity() {
             llamaHandler.handleMethodCall(call, result)
         }
 
+        // LLM event channel (load progress)
+        EventChannel(
+            flutterEngine.dartExecutor.binaryMessenger,
+            "com.microllm.app/llama_events"
+        ).setStreamHandler(llamaHandler)
+
         // Set up STT method channel
         MethodChannel(
             flutterEngine.dartExecutor.binaryMessenger,
@@ -125,6 +133,13 @@ class MainActivity : FlutterActivity() {
         }
     }
 
+    override fun onTrimMemory(level: Int) {
+        super.onTrimMemory(level)
+        if (::llamaHandler.isInitialized) {
+            llamaHandler.onTrimMemory(level)
+        }
+    }
+
     override fun onDestroy() {
         super.onDestroy()
         llamaHandler.destroy()
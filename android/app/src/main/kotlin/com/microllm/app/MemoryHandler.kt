@@ -10,8 +10,13 @@ import io.flutter.plugin.common.MethodChannel
  * Handler for memory monitoring operations.
  * 
  * Provides information about device memory status for OOM prevention.
+ * Every low-memory reading is also reported to [onLowMemoryState], which lets the
+ * LLM handler release or relock pinned model weights.
  */
-class MemoryHandler(private val context: Context) {
+class MemoryHandler(
+    private val context: Context,
+    private val onLowMemoryState: (Boolean) -> Unit = {}
+) {
 
     private val activityManager: ActivityManager by lazy {
         context.getSystemService(Context.ACTIVITY_SERVICE) as ActivityManager
@@ -70,7 +75,7 @@ class MemoryHandler(private val context: Context) {
             "availableBytes" to memInfo.availMem,
             "thresholdBytes" to memInfo.threshold,
             "lowMemory" to if (memInfo.lowMemory) 1L else 0L
-        )
+        ).also { onLowMemoryState(memInfo.lowMemory) }
     }
 
     /**
@@ -105,6 +110,7 @@ class MemoryHandler(private val context: Context) {
     private fun isLowMemory(): Boolean {
         val memInfo = ActivityManager.MemoryInfo()
         activityManager.getMemoryInfo(memInfo)
+        onLowMemoryState(memInfo.lowMemory)
         return memInfo.lowMemory
     }
 
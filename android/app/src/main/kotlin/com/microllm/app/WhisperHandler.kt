@@ -26,7 +26,10 @@ import kotlin.math.max
  * Emits events compatible with the existing STT pipeline:
  * - {type:"ready"}
  * - {type:"rms", rmsDb: <double>}
- * - {type:"result", text: <string>, confidence: <double>, isFinal: <bool>, alternatives: []}
+ * - {type:"result", confidence: <double>, isFinal: <bool>, alternatives: []}
+ *   (partials carry only segmentText/segmentStartMs/segmentEndMs for the newest segment;
+ *   the final result carries the full `text` and `segments` with timestamps and token
+ *   probabilities)
  * - {type:"error", message: <string>, code: <int>, isRecoverable: <bool>}
  * - {type:"end"}
  */
@@ -52,6 +55,12 @@ class WhisperHandler : EventChannel.StreamHandler {
     // Model state
     private var modelLoaded = false
 
+    // Language detected for the current streaming session when the caller asked for "auto".
+    // Continuous mode restarts recognition per utterance; later windows reuse this instead of
+    // re-running detection. Cleared when a new session starts or the model changes.
+    @Volatile
+    private var sessionLanguage: String? = null
+
     fun handleMethodCall(call: MethodCall, result: MethodChannel.Result) {
         when (call.method) {
             "isAvailable" -> postResult(result) { it.success(WhisperNative.isAvailable()) }
@@ -72,6 +81,7 @@ class WhisperHandler : EventChannel.StreamHandler {
                             }
                             val ok = WhisperNative.loadModel(modelPath, threads)
                             modelLoaded = ok
+                            sessionLanguage = null
                             postResult(result) {
                                 if (ok) it.success(true) else it.error("LOAD_FAILED", "Failed to load whisper model", null)
                             }
@@ -83,6 +93,32 @@ class WhisperHandler : EventChannel.StreamHandler {
                     postResult(result) { it.error("EXECUTOR_SHUTDOWN", "Whisper executor is not running", null) }
                 }
             }
+            "getMemoryReport" -> {
+                // On the executor: loadModel rewrites the native load report and context there.
+                try {
+                    executor.execute {
+                        val report = if (WhisperNative.isAvailable()) WhisperNative.getMemoryReport() else null
+                        postResult(result) {
+                            if (report == null || report.size < 6) {
+                                it.success(null)
+                            } else {
+                                it.success(
+                                    mapOf(
+                                        "weightsBytes" to report[0],
+                                        "loadRssDeltaBytes" to report[1],
+                                        "computeEstimateBytes" to report[2],
+                                        "processRssBytes" to report[3],
+                                        "ftype" to report[4].toInt(),
+                                        "mmapLoader" to (report[5] != 0L)
+                                    )
+                                )
+                            }
+                        }
+                    }
+                } catch (e: RejectedExecutionException) {
+                    postResult(result) { it.error("EXECUTOR_SHUTDOWN", "Whisper executor is not running", null) }
+                }
+            }
             "unloadModel" -> {
                 try {
                     executor.execute {
@@ -102,6 +138,8 @@ class WhisperHandler : EventChannel.StreamHandler {
             "start" -> {
                 val language = call.argument<String>("language") ?: "en-US"
                 val translateToEnglish = call.argument<Boolean>("translateToEnglish") ?: false
+                val continueSession = call.argument<Boolean>("continueSession") ?: false
+                if (!continueSession) sessionLanguage = null
                 startListening(language, translateToEnglish)
                 postResult(result) { it.success(null) }
             }
@@ -288,33 +326,44 @@ class WhisperHandler : EventChannel.StreamHandler {
 
             // Transcribe (stream partial segments while decoding)
             try {
-                val cb = NativeCallback { partial ->
+                val language = resolveLanguage(languageTag, pcm, sampleRate)
+
+                // Partial events carry only the new segment; Dart appends it to the
+                // utterance, so no growing transcript is copied per segment. The full
+                // text is sent once, in the final event.
+                val cb = NativeCallback { segment, t0Ms, t1Ms, confidence ->
                     emit(
                         mapOf(
                             "type" to "result",
-                            "text" to partial,
-                            "confidence" to 0.0,
+                            "confidence" to confidence.toDouble(),
                             "isFinal" to false,
-                            "alternatives" to emptyList<String>()
+                            "alternatives" to emptyList<String>(),
+                            "segmentText" to segment,
+                            "segmentStartMs" to t0Ms,
+                            "segmentEndMs" to t1Ms
                         )
                     )
                 }
 
-                val text = WhisperNative.transcribePcm16Streaming(
+                val transcript = WhisperNative.transcribeDetailed(
                     pcm,
                     sampleRate,
-                    languageTag,
+                    language,
                     translateToEnglish,
                     cb
-                ) ?: ""
+                )
+                val segments = transcript?.segments ?: emptyList()
+                val confidence = if (segments.isEmpty()) 0.0 else segments.map { it.confidence.toDouble() }.average()
 
                 emit(
                     mapOf(
                         "type" to "result",
-                        "text" to text,
-                        "confidence" to 0.0,
+                        "text" to (transcript?.text ?: ""),
+                        "confidence" to confidence,
                         "isFinal" to true,
-                        "alternatives" to emptyList<String>()
+                        "alternatives" to emptyList<String>(),
+                        "segments" to segments.map { it.toMap() },
+                        "language" to language
                     )
                 )
             } catch (e: Exception) {
@@ -340,6 +389,29 @@ class WhisperHandler : EventChannel.StreamHandler {
         }
     }
 
+    /**
+     * Map the requested tag to what whisper should decode with.
+     *
+     * "auto" (or blank) runs native detection on the first few seconds once per session;
+     * explicit tags pass through unchanged.
+     */
+    private fun resolveLanguage(languageTag: String, pcm: ShortArray, sampleRate: Int): String {
+        if (languageTag.isNotBlank() && !languageTag.equals(AUTO_LANGUAGE, ignoreCase = true)) {
+            return languageTag
+        }
+        sessionLanguage?.let { return it }
+
+        val prob = FloatArray(1)
+        val detected = WhisperNative.detectLanguage(pcm, sampleRate, LANGUAGE_DETECT_MS, prob)
+        if (detected.isNullOrBlank()) {
+            // Let whisper auto-detect inline; don't cache a failure.
+            return AUTO_LANGUAGE
+        }
+        android.util.Log.i("WhisperHandler", "Session language detected: $detected (p=${prob[0]})")
+        sessionLanguage = detected
+        return detected
+    }
+
     private fun stopInternal() {
         isListening = false
         audioRecord?.let {
@@ -369,14 +441,25 @@ class WhisperHandler : EventChannel.StreamHandler {
 
     @Keep
     private class NativeCallback(
-        private val onPartialCb: (String) -> Unit
+        private val onSegmentCb: (String, Long, Long, Float) -> Unit
     ) {
+        /**
+         * Called from native for each newly decoded segment (not the accumulated text).
+         * Timestamps are relative to the start of the transcribed audio.
+         */
         @Suppress("unused")
-        fun onPartial(text: String) {
-            onPartialCb(text)
+        fun onSegment(text: String, t0Ms: Long, t1Ms: Long, confidence: Float) {
+            onSegmentCb(text, t0Ms, t1Ms, confidence)
         }
     }
 
+    companion object {
+        private const val AUTO_LANGUAGE = "auto"
+
+        // Whisper only needs a few seconds of speech to identify the language reliably.
+        private const val LANGUAGE_DETECT_MS = 3000
+    }
+
     fun destroy() {
         // Defensive cleanup to avoid leaking AudioRecord threads on activity teardown.
         try {
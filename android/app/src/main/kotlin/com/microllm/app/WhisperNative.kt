@@ -11,6 +11,9 @@ object WhisperNative {
 
     init {
         try {
+            // libggml.so is the ggml runtime shared by libllama and libwhisper; the
+            // loader picks the dotprod/i8mm build when the CPU supports it.
+            GgmlLoader.load()
             System.loadLibrary("whisper")
             android.util.Log.i("WhisperNative", "Loaded libwhisper.so")
         } catch (e: UnsatisfiedLinkError) {
@@ -30,6 +33,14 @@ object WhisperNative {
     @JvmStatic
     external fun isLoaded(): Boolean
 
+    /**
+     * Memory accounting for the loaded model, or null if none is loaded.
+     *
+     * Layout: [fileBytes, loadRssDeltaBytes, computeBytesEstimate, currentRssBytes, ftype, mmapLoader].
+     */
+    @JvmStatic
+    external fun getMemoryReport(): LongArray?
+
     /**
      * Transcribe 16kHz mono PCM16 audio.
      *
@@ -49,7 +60,9 @@ object WhisperNative {
     /**
      * Transcribe and emit partial segments via callback.
      *
-     * The callback object must have a method: `fun onPartial(text: String)`.
+     * The callback object must have a method:
+     * `fun onSegment(text: String, t0Ms: Long, t1Ms: Long, confidence: Float)`.
+     * Only the newly decoded segment is passed; callers concatenate.
      */
     @JvmStatic
     external fun transcribePcm16Streaming(
@@ -59,5 +72,59 @@ object WhisperNative {
         translateToEnglish: Boolean,
         callback: Any?,
     ): String?
-}
 
+    /**
+     * Identify the spoken language from the first [maxMs] of audio.
+     *
+     * @param outProb optional 1-element array that receives the detection probability
+     * @return ISO-639-1 code (e.g. "es"), or null on failure
+     */
+    @JvmStatic
+    external fun detectLanguage(
+        pcm16: ShortArray,
+        sampleRate: Int,
+        maxMs: Int,
+        outProb: FloatArray?,
+    ): String?
+
+    /**
+     * Transcribe and return segment timestamps, token IDs and token probabilities.
+     *
+     * Returns a native direct buffer (see [WhisperTranscript.parse]) that MUST be
+     * released with [freeResult]. Partial segments are emitted via [callback] exactly
+     * like [transcribePcm16Streaming].
+     */
+    @JvmStatic
+    external fun transcribePcm16Detailed(
+        pcm16: ShortArray,
+        sampleRate: Int,
+        languageTag: String,
+        translateToEnglish: Boolean,
+        callback: Any?,
+    ): java.nio.ByteBuffer?
+
+    /**
+     * Release a buffer returned by [transcribePcm16Detailed].
+     */
+    @JvmStatic
+    external fun freeResult(buffer: java.nio.ByteBuffer)
+
+    /**
+     * Convenience wrapper: transcribe, parse and free the native buffer.
+     */
+    fun transcribeDetailed(
+        pcm16: ShortArray,
+        sampleRate: Int,
+        languageTag: String,
+        translateToEnglish: Boolean,
+        callback: Any?,
+    ): WhisperTranscript? {
+        val buffer = transcribePcm16Detailed(pcm16, sampleRate, languageTag, translateToEnglish, callback)
+            ?: return null
+        return try {
+            WhisperTranscript.parse(buffer)
+        } finally {
+            freeResult(buffer)
+        }
+    }
+}
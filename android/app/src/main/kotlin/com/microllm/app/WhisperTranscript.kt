@@ -0,0 +1,112 @@
+package com.microllm.app
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Structured whisper.cpp transcription result.
+ *
+ * Decoded from the packed direct buffer returned by
+ * [WhisperNative.transcribePcm16Detailed] (layout defined next to `transcript_header`
+ * in whisper_jni.cpp).
+ */
+data class WhisperTranscript(
+    val text: String,
+    val langId: Int,
+    val segments: List<Segment>,
+) {
+    data class Segment(
+        val text: String,
+        val startMs: Long,
+        val endMs: Long,
+        /** Mean probability of the segment's text tokens (0..1). */
+        val confidence: Float,
+        val noSpeechProb: Float,
+        val tokenIds: IntArray,
+        val tokenProbs: FloatArray,
+    ) {
+        fun toMap(): Map<String, Any> = mapOf(
+            "text" to text,
+            "startMs" to startMs,
+            "endMs" to endMs,
+            "confidence" to confidence.toDouble(),
+            "noSpeechProb" to noSpeechProb.toDouble(),
+            "tokenIds" to tokenIds.toList(),
+            "tokenProbs" to tokenProbs.map { it.toDouble() },
+        )
+    }
+
+    companion object {
+        private const val MAGIC = 0x52505357 // "WSPR"
+        private const val VERSION = 1
+        private const val HEADER_BYTES = 32
+        private const val SEGMENT_BYTES = 40
+        private const val TOKEN_BYTES = 8
+
+        /**
+         * Parse a native result buffer. Does not free it; callers must still call
+         * [WhisperNative.freeResult].
+         */
+        fun parse(buffer: ByteBuffer): WhisperTranscript {
+            val buf = buffer.duplicate().order(ByteOrder.nativeOrder())
+            buf.position(0)
+
+            require(buf.int == MAGIC) { "Bad transcript magic" }
+            val version = buf.int
+            require(version == VERSION) { "Unsupported transcript version $version" }
+            val nSegments = buf.int
+            val nTokens = buf.int
+            val textBytes = buf.int
+            val langId = buf.int
+
+            val segmentsAt = HEADER_BYTES
+            val tokensAt = segmentsAt + nSegments * SEGMENT_BYTES
+            val textAt = tokensAt + nTokens * TOKEN_BYTES
+            require(buf.capacity() >= textAt + textBytes) { "Truncated transcript buffer" }
+
+            // Decode the UTF-8 blob once; segment slices are byte ranges into it.
+            val blob = ByteArray(textBytes)
+            buf.position(textAt)
+            buf.get(blob)
+
+            val segments = ArrayList<Segment>(nSegments)
+            for (i in 0 until nSegments) {
+                buf.position(segmentsAt + i * SEGMENT_BYTES)
+                val t0 = buf.long
+                val t1 = buf.long
+                val tokenOffset = buf.int
+                val tokenCount = buf.int
+                val textOffset = buf.int
+                val textLen = buf.int
+                val confidence = buf.float
+                val noSpeech = buf.float
+
+                val ids = IntArray(tokenCount)
+                val probs = FloatArray(tokenCount)
+                for (j in 0 until tokenCount) {
+                    buf.position(tokensAt + (tokenOffset + j) * TOKEN_BYTES)
+                    ids[j] = buf.int
+                    probs[j] = buf.float
+                }
+
+                segments.add(
+                    Segment(
+                        text = String(blob, textOffset, textLen, Charsets.UTF_8),
+                        startMs = t0,
+                        endMs = t1,
+                        confidence = confidence,
+                        noSpeechProb = noSpeech,
+                        tokenIds = ids,
+                        tokenProbs = probs,
+                    )
+                )
+            }
+
+            return WhisperTranscript(
+                text = String(blob, Charsets.UTF_8),
+                langId = langId,
+                segments = segments,
+            )
+        }
+    }
+}
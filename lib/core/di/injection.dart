@@ -27,6 +27,7 @@ import '../../domain/usecases/generate_response_usecase.dart';
 import '../../domain/usecases/translate_text_usecase.dart';
 import '../../domain/usecases/speech_to_text_usecase.dart';
 import '../../domain/usecases/text_to_speech_usecase.dart';
+import '../../domain/usecases/recommend_stt_model_usecase.dart';
 import '../../domain/usecases/download_model_usecase.dart';
 import '../../domain/usecases/load_model_usecase.dart';
 import '../../domain/usecases/summarize_transcript_usecase.dart';
@@ -193,6 +194,13 @@ Future<void> initializeDependencies() async {
     () => TextToSpeechUseCase(voiceRepository: sl()),
   );
   
+  sl.registerLazySingleton(
+    () => RecommendSttModelUseCase(
+      llmRepository: sl(),
+      voiceRepository: sl(),
+    ),
+  );
+  
   sl.registerLazySingleton(
     () => DownloadModelUseCase(modelRepository: sl()),
   );
@@ -294,6 +302,7 @@ Future<void> initializeDependencies() async {
       speechToTextUseCase: sl(),
       summarizeTranscriptUseCase: sl(),
       benchmarkStorage: sl(),
+      llmRepository: sl(),
     ),
   );
   
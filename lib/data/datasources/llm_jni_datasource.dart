@@ -6,8 +6,11 @@ import 'package:flutter/services.dart';
 import '../../core/constants/app_constants.dart';
 import '../../core/error/exceptions.dart';
 import '../../core/utils/logger.dart';
+import '../../domain/entities/memory_estimate.dart';
 import '../../domain/entities/model_info.dart';
+import '../../domain/entities/model_metadata.dart';
 import '../../domain/entities/inference_request.dart';
+import '../../domain/entities/throughput_benchmark.dart';
 import 'llm_native_datasource.dart';
 
 /// Implementation of LLM native data source using JNI via platform channels.
@@ -17,6 +20,13 @@ import 'llm_native_datasource.dart';
 class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
   static const _channel = MethodChannel('com.microllm.app/llama');
   static const _memoryChannel = MethodChannel('com.microllm.app/memory');
+  static const _events = EventChannel('com.microllm.app/llama_events');
+  
+  @override
+  late final Stream<double> loadProgress = _events
+      .receiveBroadcastStream()
+      .where((event) => event is Map && event['type'] == 'loadProgress')
+      .map((event) => ((event as Map)['progress'] as num).toDouble());
   
   ModelInfo? _modelInfo;
   bool _isCancelled = false;
@@ -26,11 +36,20 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
   Future<ModelInfo> loadModel({
     required String modelPath,
     int contextSize = 2048,
-    int threads = 4,
+    int? threads,
+    int batchSize = 512,
+    int? ubatchSize = 512,
+    bool flashAttention = false,
+    KvCacheType cacheTypeK = KvCacheType.f16,
+    KvCacheType cacheTypeV = KvCacheType.f16,
+    bool prefetch = true,
+    bool lockHotWeights = false,
+    bool useOptimizedModel = false,
+    bool warmup = true,
+    bool hotSwap = true,
   }) async {
-    // Use more threads on multi-core devices for better performance
-    final optimizedThreads = threads < 6 ? 6 : threads;
-    logger.i('Loading model via JNI: $modelPath (threads: $optimizedThreads)');
+    logger.i('Loading model via JNI: $modelPath (threads: ${threads ?? 'auto'}, '
+        'flash attention: $flashAttention, KV: ${cacheTypeK.nativeName}/${cacheTypeV.nativeName})');
     
     // Validate file exists
     final file = File(modelPath);
@@ -53,37 +72,40 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
       );
     }
     
-    // Check available memory
-    try {
-      final memoryInfo = await _memoryChannel.invokeMethod<Map>('getMemoryInfo');
+    // Check available memory. A hot swap is checked natively instead, against
+    // the memory left next to the serving model, and falls back to unloading it.
+    if (!hotSwap || !isModelLoaded) {
+      try {
+        final memoryInfo = await _memoryChannel.invokeMethod<Map>('getMemoryInfo');
       
-      if (memoryInfo != null) {
-        final availableRam = (memoryInfo['availableBytes'] as num?)?.toInt() ?? 0;
-        final totalRam = (memoryInfo['totalBytes'] as num?)?.toInt() ?? 0;
-        final availableMB = availableRam ~/ 1024 ~/ 1024;
-        final totalGB = totalRam / 1024 / 1024 / 1024;
+        if (memoryInfo != null) {
+          final availableRam = (memoryInfo['availableBytes'] as num?)?.toInt() ?? 0;
+          final totalRam = (memoryInfo['totalBytes'] as num?)?.toInt() ?? 0;
+          final availableMB = availableRam ~/ 1024 ~/ 1024;
+          final totalGB = totalRam / 1024 / 1024 / 1024;
         
-        logger.i('Device RAM: ${totalGB.toStringAsFixed(1)}GB total, ${availableMB}MB available');
+          logger.i('Device RAM: ${totalGB.toStringAsFixed(1)}GB total, ${availableMB}MB available');
         
-        final estimatedRequiredBytes = (fileSize * 1.5).toInt();
-        final requiredMB = estimatedRequiredBytes ~/ 1024 ~/ 1024;
+          final estimatedRequiredBytes = (fileSize * 1.5).toInt();
+          final requiredMB = estimatedRequiredBytes ~/ 1024 ~/ 1024;
         
-        if (availableRam < estimatedRequiredBytes) {
-          logger.e('Insufficient RAM: need ~${requiredMB}MB, only ${availableMB}MB available');
-          throw LLMException(
-            message: 'Not enough memory to load this model.\n\n'
-                     'Required: ~${requiredMB}MB\n'
-                     'Available: ${availableMB}MB\n\n'
-                     'Try closing other apps or use a smaller model.',
-            code: 'INSUFFICIENT_MEMORY',
-          );
-        }
+          if (availableRam < estimatedRequiredBytes) {
+            logger.e('Insufficient RAM: need ~${requiredMB}MB, only ${availableMB}MB available');
+            throw LLMException(
+              message: 'Not enough memory to load this model.\n\n'
+                       'Required: ~${requiredMB}MB\n'
+                       'Available: ${availableMB}MB\n\n'
+                       'Try closing other apps or use a smaller model.',
+              code: 'INSUFFICIENT_MEMORY',
+            );
+          }
         
-        logger.d('Memory check passed: ${availableMB}MB available, ~${requiredMB}MB required');
+          logger.d('Memory check passed: ${availableMB}MB available, ~${requiredMB}MB required');
+        }
+      } catch (e) {
+        if (e is LLMException) rethrow;
+        logger.w('Could not check memory: $e - proceeding anyway');
       }
-    } catch (e) {
-      if (e is LLMException) rethrow;
-      logger.w('Could not check memory: $e - proceeding anyway');
     }
     
     // Check GGUF magic
@@ -110,10 +132,23 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
       final result = await _channel.invokeMethod<Map>('loadModel', {
         'modelPath': modelPath,
         'contextSize': contextSize,
-        'threads': optimizedThreads,
+        // 0 = calibrate on the performance cores (cached per device)
+        'threads': threads ?? 0,
+        'batchSize': batchSize,
+        // 0 = adaptive ubatch
+        'ubatchSize': ubatchSize ?? 0,
+        'flashAttention': flashAttention,
+        'cacheTypeK': cacheTypeK.nativeName,
+        'cacheTypeV': cacheTypeV.nativeName,
+        'prefetch': prefetch,
+        'lockHotWeights': lockHotWeights,
+        'useOptimizedModel': useOptimizedModel,
+        'warmup': warmup,
+        'hotSwap': hotSwap,
       });
       
       if (result == null || result['success'] != true) {
+        await _syncLoadedState();
         throw const LLMException(
           message: 'Failed to load model via JNI',
           code: 'LOAD_FAILED',
@@ -130,19 +165,48 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
       final loadTimeMs = result['loadTimeMs'] as int? ?? 0;
       final fileSizeBytes = result['fileSizeBytes'] as int? ?? fileSize;
       final actualContextSize = result['contextSize'] as int? ?? contextSize;
+      final memory = result['memory'] is Map
+          ? MemoryEstimate.fromMap(result['memory'] as Map)
+          : null;
+      final warmupTimeMs = (result['warmupMs'] as num?)?.toInt();
       
-      logger.i('Model loaded successfully in ${loadTimeMs}ms');
+      logger.i('Model loaded successfully in ${loadTimeMs}ms '
+          '(warm-up: ${warmupTimeMs != null ? '${warmupTimeMs}ms' : 'skipped'}, '
+          'threads: decode ${result['threads']}, prefill ${result['threadsBatch']}, '
+          'ggml: ${result['cpuVariant']}, '
+          'memory: ${memory?.totalFormatted ?? 'unknown'})');
+      
+      // The converted copy when useOptimizedModel picked one.
+      final loadedPath = result['modelPath'] as String? ?? modelPath;
+      
+      // Header facts replace the file-name and file-size guesses.
+      ModelMetadata? metadata;
+      try {
+        metadata = await inspectModel(loadedPath);
+      } catch (e) {
+        logger.w('Could not inspect model header: $e');
+      }
       
-      // Create model info
+      // Create model info. A converted copy keeps the original's name, so its
+      // quantization comes from the header.
       final fileName = modelPath.split('/').last;
+      final dominantType = metadata?.dominantTensorType ?? '';
       _modelInfo = ModelInfo(
         fileName: fileName,
         filePath: modelPath,
+        loadedFilePath: loadedPath,
         sizeBytes: fileSizeBytes,
-        quantization: _detectQuantization(fileName),
-        parameterCount: _formatParams(_estimateParams(fileSizeBytes)),
+        quantization: loadedPath != modelPath && dominantType.isNotEmpty
+            ? dominantType.toUpperCase()
+            : _detectQuantization(fileName),
+        parameterCount: metadata?.parameterCountFormatted ??
+            _formatParams(_estimateParams(fileSizeBytes)),
         contextSize: actualContextSize,
-        architecture: 'Unknown',
+        architecture: metadata?.architecture ?? 'Unknown',
+        memoryUsageBytes: memory?.totalBytes,
+        memoryEstimate: memory,
+        loadTimeMs: loadTimeMs,
+        warmupTimeMs: warmupTimeMs,
       );
       
       logger.d('Context size: $actualContextSize, Model size: ${fileSizeBytes ~/ 1024 ~/ 1024}MB');
@@ -150,6 +214,7 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
       return _modelInfo!;
     } on PlatformException catch (e) {
       logger.e('JNI load failed', error: e);
+      await _syncLoadedState();
       throw LLMException(
         message: 'Failed to load model: ${e.message}',
         code: e.code,
@@ -157,6 +222,18 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
     }
   }
   
+  /// After a failed load: a failed hot swap leaves the previous model
+  /// serving, a failed load after unloading it does not.
+  Future<void> _syncLoadedState() async {
+    try {
+      if (await _channel.invokeMethod<bool>('isModelLoaded') != true) {
+        _modelInfo = null;
+      }
+    } on PlatformException catch (_) {
+      _modelInfo = null;
+    }
+  }
+  
   @override
   Future<void> unloadModel() async {
     logger.i('Unloading model via JNI');
@@ -200,6 +277,9 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
         'topK': request.topK,
         if (request.isolated) 'systemPrompt': request.systemPrompt,
         if (request.isolated) 'stopSequences': request.stopSequences,
+        'loraAdapter': request.loraAdapterPath,
+        'loraScale': request.loraScale,
+        'grammar': request.grammar,
       });
       
       stopwatch.stop();
@@ -216,6 +296,7 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
         promptTokens: result['promptTokens'] as int? ?? 0,
         completionTokens: result['tokenCount'] as int? ?? 0,
         totalTimeMs: stopwatch.elapsedMilliseconds,
+        metrics: _parseMetrics(result['metrics']),
       );
     } on PlatformException catch (e) {
       logger.e('Generate failed', error: e);
@@ -249,6 +330,9 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
         'topK': request.topK,
         if (request.isolated) 'systemPrompt': request.systemPrompt,
         if (request.isolated) 'stopSequences': request.stopSequences,
+        'loraAdapter': request.loraAdapterPath,
+        'loraScale': request.loraScale,
+        'grammar': request.grammar,
       });
       
       if (result == null) {
@@ -274,6 +358,7 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
         wasCancelled: _isCancelled,
         totalTokens: tokenCount,
         elapsedMs: 0,
+        metrics: _parseMetrics(result['metrics']),
       );
       
     } catch (e, stack) {
@@ -329,6 +414,136 @@ class LLMJniDataSourceImpl with Loggable implements LLMNativeDataSource {
     );
   }
   
+  @override
+  Future<List<ThroughputBenchmarkRow>> runThroughputBenchmark({
+    required String modelPath,
+    required ThroughputBenchmarkConfig config,
+  }) async {
+    logger.i('Running native throughput benchmark: $modelPath '
+        '(${config.combinationCount} combinations x ${config.repetitions})');
+    try {
+      final rows = await _channel.invokeMethod<List>('runBenchmark', {
+        'modelPath': modelPath,
+        ...config.toMap(),
+      });
+      return (rows ?? const [])
+          .map((r) => ThroughputBenchmarkRow.fromMap(r as Map))
+          .toList();
+    } on PlatformException catch (e) {
+      logger.e('Throughput benchmark failed', error: e);
+      throw LLMException(
+        message: 'Benchmark failed: ${e.message}',
+        code: e.code,
+      );
+    }
+  }
+  
+  @override
+  Future<void> setThreads({required int prefill, required int decode}) async {
+    try {
+      await _channel.invokeMethod('setThreads', {
+        'prefill': prefill,
+        'decode': decode,
+      });
+      logger.i('Threads set: prefill $prefill, decode $decode');
+    } on PlatformException catch (e) {
+      throw LLMException(
+        message: 'Failed to set threads: ${e.message}',
+        code: e.code,
+      );
+    }
+  }
+  
+  @override
+  Future<void> loadAdapter(String adapterPath) async {
+    try {
+      await _channel.invokeMethod('loadAdapter', {'adapterPath': adapterPath});
+      logger.i('LoRA adapter loaded: $adapterPath');
+    } on PlatformException catch (e) {
+      throw LLMException(
+        message: 'Failed to load LoRA adapter: ${e.message}',
+        code: e.code,
+      );
+    }
+  }
+  
+  @override
+  Future<void> setThermalGovernor({
+    required bool enabled,
+    double targetTokensPerSecond = 0,
+  }) async {
+    try {
+      await _channel.invokeMethod('setThermalGovernor', {
+        'enabled': enabled,
+        'targetTokensPerSecond': targetTokensPerSecond,
+      });
+    } on PlatformException catch (e) {
+      throw LLMException(
+        message: 'Failed to configure thermal governor: ${e.message}',
+        code: e.code,
+      );
+    }
+  }
+  
+  @override
+  Future<WeightResidency> getWeightResidency() async {
+    try {
+      final result = await _channel.invokeMethod<Map>('getWeightResidency');
+      return WeightResidency.fromMap(result ?? const {});
+    } on PlatformException catch (e) {
+      throw LLMException(
+        message: 'Failed to read weight residency: ${e.message}',
+        code: e.code,
+      );
+    }
+  }
+  
+  @override
+  Future<ModelMetadata> inspectModel(String modelPath) async {
+    try {
+      final result = await _channel.invokeMethod<Map>('inspectModel', {
+        'modelPath': modelPath,
+      });
+      if (result == null) {
+        throw ModelFileException(
+          message: 'Cannot read GGUF header',
+          filePath: modelPath,
+        );
+      }
+      return ModelMetadata.fromMap(result);
+    } on PlatformException catch (e) {
+      throw ModelFileException(
+        message: 'Cannot read GGUF header: ${e.message}',
+        filePath: modelPath,
+      );
+    }
+  }
+  
+  @override
+  Future<String?> optimizeModel(String modelPath) async {
+    try {
+      final result = await _channel.invokeMethod<Map>('convertModel', {
+        'modelPath': modelPath,
+      });
+      final status = result?['status'] as String?;
+      logger.i('Model conversion: $status');
+      if (status == 'converted' || status == 'cached') {
+        return result!['path'] as String;
+      }
+      return null;
+    } on PlatformException catch (e) {
+      throw LLMException(
+        message: 'Failed to convert model: ${e.message}',
+        code: e.code,
+      );
+    }
+  }
+  
+  InferenceMetrics? _parseMetrics(Object? raw) {
+    if (raw is! Map || raw.isEmpty) return null;
+    return InferenceMetrics.fromMap(raw);
+  }
+  
   String _detectQuantization(String path) {
     final lower = path.toLowerCase();
     if (lower.contains('q4_k_m')) return 'Q4_K_M';
@@ -8,8 +8,11 @@ import 'package:flutter/services.dart';
 import '../../core/constants/app_constants.dart';
 import '../../core/error/exceptions.dart';
 import '../../core/utils/logger.dart';
+import '../../domain/entities/memory_estimate.dart';
 import '../../domain/entities/model_info.dart';
+import '../../domain/entities/model_metadata.dart';
 import '../../domain/entities/inference_request.dart';
+import '../../domain/entities/throughput_benchmark.dart';
 import '../../native/llama_bindings.dart';
 
 /// Data source for LLM operations via native llama.cpp.
@@ -18,12 +21,46 @@ import '../../native/llama_bindings.dart';
 /// All operations are designed to be thread-safe and memory-efficient.
 abstract class LLMNativeDataSource {
   /// Load a model from disk.
+  ///
+  /// [threads] fixes the inference thread count; null lets the backend pick
+  /// (the JNI backend calibrates decode and prefill counts once per device).
+  /// [batchSize] caps tokens per decode call; [ubatchSize] is the compute
+  /// step (its buffer is reserved at load), null for the adaptive mode that
+  /// sizes it from free memory and tunes it on prefill speed (JNI backend only).
+  /// [cacheTypeK]/[cacheTypeV] set the KV cache element types; a quantized V
+  /// cache turns [flashAttention] on. [prefetch] reads the weights into the
+  /// page cache in forward-pass order before returning, so the first prompt
+  /// does not fault them in from flash (JNI backend only). [lockHotWeights]
+  /// pins the output head, attention and embedding weights in RAM while memory
+  /// allows (JNI backend only). [useOptimizedModel] loads the copy
+  /// [optimizeModel] made for this CPU instead, when one exists; the file
+  /// actually loaded is [ModelInfo.loadedFilePath] (JNI backend only).
+  /// [warmup] runs a dummy prefill and decode after
+  /// loading so the first prompt runs at full speed; its cost is reported as
+  /// [ModelInfo.warmupTimeMs] (JNI backend only). [hotSwap] loads a new model
+  /// in the background while the current one keeps serving and swaps them
+  /// when it is ready, if both fit in memory; otherwise the current model is
+  /// unloaded first (JNI backend only).
   Future<ModelInfo> loadModel({
     required String modelPath,
     int contextSize = 2048,
-    int threads = 4,
+    int? threads,
+    int batchSize = 512,
+    int? ubatchSize = 512,
+    bool flashAttention = false,
+    KvCacheType cacheTypeK = KvCacheType.f16,
+    KvCacheType cacheTypeV = KvCacheType.f16,
+    bool prefetch = true,
+    bool lockHotWeights = false,
+    bool useOptimizedModel = false,
+    bool warmup = true,
+    bool hotSwap = true,
   });
   
+  /// Progress (0..1) of the [loadModel] call in flight. Backends that cannot
+  /// report it emit nothing.
+  Stream<double> get loadProgress;
+  
   /// Unload the current model.
   Future<void> unloadModel();
   
@@ -50,6 +87,39 @@ abstract class LLMNativeDataSource {
   
   /// Check available memory.
   Future<MemoryInfo> getMemoryInfo();
+
+  /// Run the native throughput benchmark against the model at [modelPath].
+  Future<List<ThroughputBenchmarkRow>> runThroughputBenchmark({
+    required String modelPath,
+    required ThroughputBenchmarkConfig config,
+  });
+
+  /// Change prefill and decode thread counts of the loaded model without
+  /// reloading it (e.g. fewer threads under thermal pressure).
+  Future<void> setThreads({required int prefill, required int decode});
+
+  /// Enable or disable thermal/battery pacing of generation. A
+  /// [targetTokensPerSecond] of 0 holds 75% of the rate measured while cool.
+  Future<void> setThermalGovernor({
+    required bool enabled,
+    double targetTokensPerSecond = 0,
+  });
+
+  /// Mapped, resident and locked bytes of the loaded weights.
+  Future<WeightResidency> getWeightResidency();
+
+  /// Load the LoRA adapter at [adapterPath] against the loaded model ahead of
+  /// the first request that names it in [InferenceRequest.loraAdapterPath].
+  Future<void> loadAdapter(String adapterPath);
+
+  /// Read [modelPath]'s GGUF header without loading the model.
+  Future<ModelMetadata> inspectModel(String modelPath);
+
+  /// Convert [modelPath] into the weight type this CPU's fastest kernels use
+  /// and cache it beside the original; later loads of [modelPath] with
+  /// useOptimizedModel use the copy. Returns the copy's path, or null when the CPU or the model gains
+  /// nothing from it.
+  Future<String?> optimizeModel(String modelPath);
 }
 
 /// Implementation of LLM native data source using llama.cpp FFI bindings.
@@ -74,10 +144,26 @@ class LLMNativeDataSourceImpl with Loggable implements LLMNativeDataSource {
   Future<ModelInfo> loadModel({
     required String modelPath,
     int contextSize = 2048,
-    int threads = 4,
+    int? threads,
+    int batchSize = 512,
+    int? ubatchSize = 512,
+    bool flashAttention = false,
+    KvCacheType cacheTypeK = KvCacheType.f16,
+    KvCacheType cacheTypeV = KvCacheType.f16,
+    bool prefetch = true,
+    bool lockHotWeights = false,
+    bool useOptimizedModel = false,
+    bool warmup = true,
+    bool hotSwap = true,
   }) async {
+    threads ??= 4;
     logger.i('Loading model from: $modelPath');
     
+    // No background loading over FFI: a hot swap degrades to unload-then-load.
+    if (isModelLoaded) {
+      await unloadModel();
+    }
+    
     // Validate file exists
     final file = File(modelPath);
     if (!await file.exists()) {
@@ -226,11 +312,16 @@ class LLMNativeDataSourceImpl with Loggable implements LLMNativeDataSource {
       
       // Modify only what we need directly on the native struct
       contextParamsPtr.ref.nCtx = contextSize;
-      contextParamsPtr.ref.nBatch = 512;
-      contextParamsPtr.ref.nUbatch = 512;
+      contextParamsPtr.ref.nBatch = batchSize;
+      // No adaptive mode through FFI: null falls back to the full batch.
+      contextParamsPtr.ref.nUbatch = ubatchSize ?? batchSize;
       contextParamsPtr.ref.nThreads = threads;
       contextParamsPtr.ref.nThreadsBatch = threads;
-      contextParamsPtr.ref.flashAttnType = 0; // Disabled for CPU-only mobile
+      // A quantized V cache is only supported with flash attention.
+      contextParamsPtr.ref.flashAttnType =
+          flashAttention || cacheTypeV != KvCacheType.f16 ? 1 : 0;
+      contextParamsPtr.ref.typeK = _ggmlType(cacheTypeK);
+      contextParamsPtr.ref.typeV = _ggmlType(cacheTypeV);
       
       logger.d('Context params: nCtx=${contextParamsPtr.ref.nCtx}, nBatch=${contextParamsPtr.ref.nBatch}, threads=$threads');
       
@@ -261,6 +352,7 @@ class LLMNativeDataSourceImpl with Loggable implements LLMNativeDataSource {
       _modelInfo = ModelInfo(
         fileName: modelPath.split('/').last,
         filePath: modelPath,
+        loadedFilePath: modelPath,
         sizeBytes: fileSize,
         quantization: _detectQuantization(modelPath),
         parameterCount: _formatParams(nParams),
@@ -316,6 +408,18 @@ class LLMNativeDataSourceImpl with Loggable implements LLMNativeDataSource {
     }
   }
   
+  /// ggml_type id of a KV cache type.
+  int _ggmlType(KvCacheType type) {
+    switch (type) {
+      case KvCacheType.f16:
+        return 1; // GGML_TYPE_F16
+      case KvCacheType.q8_0:
+        return 8; // GGML_TYPE_Q8_0
+      case KvCacheType.q4_0:
+        return 2; // GGML_TYPE_Q4_0
+    }
+  }
+  
   String _detectQuantization(String path) {
     final lower = path.toLowerCase();
     if (lower.contains('q4_k_m')) return 'Q4_K_M';
@@ -334,6 +438,9 @@ class LLMNativeDataSourceImpl with Loggable implements LLMNativeDataSource {
     return '$params';
   }
   
+  @override
+  Stream<double> get loadProgress => const Stream.empty();
+  
   @override
   Future<void> unloadModel() async {
     logger.i('Unloading model');
@@ -626,6 +733,68 @@ class LLMNativeDataSourceImpl with Loggable implements LLMNativeDataSource {
       appUsageBytes: 512 * 1024 * 1024, // 512MB
     );
   }
+
+  @override
+  Future<List<ThroughputBenchmarkRow>> runThroughputBenchmark({
+    required String modelPath,
+    required ThroughputBenchmarkConfig config,
+  }) async {
+    throw const LLMException(
+      message: 'Throughput benchmark is only available via the JNI bridge',
+      code: 'NOT_SUPPORTED',
+    );
+  }
+
+  @override
+  Future<void> setThreads({required int prefill, required int decode}) async {
+    throw const LLMException(
+      message: 'Changing threads at runtime is only available via the JNI bridge',
+      code: 'NOT_SUPPORTED',
+    );
+  }
+
+  @override
+  Future<void> setThermalGovernor({
+    required bool enabled,
+    double targetTokensPerSecond = 0,
+  }) async {
+    throw const LLMException(
+      message: 'Thermal governor is only available via the JNI bridge',
+      code: 'NOT_SUPPORTED',
+    );
+  }
+
+  @override
+  Future<WeightResidency> getWeightResidency() async {
+    throw const LLMException(
+      message: 'Weight residency is only available via the JNI bridge',
+      code: 'NOT_SUPPORTED',
+    );
+  }
+
+  @override
+  Future<void> loadAdapter(String adapterPath) async {
+    throw const LLMException(
+      message: 'LoRA adapters are only available via the JNI bridge',
+      code: 'NOT_SUPPORTED',
+    );
+  }
+
+  @override
+  Future<ModelMetadata> inspectModel(String modelPath) async {
+    throw const LLMException(
+      message: 'Model inspection is only available via the JNI bridge',
+      code: 'NOT_SUPPORTED',
+    );
+  }
+
+  @override
+  Future<String?> optimizeModel(String modelPath) async {
+    throw const LLMException(
+      message: 'Model conversion is only available via the JNI bridge',
+      code: 'NOT_SUPPORTED',
+    );
+  }
 }
 
 /// Native inference events.
@@ -653,11 +822,13 @@ final class NativeCompletionEvent extends NativeInferenceEvent {
   final bool wasCancelled;
   final int totalTokens;
   final int elapsedMs;
+  final InferenceMetrics? metrics;
   
   const NativeCompletionEvent({
     this.wasCancelled = false,
     this.totalTokens = 0,
     this.elapsedMs = 0,
+    this.metrics,
   });
 }
 
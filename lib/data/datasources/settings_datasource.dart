@@ -48,6 +48,7 @@ class SettingsDataSourceImpl with Loggable implements SettingsDataSource {
       final contextWindowSize = _settingsBox.get('contextWindowSize') as int?;
       final maxGenerationTokens = _settingsBox.get('maxGenerationTokens') as int?;
       final inferenceThreads = _settingsBox.get('inferenceThreads') as int?;
+      final optimizeModelsForCpu = _settingsBox.get('optimizeModelsForCpu') as bool?;
       final autoDetectLanguage = _settingsBox.get('autoDetectLanguage') as bool?;
       final themePreferenceIndex = _settingsBox.get('themePreference') as int?;
       final selectedModelPath = _settingsBox.get('selectedModelPath') as String?;
@@ -68,6 +69,7 @@ class SettingsDataSourceImpl with Loggable implements SettingsDataSource {
         contextWindowSize: contextWindowSize,
         maxGenerationTokens: maxGenerationTokens ?? 512,
         inferenceThreads: inferenceThreads ?? 4,
+        optimizeModelsForCpu: optimizeModelsForCpu ?? false,
         autoDetectLanguage: autoDetectLanguage ?? true,
         themePreference: themePreferenceIndex != null
             ? ThemePreference.values[themePreferenceIndex]
@@ -100,6 +102,7 @@ class SettingsDataSourceImpl with Loggable implements SettingsDataSource {
         'contextWindowSize': settings.contextWindowSize,
         'maxGenerationTokens': settings.maxGenerationTokens,
         'inferenceThreads': settings.inferenceThreads,
+        'optimizeModelsForCpu': settings.optimizeModelsForCpu,
         'autoDetectLanguage': settings.autoDetectLanguage,
         'themePreference': settings.themePreference.index,
         'selectedModelPath': settings.selectedModelPath,
@@ -13,16 +13,28 @@ abstract class WhisperDataSource {
   Future<bool> loadModel({required String modelPath, required int threads});
   Future<void> unloadModel();
 
+  /// Native memory accounting for the loaded model, or null if none is loaded.
+  ///
+  /// Keys: weightsBytes, loadRssDeltaBytes, computeEstimateBytes (RSS growth
+  /// minus the file size, an estimate), processRssBytes, ftype (ints) and
+  /// mmapLoader (bool).
+  Future<Map<String, Object>?> getMemoryReport();
+
   /// Start recognition.
   ///
   /// If [continuous] is true, the recognizer will automatically restart
   /// after each utterance finishes, accumulating transcript across multiple
   /// recording segments. This is essential for the voice benchmark flow
   /// where users speak for 2–3 minutes.
+  ///
+  /// With [autoDetectLanguage], native detects the spoken language from the
+  /// first seconds of audio instead of using [language], and keeps it for the
+  /// rest of the session.
   Stream<SpeechRecognitionResult> startRecognition({
     required String language,
     bool translateToEnglish,
     bool continuous,
+    bool autoDetectLanguage,
   });
 
   Future<void> stopRecognition();
@@ -35,6 +47,9 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
   static const _channel = MethodChannel('com.microllm.app/whisper');
   static const _events = EventChannel('com.microllm.app/whisper_events');
 
+  /// Language value that asks native to detect the spoken language.
+  static const autoLanguage = 'auto';
+
   bool _isListening = false;
   bool _continuous = false;
   bool _stopRequested = false;
@@ -43,6 +58,10 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
   StreamSubscription<dynamic>? _sub;
   StreamController<SpeechRecognitionResult>? _controller;
 
+  /// Partial transcript of the current utterance. Partial events carry only
+  /// their new segment; the final event carries the whole text.
+  final StringBuffer _utterance = StringBuffer();
+
   @override
   bool get isListening => _isListening;
 
@@ -91,21 +110,40 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
     }
   }
 
+  @override
+  Future<Map<String, Object>?> getMemoryReport() async {
+    try {
+      final report = await _channel.invokeMethod<Map>('getMemoryReport');
+      if (report == null) return null;
+      return {
+        for (final e in report.entries)
+          if (e.value is num)
+            e.key as String: (e.value as num).toInt()
+          else if (e.value is bool)
+            e.key as String: e.value as bool,
+      };
+    } on PlatformException catch (e) {
+      logger.w('Whisper getMemoryReport failed: $e');
+      return null;
+    }
+  }
+
   @override
   Stream<SpeechRecognitionResult> startRecognition({
     required String language,
     bool translateToEnglish = false,
     bool continuous = false,
+    bool autoDetectLanguage = false,
   }) {
     _cancelCurrent();
     _controller = StreamController<SpeechRecognitionResult>();
     _isListening = true;
     _continuous = continuous;
     _stopRequested = false;
-    _lastLanguage = language;
+    _lastLanguage = autoDetectLanguage ? autoLanguage : language;
     _lastTranslate = translateToEnglish;
 
-    _startNativeRecognition(language, translateToEnglish, subscribeEvents: true);
+    _startNativeRecognition(_lastLanguage, translateToEnglish, subscribeEvents: true);
 
     return _controller!.stream;
   }
@@ -115,10 +153,14 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
   /// If [subscribeEvents] is true, a new EventChannel subscription is created.
   /// On restarts in continuous mode, we pass false to reuse the existing subscription
   /// since the EventChannel eventSink stays valid as long as we don't cancel.
+  ///
+  /// [continueSession] tells native this is the next utterance of the same
+  /// session, so a language auto-detected earlier ("auto") is reused.
   void _startNativeRecognition(
     String language,
     bool translateToEnglish, {
     bool subscribeEvents = false,
+    bool continueSession = false,
   }) {
     // Subscribe to the EventChannel FIRST so the native eventSink is
     // established before we invoke 'start'. This prevents a race where
@@ -156,6 +198,7 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
     _channel.invokeMethod('start', {
       'language': language,
       'translateToEnglish': translateToEnglish,
+      'continueSession': continueSession,
     }).catchError((Object error) {
       _controller?.addError(
         VoiceException(message: 'Failed to start Whisper STT: $error'),
@@ -173,17 +216,30 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
     final type = map['type'] as String?;
     switch (type) {
       case 'result':
+        final isFinal = map['isFinal'] as bool? ?? false;
+        final String text;
+        if (isFinal) {
+          text = map['text'] as String? ?? _utterance.toString();
+          _utterance.clear();
+        } else {
+          _utterance.write(map['segmentText'] as String? ?? '');
+          text = _utterance.toString();
+        }
         controller.add(SpeechRecognitionResult(
-          text: map['text'] as String? ?? '',
+          text: text,
           confidence: (map['confidence'] as num?)?.toDouble() ?? 0.0,
-          isFinal: map['isFinal'] as bool? ?? false,
+          isFinal: isFinal,
           alternatives: (map['alternatives'] as List?)
                   ?.map((e) => e as String)
                   .toList() ??
               const [],
+          segments: (map['segments'] as List?)
+                  ?.map((e) => TranscriptSegment.fromMap(e as Map))
+                  .toList() ??
+              const [],
         ));
 
-        if (map['isFinal'] as bool? ?? false) {
+        if (isFinal) {
           // Utterance complete.
           if (_continuous && !_stopRequested) {
             // In continuous mode: restart for the next utterance.
@@ -224,7 +280,8 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
         break;
 
       case 'ready':
-        // Whisper native side is ready to receive audio — no action needed.
+        // Whisper native side is ready to receive audio; a new utterance starts.
+        _utterance.clear();
         break;
 
       case 'end':
@@ -244,7 +301,12 @@ class WhisperDataSourceImpl with Loggable implements WhisperDataSource {
       if (_stopRequested || _controller == null || _controller!.isClosed) return;
       logger.i('Whisper continuous: restarting recognizer…');
       // Don't re-subscribe to events — the EventChannel is still active.
-      _startNativeRecognition(_lastLanguage, _lastTranslate, subscribeEvents: true);
+      _startNativeRecognition(
+        _lastLanguage,
+        _lastTranslate,
+        subscribeEvents: true,
+        continueSession: true,
+      );
     });
   }
 
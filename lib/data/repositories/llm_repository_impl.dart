@@ -6,7 +6,10 @@ import '../../core/error/failures.dart';
 import '../../core/utils/result.dart';
 import '../../core/utils/logger.dart';
 import '../../domain/entities/inference_request.dart';
+import '../../domain/entities/memory_estimate.dart';
 import '../../domain/entities/model_info.dart';
+import '../../domain/entities/model_metadata.dart';
+import '../../domain/entities/throughput_benchmark.dart';
 import '../../domain/repositories/llm_repository.dart';
 import '../datasources/llm_native_datasource.dart';
 
@@ -26,12 +29,32 @@ class LLMRepositoryImpl with Loggable implements LLMRepository {
     required String modelPath,
     int? contextSize,
     int? threads,
+    int batchSize = 512,
+    int? ubatchSize = 512,
+    bool flashAttention = false,
+    KvCacheType cacheTypeK = KvCacheType.f16,
+    KvCacheType cacheTypeV = KvCacheType.f16,
+    bool prefetch = true,
+    bool lockHotWeights = false,
+    bool useOptimizedModel = false,
+    bool warmup = true,
+    bool hotSwap = true,
   }) async {
     try {
       final modelInfo = await _nativeDataSource.loadModel(
         modelPath: modelPath,
         contextSize: contextSize ?? 1024,
-        threads: threads ?? 4,
+        threads: threads,
+        batchSize: batchSize,
+        ubatchSize: ubatchSize,
+        flashAttention: flashAttention,
+        cacheTypeK: cacheTypeK,
+        cacheTypeV: cacheTypeV,
+        prefetch: prefetch,
+        lockHotWeights: lockHotWeights,
+        useOptimizedModel: useOptimizedModel,
+        warmup: warmup,
+        hotSwap: hotSwap,
       );
       return Right(modelInfo);
     } catch (e, stack) {
@@ -51,6 +74,9 @@ class LLMRepositoryImpl with Loggable implements LLMRepository {
     }
   }
   
+  @override
+  Stream<double> get loadProgress => _nativeDataSource.loadProgress;
+  
   @override
   bool get isModelLoaded => _nativeDataSource.isModelLoaded;
   
@@ -92,7 +118,11 @@ class LLMRepositoryImpl with Loggable implements LLMRepository {
             promptTokens = promptTokenCount;
             // Optionally emit a progress event here
             
-          case NativeCompletionEvent(:final wasCancelled, :final elapsedMs):
+          case NativeCompletionEvent(
+              :final wasCancelled,
+              :final elapsedMs,
+              :final metrics,
+            ):
             stopwatch.stop();
             yield CompletionEvent(
               response: InferenceResponse(
@@ -102,6 +132,7 @@ class LLMRepositoryImpl with Loggable implements LLMRepository {
                 timeToFirstTokenMs: timeToFirstToken,
                 totalTimeMs: elapsedMs > 0 ? elapsedMs : stopwatch.elapsedMilliseconds,
                 stopReason: wasCancelled ? StopReason.cancelled : StopReason.endOfText,
+                metrics: metrics,
               ),
             );
             
@@ -147,6 +178,92 @@ class LLMRepositoryImpl with Loggable implements LLMRepository {
     }
   }
   
+  @override
+  AsyncResult<List<ThroughputBenchmarkRow>> runThroughputBenchmark({
+    required String modelPath,
+    ThroughputBenchmarkConfig config = const ThroughputBenchmarkConfig(),
+  }) async {
+    try {
+      final rows = await _nativeDataSource.runThroughputBenchmark(
+        modelPath: modelPath,
+        config: config,
+      );
+      return Right(rows);
+    } catch (e, stack) {
+      logger.e('Throughput benchmark failed', error: e, stackTrace: stack);
+      return Left(_mapException(e, stack));
+    }
+  }
+
+  @override
+  AsyncResult<void> setThreads({required int prefill, required int decode}) async {
+    try {
+      await _nativeDataSource.setThreads(prefill: prefill, decode: decode);
+      return const Right(null);
+    } catch (e, stack) {
+      logger.e('Failed to set threads', error: e, stackTrace: stack);
+      return Left(_mapException(e, stack));
+    }
+  }
+
+  @override
+  AsyncResult<void> setThermalGovernor({
+    required bool enabled,
+    double targetTokensPerSecond = 0,
+  }) async {
+    try {
+      await _nativeDataSource.setThermalGovernor(
+        enabled: enabled,
+        targetTokensPerSecond: targetTokensPerSecond,
+      );
+      return const Right(null);
+    } catch (e, stack) {
+      logger.e('Failed to configure thermal governor', error: e, stackTrace: stack);
+      return Left(_mapException(e, stack));
+    }
+  }
+  
+  @override
+  AsyncResult<WeightResidency> getWeightResidency() async {
+    try {
+      return Right(await _nativeDataSource.getWeightResidency());
+    } catch (e, stack) {
+      logger.e('Failed to read weight residency', error: e, stackTrace: stack);
+      return Left(_mapException(e, stack));
+    }
+  }
+  
+  @override
+  AsyncResult<ModelMetadata> inspectModel(String modelPath) async {
+    try {
+      return Right(await _nativeDataSource.inspectModel(modelPath));
+    } catch (e, stack) {
+      logger.e('Failed to inspect model', error: e, stackTrace: stack);
+      return Left(_mapException(e, stack));
+    }
+  }
+  
+  @override
+  AsyncResult<void> loadAdapter(String adapterPath) async {
+    try {
+      await _nativeDataSource.loadAdapter(adapterPath);
+      return const Right(null);
+    } catch (e, stack) {
+      logger.e('Failed to load LoRA adapter', error: e, stackTrace: stack);
+      return Left(_mapException(e, stack));
+    }
+  }
+  
+  @override
+  AsyncResult<String?> optimizeModel(String modelPath) async {
+    try {
+      return Right(await _nativeDataSource.optimizeModel(modelPath));
+    } catch (e, stack) {
+      logger.e('Failed to optimize model', error: e, stackTrace: stack);
+      return Left(_mapException(e, stack));
+    }
+  }
+  
   /// Map exceptions to domain failures.
   LLMFailure _mapException(Object error, StackTrace? stack) {
     // Could add more specific exception handling here
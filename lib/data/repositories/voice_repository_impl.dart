@@ -102,6 +102,7 @@ class VoiceRepositoryImpl with Loggable implements VoiceRepository {
     bool continuous = false,
     bool preferOffline = true,
     bool offlineOnly = false,
+    bool autoDetectLanguage = false,
     int whisperThreads = 4,
   }) {
     switch (engine) {
@@ -118,6 +119,7 @@ class VoiceRepositoryImpl with Loggable implements VoiceRepository {
           language: language,
           translateToEnglish: false,
           continuous: continuous,
+          autoDetectLanguage: autoDetectLanguage,
         );
     }
   }
@@ -163,6 +165,24 @@ class VoiceRepositoryImpl with Loggable implements VoiceRepository {
     await _whisperDataSource.unloadModel();
   }
 
+  @override
+  AsyncResult<int?> getWhisperResidentBytes() async {
+    try {
+      final report = await _whisperDataSource.getMemoryReport();
+      if (report == null) return const Right(null);
+      final weights = report['weightsBytes'] as int? ?? 0;
+      final compute = report['computeEstimateBytes'] as int? ?? 0;
+      return Right(weights + compute);
+    } catch (e, stack) {
+      logger.e('Whisper memory report failed', error: e, stackTrace: stack);
+      return Left(VoiceFailure(
+        message: e.toString(),
+        type: VoiceFailureType.sttUnavailable,
+        stackTrace: stack,
+      ));
+    }
+  }
+
   @override
   AsyncResult<bool> isWhisperModelLoaded() async {
     try {
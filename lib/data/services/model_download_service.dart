@@ -6,16 +6,24 @@ import 'package:path_provider/path_provider.dart';
 import '../../core/utils/logger.dart';
 import '../../domain/entities/device_specs.dart';
 import '../../domain/services/model_catalog.dart';
+import '../../native/sha256_bindings.dart';
+import '../../native/storage_bindings.dart';
+import 'range_downloader.dart';
 
 /// Service for downloading LLM models.
 /// 
 /// Features:
-/// - Resumable downloads
+/// - Parallel byte-range downloads, resumable chunk by chunk
 /// - Progress tracking
-/// - Integrity verification (SHA256)
+/// - Integrity verification (SHA256, hashed while streaming to disk)
 /// - Disk space checking
 class ModelDownloadService with Loggable {
+  /// Suffix of the CPU-optimized copy the native layer writes beside a model
+  /// (`LLMRepository.optimizeModel`); not a model of its own.
+  static const String optimizedSuffix = '.repack.gguf';
+  
   HttpClient? _httpClient;
+  final RangeDownloader _rangeDownloader = RangeDownloader();
   bool _isCancelled = false;
   
   /// Get the models directory path.
@@ -68,7 +76,9 @@ class ModelDownloadService with Loggable {
     final downloaded = <DownloadedModel>[];
     
     await for (final entity in dir.list()) {
-      if (entity is File && entity.path.endsWith('.gguf')) {
+      if (entity is File &&
+          entity.path.endsWith('.gguf') &&
+          !entity.path.endsWith(optimizedSuffix)) {
         final stat = await entity.stat();
         final fileName = entity.path.split('/').last;
         
@@ -106,23 +116,69 @@ class ModelDownloadService with Loggable {
     
     _isCancelled = false;
     
-    // Check disk space
     final modelsDir = await getModelsDirectory();
-    final requiredSpace = model.sizeBytes * 1.1; // 10% buffer
-    
-    try {
-      final stat = await File(modelsDir).parent.stat();
-      // Note: Getting free space is platform-specific
-      // For now, we proceed and handle disk full errors
-    } catch (e) {
-      // Ignore stat errors
-    }
-    
     final filePath = await getModelPath(modelId);
     final file = File(filePath);
     final tempPath = '$filePath.download';
     final tempFile = File(tempPath);
     
+    // Check disk space; a partial download already holds its share.
+    final freeBytes = NativeStorage.freeBytes(modelsDir);
+    if (freeBytes != null) {
+      final partialBytes = await tempFile.exists() ? await tempFile.length() : 0;
+      final requiredBytes = (model.sizeBytes * 1.1).ceil() - partialBytes; // 10% buffer
+      if (freeBytes < requiredBytes) {
+        yield DownloadError(
+          message: 'Not enough storage: ${_formatMb(requiredBytes)} needed, '
+              '${_formatMb(freeBytes)} free',
+        );
+        return;
+      }
+    }
+    
+    final url = Uri.parse(model.downloadUrl);
+    
+    // Servers that honour byte ranges get the parallel downloader.
+    final probe = await _probeRanges(url);
+    if (_isCancelled) {
+      yield const DownloadCancelled(downloadedBytes: 0);
+      return;
+    }
+    if (probe != null) {
+      // The catalog checksum wins; otherwise trust what the host published.
+      final expectedSha256 = model.sha256.isNotEmpty
+          ? model.sha256.toLowerCase()
+          : probe.publishedSha256;
+      await for (final event in _rangeDownloader.download(
+        modelId: modelId,
+        url: url,
+        totalBytes: probe.totalBytes,
+        path: tempPath,
+        expectedSha256: expectedSha256,
+      )) {
+        if (event is DownloadComplete) {
+          await tempFile.rename(filePath);
+          logger.i('Download complete: $filePath');
+          yield DownloadComplete(
+            modelId: modelId,
+            filePath: filePath,
+            sizeBytes: event.sizeBytes,
+          );
+        } else {
+          yield event;
+        }
+      }
+      return;
+    }
+    
+    // A ranged download's file is full-size from the start; appending to it
+    // would corrupt it.
+    final partsFile = File(RangeDownloader.partsPath(tempPath));
+    if (await partsFile.exists()) {
+      await partsFile.delete();
+      if (await tempFile.exists()) await tempFile.delete();
+    }
+    
     // Check for partial download (resume)
     int downloadedBytes = 0;
     if (await tempFile.exists()) {
@@ -136,18 +192,19 @@ class ModelDownloadService with Loggable {
       resumingFrom: downloadedBytes,
     );
     
+    final hasher = StreamingSha256();
+    
     try {
       _httpClient = HttpClient();
       _httpClient!.connectionTimeout = const Duration(seconds: 30);
       
-      final request = await _httpClient!.getUrl(Uri.parse(model.downloadUrl));
-      
-      // Add range header for resume
-      if (downloadedBytes > 0) {
-        request.headers.add('Range', 'bytes=$downloadedBytes-');
-      }
-      
-      final response = await request.close();
+      final (response, publishedSha256) = await _get(
+        url,
+        range: downloadedBytes > 0 ? 'bytes=$downloadedBytes-' : null,
+      );
+      // The catalog checksum wins; otherwise trust what the host published.
+      final expectedSha256 =
+          model.sha256.isNotEmpty ? model.sha256.toLowerCase() : publishedSha256;
       
       // Handle response codes
       if (response.statusCode != 200 && response.statusCode != 206) {
@@ -172,6 +229,14 @@ class ModelDownloadService with Loggable {
         }
       }
       
+      // A resumed download hashes the part already on disk once, then
+      // continues with the streamed bytes.
+      if (downloadedBytes > 0 && response.statusCode == 206) {
+        await for (final chunk in tempFile.openRead(0, downloadedBytes)) {
+          hasher.add(chunk);
+        }
+      }
+      
       // Open file for writing
       final sink = tempFile.openWrite(
         mode: downloadedBytes > 0 && response.statusCode == 206
@@ -191,6 +256,7 @@ class ModelDownloadService with Loggable {
           }
           
           sink.add(chunk);
+          hasher.add(chunk);
           receivedBytes += chunk.length;
           
           // Update progress every 100ms or 1MB
@@ -225,6 +291,20 @@ class ModelDownloadService with Loggable {
             return;
           }
           
+          final actualSha256 = hasher.close();
+          if (expectedSha256 == null) {
+            logger.w('No published checksum for $modelId; SHA-256 $actualSha256');
+          } else if (actualSha256 != expectedSha256) {
+            // Corrupt data must not be resumed from either.
+            await tempFile.delete();
+            yield DownloadError(
+              message: 'Checksum mismatch: got $actualSha256, expected $expectedSha256',
+            );
+            return;
+          } else {
+            logger.i('SHA-256 verified: $actualSha256');
+          }
+          
           // Move temp file to final location
           await tempFile.rename(filePath);
           
@@ -246,14 +326,70 @@ class ModelDownloadService with Loggable {
       logger.e('Download failed', error: e, stackTrace: stack);
       yield DownloadError(message: e.toString());
     } finally {
+      hasher.dispose();
       _httpClient?.close();
       _httpClient = null;
     }
   }
   
+  /// Size of the file at [url] and the checksum its host publishes, if the
+  /// server honours byte ranges; null otherwise.
+  Future<({int totalBytes, String? publishedSha256})?> _probeRanges(Uri url) async {
+    try {
+      _httpClient = HttpClient();
+      _httpClient!.connectionTimeout = const Duration(seconds: 30);
+      
+      final (response, publishedSha256) = await _get(url, range: 'bytes=0-0');
+      await response.drain<void>();
+      if (response.statusCode != 206) return null;
+      
+      // "bytes 0-0/<total>"
+      final contentRange = response.headers.value(HttpHeaders.contentRangeHeader);
+      final total = int.tryParse(contentRange?.split('/').last ?? '');
+      if (total == null || total <= 0) return null;
+      return (totalBytes: total, publishedSha256: publishedSha256);
+    } catch (e) {
+      logger.w('Range probe failed, downloading sequentially: $e');
+      return null;
+    } finally {
+      _httpClient?.close();
+      _httpClient = null;
+    }
+  }
+  
+  /// GET [url] (optionally one byte [range]), following redirects by hand:
+  /// Hugging Face publishes a file's SHA-256 only on its redirect response
+  /// (`X-Linked-ETag`), which automatic redirects would hide. Returns the
+  /// final response and that checksum, if any.
+  Future<(HttpClientResponse, String?)> _get(Uri url, {String? range}) async {
+    String? publishedSha256;
+    var uri = url;
+    for (var redirects = 0; redirects < 5; redirects++) {
+      final request = await _httpClient!.getUrl(uri);
+      request.followRedirects = false;
+      
+      // Add range header for resume
+      if (range != null) {
+        request.headers.add('Range', range);
+      }
+      
+      final response = await request.close();
+      publishedSha256 ??= sha256FromEtag(response.headers.value('x-linked-etag'));
+      
+      final location = response.headers.value(HttpHeaders.locationHeader);
+      if (!response.isRedirect || location == null) {
+        return (response, publishedSha256);
+      }
+      await response.drain<void>();
+      uri = uri.resolve(location);
+    }
+    throw HttpException('Too many redirects', uri: url);
+  }
+  
   /// Cancel ongoing download.
   void cancelDownload() {
     _isCancelled = true;
+    _rangeDownloader.cancel();
     _httpClient?.close(force: true);
     _httpClient = null;
   }
@@ -264,6 +400,11 @@ class ModelDownloadService with Loggable {
       final path = await getModelPath(modelId);
       final file = File(path);
       
+      final optimized = File(_optimizedPath(path));
+      if (await optimized.exists()) {
+        await optimized.delete();
+      }
+      
       if (await file.exists()) {
         await file.delete();
         logger.i('Deleted model: $path');
@@ -277,7 +418,16 @@ class ModelDownloadService with Loggable {
     }
   }
   
-  /// Clean up partial downloads.
+  String _optimizedPath(String modelPath) {
+    final stem = modelPath.endsWith('.gguf')
+        ? modelPath.substring(0, modelPath.length - '.gguf'.length)
+        : modelPath;
+    return '$stem$optimizedSuffix';
+  }
+  
+  static String _formatMb(int bytes) => '${bytes ~/ (1024 * 1024)} MB';
+  
+  /// Clean up partial downloads and interrupted model conversions.
   Future<void> cleanupPartialDownloads() async {
     final modelsDir = await getModelsDirectory();
     final dir = Directory(modelsDir);
@@ -285,7 +435,11 @@ class ModelDownloadService with Loggable {
     if (!await dir.exists()) return;
     
     await for (final entity in dir.list()) {
-      if (entity is File && entity.path.endsWith('.download')) {
+      if (entity is File &&
+          (entity.path.endsWith('.download') ||
+              entity.path.endsWith('.download.parts') ||
+              entity.path.endsWith('.download.parts.tmp') ||
+              entity.path.endsWith('$optimizedSuffix.tmp'))) {
         try {
           await entity.delete();
           logger.d('Cleaned up: ${entity.path}');
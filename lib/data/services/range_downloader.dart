@@ -0,0 +1,386 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+import '../../core/utils/logger.dart';
+import '../../native/sha256_bindings.dart';
+import '../../native/storage_bindings.dart';
+import 'model_download_service.dart';
+
+/// Downloads one file as several concurrent HTTP byte ranges.
+///
+/// The file's storage is reserved at its full size up front (fallocate
+/// through `libmicrollm_hash.so`, so a full disk fails the download before
+/// the first byte rather than halfway through), and each chunk is written at
+/// its own offset. A chunk map next to it (`<path>.parts`)
+/// records the SHA-256 of every chunk once it is on disk. An interrupted
+/// download therefore resumes with exactly the chunks it is missing, and a
+/// chunk that no longer matches its digest on resume is fetched again.
+///
+/// The whole-file SHA-256 is still computed in a single pass while chunks
+/// arrive: completed chunks are fed to it in file order, and the download
+/// window keeps at most `2 * connections` chunks ahead of that point, so the
+/// ones waiting in memory stay bounded.
+class RangeDownloader with Loggable {
+  /// Concurrent range requests.
+  final int connections;
+
+  /// Bytes per range request and per chunk map entry.
+  final int chunkSize;
+
+  /// Attempts per chunk before the download fails (it stays resumable).
+  final int maxAttempts;
+
+  /// Delay before the first retry of a chunk; doubled for each further one.
+  final Duration retryDelay;
+
+  HttpClient? _client;
+  bool _isCancelled = false;
+
+  RangeDownloader({
+    this.connections = 4,
+    this.chunkSize = 4 * 1024 * 1024,
+    this.maxAttempts = 4,
+    this.retryDelay = const Duration(seconds: 1),
+  });
+
+  /// Path of the chunk map kept beside a download in progress.
+  static String partsPath(String path) => '$path.parts';
+
+  /// Download [url] ([totalBytes] long) into [path].
+  ///
+  /// Emits [DownloadStarted], [DownloadProgress] events and one terminal
+  /// event: [DownloadComplete] with [path], [DownloadCancelled] or
+  /// [DownloadError]. When [expectedSha256] is given and the file does not
+  /// match it, the file and its chunk map are deleted.
+  Stream<DownloadEvent> download({
+    required String modelId,
+    required Uri url,
+    required int totalBytes,
+    required String path,
+    String? expectedSha256,
+  }) {
+    late final StreamController<DownloadEvent> controller;
+    controller = StreamController<DownloadEvent>(
+      onListen: () {
+        _run(controller, modelId, url, totalBytes, path, expectedSha256)
+            .catchError((Object e, StackTrace stack) {
+          logger.e('Range download failed', error: e, stackTrace: stack);
+          controller.add(DownloadError(message: e.toString()));
+        }).whenComplete(() {
+          _client?.close(force: true);
+          _client = null;
+          controller.close();
+        });
+      },
+    );
+    return controller.stream;
+  }
+
+  /// Abort the running download; finished chunks stay recorded.
+  void cancel() {
+    _isCancelled = true;
+    _client?.close(force: true);
+  }
+
+  Future<void> _run(
+    StreamController<DownloadEvent> events,
+    String modelId,
+    Uri url,
+    int totalBytes,
+    String path,
+    String? expectedSha256,
+  ) async {
+    _isCancelled = false;
+    _client = HttpClient()
+      ..connectionTimeout = const Duration(seconds: 30)
+      ..maxConnectionsPerHost = connections;
+
+    final file = File(path);
+    final partsFile = File(partsPath(path));
+    var map = await _ChunkMap.load(partsFile);
+    if (map == null ||
+        !map.matches(url, totalBytes, chunkSize) ||
+        !await file.exists()) {
+      map = _ChunkMap(url.toString(), totalBytes, chunkSize);
+      // Full size before the first byte arrives, so chunks land at their own
+      // offsets. Filesystems without fallocate (and tests, which lack the
+      // native library) get a sparse file instead.
+      final reserved = NativeStorage.preallocate(path, totalBytes);
+      if (reserved == NativeStorage.noSpace) {
+        throw FileSystemException('Not enough storage for the download', path);
+      }
+      if (reserved != 0) {
+        final raf = await file.open(mode: FileMode.write);
+        await raf.truncate(totalBytes);
+        await raf.close();
+      }
+      await map.save(partsFile);
+    }
+
+    var receivedBytes = map.doneBytes;
+    events.add(DownloadStarted(
+      modelId: modelId,
+      totalBytes: totalBytes,
+      resumingFrom: receivedBytes,
+    ));
+
+    var lastProgressUpdate = DateTime.now();
+    var lastProgressBytes = receivedBytes;
+    void onBytes(int count) {
+      receivedBytes += count;
+      final now = DateTime.now();
+      if (now.difference(lastProgressUpdate).inMilliseconds > 100) {
+        final elapsedMs = now.difference(lastProgressUpdate).inMilliseconds;
+        events.add(DownloadProgress(
+          downloadedBytes: receivedBytes,
+          totalBytes: totalBytes,
+          bytesPerSecond: max(
+              0, (receivedBytes - lastProgressBytes) * 1000 ~/ elapsedMs),
+        ));
+        lastProgressUpdate = now;
+        lastProgressBytes = receivedBytes;
+      }
+    }
+
+    final hasher = StreamingSha256();
+    final window = connections * 2;
+    final inFlight = <int, Future<_ChunkResult>>{};
+    final pending = <int, Uint8List>{};
+    Object? failure;
+    var cursor = 0;
+
+    try {
+      while (cursor < map.length) {
+        // Feed finished chunks to the whole-file hash in order. Chunks that
+        // finished in an earlier run are read back once, and re-verified.
+        if (map.isDone(cursor)) {
+          final data = pending.remove(cursor) ?? await _readVerified(file, map, cursor);
+          if (data != null) {
+            hasher.add(data);
+            cursor++;
+            continue;
+          }
+          logger.w('Chunk $cursor changed on disk; fetching it again');
+          receivedBytes -= map.chunkLength(cursor);
+          map.clear(cursor);
+          await map.save(partsFile);
+        }
+
+        if (failure == null && !_isCancelled) {
+          for (var i = cursor;
+              i < min(cursor + window, map.length) && inFlight.length < connections;
+              i++) {
+            if (!map.isDone(i) && !inFlight.containsKey(i)) {
+              inFlight[i] = _fetchChunk(url, file, map, i, onBytes);
+            }
+          }
+        }
+        if (inFlight.isEmpty) break;
+
+        final result = await Future.any(inFlight.values);
+        inFlight.remove(result.index);
+        if (result.error != null) {
+          failure ??= result.error;
+          continue;
+        }
+        map.complete(result.index, result.digest!);
+        await map.save(partsFile);
+        pending[result.index] = result.data!;
+      }
+    } finally {
+      if (cursor < map.length) hasher.dispose();
+    }
+
+    if (_isCancelled) {
+      events.add(DownloadCancelled(downloadedBytes: map.doneBytes));
+      return;
+    }
+    if (failure != null || cursor < map.length) {
+      events.add(DownloadError(message: 'Download interrupted: $failure'));
+      return;
+    }
+
+    final actualSha256 = hasher.close();
+    if (expectedSha256 == null) {
+      logger.w('No published checksum for $modelId; SHA-256 $actualSha256');
+    } else if (actualSha256 != expectedSha256) {
+      await file.delete();
+      await partsFile.delete();
+      events.add(DownloadError(
+        message: 'Checksum mismatch: got $actualSha256, expected $expectedSha256',
+      ));
+      return;
+    } else {
+      logger.i('SHA-256 verified: $actualSha256');
+    }
+
+    await partsFile.delete();
+    events.add(DownloadProgress(
+      downloadedBytes: totalBytes,
+      totalBytes: totalBytes,
+      bytesPerSecond: 0,
+    ));
+    events.add(DownloadComplete(
+      modelId: modelId,
+      filePath: path,
+      sizeBytes: totalBytes,
+    ));
+  }
+
+  /// Fetch chunk [index], write it at its offset and flush it, retrying
+  /// with backoff. Never throws; failures come back in the result.
+  Future<_ChunkResult> _fetchChunk(
+    Uri url,
+    File file,
+    _ChunkMap map,
+    int index,
+    void Function(int) onBytes,
+  ) async {
+    final start = index * map.chunkSize;
+    final end = start + map.chunkLength(index) - 1;
+    Object? lastError;
+
+    for (var attempt = 0; attempt < maxAttempts && !_isCancelled; attempt++) {
+      if (attempt > 0) {
+        await Future<void>.delayed(retryDelay * (1 << (attempt - 1)));
+      }
+      var attemptBytes = 0;
+      try {
+        final request = await _client!.getUrl(url);
+        request.headers.add(HttpHeaders.rangeHeader, 'bytes=$start-$end');
+        final response = await request.close();
+        final contentRange = response.headers.value(HttpHeaders.contentRangeHeader);
+        if (response.statusCode != 206 ||
+            contentRange != 'bytes $start-$end/${map.totalBytes}') {
+          await response.drain<void>();
+          throw HttpException(
+            'Range $start-$end: ${response.statusCode} ($contentRange)',
+            uri: url,
+          );
+        }
+
+        final builder = BytesBuilder(copy: false);
+        await for (final bytes in response) {
+          builder.add(bytes);
+          attemptBytes += bytes.length;
+          onBytes(bytes.length);
+        }
+        if (builder.length != end - start + 1) {
+          throw HttpException(
+            'Range $start-$end: got ${builder.length} bytes',
+            uri: url,
+          );
+        }
+        final data = builder.takeBytes();
+
+        final raf = await file.open(mode: FileMode.append);
+        try {
+          await raf.setPosition(start);
+          await raf.writeFrom(data);
+          await raf.flush();
+        } finally {
+          await raf.close();
+        }
+        return _ChunkResult(index, data: data, digest: _sha256(data));
+      } catch (e) {
+        onBytes(-attemptBytes);
+        lastError = e;
+        if (!_isCancelled) logger.w('Chunk $index attempt ${attempt + 1} failed: $e');
+      }
+    }
+    return _ChunkResult(index, error: lastError ?? 'cancelled');
+  }
+
+  /// Chunk [index] as read back from disk, or null if it no longer matches
+  /// the digest recorded when it was written.
+  Future<Uint8List?> _readVerified(File file, _ChunkMap map, int index) async {
+    final start = index * map.chunkSize;
+    final builder = BytesBuilder(copy: false);
+    await for (final bytes in file.openRead(start, start + map.chunkLength(index))) {
+      builder.add(bytes);
+    }
+    final data = builder.takeBytes();
+    return _sha256(data) == map.digest(index) ? data : null;
+  }
+
+  static String _sha256(List<int> data) => (StreamingSha256()..add(data)).close();
+}
+
+class _ChunkResult {
+  final int index;
+  final Uint8List? data;
+  final String? digest;
+  final Object? error;
+
+  const _ChunkResult(this.index, {this.data, this.digest, this.error});
+}
+
+/// Which chunks of a download are on disk, with the SHA-256 of each.
+class _ChunkMap {
+  final String url;
+  final int totalBytes;
+  final int chunkSize;
+  final List<String?> _digests;
+
+  _ChunkMap(this.url, this.totalBytes, this.chunkSize)
+      : _digests = List<String?>.filled((totalBytes + chunkSize - 1) ~/ chunkSize, null);
+
+  _ChunkMap._(this.url, this.totalBytes, this.chunkSize, this._digests);
+
+  int get length => _digests.length;
+
+  int chunkLength(int index) =>
+      min(chunkSize, totalBytes - index * chunkSize);
+
+  bool isDone(int index) => _digests[index] != null;
+
+  String? digest(int index) => _digests[index];
+
+  void complete(int index, String digest) => _digests[index] = digest;
+
+  void clear(int index) => _digests[index] = null;
+
+  int get doneBytes {
+    var bytes = 0;
+    for (var i = 0; i < length; i++) {
+      if (isDone(i)) bytes += chunkLength(i);
+    }
+    return bytes;
+  }
+
+  bool matches(Uri url, int totalBytes, int chunkSize) =>
+      this.url == url.toString() &&
+      this.totalBytes == totalBytes &&
+      this.chunkSize == chunkSize;
+
+  static Future<_ChunkMap?> load(File file) async {
+    try {
+      if (!await file.exists()) return null;
+      final json = jsonDecode(await file.readAsString()) as Map<String, dynamic>;
+      return _ChunkMap._(
+        json['url'] as String,
+        json['totalBytes'] as int,
+        json['chunkSize'] as int,
+        (json['chunks'] as List).cast<String?>().toList(),
+      );
+    } catch (_) {
+      return null;
+    }
+  }
+
+  /// Written to a temporary file and renamed, so a crash mid-save leaves the
+  /// previous map intact.
+  Future<void> save(File file) async {
+    final tmp = File('${file.path}.tmp');
+    await tmp.writeAsString(jsonEncode({
+      'url': url,
+      'totalBytes': totalBytes,
+      'chunkSize': chunkSize,
+      'chunks': _digests,
+    }), flush: true);
+    await tmp.rename(file.path);
+  }
+}
@@ -54,6 +54,11 @@ class AppSettings extends Equatable {
   
   /// Number of threads for inference.
   final int inferenceThreads;
+
+  /// Rewrite Q4_K downloads as Q4_0 for this CPU's repacked dotprod/i8mm
+  /// kernels and load that copy instead. Faster on those CPUs, at a slightly
+  /// higher quantization error, so it is opt-in.
+  final bool optimizeModelsForCpu;
   
   /// Whether to auto-detect input language.
   final bool autoDetectLanguage;
@@ -84,6 +89,7 @@ class AppSettings extends Equatable {
     this.contextWindowSize,
     this.maxGenerationTokens = ModelConstants.maxGenerationTokens,
     this.inferenceThreads = ModelConstants.maxInferenceThreads,
+    this.optimizeModelsForCpu = false,
     this.autoDetectLanguage = true,
     this.themePreference = ThemePreference.system,
     this.selectedModelPath,
@@ -109,6 +115,7 @@ class AppSettings extends Equatable {
     int? contextWindowSize,
     int? maxGenerationTokens,
     int? inferenceThreads,
+    bool? optimizeModelsForCpu,
     bool? autoDetectLanguage,
     ThemePreference? themePreference,
     String? selectedModelPath,
@@ -129,6 +136,7 @@ class AppSettings extends Equatable {
       contextWindowSize: contextWindowSize ?? this.contextWindowSize,
       maxGenerationTokens: maxGenerationTokens ?? this.maxGenerationTokens,
       inferenceThreads: inferenceThreads ?? this.inferenceThreads,
+      optimizeModelsForCpu: optimizeModelsForCpu ?? this.optimizeModelsForCpu,
       autoDetectLanguage: autoDetectLanguage ?? this.autoDetectLanguage,
       themePreference: themePreference ?? this.themePreference,
       selectedModelPath: selectedModelPath ?? this.selectedModelPath,
@@ -172,6 +180,7 @@ class AppSettings extends Equatable {
     contextWindowSize,
     maxGenerationTokens,
     inferenceThreads,
+    optimizeModelsForCpu,
     autoDetectLanguage,
     themePreference,
     selectedModelPath,
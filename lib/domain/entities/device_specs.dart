@@ -1,5 +1,7 @@
 import 'package:equatable/equatable.dart';
 
+import 'memory_estimate.dart';
+
 /// Device hardware specifications.
 /// 
 /// Captures all relevant hardware info for model compatibility assessment.
@@ -191,10 +193,15 @@ class ModelOption extends Equatable {
   /// Context window size.
   final int contextSize;
   
+  /// f16 KV cache bytes per context token (K and V, all layers), from the
+  /// model architecture: 2 * layers * kv_heads * head_dim * 2. 0 if unknown.
+  final int kvCacheBytesPerToken;
+  
   /// Download URL.
   final String downloadUrl;
   
-  /// SHA256 hash for verification.
+  /// SHA256 hash the download is verified against; empty to use the one
+  /// the host publishes (Hugging Face's LFS checksum).
   final String sha256;
   
   /// Supported languages.
@@ -216,6 +223,7 @@ class ModelOption extends Equatable {
     required this.minRamBytes,
     required this.recommendedRamBytes,
     required this.contextSize,
+    this.kvCacheBytesPerToken = 0,
     required this.downloadUrl,
     required this.sha256,
     this.supportedLanguages = const ['en'],
@@ -250,6 +258,7 @@ class ModelOption extends Equatable {
       minRamBytes: minRamBytes,
       recommendedRamBytes: recommendedRamBytes,
       contextSize: contextSize,
+      kvCacheBytesPerToken: kvCacheBytesPerToken,
       downloadUrl: downloadUrl,
       sha256: sha256,
       supportedLanguages: supportedLanguages,
@@ -288,6 +297,13 @@ class ModelCompatibility extends Equatable {
   /// Recommendations.
   final List<String> recommendations;
   
+  /// Memory needed at the assessed context size and KV cache type.
+  final MemoryEstimate? memoryEstimate;
+  
+  /// Largest context (tokens) that fits in the device's available RAM with
+  /// the assessed KV cache type; 0 if not even a minimal context fits.
+  final int maxContextSize;
+  
   const ModelCompatibility({
     required this.model,
     required this.level,
@@ -297,6 +313,8 @@ class ModelCompatibility extends Equatable {
     required this.hasEnoughRam,
     this.warnings = const [],
     this.recommendations = const [],
+    this.memoryEstimate,
+    this.maxContextSize = 0,
   });
   
   /// Overall score (0-100).
@@ -0,0 +1,91 @@
+import 'package:equatable/equatable.dart';
+
+/// Native timing breakdown of a single generation request.
+///
+/// Collected inside the llama.cpp engine, so it excludes platform channel and
+/// Dart overhead. Durations are milliseconds.
+class InferenceMetrics extends Equatable {
+  final double tokenizeMs;
+
+  /// Tokens decoded in the prefill step.
+  final int promptTokens;
+  final double prefillMs;
+
+  /// Single-token decodes after the prefill.
+  final int decodeTokens;
+
+  /// Per-token decode latency percentiles.
+  final double decodeP50Ms;
+  final double decodeP95Ms;
+  final double decodeP99Ms;
+
+  /// Total time spent in the sampler chain.
+  final double sampleMs;
+
+  /// Total time spent converting tokens to text.
+  final double detokenizeMs;
+
+  /// KV cache cells in use after the request, out of [kvSize].
+  final int kvUsed;
+  final int kvSize;
+
+  /// Peak resident memory of the app process during the request.
+  final int peakRssBytes;
+
+  const InferenceMetrics({
+    this.tokenizeMs = 0,
+    this.promptTokens = 0,
+    this.prefillMs = 0,
+    this.decodeTokens = 0,
+    this.decodeP50Ms = 0,
+    this.decodeP95Ms = 0,
+    this.decodeP99Ms = 0,
+    this.sampleMs = 0,
+    this.detokenizeMs = 0,
+    this.kvUsed = 0,
+    this.kvSize = 0,
+    this.peakRssBytes = 0,
+  });
+
+  factory InferenceMetrics.fromMap(Map<dynamic, dynamic> map) {
+    double d(String key) => (map[key] as num?)?.toDouble() ?? 0.0;
+    int i(String key) => (map[key] as num?)?.toInt() ?? 0;
+    return InferenceMetrics(
+      tokenizeMs: d('tokenizeMs'),
+      promptTokens: i('promptTokens'),
+      prefillMs: d('prefillMs'),
+      decodeTokens: i('decodeTokens'),
+      decodeP50Ms: d('decodeP50Ms'),
+      decodeP95Ms: d('decodeP95Ms'),
+      decodeP99Ms: d('decodeP99Ms'),
+      sampleMs: d('sampleMs'),
+      detokenizeMs: d('detokenizeMs'),
+      kvUsed: i('kvUsed'),
+      kvSize: i('kvSize'),
+      peakRssBytes: i('peakRssBytes'),
+    );
+  }
+
+  /// Prompt processing speed in tokens per second.
+  double get prefillTokensPerSecond =>
+      prefillMs > 0 ? promptTokens / (prefillMs / 1000) : 0;
+
+  /// Fraction of the KV cache in use (0.0-1.0).
+  double get kvUsage => kvSize > 0 ? kvUsed / kvSize : 0;
+
+  @override
+  List<Object?> get props => [
+        tokenizeMs,
+        promptTokens,
+        prefillMs,
+        decodeTokens,
+        decodeP50Ms,
+        decodeP95Ms,
+        decodeP99Ms,
+        sampleMs,
+        detokenizeMs,
+        kvUsed,
+        kvSize,
+        peakRssBytes,
+      ];
+}
@@ -1,6 +1,9 @@
 import 'package:equatable/equatable.dart';
+import 'inference_metrics.dart';
 import 'message.dart';
 
+export 'inference_metrics.dart';
+
 /// Request parameters for LLM inference.
 /// 
 /// Encapsulates all parameters needed for a single inference call.
@@ -46,6 +49,25 @@ class InferenceRequest extends Equatable {
   /// The JNI backend uses ChatML and can accept a system prompt for stateless calls.
   final String? systemPrompt;
 
+  /// LoRA adapter (GGUF path) to run this request with; null for the base model.
+  ///
+  /// Adapters are loaded once against the already loaded base weights and then only
+  /// switched between requests, so per-task fine-tunes (e.g. translation or
+  /// summarization) cost no model reload. Switching adapters clears the native KV
+  /// cache; the chat is prefilled again under the new one.
+  final String? loraAdapterPath;
+
+  /// Strength of [loraAdapterPath]; 1.0 applies it as trained.
+  final double loraScale;
+
+  /// GBNF grammar (start rule `root`) every generated token must fit, e.g.
+  /// from `JsonSchemaGrammar.fromSchema`; null samples freely.
+  ///
+  /// Structured calls (evaluation JSON) then parse on the first try instead
+  /// of being retried. Only the JNI backend enforces it, so parsers keep
+  /// their fallbacks for free-form output.
+  final String? grammar;
+
   const InferenceRequest({
     required this.prompt,
     this.contextMessages = const [],
@@ -58,6 +80,9 @@ class InferenceRequest extends Equatable {
     this.stream = true,
     this.isolated = false,
     this.systemPrompt,
+    this.loraAdapterPath,
+    this.loraScale = 1.0,
+    this.grammar,
   });
   
   /// Create a request for a conversation response.
@@ -167,6 +192,9 @@ Explanation:''',
     stream,
     isolated,
     systemPrompt,
+    loraAdapterPath,
+    loraScale,
+    grammar,
   ];
 }
 
@@ -199,6 +227,9 @@ class InferenceResponse extends Equatable {
   
   /// Stop reason.
   final StopReason stopReason;
+
+  /// Native timing breakdown, when the backend reports one.
+  final InferenceMetrics? metrics;
   
   const InferenceResponse({
     required this.text,
@@ -208,6 +239,7 @@ class InferenceResponse extends Equatable {
     required this.totalTimeMs,
     this.reachedMaxTokens = false,
     this.stopReason = StopReason.endOfText,
+    this.metrics,
   });
   
   @override
@@ -219,6 +251,7 @@ class InferenceResponse extends Equatable {
     totalTimeMs,
     reachedMaxTokens,
     stopReason,
+    metrics,
   ];
 }
 
@@ -0,0 +1,100 @@
+import 'package:equatable/equatable.dart';
+
+/// Element type of the llama.cpp KV cache.
+///
+/// Quantized types shrink the cache that grows with the context window:
+/// q8_0 roughly halves it, q4_0 roughly quarters it. A quantized V cache
+/// requires flash attention, which the native loader then enables.
+enum KvCacheType {
+  f16('f16', 2.0),
+  q8_0('q8_0', 34 / 32),
+  q4_0('q4_0', 18 / 32);
+
+  /// Name understood by the native loader.
+  final String nativeName;
+
+  /// Bytes per cached value, including the per-block scales of quantized types.
+  final double bytesPerElement;
+
+  const KvCacheType(this.nativeName, this.bytesPerElement);
+
+  /// Size relative to an f16 cache.
+  double get ratioToF16 => bytesPerElement / KvCacheType.f16.bytesPerElement;
+}
+
+/// Memory a model needs once loaded: weights, KV cache and compute buffers.
+///
+/// Returned by the native loader for the loaded model, or estimated from the
+/// model catalog by `CompatibilityCalculator.estimateMemory` before download.
+class MemoryEstimate extends Equatable {
+  final int weightsBytes;
+
+  /// KV cache for the full context window.
+  final int kvCacheBytes;
+
+  /// Scratch buffers for a prompt-processing batch.
+  final int computeBytes;
+
+  const MemoryEstimate({
+    required this.weightsBytes,
+    required this.kvCacheBytes,
+    required this.computeBytes,
+  });
+
+  factory MemoryEstimate.fromMap(Map<dynamic, dynamic> map) {
+    int i(String key) => (map[key] as num?)?.toInt() ?? 0;
+    return MemoryEstimate(
+      weightsBytes: i('weightsBytes'),
+      kvCacheBytes: i('kvCacheBytes'),
+      computeBytes: i('computeBytes'),
+    );
+  }
+
+  int get totalBytes => weightsBytes + kvCacheBytes + computeBytes;
+
+  /// Human-readable total.
+  String get totalFormatted =>
+      '${(totalBytes / (1024 * 1024 * 1024)).toStringAsFixed(1)} GB';
+
+  @override
+  List<Object?> get props => [weightsBytes, kvCacheBytes, computeBytes];
+}
+
+/// Where the loaded model's memory-mapped weights currently are.
+///
+/// Weights are paged in from the model file on demand and can be reclaimed
+/// by the OS under memory pressure; locked bytes are pinned in RAM until the
+/// OS reports pressure.
+class WeightResidency extends Equatable {
+  /// Size of the mapped model file.
+  final int mappedBytes;
+
+  /// Part of it currently in RAM.
+  final int residentBytes;
+
+  /// Part of it pinned (hot tensors locked with lockHotWeights).
+  final int lockedBytes;
+
+  const WeightResidency({
+    required this.mappedBytes,
+    required this.residentBytes,
+    required this.lockedBytes,
+  });
+
+  factory WeightResidency.fromMap(Map<dynamic, dynamic> map) {
+    int i(String key) => (map[key] as num?)?.toInt() ?? 0;
+    return WeightResidency(
+      mappedBytes: i('mappedBytes'),
+      residentBytes: i('residentBytes'),
+      lockedBytes: i('lockedBytes'),
+    );
+  }
+
+  /// Fraction of the weights in RAM, 0..1. Below 1, generation may stall on
+  /// reads from flash.
+  double get residentFraction =>
+      mappedBytes == 0 ? 0 : residentBytes / mappedBytes;
+
+  @override
+  List<Object?> get props => [mappedBytes, residentBytes, lockedBytes];
+}
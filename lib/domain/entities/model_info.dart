@@ -1,5 +1,7 @@
 import 'package:equatable/equatable.dart';
 
+import 'memory_estimate.dart';
+
 /// Information about the loaded LLM model.
 /// 
 /// This entity encapsulates all metadata about the currently loaded
@@ -11,6 +13,10 @@ class ModelInfo extends Equatable {
   /// Full path to the model file.
   final String filePath;
   
+  /// File the weights were loaded from; differs from [filePath] when the
+  /// copy converted for this CPU was loaded instead. Null if not loaded.
+  final String? loadedFilePath;
+  
   /// Model size in bytes.
   final int sizeBytes;
   
@@ -38,9 +44,20 @@ class ModelInfo extends Equatable {
   /// Supported languages (if known).
   final List<String>? supportedLanguages;
   
+  /// Native memory estimate for the loaded context (weights, KV cache, compute).
+  final MemoryEstimate? memoryEstimate;
+  
+  /// Time the native load took, excluding the warm-up.
+  final int? loadTimeMs;
+  
+  /// Time the warm-up pass took after loading (dummy prefill and decode that
+  /// absorb the first-run costs), null if it was skipped.
+  final int? warmupTimeMs;
+  
   const ModelInfo({
     required this.fileName,
     required this.filePath,
+    this.loadedFilePath,
     required this.sizeBytes,
     required this.quantization,
     required this.parameterCount,
@@ -50,6 +67,9 @@ class ModelInfo extends Equatable {
     this.sha256Hash,
     this.architecture,
     this.supportedLanguages,
+    this.memoryEstimate,
+    this.loadTimeMs,
+    this.warmupTimeMs,
   });
   
   /// Create from GGUF metadata.
@@ -73,6 +93,7 @@ class ModelInfo extends Equatable {
   ModelInfo copyWith({
     String? fileName,
     String? filePath,
+    String? loadedFilePath,
     int? sizeBytes,
     String? quantization,
     String? parameterCount,
@@ -82,10 +103,14 @@ class ModelInfo extends Equatable {
     String? sha256Hash,
     String? architecture,
     List<String>? supportedLanguages,
+    MemoryEstimate? memoryEstimate,
+    int? loadTimeMs,
+    int? warmupTimeMs,
   }) {
     return ModelInfo(
       fileName: fileName ?? this.fileName,
       filePath: filePath ?? this.filePath,
+      loadedFilePath: loadedFilePath ?? this.loadedFilePath,
       sizeBytes: sizeBytes ?? this.sizeBytes,
       quantization: quantization ?? this.quantization,
       parameterCount: parameterCount ?? this.parameterCount,
@@ -95,6 +120,9 @@ class ModelInfo extends Equatable {
       sha256Hash: sha256Hash ?? this.sha256Hash,
       architecture: architecture ?? this.architecture,
       supportedLanguages: supportedLanguages ?? this.supportedLanguages,
+      memoryEstimate: memoryEstimate ?? this.memoryEstimate,
+      loadTimeMs: loadTimeMs ?? this.loadTimeMs,
+      warmupTimeMs: warmupTimeMs ?? this.warmupTimeMs,
     );
   }
   
@@ -119,6 +147,7 @@ class ModelInfo extends Equatable {
   List<Object?> get props => [
     fileName,
     filePath,
+    loadedFilePath,
     sizeBytes,
     quantization,
     parameterCount,
@@ -127,6 +156,9 @@ class ModelInfo extends Equatable {
     memoryUsageBytes,
     sha256Hash,
     architecture,
+    memoryEstimate,
+    loadTimeMs,
+    warmupTimeMs,
   ];
 }
 
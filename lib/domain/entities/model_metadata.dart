@@ -0,0 +1,102 @@
+import 'package:equatable/equatable.dart';
+
+/// Facts about a downloaded model read from its GGUF header, without
+/// loading it.
+///
+/// Unlike the catalog figures these are exact for the file on disk, so
+/// memory estimates and context sizing built on them match what the native
+/// loader will allocate.
+class ModelMetadata extends Equatable {
+  /// `general.architecture`, e.g. "llama" or "qwen2".
+  final String architecture;
+
+  /// `general.name`; empty if the file does not set it.
+  final String name;
+
+  /// Total number of weights.
+  final int parameterCount;
+
+  /// Bytes of tensor data (what the loader maps).
+  final int weightsBytes;
+
+  /// Context length the model was trained with.
+  final int contextLength;
+
+  final int vocabSize;
+  final int layerCount;
+  final int embeddingLength;
+  final int headCount;
+  final int headCountKv;
+
+  /// K plus V cache bytes one token adds with an f16 cache.
+  final int kvBytesPerToken;
+
+  /// Bytes stored per tensor type (quantization mix), largest first.
+  final Map<String, int> tensorTypeBytes;
+
+  const ModelMetadata({
+    required this.architecture,
+    required this.name,
+    required this.parameterCount,
+    required this.weightsBytes,
+    required this.contextLength,
+    required this.vocabSize,
+    required this.layerCount,
+    required this.embeddingLength,
+    required this.headCount,
+    required this.headCountKv,
+    required this.kvBytesPerToken,
+    this.tensorTypeBytes = const {},
+  });
+
+  factory ModelMetadata.fromMap(Map<dynamic, dynamic> map) {
+    int i(String key) => (map[key] as num?)?.toInt() ?? 0;
+    final types = (map['tensorTypeBytes'] as Map?) ?? const {};
+    final sorted = types.entries.toList()
+      ..sort((a, b) => (b.value as num).compareTo(a.value as num));
+    return ModelMetadata(
+      architecture: map['architecture'] as String? ?? '',
+      name: map['name'] as String? ?? '',
+      parameterCount: i('parameterCount'),
+      weightsBytes: i('weightsBytes'),
+      contextLength: i('contextLength'),
+      vocabSize: i('vocabSize'),
+      layerCount: i('layerCount'),
+      embeddingLength: i('embeddingLength'),
+      headCount: i('headCount'),
+      headCountKv: i('headCountKv'),
+      kvBytesPerToken: i('kvBytesPerToken'),
+      tensorTypeBytes: {
+        for (final e in sorted) e.key as String: (e.value as num).toInt(),
+      },
+    );
+  }
+
+  /// Tensor type holding most of the weights, e.g. "q4_K"; empty if unknown.
+  String get dominantTensorType =>
+      tensorTypeBytes.isEmpty ? '' : tensorTypeBytes.keys.first;
+
+  /// Parameter count as the catalog writes it ("135M", "1.5B").
+  String get parameterCountFormatted {
+    if (parameterCount >= 1000000000) {
+      return '${(parameterCount / 1e9).toStringAsFixed(1)}B';
+    }
+    return '${(parameterCount / 1e6).round()}M';
+  }
+
+  @override
+  List<Object?> get props => [
+        architecture,
+        name,
+        parameterCount,
+        weightsBytes,
+        contextLength,
+        vocabSize,
+        layerCount,
+        embeddingLength,
+        headCount,
+        headCountKv,
+        kvBytesPerToken,
+        tensorTypeBytes,
+      ];
+}
@@ -0,0 +1,117 @@
+import 'package:equatable/equatable.dart';
+
+/// Sweep for the native llama-bench style throughput benchmark.
+///
+/// Every combination of [batchSizes] × [threadCounts] × [promptSizes] is measured
+/// [repetitions] times against the real GGUF model.
+class ThroughputBenchmarkConfig extends Equatable {
+  /// Prompt lengths (tokens) for the prompt-processing test.
+  final List<int> promptSizes;
+
+  /// Tokens generated per run for the generation test.
+  final int genTokens;
+
+  /// Logical batch sizes (`n_batch`) to compare.
+  final List<int> batchSizes;
+
+  /// Thread counts to compare.
+  final List<int> threadCounts;
+
+  /// Runs per combination; results report mean and standard deviation.
+  final int repetitions;
+
+  const ThroughputBenchmarkConfig({
+    this.promptSizes = const [128, 512],
+    this.genTokens = 32,
+    this.batchSizes = const [128, 512],
+    this.threadCounts = const [4, 6],
+    this.repetitions = 3,
+  });
+
+  /// Quick sweep for on-device use (a few seconds on a mid-range phone with a 1B model).
+  static const quick = ThroughputBenchmarkConfig(
+    promptSizes: [128],
+    genTokens: 32,
+    batchSizes: [512],
+    threadCounts: [4, 6],
+    repetitions: 2,
+  );
+
+  int get combinationCount =>
+      promptSizes.length * batchSizes.length * threadCounts.length;
+
+  Map<String, dynamic> toMap() => {
+        'promptSizes': promptSizes,
+        'genTokens': genTokens,
+        'batchSizes': batchSizes,
+        'threadCounts': threadCounts,
+        'repetitions': repetitions,
+      };
+
+  @override
+  List<Object?> get props =>
+      [promptSizes, genTokens, batchSizes, threadCounts, repetitions];
+}
+
+/// Measured throughput for one (prompt size, batch size, thread count) combination.
+class ThroughputBenchmarkRow extends Equatable {
+  final int promptTokens;
+  final int genTokens;
+  final int batchSize;
+  final int threads;
+
+  /// Prompt processing speed (tokens/s), mean over repetitions.
+  final double promptTokensPerSecond;
+  final double promptStdDev;
+
+  /// Generation speed (tokens/s), mean over repetitions.
+  final double genTokensPerSecond;
+  final double genStdDev;
+
+  /// Prefill plus first sample, in milliseconds.
+  final double timeToFirstTokenMs;
+
+  const ThroughputBenchmarkRow({
+    required this.promptTokens,
+    required this.genTokens,
+    required this.batchSize,
+    required this.threads,
+    required this.promptTokensPerSecond,
+    required this.promptStdDev,
+    required this.genTokensPerSecond,
+    required this.genStdDev,
+    required this.timeToFirstTokenMs,
+  });
+
+  factory ThroughputBenchmarkRow.fromMap(Map<dynamic, dynamic> map) {
+    double d(String key) => (map[key] as num?)?.toDouble() ?? 0.0;
+    int i(String key) => (map[key] as num?)?.toInt() ?? 0;
+    return ThroughputBenchmarkRow(
+      promptTokens: i('nPrompt'),
+      genTokens: i('nGen'),
+      batchSize: i('nBatch'),
+      threads: i('nThreads'),
+      promptTokensPerSecond: d('ppTokensPerSecond'),
+      promptStdDev: d('ppStdDev'),
+      genTokensPerSecond: d('tgTokensPerSecond'),
+      genStdDev: d('tgStdDev'),
+      timeToFirstTokenMs: d('ttftMs'),
+    );
+  }
+
+  /// Short label in llama-bench notation, e.g. `pp128 b512 t4`.
+  String get label => 'pp$promptTokens b$batchSize t$threads';
+
+  @override
+  List<Object?> get props => [
+        promptTokens,
+        genTokens,
+        batchSize,
+        threads,
+        promptTokensPerSecond,
+        promptStdDev,
+        genTokensPerSecond,
+        genStdDev,
+        timeToFirstTokenMs,
+      ];
+}
@@ -1,5 +1,8 @@
 import '../entities/inference_request.dart';
+import '../entities/memory_estimate.dart';
 import '../entities/model_info.dart';
+import '../entities/model_metadata.dart';
+import '../entities/throughput_benchmark.dart';
 import '../../core/utils/result.dart';
 
 /// Repository interface for LLM operations.
@@ -21,13 +24,44 @@ abstract class LLMRepository {
   /// Parameters:
   /// - [modelPath]: Absolute path to the GGUF model file.
   /// - [contextSize]: Context window size (defaults to model's native size).
-  /// - [threads]: Number of threads for inference.
+  /// - [threads]: Number of threads for inference; null picks them per device.
+  /// - [batchSize]/[ubatchSize]: Tokens per decode call / per compute step;
+  ///   a null [ubatchSize] adapts it to free memory and prefill speed.
+  /// - [flashAttention]: Fused attention kernel (no n_ctx-sized score buffers).
+  /// - [cacheTypeK]/[cacheTypeV]: KV cache element types; quantized types fit
+  ///   larger contexts in the same memory.
+  /// - [prefetch]: Read the weights into memory before returning, so the first
+  ///   prompt is not slowed by paging them in. Progress is on [loadProgress].
+  /// - [lockHotWeights]: Pin the most-read weights in RAM while memory allows;
+  ///   released automatically when the OS reports memory pressure.
+  /// - [useOptimizedModel]: Load the copy [optimizeModel] made for this CPU
+  ///   instead of [modelPath] when one exists. [ModelInfo.loadedFilePath] and
+  ///   [ModelInfo.quantization] describe the file actually loaded.
+  /// - [warmup]: Absorb first-run costs at load time with a dummy prefill and
+  ///   decode; reported as [ModelInfo.warmupTimeMs].
+  /// - [hotSwap]: If a model is loaded, keep it answering while the new one
+  ///   loads, then switch; when both do not fit in memory the current model is
+  ///   unloaded first as before.
   AsyncResult<ModelInfo> loadModel({
     required String modelPath,
     int? contextSize,
     int? threads,
+    int batchSize = 512,
+    int? ubatchSize = 512,
+    bool flashAttention = false,
+    KvCacheType cacheTypeK = KvCacheType.f16,
+    KvCacheType cacheTypeV = KvCacheType.f16,
+    bool prefetch = true,
+    bool lockHotWeights = false,
+    bool useOptimizedModel = false,
+    bool warmup = true,
+    bool hotSwap = true,
   });
   
+  /// Progress (0..1) of the [loadModel] call in flight, where the backend
+  /// reports it.
+  Stream<double> get loadProgress;
+  
   /// Unload the currently loaded model from memory.
   /// 
   /// Should be called when:
@@ -81,6 +115,47 @@ abstract class LLMRepository {
   /// 
   /// Used to determine if it's safe to load a model or run inference.
   AsyncResult<MemoryStatus> checkMemoryStatus();
+  
+  /// Measure real llama.cpp throughput (prompt processing, generation,
+  /// time to first token) for the GGUF at [modelPath].
+  /// 
+  /// Runs in its own native context, so the loaded chat model and its
+  /// conversation state are unaffected.
+  AsyncResult<List<ThroughputBenchmarkRow>> runThroughputBenchmark({
+    required String modelPath,
+    ThroughputBenchmarkConfig config = const ThroughputBenchmarkConfig(),
+  });
+
+  /// Change prefill and decode thread counts of the loaded model without
+  /// reloading it. Takes effect from the next decode.
+  AsyncResult<void> setThreads({required int prefill, required int decode});
+
+  /// Enable or disable thermal/battery pacing of generation (off by default;
+  /// the choice is kept across loads). A [targetTokensPerSecond] of 0 adapts
+  /// to the device.
+  AsyncResult<void> setThermalGovernor({
+    required bool enabled,
+    double targetTokensPerSecond = 0,
+  });
+
+  /// How much of the loaded model's weights are in RAM and pinned there.
+  AsyncResult<WeightResidency> getWeightResidency();
+
+  /// Architecture, size, quantization mix and exact per-token KV cost of the
+  /// model at [modelPath], read from its header in milliseconds; nothing is
+  /// loaded, so it works for any downloaded model.
+  AsyncResult<ModelMetadata> inspectModel(String modelPath);
+
+  /// Load a LoRA adapter against the loaded model's weights so the first
+  /// request using it ([InferenceRequest.loraAdapterPath]) does not pay for
+  /// reading it. Requests switch adapters without reloading the model.
+  AsyncResult<void> loadAdapter(String adapterPath);
+
+  /// One-time rewrite of the model at [modelPath] into the layout this CPU
+  /// runs fastest, cached next to it and used by later loads that pass
+  /// useOptimizedModel. Takes minutes; yields the cached copy's path, or null
+  /// if nothing would improve.
+  AsyncResult<String?> optimizeModel(String modelPath);
 }
 
 /// Events emitted during streaming generation.
@@ -30,12 +30,15 @@ abstract class VoiceRepository {
   /// - [continuous]: Whether to keep listening for multiple utterances
   /// - [preferOffline]: Prefer offline recognition if available
   /// - [offlineOnly]: If true, never fall back to online recognition
+  /// - [autoDetectLanguage]: Whisper detects the spoken language instead of
+  ///   using [language] (ignored by the Android recognizer)
   Stream<SpeechRecognitionResult> startRecognition({
     required SpeechToTextEngine engine,
     required String language,
     bool continuous = false,
     bool preferOffline = true,
     bool offlineOnly = false,
+    bool autoDetectLanguage = false,
     int whisperThreads = 4,
   });
 
@@ -53,6 +56,11 @@ abstract class VoiceRepository {
 
   /// Returns true if Whisper model is loaded.
   AsyncResult<bool> isWhisperModelLoaded();
+
+  /// Memory the loaded Whisper model holds (weights plus the estimated
+  /// compute and KV buffers), from the native load report; null if no model
+  /// is loaded.
+  AsyncResult<int?> getWhisperResidentBytes();
   
   /// Stop ongoing speech recognition.
   Future<void> stopRecognition();
@@ -135,6 +143,12 @@ class SpeechRecognitionResult {
   /// Optional input level (RMS dB) for UI animations.
   /// This is device/engine-specific and may be null.
   final double? levelDb;
+
+  /// Timestamped segments (Whisper final results only; empty otherwise).
+  ///
+  /// Lets downstream steps chunk by time or skip low-confidence spans
+  /// without re-running recognition.
+  final List<TranscriptSegment> segments;
   
   const SpeechRecognitionResult({
     required this.text,
@@ -142,6 +156,7 @@ class SpeechRecognitionResult {
     required this.isFinal,
     this.alternatives = const [],
     this.levelDb,
+    this.segments = const [],
   });
   
   /// Returns true if confidence is high enough to use.
@@ -152,6 +167,58 @@ class SpeechRecognitionResult {
       'SpeechRecognitionResult(text: $text, confidence: $confidence, isFinal: $isFinal, levelDb: $levelDb)';
 }
 
+/// A recognized span of speech with timing and token-level confidence.
+class TranscriptSegment {
+  final String text;
+
+  /// Offsets relative to the start of the recognized audio.
+  final int startMs;
+  final int endMs;
+
+  /// Mean probability of the segment's text tokens (0.0-1.0).
+  final double confidence;
+
+  /// Whisper's no-speech probability for this segment.
+  final double noSpeechProb;
+
+  final List<int> tokenIds;
+  final List<double> tokenProbs;
+
+  const TranscriptSegment({
+    required this.text,
+    required this.startMs,
+    required this.endMs,
+    required this.confidence,
+    this.noSpeechProb = 0.0,
+    this.tokenIds = const [],
+    this.tokenProbs = const [],
+  });
+
+  factory TranscriptSegment.fromMap(Map<dynamic, dynamic> map) {
+    return TranscriptSegment(
+      text: map['text'] as String? ?? '',
+      startMs: (map['startMs'] as num?)?.toInt() ?? 0,
+      endMs: (map['endMs'] as num?)?.toInt() ?? 0,
+      confidence: (map['confidence'] as num?)?.toDouble() ?? 0.0,
+      noSpeechProb: (map['noSpeechProb'] as num?)?.toDouble() ?? 0.0,
+      tokenIds: (map['tokenIds'] as List?)
+              ?.map((e) => (e as num).toInt())
+              .toList() ??
+          const [],
+      tokenProbs: (map['tokenProbs'] as List?)
+              ?.map((e) => (e as num).toDouble())
+              .toList() ??
+          const [],
+    );
+  }
+
+  int get durationMs => endMs - startMs;
+
+  @override
+  String toString() =>
+      'TranscriptSegment([$startMs-$endMs ms] $text, confidence: $confidence)';
+}
+
 /// Represents a language available for voice operations.
 class VoiceLanguage {
   /// Language code (e.g., "en-US").
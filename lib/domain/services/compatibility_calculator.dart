@@ -1,4 +1,7 @@
+import '../../core/constants/app_constants.dart';
 import '../entities/device_specs.dart';
+import '../entities/memory_estimate.dart';
+import '../entities/model_metadata.dart';
 import 'model_catalog.dart';
 
 /// Calculates model compatibility and performance estimates for a device.
@@ -7,12 +10,42 @@ import 'model_catalog.dart';
 /// - Whether a model will run
 /// - Expected tokens per second
 /// - Time to first token
+/// - Memory needed for a context size and KV cache type
 /// - Potential issues
 class CompatibilityCalculator {
   CompatibilityCalculator._();
   
+  /// Prompt batch (n_ubatch) the native loader processes at once.
+  static const int _promptBatchTokens = 512;
+  
+  /// Activation buffers of one prompt batch, excluding attention scores.
+  static const int _baseComputeBytes = 48 * 1024 * 1024;
+  
+  /// Head count assumed for the attention score buffer without flash attention.
+  static const int _typicalHeadCount = 24;
+  
+  /// f16 KV bytes per token per billion parameters, for catalog entries
+  /// without [ModelOption.kvCacheBytesPerToken].
+  static const int _fallbackKvBytesPerTokenPerB = 32 * 1024;
+  
+  /// Smallest context worth suggesting.
+  static const int _minContextSize = 512;
+  
   /// Assess compatibility of a model with device specs.
-  static ModelCompatibility assess(ModelOption model, DeviceSpecs specs) {
+  ///
+  /// Memory is checked for [contextSize] tokens (the app default if null)
+  /// with a [kvCacheType] cache. Pass the [memoryEstimate] the native loader
+  /// returned (`ModelInfo.memoryEstimate`) to assess a loaded model exactly,
+  /// or the downloaded file's header [metadata] to replace catalog figures.
+  static ModelCompatibility assess(
+    ModelOption model,
+    DeviceSpecs specs, {
+    int? contextSize,
+    KvCacheType kvCacheType = KvCacheType.f16,
+    bool flashAttention = false,
+    MemoryEstimate? memoryEstimate,
+    ModelMetadata? metadata,
+  }) {
     final warnings = <String>[];
     final recommendations = <String>[];
     
@@ -41,6 +74,39 @@ class CompatibilityCalculator {
       warnings.add('Low available RAM - close other apps');
     }
     
+    // Check memory for the requested context and KV cache type
+    final ctx = contextSize ?? ModelConstants.contextWindowSize;
+    final memory = memoryEstimate ??
+        estimateMemory(
+          model,
+          contextSize: ctx,
+          kvCacheType: kvCacheType,
+          flashAttention: flashAttention,
+          metadata: metadata,
+        );
+    final maxContext = maxContextSize(
+      model,
+      specs.availableRamBytes,
+      kvCacheType: kvCacheType,
+      flashAttention: flashAttention,
+      metadata: metadata,
+    );
+    if (memory.totalBytes > specs.availableRamBytes) {
+      warnings.add('A $ctx-token context needs ~${memory.totalFormatted} RAM');
+      final quantizedMax = maxContextSize(
+        model,
+        specs.availableRamBytes,
+        kvCacheType: KvCacheType.q8_0,
+        flashAttention: true,
+        metadata: metadata,
+      );
+      if (kvCacheType == KvCacheType.f16 && quantizedMax >= ctx) {
+        recommendations.add('Use a q8_0 KV cache with flash attention to fit $ctx tokens');
+      } else if (maxContext >= _minContextSize) {
+        recommendations.add('Reduce the context to $maxContext tokens');
+      }
+    }
+    
     // Check architecture
     if (!specs.cpuArchitecture.contains('arm64')) {
       warnings.add('32-bit architecture may have reduced performance');
@@ -71,13 +137,78 @@ class CompatibilityCalculator {
       hasEnoughRam: hasEnoughRam,
       warnings: warnings,
       recommendations: recommendations,
+      memoryEstimate: memory,
+      maxContextSize: maxContext,
     );
   }
   
-  /// Assess all models in catalog.
-  static List<ModelCompatibility> assessAll(DeviceSpecs specs) {
+  /// Estimate the memory [model] needs with a [contextSize]-token context.
+  ///
+  /// Mirrors the native estimate (llm_engine::estimate_memory) using catalog
+  /// data: the file size for weights, the per-token KV size of the
+  /// architecture scaled to [kvCacheType], and prompt-batch buffers whose
+  /// attention scores grow with the context unless [flashAttention] is on.
+  /// With the file's header [metadata] the weights, KV size and head count
+  /// are exact.
+  static MemoryEstimate estimateMemory(
+    ModelOption model, {
+    int? contextSize,
+    KvCacheType kvCacheType = KvCacheType.f16,
+    bool flashAttention = false,
+    ModelMetadata? metadata,
+  }) {
+    final ctx = contextSize ?? ModelConstants.contextWindowSize;
+    return MemoryEstimate(
+      weightsBytes: _weightsBytes(model, metadata),
+      kvCacheBytes: (_kvBytesPerToken(model, metadata) * kvCacheType.ratioToF16 * ctx).round(),
+      computeBytes: _baseComputeBytes + _scoreBytesPerToken(flashAttention, metadata) * ctx,
+    );
+  }
+  
+  /// Largest context, in steps of 256 tokens up to the model's trained
+  /// context, whose [estimateMemory] fits in [availableBytes]; 0 if none.
+  static int maxContextSize(
+    ModelOption model,
+    int availableBytes, {
+    KvCacheType kvCacheType = KvCacheType.f16,
+    bool flashAttention = false,
+    ModelMetadata? metadata,
+  }) {
+    final budget = availableBytes - _weightsBytes(model, metadata) - _baseComputeBytes;
+    final perToken = _kvBytesPerToken(model, metadata) * kvCacheType.ratioToF16 +
+        _scoreBytesPerToken(flashAttention, metadata);
+    if (budget <= 0 || perToken <= 0) return 0;
+    final tokens = (budget / perToken).floor() ~/ 256 * 256;
+    final trained = (metadata?.contextLength ?? 0) > 0
+        ? metadata!.contextLength
+        : model.contextSize;
+    return tokens.clamp(0, trained);
+  }
+  
+  static int _weightsBytes(ModelOption model, ModelMetadata? metadata) =>
+      (metadata?.weightsBytes ?? 0) > 0 ? metadata!.weightsBytes : model.sizeBytes;
+  
+  static int _kvBytesPerToken(ModelOption model, ModelMetadata? metadata) {
+    if ((metadata?.kvBytesPerToken ?? 0) > 0) return metadata!.kvBytesPerToken;
+    if (model.kvCacheBytesPerToken > 0) return model.kvCacheBytesPerToken;
+    return (_parseParameterCount(model.parameters) * _fallbackKvBytesPerTokenPerB).round();
+  }
+  
+  /// f32 attention scores per context token for one prompt batch.
+  static int _scoreBytesPerToken(bool flashAttention, ModelMetadata? metadata) {
+    if (flashAttention) return 0;
+    final heads = (metadata?.headCount ?? 0) > 0 ? metadata!.headCount : _typicalHeadCount;
+    return 4 * _promptBatchTokens * heads;
+  }
+  
+  /// Assess all models in catalog, using header [metadata] (by model id) for
+  /// the ones that are downloaded.
+  static List<ModelCompatibility> assessAll(
+    DeviceSpecs specs, {
+    Map<String, ModelMetadata> metadata = const {},
+  }) {
     return ModelCatalog.models
-        .map((model) => assess(model, specs))
+        .map((model) => assess(model, specs, metadata: metadata[model.id]))
         .toList()
       ..sort((a, b) {
         // Sort by compatibility level (best first), then by model size
@@ -88,8 +219,11 @@ class CompatibilityCalculator {
   }
   
   /// Get recommended model for device.
-  static ModelCompatibility? getRecommended(DeviceSpecs specs) {
-    final assessments = assessAll(specs);
+  static ModelCompatibility? getRecommended(
+    DeviceSpecs specs, {
+    Map<String, ModelMetadata> metadata = const {},
+  }) {
+    final assessments = assessAll(specs, metadata: metadata);
     
     // Find the best model with at least "good" compatibility
     for (final assessment in assessments) {
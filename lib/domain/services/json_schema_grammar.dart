@@ -0,0 +1,148 @@
+import 'dart:convert';
+
+/// Converts a JSON schema into a GBNF grammar for constrained sampling
+/// ([InferenceRequest.grammar]): the model can then only emit JSON of that
+/// shape, so structured outputs parse on the first try.
+///
+/// Covers the subset the app's structured prompts use:
+/// - objects: every listed property is emitted, in declaration order
+/// - strings, optionally capped with `maxLength` (keeps free-text fields from
+///   running into the token limit and truncating the JSON)
+/// - integers (small `minimum`..`maximum` ranges become literal
+///   alternatives), numbers and booleans
+/// - arrays of `items`, optionally capped with `maxItems`
+/// - `enum` of any JSON values
+///
+/// llama.cpp ships its own converter in its `common` library, which the app
+/// does not link.
+class JsonSchemaGrammar {
+  JsonSchemaGrammar._();
+
+  /// Widest integer range expanded into literal alternatives.
+  static const int _maxIntegerRange = 100;
+
+  static const String _primitives = r'''
+space ::= | " " | "\n" [ \t]{0,20}
+char ::= [^"\\\x7F\x00-\x1F] | [\\] (["\\bfnrt] | "u" [0-9a-fA-F]{4})
+string ::= "\"" char* "\"" space
+integer ::= "-"? ([0-9] | [1-9] [0-9]{0,15}) space
+number ::= "-"? ([0-9] | [1-9] [0-9]{0,15}) ("." [0-9]+)? ([eE] [-+]? [0-9]{1,15})? space
+boolean ::= ("true" | "false") space
+''';
+
+  static const Set<String> _primitiveRules = {
+    'string',
+    'integer',
+    'number',
+    'boolean',
+  };
+
+  static const Set<String> _reservedNames = {'root', 'space', 'char', ..._primitiveRules};
+
+  /// GBNF grammar (start rule `root`) accepting the JSON values [schema]
+  /// describes. Throws [ArgumentError] for schema features outside the
+  /// supported subset.
+  static String fromSchema(Map<String, Object?> schema) {
+    final rules = <String, String>{};
+    final root = _expression(schema, 'root', rules);
+
+    final buffer = StringBuffer()..writeln('root ::= $root');
+    for (final rule in rules.entries) {
+      buffer.writeln('${rule.key} ::= ${rule.value}');
+    }
+    buffer.write(_primitives);
+    return buffer.toString();
+  }
+
+  /// Rule body matching [schema]. Nested objects and arrays get rules of their
+  /// own in [rules], named after their property path.
+  static String _expression(
+    Map<String, Object?> schema,
+    String name,
+    Map<String, String> rules,
+  ) {
+    final values = schema['enum'];
+    if (values is List) {
+      return '(${values.map((v) => _literal(jsonEncode(v))).join(' | ')}) space';
+    }
+
+    switch (schema['type']) {
+      case 'object':
+        final properties =
+            (schema['properties'] as Map?)?.cast<String, Object?>() ?? const {};
+        final members = [
+          for (final entry in properties.entries)
+            '${_literal(jsonEncode(entry.key))} space ":" space '
+                '${_reference(_schema(entry.value), _childName(name, entry.key), rules)}',
+        ];
+        if (members.isEmpty) return '"{" space "}" space';
+        return '"{" space ${members.join(' "," space ')} "}" space';
+      case 'array':
+        final item = _reference(
+          _schema(schema['items'] ?? const {'type': 'string'}),
+          '$name-item',
+          rules,
+        );
+        final maxItems = schema['maxItems'] as int?;
+        final more = maxItems == null
+            ? '("," space $item)*'
+            : '("," space $item){0,${maxItems - 1}}';
+        return '"[" space ($item $more)? "]" space';
+      case 'string':
+        final maxLength = schema['maxLength'] as int?;
+        if (maxLength == null) return 'string';
+        return '"\\"" char{0,$maxLength} "\\"" space';
+      case 'integer':
+        final minimum = schema['minimum'] as int?;
+        final maximum = schema['maximum'] as int?;
+        if (minimum != null &&
+            maximum != null &&
+            maximum >= minimum &&
+            maximum - minimum <= _maxIntegerRange) {
+          return '(${[for (var i = minimum; i <= maximum; i++) '"$i"'].join(' | ')}) space';
+        }
+        return 'integer';
+      case 'number':
+        return 'number';
+      case 'boolean':
+        return 'boolean';
+      default:
+        throw ArgumentError.value(schema, 'schema', 'Unsupported JSON schema');
+    }
+  }
+
+  /// [schema] as a named rule, or the shared primitive rule it reduces to.
+  static String _reference(
+    Map<String, Object?> schema,
+    String name,
+    Map<String, String> rules,
+  ) {
+    final expression = _expression(schema, name, rules);
+    if (_primitiveRules.contains(expression)) return expression;
+    rules[name] = expression;
+    return name;
+  }
+
+  static Map<String, Object?> _schema(Object? value) {
+    if (value is Map) return value.cast<String, Object?>();
+    throw ArgumentError.value(value, 'schema', 'Expected a JSON schema object');
+  }
+
+  /// GBNF rule names allow only letters, digits and dashes.
+  static String _childName(String parent, String key) {
+    final name = key.replaceAll(RegExp('[^a-zA-Z0-9]+'), '-');
+    if (parent != 'root') return '$parent-$name';
+    return _reservedNames.contains(name) ? '$name-value' : name;
+  }
+
+  /// [text] as a GBNF string literal.
+  static String _literal(String text) {
+    final escaped = text
+        .replaceAll(r'\', r'\\')
+        .replaceAll('"', r'\"')
+        .replaceAll('\n', r'\n')
+        .replaceAll('\r', r'\r')
+        .replaceAll('\t', r'\t');
+    return '"$escaped"';
+  }
+}
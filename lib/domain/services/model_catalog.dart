@@ -24,6 +24,7 @@ class ModelCatalog {
       minRamBytes: 512 * 1024 * 1024, // 512 MB
       recommendedRamBytes: 1024 * 1024 * 1024, // 1 GB
       contextSize: 2048,
+      kvCacheBytesPerToken: 23040, // 30 layers, 3 KV heads x 64
       downloadUrl: 'https://huggingface.co/HuggingFaceTB/smollm-135M-instruct-v0.2-Q8_0-GGUF/resolve/main/smollm-135m-instruct-v0.2-q8_0.gguf',
       sha256: '',
       supportedLanguages: ['en'],
@@ -42,6 +43,7 @@ class ModelCatalog {
       minRamBytes: 2 * 1024 * 1024 * 1024, // 2 GB
       recommendedRamBytes: 3 * 1024 * 1024 * 1024, // 3 GB
       contextSize: 2048,
+      kvCacheBytesPerToken: 22528, // 22 layers, 4 KV heads x 64
       downloadUrl: 'https://huggingface.co/TheBloke/TinyLlama-1.1B-Chat-v1.0-GGUF/resolve/main/tinyllama-1.1b-chat-v1.0.Q4_K_M.gguf',
       sha256: '',
       supportedLanguages: ['en'],
@@ -60,6 +62,7 @@ class ModelCatalog {
       minRamBytes: 1 * 1024 * 1024 * 1024, // 1 GB
       recommendedRamBytes: 2 * 1024 * 1024 * 1024, // 2 GB
       contextSize: 4096,
+      kvCacheBytesPerToken: 12288, // 24 layers, 2 KV heads x 64
       downloadUrl: 'https://huggingface.co/Qwen/Qwen2.5-0.5B-Instruct-GGUF/resolve/main/qwen2.5-0.5b-instruct-q4_k_m.gguf',
       sha256: '',
       supportedLanguages: ['en', 'zh', 'ja', 'ko', 'es', 'fr', 'de'],
@@ -78,6 +81,7 @@ class ModelCatalog {
       minRamBytes: 2 * 1024 * 1024 * 1024, // 2 GB
       recommendedRamBytes: 3 * 1024 * 1024 * 1024, // 3 GB
       contextSize: 8192,
+      kvCacheBytesPerToken: 28672, // 28 layers, 2 KV heads x 128
       downloadUrl: 'https://huggingface.co/Qwen/Qwen2.5-1.5B-Instruct-GGUF/resolve/main/qwen2.5-1.5b-instruct-q4_k_m.gguf',
       sha256: '',
       supportedLanguages: ['en', 'zh', 'ja', 'ko', 'es', 'fr', 'de', 'ru', 'ar'],
@@ -96,6 +100,7 @@ class ModelCatalog {
       minRamBytes: 4 * 1024 * 1024 * 1024, // 4 GB
       recommendedRamBytes: 6 * 1024 * 1024 * 1024, // 6 GB
       contextSize: 4096,
+      kvCacheBytesPerToken: 393216, // 32 layers, 32 KV heads x 96
       downloadUrl: 'https://huggingface.co/microsoft/Phi-3-mini-4k-instruct-gguf/resolve/main/Phi-3-mini-4k-instruct-q4.gguf',
       sha256: '',
       supportedLanguages: ['en'],
@@ -114,6 +119,7 @@ class ModelCatalog {
       minRamBytes: 3 * 1024 * 1024 * 1024, // 3 GB
       recommendedRamBytes: 4 * 1024 * 1024 * 1024, // 4 GB
       contextSize: 8192,
+      kvCacheBytesPerToken: 106496, // 26 layers, 4 KV heads x 256
       downloadUrl: 'https://huggingface.co/bartowski/gemma-2-2b-it-GGUF/resolve/main/gemma-2-2b-it-Q4_K_M.gguf',
       sha256: '',
       supportedLanguages: ['en', 'es', 'fr', 'de', 'it', 'pt', 'nl', 'ru'],
@@ -132,6 +138,7 @@ class ModelCatalog {
       minRamBytes: 3 * 1024 * 1024 * 1024, // 3 GB
       recommendedRamBytes: 5 * 1024 * 1024 * 1024, // 5 GB
       contextSize: 2048,
+      kvCacheBytesPerToken: 327680, // 32 layers, 32 KV heads x 80
       // Common Phi-2 GGUF location
       downloadUrl: 'https://huggingface.co/TheBloke/phi-2-GGUF/resolve/main/phi-2.Q4_K_M.gguf',
       sha256: '',
@@ -151,6 +158,7 @@ class ModelCatalog {
       minRamBytes: 2 * 1024 * 1024 * 1024, // 2 GB
       recommendedRamBytes: 3 * 1024 * 1024 * 1024, // 3 GB
       contextSize: 8192,
+      kvCacheBytesPerToken: 32768, // 16 layers, 8 KV heads x 64
       downloadUrl: 'https://huggingface.co/bartowski/Llama-3.2-1B-Instruct-GGUF/resolve/main/Llama-3.2-1B-Instruct-Q4_K_M.gguf',
       sha256: '',
       supportedLanguages: ['en', 'de', 'fr', 'it', 'pt', 'hi', 'es', 'th'],
@@ -169,6 +177,7 @@ class ModelCatalog {
       minRamBytes: 4 * 1024 * 1024 * 1024, // 4 GB
       recommendedRamBytes: 6 * 1024 * 1024 * 1024, // 6 GB
       contextSize: 8192,
+      kvCacheBytesPerToken: 114688, // 28 layers, 8 KV heads x 128
       downloadUrl: 'https://huggingface.co/bartowski/Llama-3.2-3B-Instruct-GGUF/resolve/main/Llama-3.2-3B-Instruct-Q4_K_M.gguf',
       sha256: '',
       supportedLanguages: ['en', 'de', 'fr', 'it', 'pt', 'hi', 'es', 'th'],
@@ -187,6 +196,7 @@ class ModelCatalog {
       minRamBytes: 6 * 1024 * 1024 * 1024, // 6 GB
       recommendedRamBytes: 8 * 1024 * 1024 * 1024, // 8 GB
       contextSize: 8192,
+      kvCacheBytesPerToken: 131072, // 32 layers, 8 KV heads x 128
       downloadUrl: 'https://huggingface.co/bartowski/Mistral-7B-Instruct-v0.3-GGUF/resolve/main/Mistral-7B-Instruct-v0.3-Q4_K_M.gguf',
       sha256: '',
       supportedLanguages: ['en', 'fr', 'es', 'de', 'it', 'pt'],
@@ -4,19 +4,43 @@
 class SttModelOption {
   final String id;
   final String name;
+
+  /// Short label for compact pickers.
+  final String shortName;
   final String description;
   final int sizeBytes;
   final String downloadUrl;
 
+  /// Weight format as stored in the file (e.g. "F16", "Q5_1", "Q8_0").
+  final String quantization;
+
+  /// KV caches + compute buffers whisper.cpp allocates at load, on top of weights.
+  ///
+  /// Depends on the architecture (base/small), not the weight quantization.
+  /// Measured from whisper.cpp's CPU load logs; WhisperNative.getMemoryReport
+  /// estimates it from the RSS growth once a model is loaded.
+  final int runtimeOverheadBytes;
+
   const SttModelOption({
     required this.id,
     required this.name,
+    required this.shortName,
     required this.description,
     required this.sizeBytes,
     required this.downloadUrl,
+    required this.runtimeOverheadBytes,
+    this.quantization = 'F16',
   });
 
   String get fileName => downloadUrl.split('/').last;
+
+  /// Approximate resident memory once loaded.
+  int get estimatedRuntimeBytes => sizeBytes + runtimeOverheadBytes;
+
+  /// Whether this model fits in [availableBytes] while keeping [reservedBytes]
+  /// (e.g. an already-loaded LLM's working set) untouched.
+  bool fitsAlongside({required int availableBytes, int reservedBytes = 0}) =>
+      estimatedRuntimeBytes + reservedBytes <= availableBytes;
 }
 
 class SttModelCatalog {
@@ -24,23 +48,72 @@ class SttModelCatalog {
   static const _hfBase =
       'https://huggingface.co/ggerganov/whisper.cpp/resolve/main';
 
+  static const _baseOverheadBytes = 230 * 1024 * 1024;
+  static const _smallOverheadBytes = 320 * 1024 * 1024;
+
   /// Multilingual Whisper models.
   ///
   /// Note: `small` is ~466 MiB (your choice: better accuracy, heavier).
+  /// Quantized variants trade a little accuracy for much smaller weights, which
+  /// matters when an LLM is loaded at the same time.
   static const List<SttModelOption> models = [
     SttModelOption(
       id: 'base',
       name: 'Whisper Base (multilingual)',
+      shortName: 'Base (faster)',
       description: 'Faster, lower accuracy than Small.',
       sizeBytes: 142 * 1024 * 1024, // approximate; server is source of truth
       downloadUrl: '$_hfBase/ggml-base.bin',
+      runtimeOverheadBytes: _baseOverheadBytes,
+    ),
+    SttModelOption(
+      id: 'base-q8_0',
+      name: 'Whisper Base Q8_0 (multilingual)',
+      shortName: 'Base Q8 (lighter)',
+      description: 'Base with 8-bit weights; near-identical accuracy.',
+      sizeBytes: 78 * 1024 * 1024, // approximate
+      downloadUrl: '$_hfBase/ggml-base-q8_0.bin',
+      runtimeOverheadBytes: _baseOverheadBytes,
+      quantization: 'Q8_0',
+    ),
+    SttModelOption(
+      id: 'base-q5_1',
+      name: 'Whisper Base Q5_1 (multilingual)',
+      shortName: 'Base Q5 (lightest)',
+      description: 'Base with 5-bit weights; smallest footprint.',
+      sizeBytes: 57 * 1024 * 1024, // approximate
+      downloadUrl: '$_hfBase/ggml-base-q5_1.bin',
+      runtimeOverheadBytes: _baseOverheadBytes,
+      quantization: 'Q5_1',
     ),
     SttModelOption(
       id: 'small',
       name: 'Whisper Small (multilingual)',
+      shortName: 'Small (better accuracy)',
       description: 'Better accuracy, heavier (~460MB).',
       sizeBytes: 466 * 1024 * 1024, // approximate
       downloadUrl: '$_hfBase/ggml-small.bin',
+      runtimeOverheadBytes: _smallOverheadBytes,
+    ),
+    SttModelOption(
+      id: 'small-q8_0',
+      name: 'Whisper Small Q8_0 (multilingual)',
+      shortName: 'Small Q8',
+      description: 'Small with 8-bit weights (~250MB).',
+      sizeBytes: 252 * 1024 * 1024, // approximate
+      downloadUrl: '$_hfBase/ggml-small-q8_0.bin',
+      runtimeOverheadBytes: _smallOverheadBytes,
+      quantization: 'Q8_0',
+    ),
+    SttModelOption(
+      id: 'small-q5_1',
+      name: 'Whisper Small Q5_1 (multilingual)',
+      shortName: 'Small Q5',
+      description: 'Small with 5-bit weights (~180MB).',
+      sizeBytes: 181 * 1024 * 1024, // approximate
+      downloadUrl: '$_hfBase/ggml-small-q5_1.bin',
+      runtimeOverheadBytes: _smallOverheadBytes,
+      quantization: 'Q5_1',
     ),
   ];
 
@@ -50,5 +123,23 @@ class SttModelCatalog {
     }
     return null;
   }
-}
 
+  /// Largest-weight model that fits next to [reservedBytes] of other usage
+  /// (typically the loaded LLM), or null if none fits.
+  static SttModelOption? bestFitting({
+    required int availableBytes,
+    int reservedBytes = 0,
+  }) {
+    SttModelOption? best;
+    for (final m in models) {
+      if (!m.fitsAlongside(
+        availableBytes: availableBytes,
+        reservedBytes: reservedBytes,
+      )) {
+        continue;
+      }
+      if (best == null || m.sizeBytes > best.sizeBytes) best = m;
+    }
+    return best;
+  }
+}
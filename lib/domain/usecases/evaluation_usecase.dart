@@ -3,6 +3,7 @@ import 'dart:convert';
 import '../entities/evaluation_result.dart';
 import '../entities/inference_request.dart';
 import '../repositories/llm_repository.dart';
+import '../services/json_schema_grammar.dart';
 import '../services/system_prompt_manager.dart';
 import '../../core/utils/logger.dart';
 
@@ -33,6 +34,24 @@ class EvaluationUseCase {
   })  : _llmRepository = llmRepository,
         _promptManager = promptManager;
 
+  /// JSON the evaluation prompt asks for. Generation is constrained to it, so
+  /// the model cannot drift from the format; the text fields are capped so
+  /// the object always closes within the token budget.
+  static const Map<String, Object?> outputSchema = {
+    'type': 'object',
+    'properties': {
+      'clarity_score': {'type': 'integer', 'minimum': 1, 'maximum': 10},
+      'clarity_reasoning': {'type': 'string', 'maxLength': 240},
+      'language_score': {'type': 'integer', 'minimum': 1, 'maximum': 10},
+      'language_reasoning': {'type': 'string', 'maxLength': 240},
+      'safety_flag': {'type': 'boolean'},
+      'safety_notes': {'type': 'string', 'maxLength': 120},
+      'overall_feedback': {'type': 'string', 'maxLength': 320},
+    },
+  };
+
+  static final String _outputGrammar = JsonSchemaGrammar.fromSchema(outputSchema);
+
   /// Evaluate the given [transcript] and return an [EvaluationResult].
   ///
   /// Returns [EvaluationResult.parseError()] if the model output
@@ -64,6 +83,7 @@ class EvaluationUseCase {
         temperature: 0.2, // Low temperature for consistent scoring
         stream: false,
         isolated: true,
+        grammar: _outputGrammar,
       );
 
       final result = await _llmRepository.generate(request);
@@ -1,6 +1,7 @@
 import 'package:dartz/dartz.dart';
 import 'package:equatable/equatable.dart';
 
+import '../entities/memory_estimate.dart';
 import '../entities/model_info.dart';
 import '../repositories/llm_repository.dart';
 import '../repositories/model_repository.dart';
@@ -49,8 +50,9 @@ class LoadModelUseCase extends UseCase<ModelInfo, LoadModelParams> {
       ));
     }
     
-    // Unload existing model if reloading
-    if (_llmRepository.isModelLoaded) {
+    // Unload existing model if reloading; a hot swap keeps it serving until
+    // the new one is ready (the backend unloads it first if both do not fit).
+    if (_llmRepository.isModelLoaded && !params.hotSwap) {
       await _llmRepository.unloadModel();
     }
     
@@ -58,10 +60,24 @@ class LoadModelUseCase extends UseCase<ModelInfo, LoadModelParams> {
     return _llmRepository.loadModel(
       modelPath: params.modelPath,
       contextSize: params.contextSize ?? ModelConstants.contextWindowSize,
-      threads: params.threads ?? ModelConstants.maxInferenceThreads,
+      // null lets the backend calibrate thread counts for this device
+      threads: params.threads,
+      batchSize: params.batchSize,
+      ubatchSize: params.ubatchSize,
+      flashAttention: params.flashAttention,
+      cacheTypeK: params.kvCacheType,
+      cacheTypeV: params.kvCacheType,
+      prefetch: params.prefetch,
+      lockHotWeights: params.lockHotWeights,
+      useOptimizedModel: params.useOptimizedModel,
+      warmup: params.warmup,
+      hotSwap: params.hotSwap,
     );
   }
   
+  /// Progress (0..1) of the load in flight, where the backend reports it.
+  Stream<double> get progress => _llmRepository.loadProgress;
+  
   /// Unload the model from memory.
   AsyncResult<void> unload() async {
     return _llmRepository.unloadModel();
@@ -85,13 +101,60 @@ class LoadModelParams extends Equatable {
   /// Force reload even if already loaded.
   final bool forceReload;
   
+  /// Most tokens per decode call.
+  final int batchSize;
+  
+  /// Tokens per compute step; null sizes it from free memory and tunes the
+  /// prefill chunk on measured speed, so low-RAM devices avoid a large compute
+  /// buffer and fast ones keep big chunks.
+  final int? ubatchSize;
+  
+  /// Fused attention kernel; required by a quantized V cache.
+  final bool flashAttention;
+  
+  /// Element type of both the K and V cache. q8_0 halves the KV memory of a
+  /// context versus f16 with negligible quality loss.
+  final KvCacheType kvCacheType;
+  
+  /// Read the weights into memory during the load instead of on the first
+  /// prompt: a longer load, a faster first reply.
+  final bool prefetch;
+  
+  /// Pin the most-read weights in RAM while memory allows (opt-in: pinned
+  /// memory is unavailable to other apps until the OS reports pressure).
+  final bool lockHotWeights;
+  
+  /// Load the copy converted for this CPU ([LLMRepository.optimizeModel])
+  /// instead of [modelPath] when one exists.
+  final bool useOptimizedModel;
+  
+  /// Run a dummy prefill and decode at load so the user's first message does
+  /// not pay the cold-start cost.
+  final bool warmup;
+  
+  /// Switching models: keep the current one answering while the next loads
+  /// in the background, instead of a dead period between the two.
+  final bool hotSwap;
+  
   const LoadModelParams({
     required this.modelPath,
     this.contextSize,
     this.threads,
     this.forceReload = false,
+    this.batchSize = 512,
+    this.ubatchSize,
+    this.flashAttention = true,
+    this.kvCacheType = KvCacheType.q8_0,
+    this.prefetch = true,
+    this.lockHotWeights = false,
+    this.useOptimizedModel = false,
+    this.warmup = true,
+    this.hotSwap = true,
   });
   
   @override
-  List<Object?> get props => [modelPath, contextSize, threads, forceReload];
+  List<Object?> get props =>
+      [modelPath, contextSize, threads, forceReload, batchSize, ubatchSize,
+       flashAttention, kvCacheType, prefetch, lockHotWeights, useOptimizedModel,
+       warmup, hotSwap];
 }
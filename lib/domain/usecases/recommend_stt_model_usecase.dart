@@ -0,0 +1,85 @@
+import 'package:dartz/dartz.dart';
+import 'package:equatable/equatable.dart';
+
+import '../repositories/llm_repository.dart';
+import '../repositories/voice_repository.dart';
+import '../services/stt_model_catalog.dart';
+import '../../core/utils/result.dart';
+import 'usecase.dart';
+
+/// Use case for picking the Whisper models that fit next to the loaded LLM.
+///
+/// Memory free for a Whisper model is the available system memory, plus what
+/// the currently loaded Whisper model holds (switching models frees it),
+/// minus the loaded LLM's weights: they are memory-mapped, so the OS counts
+/// their pages as reclaimable cache although every token reads them. The
+/// LLM's KV cache and compute buffers are already outside available memory.
+class RecommendSttModelUseCase extends UseCase<SttModelFit, NoParams> {
+  final LLMRepository _llmRepository;
+  final VoiceRepository _voiceRepository;
+
+  RecommendSttModelUseCase({
+    required LLMRepository llmRepository,
+    required VoiceRepository voiceRepository,
+  })  : _llmRepository = llmRepository,
+        _voiceRepository = voiceRepository;
+
+  @override
+  AsyncResult<SttModelFit> call(NoParams params) async {
+    final memoryResult = await _llmRepository.checkMemoryStatus();
+    final failure = memoryResult.failureOrNull;
+    if (failure != null) return Left(failure);
+    final memory = memoryResult.getOrThrow();
+
+    final whisperResult = await _voiceRepository.getWhisperResidentBytes();
+    final whisperBytes = whisperResult.fold((_) => null, (bytes) => bytes) ?? 0;
+    final llmWeightsBytes =
+        _llmRepository.currentModelInfo?.memoryEstimate?.weightsBytes ?? 0;
+    final availableBytes = memory.availableBytes + whisperBytes;
+
+    return Right(SttModelFit(
+      availableBytes: availableBytes,
+      reservedBytes: llmWeightsBytes,
+      fitting: [
+        for (final m in SttModelCatalog.models)
+          if (m.fitsAlongside(
+            availableBytes: availableBytes,
+            reservedBytes: llmWeightsBytes,
+          ))
+            m,
+      ],
+      recommended: SttModelCatalog.bestFitting(
+        availableBytes: availableBytes,
+        reservedBytes: llmWeightsBytes,
+      ),
+    ));
+  }
+}
+
+/// Whisper models that fit in memory next to the loaded LLM.
+class SttModelFit extends Equatable {
+  /// Memory a Whisper model can use, including what the loaded one holds.
+  final int availableBytes;
+
+  /// Memory kept for the loaded LLM's weights.
+  final int reservedBytes;
+
+  /// Catalog models that fit, in catalog order.
+  final List<SttModelOption> fitting;
+
+  /// Largest model that fits, or null if none does.
+  final SttModelOption? recommended;
+
+  const SttModelFit({
+    required this.availableBytes,
+    required this.reservedBytes,
+    required this.fitting,
+    required this.recommended,
+  });
+
+  /// Whether the model with [id] fits.
+  bool fits(String id) => fitting.any((m) => m.id == id);
+
+  @override
+  List<Object?> get props => [availableBytes, reservedBytes, fitting, recommended];
+}
@@ -115,6 +115,7 @@ class SpeechToTextUseCase
         continuous: params.continuous,
         preferOffline: true,
         offlineOnly: params.offlineOnly,
+        autoDetectLanguage: params.autoDetectLanguage,
         whisperThreads: params.whisperThreads,
       )) {
         yield SpeechToTextResult(
@@ -188,6 +189,9 @@ class SpeechToTextParams extends Equatable {
   /// If true, never fall back to online recognition.
   final bool offlineOnly;
 
+  /// Let Whisper detect the spoken language instead of using [language].
+  final bool autoDetectLanguage;
+
   /// Selected STT engine.
   final SpeechToTextEngine engine;
 
@@ -201,6 +205,7 @@ class SpeechToTextParams extends Equatable {
     required this.language,
     this.continuous = false,
     this.offlineOnly = false,
+    this.autoDetectLanguage = false,
     this.engine = SpeechToTextEngine.androidSpeechRecognizer,
     this.whisperModelId = 'small',
     this.whisperThreads = 4,
@@ -211,6 +216,7 @@ class SpeechToTextParams extends Equatable {
         language,
         continuous,
         offlineOnly,
+        autoDetectLanguage,
         engine,
         whisperModelId,
         whisperThreads,
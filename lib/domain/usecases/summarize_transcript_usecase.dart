@@ -1,4 +1,5 @@
 import 'dart:async';
+import 'dart:convert';
 
 import 'package:equatable/equatable.dart';
 
@@ -8,6 +9,7 @@ import '../entities/evaluation_result.dart';
 import '../entities/safety_result.dart';
 import '../entities/inference_request.dart';
 import '../repositories/llm_repository.dart';
+import '../services/json_schema_grammar.dart';
 import 'safety_preprocessor_usecase.dart';
 import 'evaluation_usecase.dart';
 import '../../core/utils/logger.dart';
@@ -94,6 +96,8 @@ enum PipelineStep {
 ///
 /// Each step emits progress events so the UI can display step-by-step status.
 /// All LLM calls use `isolated: true` to avoid polluting the chat context.
+/// The evaluation call is grammar-constrained to one JSON object, so its
+/// output parses without a retry.
 class SummarizeTranscriptUseCase {
   final LLMRepository _llmRepository;
   final SafetyPreprocessorUseCase _safetyPreprocessor;
@@ -107,6 +111,15 @@ class SummarizeTranscriptUseCase {
         _safetyPreprocessor = safetyPreprocessor,
         _evaluationUseCase = evaluationUseCase;
 
+  /// Summary quality rubric: dimension name -> what it measures.
+  static const Map<String, String> _dimensionDefs = {
+    'Relevance': 'Did the summary reflect the main ideas?',
+    'Coverage': 'Were important points missed?',
+    'Coherence': 'Is the summary logically structured?',
+    'Conciseness': 'Is it appropriately brief?',
+    'Faithfulness': 'No hallucinated information?',
+  };
+
   /// Run the pipeline on the given transcript.
   Stream<SummarizationPipelineEvent> call(
       SummarizeTranscriptParams params) async* {
@@ -316,19 +329,18 @@ class SummarizeTranscriptUseCase {
     final promptParts = <String>[
       'You are a strict evaluator. Perform the requested evaluations below.',
     ];
+    final jsonFields = <String>[];
 
     if (includeBenchmark) {
       promptParts.add(
         'TASK A — SUMMARY QUALITY:\n'
         'Rate each dimension as Good, Fair, or Poor with a brief explanation.\n'
-        'Dimensions: Relevance, Coverage, Coherence, Conciseness, Faithfulness.\n'
-        'Format:\n'
-        'Relevance: [Good/Fair/Poor] - [explanation]\n'
-        'Coverage: [Good/Fair/Poor] - [explanation]\n'
-        'Coherence: [Good/Fair/Poor] - [explanation]\n'
-        'Conciseness: [Good/Fair/Poor] - [explanation]\n'
-        'Faithfulness: [Good/Fair/Poor] - [explanation]',
+        'Dimensions: Relevance, Coverage, Coherence, Conciseness, Faithfulness.',
       );
+      jsonFields.addAll([
+        for (final name in _dimensionDefs.keys)
+          '"${name.toLowerCase()}":{"score":"<Good|Fair|Poor>","explanation":"<brief>"}',
+      ]);
     }
 
     if (includeTranscriptEval) {
@@ -340,19 +352,22 @@ class SummarizeTranscriptUseCase {
         'Clarity of Thought (1-10): intro→main points→conclusion, elaboration, no repetition.\n'
         '9-10: professional | 7-8: good, minor gaps | 5-6: moderate, disjointed | 3-4: poor, random | 1-2: incoherent\n\n'
         'Language Proficiency (1-10): grammar, tenses, vocabulary, fluency, no fillers.\n'
-        '9-10: excellent | 7-8: good, minor errors | 5-6: noticeable errors | 3-4: frequent mistakes | 1-2: very limited\n\n'
-        'Format as JSON:\n'
-        '{"clarity_score":<n>,"clarity_reasoning":"<cite problems>","language_score":<n>,'
-        '"language_reasoning":"<cite errors>","safety_flag":false,'
-        '"safety_notes":"None","overall_feedback":"<honest 2-3 sentences>"}',
+        '9-10: excellent | 7-8: good, minor errors | 5-6: noticeable errors | 3-4: frequent mistakes | 1-2: very limited',
       );
+      jsonFields.addAll([
+        '"clarity_score":<n>',
+        '"clarity_reasoning":"<cite problems>"',
+        '"language_score":<n>',
+        '"language_reasoning":"<cite errors>"',
+        '"safety_flag":false',
+        '"safety_notes":"None"',
+        '"overall_feedback":"<honest 2-3 sentences>"',
+      ]);
     }
 
-    if (includeBenchmark && includeTranscriptEval) {
-      promptParts.add(
-        'Separate the two tasks with: ===TASK_B===',
-      );
-    }
+    promptParts.add(
+      'Respond with ONLY this JSON object:\n{${jsonFields.join(',')}}',
+    );
 
     final userPrompt = StringBuffer();
     if (includeBenchmark) {
@@ -365,8 +380,13 @@ class SummarizeTranscriptUseCase {
     final result = await _runLLMStep(
       systemPrompt: promptParts.join('\n\n'),
       userPrompt: userPrompt.toString(),
-      maxTokens: 512,
+      // Both tasks together fill about 550 tokens at the field caps.
+      maxTokens: includeBenchmark && includeTranscriptEval ? 768 : 512,
       temperature: 0.3,
+      grammar: _mergedEvaluationGrammar(
+        includeBenchmark: includeBenchmark,
+        includeTranscriptEval: includeTranscriptEval,
+      ),
     );
 
     if (result == null) return null;
@@ -383,36 +403,42 @@ class SummarizeTranscriptUseCase {
     required bool includeBenchmark,
     required bool includeTranscriptEval,
   }) {
-    List<BenchmarkDimension> dimensions = const [];
-    EvaluationResult? evaluationResult;
-
-    if (includeBenchmark && includeTranscriptEval) {
-      // Split on task marker
-      final marker = RegExp(r'===\s*TASK[_ ]?B\s*===', caseSensitive: false);
-      final match = marker.firstMatch(raw);
-
-      if (match != null) {
-        final taskA = raw.substring(0, match.start).trim();
-        final taskB = raw.substring(match.end).trim();
-        dimensions = _parseBenchmarkDimensions(taskA);
-        evaluationResult = _evaluationUseCase.parseRawOutput(taskB);
-      } else {
-        // No marker found — try to extract JSON for eval, rest for benchmark
-        dimensions = _parseBenchmarkDimensions(raw);
-        evaluationResult = _evaluationUseCase.parseRawOutput(raw);
-      }
-    } else if (includeBenchmark) {
-      dimensions = _parseBenchmarkDimensions(raw);
-    } else if (includeTranscriptEval) {
-      evaluationResult = _evaluationUseCase.parseRawOutput(raw);
-    }
-
+    // One JSON object carries both tasks; the transcript scores are its
+    // top-level evaluation fields.
     return _MergedEvaluationResult(
-      dimensions: dimensions,
-      evaluationResult: evaluationResult,
+      dimensions:
+          includeBenchmark ? _parseBenchmarkDimensions(raw) : const [],
+      evaluationResult: includeTranscriptEval
+          ? _evaluationUseCase.parseRawOutput(raw)
+          : null,
     );
   }
 
+  /// GBNF grammar for the merged evaluation's JSON object.
+  static String _mergedEvaluationGrammar({
+    required bool includeBenchmark,
+    required bool includeTranscriptEval,
+  }) {
+    return JsonSchemaGrammar.fromSchema({
+      'type': 'object',
+      'properties': {
+        if (includeBenchmark)
+          for (final name in _dimensionDefs.keys)
+            name.toLowerCase(): {
+              'type': 'object',
+              'properties': {
+                'score': {
+                  'enum': ['Good', 'Fair', 'Poor'],
+                },
+                'explanation': {'type': 'string', 'maxLength': 120},
+              },
+            },
+        if (includeTranscriptEval)
+          ...EvaluationUseCase.outputSchema['properties']! as Map<String, Object?>,
+      },
+    });
+  }
+
   // ══════════════════════════════════════════════════════════════════════════
   // COMMON HELPERS
   // ══════════════════════════════════════════════════════════════════════════
@@ -425,6 +451,7 @@ class SummarizeTranscriptUseCase {
     required String userPrompt,
     int maxTokens = 512,
     double temperature = 0.5,
+    String? grammar,
   }) async {
     if (!_llmRepository.isModelLoaded) {
       AppLogger.e('LLM not loaded during benchmark pipeline');
@@ -438,6 +465,7 @@ class SummarizeTranscriptUseCase {
       temperature: temperature,
       stream: false,
       isolated: true,
+      grammar: grammar,
     );
 
     final result = await _llmRepository.generate(request);
@@ -455,40 +483,47 @@ class SummarizeTranscriptUseCase {
   }
 
   /// Parse the LLM evaluation output into structured [BenchmarkDimension]s.
+  ///
+  /// Reads the JSON object the constrained call emits; for free-form output
+  /// (backends without grammar support) falls back to `Name: Score - text`
+  /// lines.
   List<BenchmarkDimension> _parseBenchmarkDimensions(String evalText) {
+    final json = _decodeJsonObject(evalText);
     final dimensions = <BenchmarkDimension>[];
 
-    final dimensionDefs = {
-      'Relevance': 'Did the summary reflect the main ideas?',
-      'Coverage': 'Were important points missed?',
-      'Coherence': 'Is the summary logically structured?',
-      'Conciseness': 'Is it appropriately brief?',
-      'Faithfulness': 'No hallucinated information?',
-    };
-
-    for (final entry in dimensionDefs.entries) {
+    for (final entry in _dimensionDefs.entries) {
       final name = entry.key;
       final description = entry.value;
 
-      final regex = RegExp(
-        '${RegExp.escape(name)}\\s*:\\s*(Good|Fair|Poor)\\s*[-–—]?\\s*(.*)',
-        caseSensitive: false,
-      );
+      String? scoreStr;
+      String? explanation;
 
-      final match = regex.firstMatch(evalText);
+      final fromJson = json?[name.toLowerCase()];
+      if (fromJson is Map) {
+        scoreStr = (fromJson['score'] as String?)?.toLowerCase();
+        explanation = (fromJson['explanation'] as String?)?.trim();
+      } else {
+        final regex = RegExp(
+          '${RegExp.escape(name)}\\s*:\\s*(Good|Fair|Poor)\\s*[-–—]?\\s*(.*)',
+          caseSensitive: false,
+        );
+        final match = regex.firstMatch(evalText);
+        if (match != null) {
+          scoreStr = match.group(1)?.toLowerCase() ?? 'fair';
+          explanation = match.group(2)?.trim() ?? 'No explanation provided.';
+        }
+      }
 
       BenchmarkScore score;
-      String explanation;
-
-      if (match != null) {
-        final scoreStr = match.group(1)?.toLowerCase() ?? 'fair';
+      if (scoreStr != null) {
         score = switch (scoreStr) {
           'good' => BenchmarkScore.good,
           'poor' => BenchmarkScore.poor,
           _ => BenchmarkScore.fair,
         };
-        explanation = match.group(2)?.trim() ?? 'No explanation provided.';
-        if (explanation.isEmpty) explanation = 'No explanation provided.';
+        if (explanation == null || explanation.isEmpty) {
+          explanation = 'No explanation provided.';
+        }
       } else {
         score = BenchmarkScore.fair;
         explanation = 'Could not parse evaluation for this dimension.';
@@ -505,6 +540,19 @@ class SummarizeTranscriptUseCase {
     return dimensions;
   }
 
+  /// The outermost JSON object in [text], or null if there is none.
+  Map<String, dynamic>? _decodeJsonObject(String text) {
+    final start = text.indexOf('{');
+    final end = text.lastIndexOf('}');
+    if (start < 0 || end <= start) return null;
+    try {
+      final decoded = jsonDecode(text.substring(start, end + 1));
+      return decoded is Map<String, dynamic> ? decoded : null;
+    } on FormatException {
+      return null;
+    }
+  }
+
   /// Cancel the current pipeline.
   void cancel() {
     _llmRepository.cancelGeneration();
@@ -0,0 +1,148 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+
+import 'package:crypto/crypto.dart' as crypto;
+import 'package:ffi/ffi.dart';
+
+/// Incremental SHA-256 of a file as its chunks stream in, so a download is
+/// verified without reading it back from storage.
+///
+/// Uses the native hasher in `libmicrollm_hash.so` (ARMv8 SHA2 instructions
+/// where the CPU has them) and falls back to `package:crypto` when the
+/// library is not available, e.g. in tests.
+abstract class StreamingSha256 {
+  factory StreamingSha256() {
+    try {
+      return _NativeSha256(_Sha256Bindings.instance);
+    } catch (_) {
+      return _DartSha256();
+    }
+  }
+
+  /// Feed the next chunk of the file.
+  void add(List<int> chunk);
+
+  /// Lowercase hex digest of everything added; the hasher is released.
+  String close();
+
+  /// Release the hasher without a digest (cancelled or failed download).
+  void dispose();
+}
+
+/// `X-Linked-ETag`/`ETag` header value as a SHA-256 hex digest, or null if
+/// it is not one (Hugging Face sends the LFS object's SHA-256 there).
+String? sha256FromEtag(String? etag) {
+  if (etag == null) return null;
+  var value = etag.trim();
+  if (value.startsWith('W/')) value = value.substring(2);
+  value = value.replaceAll('"', '').toLowerCase();
+  return RegExp(r'^[0-9a-f]{64}$').hasMatch(value) ? value : null;
+}
+
+typedef _NewNative = Pointer<Void> Function();
+typedef _UpdateNative = Void Function(Pointer<Void>, Pointer<Uint8>, Size);
+typedef _UpdateDart = void Function(Pointer<Void>, Pointer<Uint8>, int);
+typedef _FinishNative = Void Function(Pointer<Void>, Pointer<Uint8>);
+typedef _FinishDart = void Function(Pointer<Void>, Pointer<Uint8>);
+typedef _FreeNative = Void Function(Pointer<Void>);
+typedef _FreeDart = void Function(Pointer<Void>);
+
+class _Sha256Bindings {
+  static _Sha256Bindings? _instance;
+
+  static _Sha256Bindings get instance => _instance ??= _Sha256Bindings._();
+
+  late final Pointer<Void> Function() create;
+  late final _UpdateDart update;
+  late final _FinishDart finish;
+  late final _FreeDart free;
+
+  _Sha256Bindings._() {
+    if (!Platform.isAndroid && !Platform.isLinux) {
+      throw UnsupportedError('libmicrollm_hash is built for Android and Linux');
+    }
+    final lib = DynamicLibrary.open('libmicrollm_hash.so');
+    create = lib.lookupFunction<_NewNative, _NewNative>('microllm_sha256_new');
+    update = lib.lookupFunction<_UpdateNative, _UpdateDart>('microllm_sha256_update');
+    finish = lib.lookupFunction<_FinishNative, _FinishDart>('microllm_sha256_finish');
+    free = lib.lookupFunction<_FreeNative, _FreeDart>('microllm_sha256_free');
+  }
+}
+
+class _NativeSha256 implements StreamingSha256 {
+  final _Sha256Bindings _bindings;
+  Pointer<Void> _hasher;
+  // Staging buffer the chunks are copied into; grown to the largest chunk.
+  Pointer<Uint8> _buffer = nullptr;
+  int _capacity = 0;
+
+  _NativeSha256(this._bindings) : _hasher = _bindings.create();
+
+  @override
+  void add(List<int> chunk) {
+    if (chunk.length > _capacity) {
+      if (_buffer != nullptr) calloc.free(_buffer);
+      _capacity = chunk.length;
+      _buffer = calloc<Uint8>(_capacity);
+    }
+    _buffer.asTypedList(chunk.length).setAll(0, chunk);
+    _bindings.update(_hasher, _buffer, chunk.length);
+  }
+
+  @override
+  String close() {
+    final digest = calloc<Uint8>(32);
+    try {
+      _bindings.finish(_hasher, digest);
+      return digest
+          .asTypedList(32)
+          .map((b) => b.toRadixString(16).padLeft(2, '0'))
+          .join();
+    } finally {
+      calloc.free(digest);
+      dispose();
+    }
+  }
+
+  @override
+  void dispose() {
+    if (_hasher != nullptr) {
+      _bindings.free(_hasher);
+      _hasher = nullptr;
+    }
+    if (_buffer != nullptr) {
+      calloc.free(_buffer);
+      _buffer = nullptr;
+      _capacity = 0;
+    }
+  }
+}
+
+class _DartSha256 implements StreamingSha256 {
+  final _DigestSink _digest = _DigestSink();
+  late final ByteConversionSink _input =
+      crypto.sha256.startChunkedConversion(_digest);
+
+  @override
+  void add(List<int> chunk) => _input.add(chunk);
+
+  @override
+  String close() {
+    _input.close();
+    return _digest.value.toString();
+  }
+
+  @override
+  void dispose() {}
+}
+
+class _DigestSink implements Sink<crypto.Digest> {
+  late crypto.Digest value;
+
+  @override
+  void add(crypto.Digest data) => value = data;
+
+  @override
+  void close() {}
+}
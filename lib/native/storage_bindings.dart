@@ -0,0 +1,79 @@
+import 'dart:ffi';
+import 'dart:io';
+
+import 'package:ffi/ffi.dart';
+
+/// Storage helpers from `libmicrollm_hash.so` for large downloads: reserving
+/// a file's blocks before it is written, and the free space left on a
+/// filesystem. Both report "unknown" (null) when the library is not
+/// available, e.g. in tests, so callers keep their portable fallback.
+class NativeStorage {
+  NativeStorage._();
+
+  /// errno for a filesystem that is full (Linux and Android).
+  static const int noSpace = 28;
+
+  /// Create or truncate [path] and reserve [size] bytes of storage for it.
+  ///
+  /// Returns 0 on success, [noSpace] when it does not fit, another errno when
+  /// the filesystem cannot preallocate, or null without the native library.
+  static int? preallocate(String path, int size) {
+    final bindings = _StorageBindings.instance;
+    if (bindings == null) return null;
+    final nativePath = path.toNativeUtf8();
+    try {
+      return bindings.fallocate(nativePath, size);
+    } finally {
+      calloc.free(nativePath);
+    }
+  }
+
+  /// Bytes an app can still write on the filesystem holding [path], or null
+  /// when unknown.
+  static int? freeBytes(String path) {
+    final bindings = _StorageBindings.instance;
+    if (bindings == null) return null;
+    final nativePath = path.toNativeUtf8();
+    try {
+      final bytes = bindings.freeBytes(nativePath);
+      return bytes < 0 ? null : bytes;
+    } finally {
+      calloc.free(nativePath);
+    }
+  }
+}
+
+typedef _FallocateNative = Int32 Function(Pointer<Utf8>, Int64);
+typedef _FallocateDart = int Function(Pointer<Utf8>, int);
+typedef _FreeBytesNative = Int64 Function(Pointer<Utf8>);
+typedef _FreeBytesDart = int Function(Pointer<Utf8>);
+
+class _StorageBindings {
+  static bool _loaded = false;
+  static _StorageBindings? _instance;
+
+  /// Null when the library cannot be opened on this platform.
+  static _StorageBindings? get instance {
+    if (!_loaded) {
+      _loaded = true;
+      try {
+        _instance = _StorageBindings._();
+      } catch (_) {
+        _instance = null;
+      }
+    }
+    return _instance;
+  }
+
+  late final _FallocateDart fallocate;
+  late final _FreeBytesDart freeBytes;
+
+  _StorageBindings._() {
+    if (!Platform.isAndroid && !Platform.isLinux) {
+      throw UnsupportedError('libmicrollm_hash is built for Android and Linux');
+    }
+    final lib = DynamicLibrary.open('libmicrollm_hash.so');
+    fallocate = lib.lookupFunction<_FallocateNative, _FallocateDart>('microllm_fallocate');
+    freeBytes = lib.lookupFunction<_FreeBytesNative, _FreeBytesDart>('microllm_free_bytes');
+  }
+}
@@ -7,6 +7,8 @@ import '../../../domain/entities/benchmark_result.dart';
 import '../../../domain/entities/benchmark_prompt.dart';
 import '../../../domain/entities/safety_result.dart';
 import '../../../domain/entities/speech_to_text_engine.dart';
+import '../../../domain/entities/throughput_benchmark.dart';
+import '../../../domain/repositories/llm_repository.dart';
 import '../../../domain/usecases/summarize_transcript_usecase.dart';
 import '../../../domain/usecases/speech_to_text_usecase.dart';
 import '../../../data/datasources/benchmark_storage.dart';
@@ -26,6 +28,7 @@ class BenchmarkBloc extends Bloc<BenchmarkEvent, BenchmarkState> with Loggable {
   final SpeechToTextUseCase _speechToTextUseCase;
   final SummarizeTranscriptUseCase _summarizeTranscriptUseCase;
   final BenchmarkStorage _benchmarkStorage;
+  final LLMRepository _llmRepository;
 
   StreamSubscription<SpeechToTextEvent>? _sttSubscription;
   StreamSubscription<SummarizationPipelineEvent>? _pipelineSubscription;
@@ -37,9 +40,11 @@ class BenchmarkBloc extends Bloc<BenchmarkEvent, BenchmarkState> with Loggable {
     required SpeechToTextUseCase speechToTextUseCase,
     required SummarizeTranscriptUseCase summarizeTranscriptUseCase,
     required BenchmarkStorage benchmarkStorage,
+    required LLMRepository llmRepository,
   })  : _speechToTextUseCase = speechToTextUseCase,
         _summarizeTranscriptUseCase = summarizeTranscriptUseCase,
         _benchmarkStorage = benchmarkStorage,
+        _llmRepository = llmRepository,
         super(BenchmarkState.initial()) {
     on<BenchmarkStarted>(_onStarted);
     on<BenchmarkRecordingStarted>(_onRecordingStarted);
@@ -57,6 +62,7 @@ class BenchmarkBloc extends Bloc<BenchmarkEvent, BenchmarkState> with Loggable {
     on<BenchmarkTranscriptEvalToggled>(_onTranscriptEvalToggled);
     on<BenchmarkSafetyBlocked>(_onSafetyBlocked);
     on<BenchmarkReset>(_onReset);
+    on<BenchmarkThroughputRequested>(_onThroughputRequested);
   }
 
   @override
@@ -359,4 +365,44 @@ class BenchmarkBloc extends Bloc<BenchmarkEvent, BenchmarkState> with Loggable {
       errorMessage: null,
     ));
   }
+
+  /// Native llama.cpp throughput sweep on the currently loaded model file.
+  ///
+  /// Independent of the voice flow: it only touches the throughput fields, so it
+  /// can run from the idle view without disturbing prompts or past results.
+  Future<void> _onThroughputRequested(
+    BenchmarkThroughputRequested event,
+    Emitter<BenchmarkState> emit,
+  ) async {
+    if (state.throughputRunning) return;
+
+    final modelPath = _llmRepository.currentModelInfo?.filePath;
+    if (modelPath == null) {
+      emit(state.copyWith(
+        errorMessage: 'Load a model before running the throughput benchmark.',
+      ));
+      return;
+    }
+
+    emit(state.copyWith(throughputRunning: true, errorMessage: null));
+
+    final result = await _llmRepository.runThroughputBenchmark(
+      modelPath: modelPath,
+      config: event.config,
+    );
+
+    result.fold(
+      (failure) {
+        logger.e('Throughput benchmark failed: ${failure.message}');
+        emit(state.copyWith(
+          throughputRunning: false,
+          errorMessage: 'Throughput benchmark failed: ${failure.message}',
+        ));
+      },
+      (rows) => emit(state.copyWith(
+        throughputRunning: false,
+        throughputRows: rows,
+      )),
+    );
+  }
 }
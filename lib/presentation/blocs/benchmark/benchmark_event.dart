@@ -146,3 +146,14 @@ final class BenchmarkSafetyBlocked extends BenchmarkEvent {
 final class BenchmarkReset extends BenchmarkEvent {
   const BenchmarkReset();
 }
+
+/// Run the native llama.cpp throughput benchmark on the loaded model.
+final class BenchmarkThroughputRequested extends BenchmarkEvent {
+  final ThroughputBenchmarkConfig config;
+  const BenchmarkThroughputRequested({
+    this.config = ThroughputBenchmarkConfig.quick,
+  });
+
+  @override
+  List<Object> get props => [config];
+}
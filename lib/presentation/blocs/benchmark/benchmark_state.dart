@@ -72,6 +72,12 @@ class BenchmarkState extends Equatable {
   /// Error message, if any.
   final String? errorMessage;
 
+  /// Whether the native throughput benchmark is running.
+  final bool throughputRunning;
+
+  /// Rows from the last native throughput benchmark (empty until one ran).
+  final List<ThroughputBenchmarkRow> throughputRows;
+
   const BenchmarkState({
     required this.status,
     required this.prompts,
@@ -87,6 +93,8 @@ class BenchmarkState extends Equatable {
     this.evaluationEnabled = true,
     this.safetyResult,
     this.errorMessage,
+    this.throughputRunning = false,
+    this.throughputRows = const [],
   });
 
   factory BenchmarkState.initial() {
@@ -113,6 +121,8 @@ class BenchmarkState extends Equatable {
     bool? evaluationEnabled,
     Object? safetyResult = _unset,
     Object? errorMessage = _unset,
+    bool? throughputRunning,
+    List<ThroughputBenchmarkRow>? throughputRows,
   }) {
     return BenchmarkState(
       status: status ?? this.status,
@@ -139,6 +149,8 @@ class BenchmarkState extends Equatable {
       errorMessage: identical(errorMessage, _unset)
           ? this.errorMessage
           : errorMessage as String?,
+      throughputRunning: throughputRunning ?? this.throughputRunning,
+      throughputRows: throughputRows ?? this.throughputRows,
     );
   }
 
@@ -178,5 +190,7 @@ class BenchmarkState extends Equatable {
         evaluationEnabled,
         safetyResult,
         errorMessage,
+        throughputRunning,
+        throughputRows,
       ];
 }
@@ -6,6 +6,9 @@ import 'package:equatable/equatable.dart';
 import '../../../data/datasources/device_scanner_datasource.dart';
 import '../../../data/services/model_download_service.dart';
 import '../../../domain/entities/device_specs.dart';
+import '../../../domain/entities/model_metadata.dart';
+import '../../../domain/repositories/llm_repository.dart';
+import '../../../domain/repositories/settings_repository.dart';
 import '../../../domain/services/compatibility_calculator.dart';
 import '../../../domain/services/model_catalog.dart';
 import '../../../core/utils/logger.dart';
@@ -23,12 +26,18 @@ part 'device_state.dart';
 /// - Model downloads
 class DeviceBloc extends Bloc<DeviceEvent, DeviceState> with Loggable {
   final DeviceScannerDataSource _deviceScanner;
+  final LLMRepository? _llmRepository;
+  final SettingsRepository? _settingsRepository;
   final ModelDownloadService _downloadService = ModelDownloadService();
   StreamSubscription? _downloadSubscription;
   
   DeviceBloc({
     required DeviceScannerDataSource deviceScanner,
+    LLMRepository? llmRepository,
+    SettingsRepository? settingsRepository,
   })  : _deviceScanner = deviceScanner,
+        _llmRepository = llmRepository,
+        _settingsRepository = settingsRepository,
         super(const DeviceState()) {
     on<DeviceScanRequested>(_onScanRequested);
     on<DeviceMemoryRefreshRequested>(_onMemoryRefreshRequested);
@@ -52,11 +61,40 @@ class DeviceBloc extends Bloc<DeviceEvent, DeviceState> with Loggable {
           .toSet();
       // ignore: invalid_use_of_visible_for_testing_member
       emit(state.copyWith(downloadedModels: ids));
+      await _inspectDownloadedModels(downloaded);
     } catch (e) {
       logger.w('Could not check downloaded models: $e');
     }
   }
   
+  /// Reads the GGUF header of each downloaded catalog model so its
+  /// assessment uses the file's exact sizes instead of catalog figures.
+  Future<void> _inspectDownloadedModels(List<DownloadedModel> downloaded) async {
+    final repository = _llmRepository;
+    if (repository == null) return;
+    
+    final metadata = <String, ModelMetadata>{};
+    for (final model in downloaded) {
+      final catalogModel = model.catalogModel;
+      if (catalogModel == null) continue;
+      final result = await repository.inspectModel(model.filePath);
+      result.fold(
+        (failure) => logger.w('Could not inspect ${model.fileName}: ${failure.message}'),
+        (info) => metadata[catalogModel.id] = info,
+      );
+    }
+    if (metadata.isEmpty || isClosed) return;
+    
+    final specs = state.deviceSpecs;
+    // ignore: invalid_use_of_visible_for_testing_member
+    emit(state.copyWith(
+      modelMetadata: metadata,
+      modelAssessments: specs != null
+          ? CompatibilityCalculator.assessAll(specs, metadata: metadata)
+          : null,
+    ));
+  }
+  
   @override
   Future<void> close() {
     _downloadSubscription?.cancel();
@@ -78,10 +116,16 @@ class DeviceBloc extends Bloc<DeviceEvent, DeviceState> with Loggable {
                'Arch: ${specs.cpuArchitecture}');
       
       // Assess all models
-      final assessments = CompatibilityCalculator.assessAll(specs);
+      final assessments = CompatibilityCalculator.assessAll(
+        specs,
+        metadata: state.modelMetadata,
+      );
       
       // Get recommendation
-      final recommended = CompatibilityCalculator.getRecommended(specs);
+      final recommended = CompatibilityCalculator.getRecommended(
+        specs,
+        metadata: state.modelMetadata,
+      );
       
       emit(state.copyWith(
         status: DeviceScanStatus.complete,
@@ -125,7 +169,10 @@ class DeviceBloc extends Bloc<DeviceEvent, DeviceState> with Loggable {
       );
       
       // Re-assess with updated RAM
-      final assessments = CompatibilityCalculator.assessAll(updatedSpecs);
+      final assessments = CompatibilityCalculator.assessAll(
+        updatedSpecs,
+        metadata: state.modelMetadata,
+      );
       
       emit(state.copyWith(
         deviceSpecs: updatedSpecs,
@@ -222,6 +269,30 @@ class DeviceBloc extends Bloc<DeviceEvent, DeviceState> with Loggable {
       downloadProgress: 1.0,
       clearDownloading: true,
     ));
+    
+    unawaited(_optimizeModel(event.modelId));
+  }
+  
+  /// Converts a fresh download for this CPU in the background when the
+  /// "optimize for this CPU" setting is on; the model is usable meanwhile and
+  /// loads with that setting pick up the faster copy once it exists.
+  Future<void> _optimizeModel(String modelId) async {
+    final repository = _llmRepository;
+    final settingsRepository = _settingsRepository;
+    if (repository == null || settingsRepository == null) return;
+    
+    final settings = await settingsRepository.loadSettings();
+    final enabled = settings.fold((_) => false, (s) => s.optimizeModelsForCpu);
+    if (!enabled) return;
+    
+    final path = await _downloadService.getModelPath(modelId);
+    final result = await repository.optimizeModel(path);
+    result.fold(
+      (failure) => logger.w('Could not optimize $modelId: ${failure.message}'),
+      (optimizedPath) => logger.i(optimizedPath != null
+          ? 'Optimized $modelId for this CPU: $optimizedPath'
+          : 'No CPU-specific layout for $modelId'),
+    );
   }
   
   void _onDownloadFailed(
@@ -40,6 +40,9 @@ class DeviceState extends Equatable {
   /// Download progress (0.0 to 1.0).
   final double downloadProgress;
   
+  /// GGUF header facts of downloaded models, by catalog id.
+  final Map<String, ModelMetadata> modelMetadata;
+  
   const DeviceState({
     this.status = DeviceScanStatus.initial,
     this.deviceSpecs,
@@ -51,6 +54,7 @@ class DeviceState extends Equatable {
     this.downloadedModels = const {},
     this.downloadingModelId,
     this.downloadProgress = 0.0,
+    this.modelMetadata = const {},
   });
   
   /// Create copy with updated fields.
@@ -65,6 +69,7 @@ class DeviceState extends Equatable {
     Set<String>? downloadedModels,
     String? downloadingModelId,
     double? downloadProgress,
+    Map<String, ModelMetadata>? modelMetadata,
     bool clearDownloading = false,
   }) {
     return DeviceState(
@@ -78,6 +83,7 @@ class DeviceState extends Equatable {
       downloadedModels: downloadedModels ?? this.downloadedModels,
       downloadingModelId: clearDownloading ? null : (downloadingModelId ?? this.downloadingModelId),
       downloadProgress: downloadProgress ?? this.downloadProgress,
+      modelMetadata: modelMetadata ?? this.modelMetadata,
     );
   }
   
@@ -122,5 +128,6 @@ class DeviceState extends Equatable {
     downloadedModels,
     downloadingModelId,
     downloadProgress,
+    modelMetadata,
   ];
 }
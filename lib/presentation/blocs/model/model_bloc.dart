@@ -180,11 +180,7 @@ class ModelBloc extends Bloc<ModelEvent, ModelState> with Loggable {
     ModelLoadRequested event,
     Emitter<ModelState> emit,
   ) async {
-    emit(state.copyWith(status: ModelStatus.loading));
-    
-    // CRITICAL: Yield to UI to allow the loading indicator to render
-    // Without this, the blocking FFI call starts before Flutter can paint
-    await Future.delayed(const Duration(milliseconds: 200));
+    if (!state.isReady) emit(state.copyWith(status: ModelStatus.loading));
     
     // Get model path (default)
     final pathResult = await _modelRepository.getModelPath();
@@ -203,6 +199,7 @@ class ModelBloc extends Bloc<ModelEvent, ModelState> with Loggable {
       modelPath: modelPath,
       contextSize: event.contextSize,
       threads: event.threads,
+      useOptimizedModel: event.useOptimizedModel,
     );
   }
 
@@ -210,14 +207,15 @@ class ModelBloc extends Bloc<ModelEvent, ModelState> with Loggable {
     ModelLoadFromPathRequested event,
     Emitter<ModelState> emit,
   ) async {
-    emit(state.copyWith(status: ModelStatus.loading));
-    await Future.delayed(const Duration(milliseconds: 200));
+    // A loaded model keeps answering while the next one loads (hot swap).
+    if (!state.isReady) emit(state.copyWith(status: ModelStatus.loading));
 
     await _loadFromPath(
       emit: emit,
       modelPath: event.modelPath,
       contextSize: event.contextSize,
       threads: event.threads,
+      useOptimizedModel: event.useOptimizedModel,
     );
   }
 
@@ -226,21 +224,35 @@ class ModelBloc extends Bloc<ModelEvent, ModelState> with Loggable {
     required String modelPath,
     int? contextSize,
     int? threads,
+    bool useOptimizedModel = false,
   }) async {
     logger.i('Starting model load from: $modelPath');
     logger.i('This may take 1-5 minutes for larger models...');
+    final switching = state.isReady && state.modelInfo?.filePath != modelPath;
 
+    // The JNI backend loads off the UI thread and reports real progress
+    // (model setup, then the weight prefetch).
+    final progressSubscription = _loadModelUseCase.progress.listen((progress) {
+      if (!emit.isDone && state.isLoading) {
+        emit(state.copyWith(loadProgress: progress));
+      }
+    });
     final result = await _loadModelUseCase(LoadModelParams(
       modelPath: modelPath,
       contextSize: contextSize,
       threads: threads,
+      forceReload: switching,
+      useOptimizedModel: useOptimizedModel,
     ));
+    await progressSubscription.cancel();
     
     result.fold(
       (failure) {
         logger.e('Failed to load model: ${failure.message}');
+        // A failed hot swap leaves the previous model loaded and usable.
+        final stillServing = switching && _loadModelUseCase.isLoaded;
         emit(state.copyWith(
-          status: ModelStatus.error,
+          status: stillServing ? ModelStatus.ready : ModelStatus.error,
           errorMessage: failure.message,
         ));
       },
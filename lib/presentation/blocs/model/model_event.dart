@@ -65,14 +65,16 @@ final class ModelDownloadCancelled extends ModelEvent {
 final class ModelLoadRequested extends ModelEvent {
   final int? contextSize;
   final int? threads;
+  final bool useOptimizedModel;
   
   const ModelLoadRequested({
     this.contextSize,
     this.threads,
+    this.useOptimizedModel = false,
   });
   
   @override
-  List<Object?> get props => [contextSize, threads];
+  List<Object?> get props => [contextSize, threads, useOptimizedModel];
 }
 
 /// Load a specific model file into memory.
@@ -80,15 +82,17 @@ final class ModelLoadFromPathRequested extends ModelEvent {
   final String modelPath;
   final int? contextSize;
   final int? threads;
+  final bool useOptimizedModel;
 
   const ModelLoadFromPathRequested({
     required this.modelPath,
     this.contextSize,
     this.threads,
+    this.useOptimizedModel = false,
   });
 
   @override
-  List<Object?> get props => [modelPath, contextSize, threads];
+  List<Object?> get props => [modelPath, contextSize, threads, useOptimizedModel];
 }
 
 /// Unload model from memory.
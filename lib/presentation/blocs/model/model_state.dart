@@ -11,6 +11,9 @@ class ModelState extends Equatable {
   /// Download progress (if downloading).
   final DownloadProgress? downloadProgress;
   
+  /// Load progress, 0..1 (if loading and the backend reports it).
+  final double? loadProgress;
+  
   /// Error message (if error status).
   final String? errorMessage;
   
@@ -18,6 +21,7 @@ class ModelState extends Equatable {
     this.status = ModelStatus.notDownloaded,
     this.modelInfo,
     this.downloadProgress,
+    this.loadProgress,
     this.errorMessage,
   });
   
@@ -26,12 +30,14 @@ class ModelState extends Equatable {
     ModelStatus? status,
     ModelInfo? modelInfo,
     DownloadProgress? downloadProgress,
+    double? loadProgress,
     String? errorMessage,
   }) {
     return ModelState(
       status: status ?? this.status,
       modelInfo: modelInfo ?? this.modelInfo,
       downloadProgress: downloadProgress,
+      loadProgress: loadProgress,
       errorMessage: errorMessage,
     );
   }
@@ -76,6 +82,10 @@ class ModelState extends Equatable {
       case ModelStatus.downloaded:
         return 'Model downloaded, ready to load';
       case ModelStatus.loading:
+        final progress = loadProgress;
+        if (progress != null) {
+          return 'Loading model: ${(progress * 100).round()}%';
+        }
         return 'Loading model...';
       case ModelStatus.ready:
         return 'Model ready';
@@ -91,6 +101,7 @@ class ModelState extends Equatable {
     status,
     modelInfo,
     downloadProgress,
+    loadProgress,
     errorMessage,
   ];
 }
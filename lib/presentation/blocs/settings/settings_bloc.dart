@@ -26,6 +26,7 @@ class SettingsBloc extends Bloc<SettingsEvent, SettingsState> with Loggable {
     on<VoiceInputToggled>(_onVoiceInputToggled);
     on<VoiceOutputToggled>(_onVoiceOutputToggled);
     on<VoiceSttOfflineOnlyToggled>(_onVoiceSttOfflineOnlyToggled);
+    on<OptimizeModelsForCpuToggled>(_onOptimizeModelsForCpuToggled);
     on<SpeechToTextEngineChanged>(_onSpeechToTextEngineChanged);
     on<WhisperModelChanged>(_onWhisperModelChanged);
     on<TextToSpeechEngineChanged>(_onTextToSpeechEngineChanged);
@@ -157,6 +158,16 @@ class SettingsBloc extends Bloc<SettingsEvent, SettingsState> with Loggable {
     add(SettingsUpdated(settings: newSettings));
   }
 
+  Future<void> _onOptimizeModelsForCpuToggled(
+    OptimizeModelsForCpuToggled event,
+    Emitter<SettingsState> emit,
+  ) async {
+    final newSettings = state.settings.copyWith(
+      optimizeModelsForCpu: !state.settings.optimizeModelsForCpu,
+    );
+    add(SettingsUpdated(settings: newSettings));
+  }
+
   Future<void> _onSpeechToTextEngineChanged(
     SpeechToTextEngineChanged event,
     Emitter<SettingsState> emit,
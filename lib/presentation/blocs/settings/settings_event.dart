@@ -63,6 +63,11 @@ final class VoiceSttOfflineOnlyToggled extends SettingsEvent {
   const VoiceSttOfflineOnlyToggled();
 }
 
+/// Toggle converting downloaded models for this CPU (and loading the copy).
+final class OptimizeModelsForCpuToggled extends SettingsEvent {
+  const OptimizeModelsForCpuToggled();
+}
+
 /// Change STT engine.
 final class SpeechToTextEngineChanged extends SettingsEvent {
   final SpeechToTextEngine engine;
@@ -72,6 +72,7 @@ class VoiceBloc extends Bloc<VoiceEvent, VoiceState> with Loggable {
     _sttSubscription = _speechToTextUseCase(SpeechToTextParams(
       language: event.language,
       offlineOnly: event.offlineOnly,
+      autoDetectLanguage: event.autoDetectLanguage,
       engine: event.engine,
       whisperModelId: event.whisperModelId,
       whisperThreads: 4,
@@ -13,17 +13,20 @@ final class VoiceRecognitionStarted extends VoiceEvent {
   final SpeechToTextEngine engine;
   final String language;
   final bool offlineOnly;
+  final bool autoDetectLanguage;
   final String whisperModelId;
   
   const VoiceRecognitionStarted({
     required this.engine,
     required this.language,
     this.offlineOnly = false,
+    this.autoDetectLanguage = false,
     this.whisperModelId = 'small',
   });
   
   @override
-  List<Object?> get props => [engine, language, offlineOnly, whisperModelId];
+  List<Object?> get props =>
+      [engine, language, offlineOnly, autoDetectLanguage, whisperModelId];
 }
 
 /// Stop speech recognition.
@@ -8,6 +8,7 @@ import '../../domain/entities/benchmark_result.dart';
 import '../../domain/entities/benchmark_prompt.dart';
 import '../../domain/entities/evaluation_result.dart';
 import '../../domain/entities/safety_result.dart';
+import '../../domain/entities/throughput_benchmark.dart';
 import '../../domain/usecases/summarize_transcript_usecase.dart';
 import '../blocs/benchmark/benchmark_bloc.dart';
 import '../blocs/settings/settings_bloc.dart';
@@ -222,6 +223,18 @@ class _IdleView extends StatelessWidget {
                   ),
                 ),
                 const SizedBox(height: UiTokens.s32),
+
+                // Native llama.cpp throughput (independent of the voice flow)
+                _ThroughputCard(
+                  running: state.throughputRunning,
+                  rows: state.throughputRows,
+                  onRun: () {
+                    context
+                        .read<BenchmarkBloc>()
+                        .add(const BenchmarkThroughputRequested());
+                  },
+                ),
+                const SizedBox(height: UiTokens.s32),
               ],
             ),
           ),
@@ -2008,6 +2021,103 @@ class _MetricChip extends StatelessWidget {
   }
 }
 
+/// Native throughput results: prompt processing, generation and time to first
+/// token per (prompt, batch, threads) combination, measured on the loaded GGUF.
+class _ThroughputCard extends StatelessWidget {
+  final bool running;
+  final List<ThroughputBenchmarkRow> rows;
+  final VoidCallback onRun;
+
+  const _ThroughputCard({
+    required this.running,
+    required this.rows,
+    required this.onRun,
+  });
+
+  @override
+  Widget build(BuildContext context) {
+    final theme = Theme.of(context);
+    final muted = theme.colorScheme.onSurface.withOpacity(0.55);
+
+    return Container(
+      width: double.infinity,
+      padding: const EdgeInsets.all(UiTokens.s16),
+      decoration: BoxDecoration(
+        color: theme.colorScheme.surface,
+        borderRadius: BorderRadius.circular(UiTokens.r12),
+        border: Border.all(
+          color: theme.colorScheme.onSurface.withOpacity(0.08),
+        ),
+      ),
+      child: Column(
+        crossAxisAlignment: CrossAxisAlignment.start,
+        children: [
+          Row(
+            children: [
+              Icon(Icons.speed_rounded, size: 20, color: muted),
+              const SizedBox(width: UiTokens.s8),
+              Expanded(
+                child: Text('Model throughput',
+                    style: theme.textTheme.titleSmall),
+              ),
+              if (running)
+                const SizedBox(
+                  width: 20,
+                  height: 20,
+                  child: CircularProgressIndicator(strokeWidth: 2),
+                )
+              else
+                TextButton(
+                  onPressed: onRun,
+                  child: Text(rows.isEmpty ? 'Run' : 'Run again'),
+                ),
+            ],
+          ),
+          Text(
+            'Prompt processing, generation speed and time to first token '
+            'on the loaded model.',
+            style: theme.textTheme.bodySmall?.copyWith(color: muted),
+          ),
+          if (rows.isNotEmpty) ...[
+            const SizedBox(height: UiTokens.s12),
+            _throughputRow(
+              theme,
+              ['Config', 'Prompt t/s', 'Gen t/s', 'TTFT'],
+              style: theme.textTheme.labelMedium?.copyWith(color: muted),
+            ),
+            const Divider(height: UiTokens.s12),
+            for (final r in rows)
+              _throughputRow(theme, [
+                r.label,
+                r.promptTokensPerSecond.toStringAsFixed(1),
+                r.genTokensPerSecond.toStringAsFixed(1),
+                '${r.timeToFirstTokenMs.round()} ms',
+              ]),
+          ],
+        ],
+      ),
+    );
+  }
+
+  Widget _throughputRow(ThemeData theme, List<String> cells,
+      {TextStyle? style}) {
+    final textStyle = style ?? theme.textTheme.bodySmall;
+    return Padding(
+      padding: const EdgeInsets.symmetric(vertical: 2),
+      child: Row(
+        children: [
+          Expanded(flex: 3, child: Text(cells[0], style: textStyle)),
+          for (final cell in cells.skip(1))
+            Expanded(
+              flex: 2,
+              child: Text(cell, style: textStyle, textAlign: TextAlign.end),
+            ),
+        ],
+      ),
+    );
+  }
+}
+
 /// A titled section showing text content.
 class _ResultSection extends StatelessWidget {
   final String title;
@@ -116,6 +116,7 @@ class _ChatViewState extends State<ChatView> {
       engine: settings.speechToTextEngine,
       language: settings.sourceLanguage,
       offlineOnly: settings.voiceSttOfflineOnly,
+      autoDetectLanguage: settings.autoDetectLanguage,
       whisperModelId: settings.whisperModelId,
     ));
   }
@@ -146,6 +147,7 @@ class _ChatViewState extends State<ChatView> {
             engine: settingsState.settings.speechToTextEngine,
             language: settingsState.settings.sourceLanguage,
             offlineOnly: settingsState.settings.voiceSttOfflineOnly,
+            autoDetectLanguage: settingsState.settings.autoDetectLanguage,
             whisperModelId: settingsState.settings.whisperModelId,
           ));
         }
@@ -327,6 +329,7 @@ class _ChatViewState extends State<ChatView> {
                                     engine: settings.speechToTextEngine,
                                     language: settings.sourceLanguage,
                                     offlineOnly: settings.voiceSttOfflineOnly,
+                                    autoDetectLanguage: settings.autoDetectLanguage,
                                     whisperModelId: settings.whisperModelId,
                                   ),
                                 );
@@ -4,6 +4,8 @@ import 'package:flutter_bloc/flutter_bloc.dart';
 import '../../core/di/injection.dart';
 import '../../data/datasources/device_scanner_datasource.dart';
 import '../../domain/entities/device_specs.dart';
+import '../../domain/repositories/llm_repository.dart';
+import '../../domain/repositories/settings_repository.dart';
 import '../../domain/services/device_benchmark.dart';
 import '../blocs/device/device_bloc.dart';
 import '../widgets/device_specs_card.dart';
@@ -27,6 +29,8 @@ class DeviceCompatibilityPage extends StatelessWidget {
     return BlocProvider(
       create: (_) => DeviceBloc(
         deviceScanner: sl<DeviceScannerDataSource>(),
+        llmRepository: sl<LLMRepository>(),
+        settingsRepository: sl<SettingsRepository>(),
       )..add(const DeviceScanRequested()),
       child: const DeviceCompatibilityView(),
     );
@@ -163,7 +163,7 @@ class OnboardingPage extends StatelessWidget {
         return _buildLoadPrompt(context, state);
       
       case ModelStatus.loading:
-        return _buildLoadingIndicator(context);
+        return _buildLoadingIndicator(context, state);
       
       case ModelStatus.error:
         return _buildErrorState(context, state);
@@ -311,18 +311,21 @@ class OnboardingPage extends StatelessWidget {
     );
   }
   
-  Widget _buildLoadingIndicator(BuildContext context) {
+  Widget _buildLoadingIndicator(BuildContext context, ModelState state) {
     final cs = Theme.of(context).colorScheme;
+    final progress = state.loadProgress;
     return Column(
       children: [
-        const SizedBox(
+        SizedBox(
           width: 60,
           height: 60,
-          child: CircularProgressIndicator(strokeWidth: 4),
+          child: CircularProgressIndicator(value: progress, strokeWidth: 4),
         ),
         const SizedBox(height: 24),
         Text(
-          'Loading model into memory...',
+          progress != null
+              ? 'Loading model into memory... ${(progress * 100).round()}%'
+              : 'Loading model into memory...',
           style: Theme.of(context).textTheme.titleMedium?.copyWith(
             fontWeight: FontWeight.w600,
           ),
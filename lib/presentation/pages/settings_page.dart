@@ -11,6 +11,8 @@ import '../../domain/entities/speech_to_text_engine.dart';
 import '../../domain/entities/text_to_speech_engine.dart';
 import '../../domain/services/stt_model_catalog.dart';
 import '../../domain/services/stt_model_path_resolver.dart';
+import '../../domain/usecases/recommend_stt_model_usecase.dart';
+import '../../domain/usecases/usecase.dart';
 import '../../data/services/model_download_service.dart';
 import '../../data/services/stt_model_download_service.dart';
 import '../../domain/repositories/voice_repository.dart';
@@ -126,32 +128,8 @@ class SettingsPage extends StatelessWidget {
                         ? Column(
                             mainAxisSize: MainAxisSize.min,
                             children: [
-                              ListTile(
-                                title: const Text('Whisper Model'),
-                                subtitle: const Text(
-                                  'Select the offline Whisper model. Download below.',
-                                ),
-                                trailing: DropdownButton<String>(
-                                  value: state.settings.whisperModelId,
-                                  underline: const SizedBox.shrink(),
-                                  items: const [
-                                    DropdownMenuItem(
-                                      value: 'base',
-                                      child: Text('Base (faster)'),
-                                    ),
-                                    DropdownMenuItem(
-                                      value: 'small',
-                                      child: Text('Small (better accuracy)'),
-                                    ),
-                                  ],
-                                  onChanged: (id) {
-                                    if (id != null) {
-                                      context
-                                          .read<SettingsBloc>()
-                                          .add(WhisperModelChanged(modelId: id));
-                                    }
-                                  },
-                                ),
+                              _WhisperModelPicker(
+                                modelId: state.settings.whisperModelId,
                               ),
                               _WhisperModelManagerTile(
                                 modelId: state.settings.whisperModelId,
@@ -211,6 +189,19 @@ class SettingsPage extends StatelessWidget {
                   _buildTemperatureSlider(context, state.settings),
                   _buildLastGenerationStats(context),
                   _buildModelSelector(context, state.settings),
+                  SwitchListTile.adaptive(
+                    title: const Text('Optimize for this CPU'),
+                    subtitle: const Text(
+                      'Convert Q4_K downloads to Q4_0 for faster ARM kernels. '
+                      'Slightly lower quality; applies from the next model load.',
+                    ),
+                    value: state.settings.optimizeModelsForCpu,
+                    onChanged: (_) {
+                      context
+                          .read<SettingsBloc>()
+                          .add(const OptimizeModelsForCpuToggled());
+                    },
+                  ),
                   _buildModelInfo(context),
                 ],
               ),
@@ -493,17 +484,18 @@ class SettingsPage extends StatelessWidget {
                     SelectedModelChanged(modelPath: value),
                   );
 
-              // Reload model immediately if one is already loaded/ready
+              // Switch immediately; a loaded model keeps serving until the
+              // new one is ready (ModelBloc hot-swaps them).
               final threads = settings.inferenceThreads;
               final ctx = settings.contextWindowSize;
 
-              context.read<ModelBloc>().add(const ModelUnloadRequested());
               if (value != null) {
                 context.read<ModelBloc>().add(
                       ModelLoadFromPathRequested(
                         modelPath: value,
                         contextSize: ctx,
                         threads: threads,
+                        useOptimizedModel: settings.optimizeModelsForCpu,
                       ),
                     );
               } else {
@@ -511,6 +503,7 @@ class SettingsPage extends StatelessWidget {
                       ModelLoadRequested(
                         contextSize: ctx,
                         threads: threads,
+                        useOptimizedModel: settings.optimizeModelsForCpu,
                       ),
                     );
               }
@@ -575,6 +568,76 @@ class SettingsPage extends StatelessWidget {
   }
 }
 
+/// Whisper model dropdown offering the models that fit in memory next to the
+/// loaded LLM ([RecommendSttModelUseCase]); the largest of them is marked as
+/// recommended. Lists the whole catalog when memory cannot be read.
+class _WhisperModelPicker extends StatefulWidget {
+  final String modelId;
+
+  const _WhisperModelPicker({required this.modelId});
+
+  @override
+  State<_WhisperModelPicker> createState() => _WhisperModelPickerState();
+}
+
+class _WhisperModelPickerState extends State<_WhisperModelPicker> {
+  late final Future<SttModelFit?> _fit = sl<RecommendSttModelUseCase>()
+      .call(const NoParams())
+      .then((result) => result.fold((_) => null, (fit) => fit));
+
+  @override
+  Widget build(BuildContext context) {
+    return FutureBuilder<SttModelFit?>(
+      future: _fit,
+      builder: (context, snapshot) {
+        final fit = snapshot.data;
+        // The selected model stays listed so the dropdown keeps its value.
+        final options = [
+          for (final m in SttModelCatalog.models)
+            if (fit == null || fit.fits(m.id) || m.id == widget.modelId) m,
+        ];
+        final String subtitle;
+        if (fit == null) {
+          subtitle = 'Select the offline Whisper model. Download below.';
+        } else if (fit.recommended == null) {
+          subtitle = 'No Whisper model fits next to the loaded model; '
+              'unload it or pick a smaller one.';
+        } else if (!fit.fits(widget.modelId)) {
+          subtitle = 'The selected model may not fit next to the loaded model. '
+              'Recommended: ${fit.recommended!.shortName}.';
+        } else {
+          subtitle = 'Models that fit next to the loaded model. Download below.';
+        }
+
+        return ListTile(
+          title: const Text('Whisper Model'),
+          subtitle: Text(subtitle),
+          trailing: DropdownButton<String>(
+            value: widget.modelId,
+            underline: const SizedBox.shrink(),
+            items: [
+              for (final m in options)
+                DropdownMenuItem(
+                  value: m.id,
+                  child: Text(
+                    m.id == fit?.recommended?.id
+                        ? '${m.shortName} • recommended'
+                        : m.shortName,
+                  ),
+                ),
+            ],
+            onChanged: (id) {
+              if (id != null) {
+                context.read<SettingsBloc>().add(WhisperModelChanged(modelId: id));
+              }
+            },
+          ),
+        );
+      },
+    );
+  }
+}
+
 class _WhisperModelManagerTile extends StatefulWidget {
   final String modelId;
   final int threads;
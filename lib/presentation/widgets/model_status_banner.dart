@@ -52,6 +52,16 @@ class ModelStatusBanner extends StatelessWidget {
                     ),
                   ),
                 ],
+                if (state.isLoading && state.loadProgress != null) ...[
+                  const SizedBox(height: 8),
+                  LinearProgressIndicator(
+                    value: state.loadProgress,
+                    minHeight: 4,
+                    borderRadius: BorderRadius.circular(2),
+                    backgroundColor: Colors.white.withOpacity(0.3),
+                    valueColor: AlwaysStoppedAnimation(_foregroundColor(context)),
+                  ),
+                ],
               ],
             ),
           ),
@@ -103,6 +103,7 @@ class VoiceButton extends StatelessWidget {
         engine: settings.speechToTextEngine,
         language: settings.sourceLanguage,
         offlineOnly: settings.voiceSttOfflineOnly,
+        autoDetectLanguage: settings.autoDetectLanguage,
         whisperModelId: settings.whisperModelId,
       ));
     }
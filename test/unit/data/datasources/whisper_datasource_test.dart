@@ -0,0 +1,101 @@
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:micro_llm_app/data/datasources/whisper_datasource.dart';
+import 'package:micro_llm_app/domain/repositories/voice_repository.dart';
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  const channel = MethodChannel('com.microllm.app/whisper');
+  const eventsName = 'com.microllm.app/whisper_events';
+  final messenger =
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger;
+
+  late List<Map<Object?, Object?>> starts;
+
+  Future<void> sendEvent(Map<String, Object?> event) =>
+      messenger.handlePlatformMessage(
+        eventsName,
+        const StandardMethodCodec().encodeSuccessEnvelope(event),
+        (_) {},
+      );
+
+  setUp(() {
+    starts = [];
+    messenger.setMockMethodCallHandler(channel, (call) async {
+      switch (call.method) {
+        case 'start':
+          starts.add(call.arguments as Map<Object?, Object?>);
+        case 'getMemoryReport':
+          return {'weightsBytes': 190000000, 'ftype': 1, 'mmapLoader': true};
+      }
+      return null;
+    });
+    messenger.setMockMethodCallHandler(
+      const MethodChannel(eventsName),
+      (_) async => null,
+    );
+  });
+
+  tearDown(() {
+    messenger.setMockMethodCallHandler(channel, null);
+    messenger.setMockMethodCallHandler(const MethodChannel(eventsName), null);
+  });
+
+  group('WhisperDataSourceImpl.startRecognition', () {
+    test('sends the language tag when auto-detection is off', () async {
+      final dataSource = WhisperDataSourceImpl();
+      dataSource.startRecognition(language: 'de-DE');
+      await pumpEventQueue();
+
+      expect(starts.single['language'], 'de-DE');
+      expect(starts.single['continueSession'], isFalse);
+      await dataSource.cancelRecognition();
+    });
+
+    test('sends auto when auto-detection is on, also on restarts', () async {
+      final dataSource = WhisperDataSourceImpl();
+      dataSource.startRecognition(
+        language: 'en-US',
+        continuous: true,
+        autoDetectLanguage: true,
+      );
+      await pumpEventQueue();
+      expect(starts.single['language'], WhisperDataSourceImpl.autoLanguage);
+
+      await sendEvent({'type': 'result', 'text': 'hallo', 'isFinal': true});
+      await Future<void>.delayed(const Duration(milliseconds: 400));
+
+      expect(starts, hasLength(2));
+      expect(starts.last['language'], WhisperDataSourceImpl.autoLanguage);
+      expect(starts.last['continueSession'], isTrue);
+      await dataSource.cancelRecognition();
+    });
+  });
+
+  test('partial results append segments; the final result carries the text',
+      () async {
+    final dataSource = WhisperDataSourceImpl();
+    final results = <SpeechRecognitionResult>[];
+    final sub = dataSource
+        .startRecognition(language: 'en-US')
+        .listen(results.add);
+    await pumpEventQueue();
+
+    await sendEvent({'type': 'result', 'segmentText': ' Hello', 'isFinal': false});
+    await sendEvent({'type': 'result', 'segmentText': ' world', 'isFinal': false});
+    await sendEvent({'type': 'result', 'text': 'Hello world.', 'isFinal': true});
+    await pumpEventQueue();
+
+    expect(results.map((r) => r.text), [' Hello', ' Hello world', 'Hello world.']);
+    expect(results.map((r) => r.isFinal), [false, false, true]);
+    await sub.cancel();
+  });
+
+  test('memory report keeps the mmapLoader flag', () async {
+    final report = await WhisperDataSourceImpl().getMemoryReport();
+
+    expect(report, {'weightsBytes': 190000000, 'ftype': 1, 'mmapLoader': true});
+  });
+}
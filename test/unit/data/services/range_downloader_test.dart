@@ -0,0 +1,123 @@
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:crypto/crypto.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:micro_llm_app/data/services/model_download_service.dart';
+import 'package:micro_llm_app/data/services/range_downloader.dart';
+
+/// Loopback stand-in for the model host: serves [data] with byte ranges and
+/// fails every request for a range starting at one of [failingStarts].
+class _RangeServer {
+  final Uint8List data;
+  final Set<int> failingStarts = {};
+  final List<String> ranges = [];
+  late final HttpServer _server;
+
+  _RangeServer(this.data);
+
+  Uri get url => Uri.parse('http://127.0.0.1:${_server.port}/model.gguf');
+
+  Future<void> start() async {
+    _server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+    _server.listen((request) async {
+      final range = request.headers.value(HttpHeaders.rangeHeader)!;
+      ranges.add(range);
+      final bounds = range.substring('bytes='.length).split('-');
+      final start = int.parse(bounds[0]);
+      final end = int.parse(bounds[1]);
+      final response = request.response;
+      if (failingStarts.contains(start)) {
+        response.statusCode = HttpStatus.internalServerError;
+      } else {
+        response.statusCode = HttpStatus.partialContent;
+        response.headers.set(
+            HttpHeaders.contentRangeHeader, 'bytes $start-$end/${data.length}');
+        response.add(data.sublist(start, end + 1));
+      }
+      await response.close();
+    });
+  }
+
+  Future<void> stop() => _server.close(force: true);
+}
+
+void main() {
+  late _RangeServer server;
+  late Directory dir;
+  late String path;
+  late String sha;
+
+  RangeDownloader downloader() => RangeDownloader(
+        connections: 3,
+        chunkSize: 1000,
+        maxAttempts: 2,
+        retryDelay: Duration.zero,
+      );
+
+  Future<List<DownloadEvent>> run(RangeDownloader d, {String? expectedSha256}) =>
+      d
+          .download(
+            modelId: 'test',
+            url: server.url,
+            totalBytes: server.data.length,
+            path: path,
+            expectedSha256: expectedSha256,
+          )
+          .toList();
+
+  setUp(() async {
+    final random = Random(7);
+    final data = Uint8List.fromList(
+        List.generate(10500, (_) => random.nextInt(256)));
+    sha = sha256.convert(data).toString();
+    server = _RangeServer(data);
+    await server.start();
+    dir = await Directory.systemTemp.createTemp('range_downloader_test');
+    path = '${dir.path}/model.gguf.download';
+  });
+
+  tearDown(() async {
+    await server.stop();
+    await dir.delete(recursive: true);
+  });
+
+  test('assembles concurrent ranges and verifies the whole file', () async {
+    final events = await run(downloader(), expectedSha256: sha);
+
+    expect(events.last, isA<DownloadComplete>());
+    expect(await File(path).readAsBytes(), server.data);
+    expect(server.ranges, hasLength(11));
+    expect(server.ranges, contains('bytes=10000-10499'));
+    expect(File(RangeDownloader.partsPath(path)).existsSync(), isFalse);
+  });
+
+  test('resumes with exactly the chunks that are missing', () async {
+    server.failingStarts.add(3000);
+    final failed = await run(downloader(), expectedSha256: sha);
+    expect(failed.last, isA<DownloadError>());
+    expect(File(RangeDownloader.partsPath(path)).existsSync(), isTrue);
+
+    final fetchedBefore = server.ranges.toSet()..remove('bytes=3000-3999');
+    server.failingStarts.clear();
+    server.ranges.clear();
+    final resumed = await run(downloader(), expectedSha256: sha);
+
+    expect(resumed.first, isA<DownloadStarted>());
+    expect((resumed.first as DownloadStarted).resumingFrom, greaterThan(0));
+    expect(resumed.last, isA<DownloadComplete>());
+    expect(server.ranges, contains('bytes=3000-3999'));
+    expect(server.ranges.toSet().intersection(fetchedBefore), isEmpty);
+    expect(await File(path).readAsBytes(), server.data);
+  });
+
+  test('deletes the file when the checksum does not match', () async {
+    final events = await run(downloader(), expectedSha256: '0' * 64);
+
+    expect(events.last, isA<DownloadError>());
+    expect(File(path).existsSync(), isFalse);
+    expect(File(RangeDownloader.partsPath(path)).existsSync(), isFalse);
+  });
+}
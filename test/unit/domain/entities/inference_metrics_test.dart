@@ -0,0 +1,56 @@
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:micro_llm_app/domain/entities/inference_metrics.dart';
+
+void main() {
+  group('InferenceMetrics', () {
+    test('parses the platform channel map', () {
+      final metrics = InferenceMetrics.fromMap({
+        'tokenizeMs': 1.5,
+        'promptTokens': 120,
+        'prefillMs': 600.0,
+        'decodeTokens': 31,
+        'decodeP50Ms': 42.0,
+        'decodeP95Ms': 55.5,
+        'decodeP99Ms': 80,
+        'sampleMs': 3.25,
+        'detokenizeMs': 0.5,
+        'kvUsed': 512,
+        'kvSize': 2048,
+        'peakRssBytes': 1200000000,
+      });
+
+      expect(metrics.promptTokens, 120);
+      expect(metrics.decodeTokens, 31);
+      expect(metrics.decodeP99Ms, 80.0);
+      expect(metrics.peakRssBytes, 1200000000);
+    });
+
+    test('defaults missing keys to zero', () {
+      final metrics = InferenceMetrics.fromMap({'prefillMs': 10});
+
+      expect(metrics.prefillMs, 10.0);
+      expect(metrics.kvSize, 0);
+      expect(metrics.decodeP50Ms, 0.0);
+    });
+
+    test('derives prefill speed and KV usage', () {
+      const metrics = InferenceMetrics(
+        promptTokens: 200,
+        prefillMs: 500,
+        kvUsed: 512,
+        kvSize: 2048,
+      );
+
+      expect(metrics.prefillTokensPerSecond, closeTo(400.0, 0.001));
+      expect(metrics.kvUsage, closeTo(0.25, 0.001));
+    });
+
+    test('derived values are zero when nothing was measured', () {
+      const metrics = InferenceMetrics();
+
+      expect(metrics.prefillTokensPerSecond, 0);
+      expect(metrics.kvUsage, 0);
+    });
+  });
+}
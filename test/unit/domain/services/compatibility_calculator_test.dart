@@ -3,6 +3,8 @@ import 'package:flutter_test/flutter_test.dart';
 import 'package:micro_llm_app/domain/services/compatibility_calculator.dart';
 import 'package:micro_llm_app/domain/services/model_catalog.dart';
 import 'package:micro_llm_app/domain/entities/device_specs.dart';
+import 'package:micro_llm_app/domain/entities/memory_estimate.dart';
+import 'package:micro_llm_app/domain/entities/model_metadata.dart';
 
 void main() {
   group('CompatibilityCalculator', () {
@@ -133,6 +135,104 @@ void main() {
         expect(tightModel.warnings, isNotEmpty);
       }
     });
+
+    group('memory estimate', () {
+      final phi3 = ModelCatalog.models.firstWhere((m) => m.id == 'phi3-mini-q4');
+
+      test('quantized KV cache and flash attention shrink the estimate', () {
+        final f16 = CompatibilityCalculator.estimateMemory(phi3, contextSize: 4096);
+        final q8 = CompatibilityCalculator.estimateMemory(
+          phi3,
+          contextSize: 4096,
+          kvCacheType: KvCacheType.q8_0,
+          flashAttention: true,
+        );
+
+        expect(f16.weightsBytes, phi3.sizeBytes);
+        expect(f16.kvCacheBytes, phi3.kvCacheBytesPerToken * 4096);
+        expect(q8.kvCacheBytes / f16.kvCacheBytes, closeTo(34 / 64, 0.001));
+        expect(q8.computeBytes, lessThan(f16.computeBytes));
+      });
+
+      test('q8_0 KV cache fits a larger context in the same RAM', () {
+        const available = 3 * 1024 * 1024 * 1024;
+        final f16Max = CompatibilityCalculator.maxContextSize(phi3, available);
+        final q8Max = CompatibilityCalculator.maxContextSize(
+          phi3,
+          available,
+          kvCacheType: KvCacheType.q8_0,
+          flashAttention: true,
+        );
+
+        expect(f16Max % 256, 0);
+        expect(q8Max, greaterThan(f16Max));
+        expect(q8Max, lessThanOrEqualTo(phi3.contextSize));
+      });
+
+      test('recommends a quantized KV cache when f16 does not fit', () {
+        final assessment = CompatibilityCalculator.assess(
+          phi3,
+          midRangeDevice,
+          contextSize: 2048,
+        );
+
+        expect(assessment.memoryEstimate!.totalBytes,
+            greaterThan(midRangeDevice.availableRamBytes));
+        expect(
+          assessment.recommendations,
+          contains(contains('q8_0 KV cache')),
+        );
+      });
+
+      test('uses the native estimate when given', () {
+        const native = MemoryEstimate(
+          weightsBytes: 100,
+          kvCacheBytes: 20,
+          computeBytes: 3,
+        );
+        final assessment = CompatibilityCalculator.assess(
+          phi3,
+          highEndDevice,
+          memoryEstimate: native,
+        );
+
+        expect(assessment.memoryEstimate, native);
+        expect(native.totalBytes, 123);
+      });
+
+      test('uses GGUF header metadata over catalog figures', () {
+        const header = ModelMetadata(
+          architecture: 'phi3',
+          name: 'Phi 3 Mini',
+          parameterCount: 3821079552,
+          weightsBytes: 2250 * 1024 * 1024,
+          contextLength: 131072,
+          vocabSize: 32064,
+          layerCount: 32,
+          embeddingLength: 3072,
+          headCount: 32,
+          headCountKv: 32,
+          kvBytesPerToken: 393216,
+          tensorTypeBytes: {'q4_K': 1950 * 1024 * 1024, 'q6_K': 300 * 1024 * 1024},
+        );
+        final memory = CompatibilityCalculator.estimateMemory(
+          phi3,
+          contextSize: 1024,
+          metadata: header,
+        );
+        final maxContext = CompatibilityCalculator.maxContextSize(
+          phi3,
+          64 * 1024 * 1024 * 1024,
+          metadata: header,
+        );
+
+        expect(memory.weightsBytes, header.weightsBytes);
+        expect(memory.kvCacheBytes, header.kvBytesPerToken * 1024);
+        expect(maxContext, header.contextLength);
+        expect(header.dominantTensorType, 'q4_K');
+        expect(header.parameterCountFormatted, '3.8B');
+      });
+    });
   });
 
   group('CompatibilityLevel', () {
@@ -0,0 +1,84 @@
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:micro_llm_app/domain/services/json_schema_grammar.dart';
+import 'package:micro_llm_app/domain/usecases/evaluation_usecase.dart';
+
+void main() {
+  group('JsonSchemaGrammar', () {
+    List<String> rules(String grammar) =>
+        grammar.split('\n').where((line) => line.isNotEmpty).toList();
+
+    test('emits object properties in order with their own rules', () {
+      final grammar = JsonSchemaGrammar.fromSchema({
+        'type': 'object',
+        'properties': {
+          'score': {'type': 'integer', 'minimum': 1, 'maximum': 3},
+          'tags': {
+            'type': 'array',
+            'items': {'type': 'string'},
+            'maxItems': 2,
+          },
+          'note': {'type': 'string', 'maxLength': 5},
+          'ok': {'type': 'boolean'},
+        },
+      });
+
+      expect(
+        rules(grammar).take(4),
+        [
+          r'root ::= "{" space "\"score\"" space ":" space score "," space '
+              r'"\"tags\"" space ":" space tags "," space '
+              r'"\"note\"" space ":" space note "," space '
+              r'"\"ok\"" space ":" space boolean "}" space',
+          r'score ::= ("1" | "2" | "3") space',
+          r'tags ::= "[" space (string ("," space string){0,1})? "]" space',
+          r'note ::= "\"" char{0,5} "\"" space',
+        ],
+      );
+      expect(grammar, contains('\nspace ::= '));
+      expect(grammar, contains('\nboolean ::= '));
+    });
+
+    test('escapes enum values as JSON inside GBNF literals', () {
+      final grammar = JsonSchemaGrammar.fromSchema({
+        'type': 'object',
+        'properties': {
+          'string': {
+            'enum': ['a"b', 7],
+          },
+        },
+      });
+
+      // A property named like a shared rule must not replace it.
+      expect(grammar, contains(r'space ":" space string-value "}" space'));
+      expect(grammar, contains(r'string-value ::= ("\"a\\\"b\"" | "7") space'));
+      expect(grammar, contains('\nstring ::= '));
+    });
+
+    test('keeps wide integer ranges as plain integers', () {
+      final grammar = JsonSchemaGrammar.fromSchema({
+        'type': 'object',
+        'properties': {
+          'tokens': {'type': 'integer', 'minimum': 0, 'maximum': 4096},
+        },
+      });
+
+      expect(grammar, contains('space ":" space integer "}" space'));
+    });
+
+    test('covers the evaluation output schema', () {
+      final grammar = JsonSchemaGrammar.fromSchema(EvaluationUseCase.outputSchema);
+
+      expect(grammar, startsWith(r'root ::= "{" space "\"clarity_score\""'));
+      expect(grammar, contains('clarity-score ::= ("1" | "2" |'));
+      expect(grammar, contains(r'overall-feedback ::= "\"" char{0,320} "\"" space'));
+    });
+
+    test('rejects unsupported schemas', () {
+      expect(
+        () => JsonSchemaGrammar.fromSchema({'type': 'null'}),
+        throwsArgumentError,
+      );
+    });
+  });
+}
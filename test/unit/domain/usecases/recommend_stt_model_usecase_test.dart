@@ -0,0 +1,123 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:mocktail/mocktail.dart';
+import 'package:dartz/dartz.dart';
+
+import 'package:micro_llm_app/core/error/failures.dart';
+import 'package:micro_llm_app/core/utils/result.dart';
+import 'package:micro_llm_app/domain/entities/memory_estimate.dart';
+import 'package:micro_llm_app/domain/entities/model_info.dart';
+import 'package:micro_llm_app/domain/repositories/llm_repository.dart';
+import 'package:micro_llm_app/domain/repositories/voice_repository.dart';
+import 'package:micro_llm_app/domain/usecases/recommend_stt_model_usecase.dart';
+import 'package:micro_llm_app/domain/usecases/usecase.dart';
+
+// Mocks
+class MockLLMRepository extends Mock implements LLMRepository {}
+
+class MockVoiceRepository extends Mock implements VoiceRepository {}
+
+void main() {
+  const mib = 1024 * 1024;
+
+  late RecommendSttModelUseCase useCase;
+  late MockLLMRepository llmRepository;
+  late MockVoiceRepository voiceRepository;
+
+  void givenAvailable(int bytes) {
+    when(() => llmRepository.checkMemoryStatus()).thenAnswer(
+      (_) async => Right(MemoryStatus(
+        totalBytes: 8 * 1024 * mib,
+        availableBytes: bytes,
+        appUsageBytes: 0,
+      )),
+    );
+  }
+
+  void givenLoadedLlm(int weightsBytes) {
+    when(() => llmRepository.currentModelInfo).thenReturn(ModelInfo(
+      fileName: 'model.gguf',
+      filePath: '/models/model.gguf',
+      sizeBytes: weightsBytes,
+      quantization: 'Q4_K_M',
+      parameterCount: '1.5B',
+      contextSize: 2048,
+      isLoaded: true,
+      memoryEstimate: MemoryEstimate(
+        weightsBytes: weightsBytes,
+        kvCacheBytes: 200 * mib,
+        computeBytes: 100 * mib,
+      ),
+    ));
+  }
+
+  setUp(() {
+    llmRepository = MockLLMRepository();
+    voiceRepository = MockVoiceRepository();
+    useCase = RecommendSttModelUseCase(
+      llmRepository: llmRepository,
+      voiceRepository: voiceRepository,
+    );
+    when(() => llmRepository.currentModelInfo).thenReturn(null);
+    when(() => voiceRepository.getWhisperResidentBytes())
+        .thenAnswer((_) async => const Right(null));
+  });
+
+  group('RecommendSttModelUseCase', () {
+    test('recommends the largest model when memory is plentiful', () async {
+      givenAvailable(2000 * mib);
+
+      final fit = (await useCase(const NoParams())).getOrThrow();
+
+      expect(fit.recommended?.id, 'small');
+      expect(fit.fitting, hasLength(6));
+    });
+
+    test('keeps the loaded LLM weights free and offers what fits beside them',
+        () async {
+      givenAvailable(1800 * mib);
+      givenLoadedLlm(1200 * mib);
+
+      final fit = (await useCase(const NoParams())).getOrThrow();
+
+      // 600 MiB left: Small F16 (466 MiB + 320 MiB buffers) does not fit.
+      expect(fit.reservedBytes, 1200 * mib);
+      expect(fit.recommended?.id, 'small-q8_0');
+      expect(fit.fits('small'), isFalse);
+      expect(fit.fits('small-q5_1'), isTrue);
+    });
+
+    test('counts the loaded Whisper model as free for a replacement', () async {
+      givenAvailable(300 * mib);
+      when(() => voiceRepository.getWhisperResidentBytes())
+          .thenAnswer((_) async => const Right(300 * mib));
+
+      final fit = (await useCase(const NoParams())).getOrThrow();
+
+      expect(fit.availableBytes, 600 * mib);
+      expect(fit.recommended?.id, 'small-q8_0');
+    });
+
+    test('recommends nothing when no model fits', () async {
+      givenAvailable(200 * mib);
+
+      final fit = (await useCase(const NoParams())).getOrThrow();
+
+      expect(fit.recommended, isNull);
+      expect(fit.fitting, isEmpty);
+    });
+
+    test('returns the failure when memory cannot be read', () async {
+      when(() => llmRepository.checkMemoryStatus()).thenAnswer(
+        (_) async => const Left(LLMFailure(
+          message: 'no memory info',
+          type: LLMFailureType.outOfMemory,
+        )),
+      );
+
+      final result = await useCase(const NoParams());
+
+      expect(result.isLeft(), isTrue);
+      verifyNever(() => voiceRepository.getWhisperResidentBytes());
+    });
+  });
+}
@@ -0,0 +1,34 @@
+import 'package:flutter_test/flutter_test.dart';
+
+import 'package:micro_llm_app/native/sha256_bindings.dart';
+
+void main() {
+  group('StreamingSha256', () {
+    test('digest does not depend on how the bytes are chunked', () {
+      final whole = StreamingSha256()..add('abc'.codeUnits);
+      final split = StreamingSha256()
+        ..add('a'.codeUnits)
+        ..add('bc'.codeUnits);
+
+      const expected =
+          'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad';
+      expect(whole.close(), expected);
+      expect(split.close(), expected);
+    });
+  });
+
+  group('sha256FromEtag', () {
+    const sha =
+        '9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08';
+
+    test('accepts quoted and weak Hugging Face etags', () {
+      expect(sha256FromEtag('"$sha"'), sha);
+      expect(sha256FromEtag('W/"${sha.toUpperCase()}"'), sha);
+    });
+
+    test('rejects etags that are not SHA-256 digests', () {
+      expect(sha256FromEtag(null), isNull);
+      expect(sha256FromEtag('"5d41402abc4b2a76b9719d911017c592"'), isNull);
+    });
+  });
+}